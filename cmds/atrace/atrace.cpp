@@ -900,7 +900,10 @@ static void stopTrace()
 // Read data from the tracing pipe and forward to stdout
 static void streamTrace()
 {
-    char trace_data[4096];
+    // Match the dump path's buffer size: a read drains whatever the pipe has
+    // ready, and 4KiB reads made busy traces pay a syscall per page.
+    constexpr size_t bufSize = 64*1024;
+    std::unique_ptr<char[]> trace_data(new char[bufSize]);
     int traceFD = open((g_traceFolder + k_traceStreamPath).c_str(), O_RDWR);
     if (traceFD == -1) {
         fprintf(stderr, "error opening %s: %s (%d)\n", k_traceStreamPath,
@@ -908,10 +911,9 @@ static void streamTrace()
         return;
     }
     while (!g_traceAborted) {
-        ssize_t bytes_read = read(traceFD, trace_data, 4096);
+        ssize_t bytes_read = read(traceFD, trace_data.get(), bufSize);
         if (bytes_read > 0) {
-            write(STDOUT_FILENO, trace_data, bytes_read);
-            fflush(stdout);
+            write(STDOUT_FILENO, trace_data.get(), bytes_read);
         } else {
             if (!g_traceAborted) {
                 fprintf(stderr, "read returned %zd bytes err %d (%s)\n",
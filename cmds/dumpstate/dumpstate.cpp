@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/mount.h>
 #include <sys/poll.h>
 #include <sys/prctl.h>
@@ -54,6 +55,7 @@
 #include <regex>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -230,6 +232,7 @@ static const std::string DUMP_INCIDENT_REPORT_TASK = "INCIDENT REPORT";
 static const std::string DUMP_HALS_TASK = "DUMP HALS";
 static const std::string DUMP_BOARD_TASK = "dumpstate_board()";
 static const std::string DUMP_CHECKINS_TASK = "DUMP CHECKINS";
+static const std::string DUMP_APP_INFOS_TASK = "DUMP APP INFOS";
 
 namespace android {
 namespace os {
@@ -1603,6 +1606,7 @@ static Dumpstate::RunStatus dumpstate() {
         ds.dump_pool_->enqueueTask(DUMP_INCIDENT_REPORT_TASK, &DumpIncidentReport);
         ds.dump_pool_->enqueueTaskWithFd(DUMP_BOARD_TASK, &Dumpstate::DumpstateBoard, &ds, _1);
         ds.dump_pool_->enqueueTaskWithFd(DUMP_CHECKINS_TASK, &DumpCheckins, _1);
+        ds.dump_pool_->enqueueTaskWithFd(DUMP_APP_INFOS_TASK, &DumpAppInfos, _1);
     }
 
     // Dump various things. Note that anything that takes "long" (i.e. several seconds) should
@@ -1768,7 +1772,11 @@ static Dumpstate::RunStatus dumpstate() {
         RUN_SLOW_FUNCTION_WITH_CONSENT_CHECK_AND_LOG(DUMP_CHECKINS_TASK, DumpCheckins);
     }
 
-    RUN_SLOW_FUNCTION_WITH_CONSENT_CHECK(DumpAppInfos);
+    if (ds.dump_pool_) {
+        WAIT_TASK_WITH_CONSENT_CHECK(DUMP_APP_INFOS_TASK, ds.dump_pool_);
+    } else {
+        RUN_SLOW_FUNCTION_WITH_CONSENT_CHECK_AND_LOG(DUMP_APP_INFOS_TASK, DumpAppInfos);
+    }
 
     printf("========================================================\n");
     printf("== Dropbox crashes\n");
@@ -2115,13 +2123,19 @@ Dumpstate::RunStatus Dumpstate::DumpTraces(const char** path) {
         return RunStatus::OK;
     }
 
-    // Number of times process dumping has timed out. If we encounter too many
-    // failures, we'll give up.
-    int timeout_failures = 0;
     bool dalvik_found = false;
 
     const std::set<int> hal_pids = get_interesting_hal_pids();
 
+    // First pass: decide which processes to dump. The dumps themselves run
+    // below, a bounded number at a time, so the worst case tracks the slowest
+    // processes rather than the sum of every per-process timeout.
+    struct TraceTarget {
+        int pid;
+        bool is_java_process;
+    };
+    std::vector<TraceTarget> targets;
+
     struct dirent* d;
     while ((d = readdir(proc.get()))) {
         RETURN_IF_USER_DENIED_CONSENT();
@@ -2152,34 +2166,90 @@ Dumpstate::RunStatus Dumpstate::DumpTraces(const char** path) {
             continue;
         }
 
-        // If 3 backtrace dumps fail in a row, consider debuggerd dead.
-        if (timeout_failures == 3) {
-            dprintf(fd, "ERROR: Too many stack dump failures, exiting.\n");
-            break;
+        targets.push_back({pid, is_java_process});
+    }
+
+    // Each process unwinds itself, so dumping a few concurrently mostly
+    // overlaps waiting. Keep the width modest to bound the extra load this
+    // puts on an already struggling system.
+    constexpr size_t kConcurrentDumps = 4;
+
+    // Number of times process dumping has timed out. If we encounter too many
+    // failures, we'll give up.
+    int timeout_failures = 0;
+
+    for (size_t base = 0; base < targets.size(); base += kConcurrentDumps) {
+        RETURN_IF_USER_DENIED_CONSENT();
+        const size_t wave_size = std::min(kConcurrentDumps, targets.size() - base);
+
+        struct DumpResult {
+            android::base::unique_fd fd;
+            int ret = -1;
+            uint64_t elapsed_ns = 0;
+        };
+        std::vector<DumpResult> results(wave_size);
+        std::vector<std::thread> threads;
+
+        for (size_t i = 0; i < wave_size; i++) {
+            results[i].fd.reset(memfd_create("dumptrace", MFD_CLOEXEC));
+            if (results[i].fd.get() == -1) {
+                MYLOGE("memfd_create failed: %s\n", strerror(errno));
+                continue;
+            }
+            const TraceTarget& target = targets[base + i];
+            threads.emplace_back([&results, i, target] {
+                const uint64_t start = Nanotime();
+                results[i].ret = dump_backtrace_to_file_timeout(
+                        target.pid,
+                        target.is_java_process ? kDebuggerdJavaBacktrace : kDebuggerdNativeBacktrace,
+                        target.is_java_process ? 5 : 20, results[i].fd.get());
+                results[i].elapsed_ns = Nanotime() - start;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
         }
 
-        const uint64_t start = Nanotime();
-        const int ret = dump_backtrace_to_file_timeout(
-            pid, is_java_process ? kDebuggerdJavaBacktrace : kDebuggerdNativeBacktrace,
-            is_java_process ? 5 : 20, fd);
+        // Concatenate the results in collection order so the output matches
+        // what sequential dumping produced.
+        bool too_many_failures = false;
+        for (size_t i = 0; i < wave_size; i++) {
+            const TraceTarget& target = targets[base + i];
+            DumpResult& result = results[i];
+
+            if (result.fd.get() != -1 && result.ret != -1) {
+                // We've successfully dumped stack traces, reset the failure
+                // count, append the dump and a summary of the elapsed time.
+                timeout_failures = 0;
+
+                if (lseek(result.fd.get(), 0, SEEK_SET) == -1 ||
+                    !CopyFile(result.fd.get(), fd)) {
+                    MYLOGE("Failed to copy stack dump for pid %d: %s\n", target.pid,
+                           strerror(errno));
+                }
+                dprintf(fd, "[dump %s stack %d: %.3fs elapsed]\n",
+                        target.is_java_process ? "dalvik" : "native", target.pid,
+                        (float)result.elapsed_ns / NANOS_PER_SEC);
+                continue;
+            }
 
-        if (ret == -1) {
             // For consistency, the header and footer to this message match those
             // dumped by debuggerd in the success case.
-            dprintf(fd, "\n---- pid %d at [unknown] ----\n", pid);
+            dprintf(fd, "\n---- pid %d at [unknown] ----\n", target.pid);
             dprintf(fd, "Dump failed, likely due to a timeout.\n");
-            dprintf(fd, "---- end %d ----", pid);
+            dprintf(fd, "---- end %d ----", target.pid);
             timeout_failures++;
-            continue;
-        }
 
-        // We've successfully dumped stack traces, reset the failure count
-        // and write a summary of the elapsed time to the file and continue with the
-        // next process.
-        timeout_failures = 0;
-
-        dprintf(fd, "[dump %s stack %d: %.3fs elapsed]\n", is_java_process ? "dalvik" : "native",
-                pid, (float)(Nanotime() - start) / NANOS_PER_SEC);
+            // If 3 backtrace dumps fail in a row, consider debuggerd dead.
+            if (timeout_failures == 3) {
+                dprintf(fd, "ERROR: Too many stack dump failures, exiting.\n");
+                too_many_failures = true;
+                break;
+            }
+        }
+        if (too_many_failures) {
+            break;
+        }
     }
 
     if (!dalvik_found) {
@@ -254,34 +254,55 @@ int Dumpsys::main(int argc, char* const argv[]) {
         return 0;
     }
 
+    Vector<String16> servicesToDump;
     for (size_t i = 0; i < N; i++) {
-        const String16& serviceName = services[i];
-        if (IsSkipped(skippedServices, serviceName)) continue;
+        if (IsSkipped(skippedServices, services[i])) continue;
+        servicesToDump.add(services[i]);
+    }
 
-        if (startDumpThread(type, serviceName, args) == OK) {
-            bool addSeparator = (N > 1);
-            if (addSeparator) {
-                writeDumpHeader(STDOUT_FILENO, serviceName, priorityFlags);
-            }
-            std::chrono::duration<double> elapsedDuration;
-            size_t bytesWritten = 0;
-            status_t status =
-                writeDump(STDOUT_FILENO, serviceName, std::chrono::milliseconds(timeoutArgMs),
-                          asProto, elapsedDuration, bytesWritten);
-
-            if (status == TIMED_OUT) {
-                std::cout << std::endl
-                     << "*** SERVICE '" << serviceName << "' DUMP TIMEOUT (" << timeoutArgMs
-                     << "ms) EXPIRED ***" << std::endl
-                     << std::endl;
-            }
+    // Dump with one service of lookahead: while one service's output is being
+    // drained to stdout, the next service's dump thread is already running and
+    // filling its pipe, so collection overlaps with writing instead of
+    // serializing behind it. Output order is unchanged, and a slow service
+    // delays the ones after it by at most its own drain time.
+    const size_t M = servicesToDump.size();
+    Dumpsys pipeline[2]{Dumpsys(sm_), Dumpsys(sm_)};
+    status_t startStatus[2];
+    if (M > 0) {
+        startStatus[0] = pipeline[0].startDumpThread(type, servicesToDump[0], args);
+    }
+    for (size_t i = 0; i < M; i++) {
+        const String16& serviceName = servicesToDump[i];
+        Dumpsys& current = pipeline[i % 2];
+        if (i + 1 < M) {
+            startStatus[(i + 1) % 2] =
+                pipeline[(i + 1) % 2].startDumpThread(type, servicesToDump[i + 1], args);
+        }
+        if (startStatus[i % 2] != OK) continue;
 
-            if (addSeparator) {
-                writeDumpFooter(STDOUT_FILENO, serviceName, elapsedDuration);
-            }
-            bool dumpComplete = (status == OK);
-            stopDumpThread(dumpComplete);
+        bool addSeparator = (N > 1);
+        if (addSeparator) {
+            current.writeDumpHeader(STDOUT_FILENO, serviceName, priorityFlags);
+        }
+        std::chrono::duration<double> elapsedDuration;
+        size_t bytesWritten = 0;
+        status_t status =
+            current.writeDump(STDOUT_FILENO, serviceName,
+                              std::chrono::milliseconds(timeoutArgMs), asProto, elapsedDuration,
+                              bytesWritten);
+
+        if (status == TIMED_OUT) {
+            std::cout << std::endl
+                 << "*** SERVICE '" << serviceName << "' DUMP TIMEOUT (" << timeoutArgMs
+                 << "ms) EXPIRED ***" << std::endl
+                 << std::endl;
+        }
+
+        if (addSeparator) {
+            current.writeDumpFooter(STDOUT_FILENO, serviceName, elapsedDuration);
         }
+        bool dumpComplete = (status == OK);
+        current.stopDumpThread(dumpComplete);
     }
 
     return 0;
@@ -25,7 +25,7 @@ namespace android {
 
 #define NELEMS(x) ((int) (sizeof(x) / sizeof((x)[0])))
 
-enum { MAX_NUM_LAYERS = 16 };
+enum { MAX_NUM_LAYERS = 32 };
 enum { MAX_TEST_RUNS = 16 };
 
 class Composer;
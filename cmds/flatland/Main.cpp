@@ -36,6 +36,8 @@ using namespace ::android;
 
 static uint32_t g_SleepBetweenSamplesMs = 0;
 static bool     g_PresentToWindow       = false;
+static bool     g_JsonOutput            = false;
+static bool     g_JsonResultPrinted     = false;
 static size_t   g_BenchmarkNameLen      = 0;
 
 struct BenchmarkDesc {
@@ -201,6 +203,82 @@ static const BenchmarkDesc benchmarks[] = {
             },
         },
     },
+
+    { "19.5:9 Modern App -> Home Transition",
+        1440, 3120, { 780, 1560, 3120 },
+        {
+            {   // Wallpaper
+                0, staticGradient, opaque,
+                0,    110,    1440,   2890,
+            },
+            {   // Launcher
+                0, staticGradient, blend,
+                0,    110,    1440,   2890,
+            },
+            {   // Outgoing activity
+                0, staticGradient, blendShrink,
+                20,   130,    1400,   2850,
+            },
+            {   // Status bar
+                0, staticGradient, opaque,
+                0,    0,      1440,   110,
+            },
+            {   // Gesture navigation bar
+                0, staticGradient, blend,
+                0,    3000,   1440,   120,
+            },
+        },
+    },
+
+    // A freeform-style stack of many blended windows over a wallpaper. This
+    // is well past what phone UIs show at once, but it approximates desktop
+    // or stress-test layer counts and scales the per-layer composition cost.
+    { "16:9 Many Windows",
+        1920, 1080, { 540, 810, 1080 },
+        {
+            {   // Wallpaper
+                0, staticGradient, opaque,
+                0,    40,     1920,   960,
+            },
+            {   // Status bar
+                0, staticGradient, opaque,
+                0,    0,      1920,   40,
+            },
+            {   // Navigation bar
+                0, staticGradient, opaque,
+                0,    1000,   1920,   80,
+            },
+            // 28 windows in a 4x7 cascade.
+            { 0, staticGradient, blend,     0,     40,   480,   270, },
+            { 0, staticGradient, blend,   480,     40,   480,   270, },
+            { 0, staticGradient, blend,   960,     40,   480,   270, },
+            { 0, staticGradient, blend,  1440,     40,   480,   270, },
+            { 0, staticGradient, blend,     0,    140,   480,   270, },
+            { 0, staticGradient, blend,   480,    140,   480,   270, },
+            { 0, staticGradient, blend,   960,    140,   480,   270, },
+            { 0, staticGradient, blend,  1440,    140,   480,   270, },
+            { 0, staticGradient, blend,     0,    240,   480,   270, },
+            { 0, staticGradient, blend,   480,    240,   480,   270, },
+            { 0, staticGradient, blend,   960,    240,   480,   270, },
+            { 0, staticGradient, blend,  1440,    240,   480,   270, },
+            { 0, staticGradient, blend,     0,    340,   480,   270, },
+            { 0, staticGradient, blend,   480,    340,   480,   270, },
+            { 0, staticGradient, blend,   960,    340,   480,   270, },
+            { 0, staticGradient, blend,  1440,    340,   480,   270, },
+            { 0, staticGradient, blend,     0,    440,   480,   270, },
+            { 0, staticGradient, blend,   480,    440,   480,   270, },
+            { 0, staticGradient, blend,   960,    440,   480,   270, },
+            { 0, staticGradient, blend,  1440,    440,   480,   270, },
+            { 0, staticGradient, blend,     0,    540,   480,   270, },
+            { 0, staticGradient, blend,   480,    540,   480,   270, },
+            { 0, staticGradient, blend,   960,    540,   480,   270, },
+            { 0, staticGradient, blend,  1440,    540,   480,   270, },
+            { 0, staticGradient, blend,     0,    640,   480,   270, },
+            { 0, staticGradient, blend,   480,    640,   480,   270, },
+            { 0, staticGradient, blend,   960,    640,   480,   270, },
+            { 0, staticGradient, blend,  1440,    640,   480,   270, },
+        },
+    },
 };
 
 static const ShaderDesc shaders[] = {
@@ -590,13 +668,17 @@ static int cmpDouble(const double* lhs, const double* rhs) {
 static bool runTest(const BenchmarkDesc b, size_t run) {
     bool success = true;
     double prevResult = 0.0, result = 0.0;
+    double msPerFrame = 0.0;
+    const char* skipReason = nullptr;
     Vector<double> samples;
 
     uint32_t runHeight = b.runHeights[run];
     uint32_t runWidth = b.width * runHeight / b.height;
-    printf(" %-*s | %4d x %4d | ", static_cast<int>(g_BenchmarkNameLen), b.name,
-            runWidth, runHeight);
-    fflush(stdout);
+    if (!g_JsonOutput) {
+        printf(" %-*s | %4d x %4d | ", static_cast<int>(g_BenchmarkNameLen), b.name,
+                runWidth, runHeight);
+        fflush(stdout);
+    }
 
     BenchmarkRunner r(b, run);
     if (!r.setUp()) {
@@ -627,11 +709,11 @@ static bool runTest(const BenchmarkDesc b, size_t run) {
 
     if (totalFrames - warmUpFrames > 16) {
         // The test runs too fast to get a stable result.  Skip it.
-        printf("  fast");
+        skipReason = "fast";
         goto done;
     } else if (totalFrames == 5 && runTime > 200e6) {
         // The test runs too slow to be very useful.  Skip it.
-        printf("  slow");
+        skipReason = "slow";
         goto done;
     }
 
@@ -642,7 +724,7 @@ static bool runTest(const BenchmarkDesc b, size_t run) {
         }
 
         if (newSamples > 512) {
-            printf("varies");
+            skipReason = "varies";
             goto done;
         }
 
@@ -668,11 +750,32 @@ static bool runTest(const BenchmarkDesc b, size_t run) {
         result = (samples[elem-1] + samples[elem]) * 0.5;
     } while (fabs(result - prevResult) > threshold * result);
 
-    printf("%6.3f", result / double(totalFrames - warmUpFrames) / 1e6);
+    msPerFrame = result / double(totalFrames - warmUpFrames) / 1e6;
 
 done:
 
-    printf("\n");
+    if (g_JsonOutput) {
+        if (success) {
+            if (g_JsonResultPrinted) {
+                printf(",\n");
+            }
+            printf("  { \"scenario\": \"%s\", \"width\": %u, \"height\": %u, ",
+                    b.name, runWidth, runHeight);
+            if (skipReason != nullptr) {
+                printf("\"skipped\": \"%s\" }", skipReason);
+            } else {
+                printf("\"frameTimeMs\": %.3f }", msPerFrame);
+            }
+            g_JsonResultPrinted = true;
+        }
+    } else {
+        if (skipReason != nullptr) {
+            printf("%6s", skipReason);
+        } else if (success) {
+            printf("%6.3f", msPerFrame);
+        }
+        printf("\n");
+    }
     fflush(stdout);
     r.tearDown();
 
@@ -691,7 +794,11 @@ static void printResultsTableHeader() {
 
 // Run ALL the benchmarks!
 static bool runTests() {
-    printResultsTableHeader();
+    if (g_JsonOutput) {
+        printf("[\n");
+    } else {
+        printResultsTableHeader();
+    }
 
     for (size_t i = 0; i < NELEMS(benchmarks); i++) {
         const BenchmarkDesc& b = benchmarks[i];
@@ -701,6 +808,10 @@ static bool runTests() {
             }
         }
     }
+
+    if (g_JsonOutput) {
+        printf("\n]\n");
+    }
     return true;
 }
 
@@ -723,6 +834,7 @@ static void showHelp(const char *cmd) {
     fprintf(stderr, "options include:\n"
                     "  -s N            sleep for N ms between samples\n"
                     "  -d              display the test frame to a window\n"
+                    "  -j, --json      print results as a JSON array rather than a table\n"
                     "  --help          print this helpful message and exit\n"
             );
 }
@@ -738,10 +850,11 @@ int main(int argc, char** argv) {
         int option_index = 0;
         static struct option long_options[] = {
             {"help",     no_argument, 0,  0 },
+            {"json",     no_argument, 0, 'j'},
             {     0,               0, 0,  0 }
         };
 
-        ret = getopt_long(argc, argv, "ds:",
+        ret = getopt_long(argc, argv, "djs:",
                           long_options, &option_index);
 
         if (ret < 0) {
@@ -753,6 +866,10 @@ int main(int argc, char** argv) {
                 g_PresentToWindow = true;
             break;
 
+            case 'j':
+                g_JsonOutput = true;
+            break;
+
             case 's':
                 g_SleepBetweenSamplesMs = atoi(optarg);
             break;
@@ -772,11 +889,13 @@ int main(int argc, char** argv) {
 
     g_BenchmarkNameLen = maxBenchmarkNameLen();
 
-    printf(" cmdline:");
-    for (int i = 0; i < argc; i++) {
-        printf(" %s", argv[i]);
+    if (!g_JsonOutput) {
+        printf(" cmdline:");
+        for (int i = 0; i < argc; i++) {
+            printf(" %s", argv[i]);
+        }
+        printf("\n");
     }
-    printf("\n");
 
     if (!runTests()) {
         fprintf(stderr, "exiting due to error.\n");
@@ -1649,30 +1649,33 @@ static void collectManualStats(const std::string& path, struct stats* stats) {
         const char *name = de->d_name;
 
         int64_t size = 0;
-        if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) == 0) {
-            size = s.st_blocks * 512;
-        }
-
         if (de->d_type == DT_DIR) {
-            if (!strcmp(name, ".")) {
-                // Don't recurse, but still count node size
-            } else if (!strcmp(name, "..")) {
+            if (!strcmp(name, "..")) {
                 // Don't recurse or count node size
                 continue;
+            } else if (!strcmp(name, ".")) {
+                // Don't recurse, but still count node size
+                if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) == 0) {
+                    size = s.st_blocks * 512;
+                }
             } else {
-                // Measure all children nodes
-                size = 0;
+                // Measure all children nodes; the tree walk already counts
+                // the directory node itself, so no separate stat is needed
                 calculate_tree_size(StringPrintf("%s/%s", path.c_str(), name), &size);
             }
 
             if (!strcmp(name, "cache") || !strcmp(name, "code_cache")) {
                 stats->cacheSize += size;
             }
-        }
+        } else {
+            // Legacy symlink isn't owned by app
+            if (de->d_type == DT_LNK && !strcmp(name, "lib")) {
+                continue;
+            }
 
-        // Legacy symlink isn't owned by app
-        if (de->d_type == DT_LNK && !strcmp(name, "lib")) {
-            continue;
+            if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) == 0) {
+                size = s.st_blocks * 512;
+            }
         }
 
         // Everything found inside is considered data
@@ -1699,17 +1702,20 @@ static void collectManualStatsForUser(const std::string& path, struct stats* sta
     while ((de = readdir(d))) {
         if (de->d_type == DT_DIR) {
             const char *name = de->d_name;
-            if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) != 0) {
-                continue;
-            }
-            int32_t user_uid = multiuser_get_app_id(s.st_uid);
             if (!strcmp(name, ".") || !strcmp(name, "..")) {
                 continue;
-            } else if (exclude_apps && (user_uid >= AID_APP_START && user_uid <= AID_APP_END)) {
-                continue;
-            } else {
-                collectManualStats(StringPrintf("%s/%s", path.c_str(), name), stats);
             }
+            // Only stat when we actually need the owner to filter apps out
+            if (exclude_apps) {
+                if (fstatat(dfd, name, &s, AT_SYMLINK_NOFOLLOW) != 0) {
+                    continue;
+                }
+                int32_t user_uid = multiuser_get_app_id(s.st_uid);
+                if (user_uid >= AID_APP_START && user_uid <= AID_APP_END) {
+                    continue;
+                }
+            }
+            collectManualStats(StringPrintf("%s/%s", path.c_str(), name), stats);
         }
     }
     closedir(d);
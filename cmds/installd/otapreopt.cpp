@@ -133,6 +133,18 @@ class OTAPreoptService {
             return 3;
         }
 
+        // A skipped package needs none of the remaining setup. Deciding here
+        // avoids running derive_classpath and verifying the boot image for
+        // every package that is already preopted in the system image.
+        if (ShouldSkipPreopt()) {
+            return 0;
+        }
+
+        if (!ReadBootClassPath()) {
+            LOG(ERROR) << "Failed deriving boot classpath.";
+            return 3;
+        }
+
         if (!CheckAndInitializeInstalldGlobals()) {
             LOG(ERROR) << "Failed initializing globals.";
             return 4;
@@ -192,37 +204,37 @@ private:
         return true;
     }
 
-    bool ReadEnvironment() {
-        // Parse the environment variables from init.environ.rc, which have the form
-        //   export NAME VALUE
-        // For simplicity, don't respect string quotation. The values we are interested in can be
-        // encoded without them.
-        //
-        // init.environ.rc and derive_classpath all have the same format for
-        // environment variable exports (since they are all meant to be read by
-        // init) and can be matched by the same regex.
-
+    // Parse environment variable exports of the form
+    //   export NAME VALUE
+    // For simplicity, don't respect string quotation. The values we are interested in can be
+    // encoded without them.
+    //
+    // init.environ.rc and derive_classpath all have the same format for
+    // environment variable exports (since they are all meant to be read by
+    // init) and can be matched by the same regex.
+    template<typename T>
+    void ParseEnvironmentExports(T&& input) {
         std::regex export_regex("\\s*export\\s+(\\S+)\\s+(\\S+)");
-        auto parse_results = [&](auto& input) {
-          ParseFile(input, [&](const std::string& line) {
-              std::smatch export_match;
-              if (!std::regex_match(line, export_match, export_regex)) {
-                  return true;
-              }
+        ParseFile(input, [&](const std::string& line) {
+            std::smatch export_match;
+            if (!std::regex_match(line, export_match, export_regex)) {
+                return true;
+            }
 
-              if (export_match.size() != 3) {
-                  return true;
-              }
+            if (export_match.size() != 3) {
+                return true;
+            }
 
-              std::string name = export_match[1].str();
-              std::string value = export_match[2].str();
+            std::string name = export_match[1].str();
+            std::string value = export_match[2].str();
 
-              system_properties_.SetProperty(name, value);
+            system_properties_.SetProperty(name, value);
 
-              return true;
-          });
-        };
+            return true;
+        });
+    }
 
+    bool ReadEnvironment() {
         // TODO Just like with the system-properties above we really should have
         // common code between init and otapreopt to deal with reading these
         // things. See b/181182967
@@ -231,27 +243,10 @@ private:
         static constexpr const char* kEnvironmentVariableSources[] = {
                 "/init.environ.rc",
         };
-        // First get everything from the static files.
+        // Get everything from the static files. The boot classpath is derived
+        // separately (and later), as it requires running derive_classpath.
         for (const char* env_vars_file : kEnvironmentVariableSources) {
-          parse_results(env_vars_file);
-        }
-
-        // Next get everything from derive_classpath, since we're already in the
-        // chroot it will get the new versions of any dependencies.
-        {
-          android::base::unique_fd fd(memfd_create("derive_classpath_temp", MFD_CLOEXEC));
-          if (!fd.ok()) {
-            LOG(ERROR) << "Unable to create fd for derive_classpath";
-            return false;
-          }
-          std::string memfd_file = StringPrintf("/proc/%d/fd/%d", getpid(), fd.get());
-          std::string error_msg;
-          if (!Exec({"/apex/com.android.sdkext/bin/derive_classpath", memfd_file}, &error_msg)) {
-            PLOG(ERROR) << "Running derive_classpath failed: " << error_msg;
-            return false;
-          }
-          std::ifstream ifs(memfd_file);
-          parse_results(ifs);
+          ParseEnvironmentExports(env_vars_file);
         }
 
         if (system_properties_.GetProperty(kAndroidDataPathPropertyName) == nullptr) {
@@ -264,15 +259,35 @@ private:
         }
         android_root_ = *system_properties_.GetProperty(kAndroidRootPathPropertyName);
 
-        if (system_properties_.GetProperty(kBootClassPathPropertyName) == nullptr) {
+        if (system_properties_.GetProperty(ASEC_MOUNTPOINT_ENV_NAME) == nullptr) {
             return false;
         }
-        boot_classpath_ = *system_properties_.GetProperty(kBootClassPathPropertyName);
+        asec_mountpoint_ = *system_properties_.GetProperty(ASEC_MOUNTPOINT_ENV_NAME);
 
-        if (system_properties_.GetProperty(ASEC_MOUNTPOINT_ENV_NAME) == nullptr) {
+        return true;
+    }
+
+    bool ReadBootClassPath() {
+        // Get the boot classpath from derive_classpath, since we're already in
+        // the chroot it will get the new versions of any dependencies.
+        android::base::unique_fd fd(memfd_create("derive_classpath_temp", MFD_CLOEXEC));
+        if (!fd.ok()) {
+          LOG(ERROR) << "Unable to create fd for derive_classpath";
+          return false;
+        }
+        std::string memfd_file = StringPrintf("/proc/%d/fd/%d", getpid(), fd.get());
+        std::string error_msg;
+        if (!Exec({"/apex/com.android.sdkext/bin/derive_classpath", memfd_file}, &error_msg)) {
+          PLOG(ERROR) << "Running derive_classpath failed: " << error_msg;
+          return false;
+        }
+        std::ifstream ifs(memfd_file);
+        ParseEnvironmentExports(ifs);
+
+        if (system_properties_.GetProperty(kBootClassPathPropertyName) == nullptr) {
             return false;
         }
-        asec_mountpoint_ = *system_properties_.GetProperty(ASEC_MOUNTPOINT_ENV_NAME);
+        boot_classpath_ = *system_properties_.GetProperty(kBootClassPathPropertyName);
 
         return true;
     }
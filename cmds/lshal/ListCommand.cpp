@@ -19,13 +19,16 @@
 #include <getopt.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include <android-base/file.h>
 #include <android-base/logging.h>
@@ -209,6 +212,7 @@ bool ListCommand::getPidInfo(
 }
 
 const BinderPidInfo* ListCommand::getPidInfoCached(pid_t serverPid) {
+    std::lock_guard<std::mutex> lock(mCachedPidInfosMutex);
     auto pair = mCachedPidInfos.insert({serverPid, BinderPidInfo{}});
     if (pair.second /* did insertion take place? */) {
         if (!getPidInfo(serverPid, &pair.first->second)) {
@@ -585,16 +589,43 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
         return DUMP_BINDERIZED_ERROR;
     }
 
-    Status status = OK;
     std::map<std::string, TableEntry> allTableEntries;
+    std::vector<TableEntry*> entries;
+    entries.reserve(fqInstanceNames.size());
     for (const auto &fqInstanceName : fqInstanceNames) {
         // create entry and default assign all fields.
         TableEntry& entry = allTableEntries[fqInstanceName];
         entry.interfaceName = fqInstanceName;
         entry.transport = mode;
         entry.serviceStatus = ServiceStatus::NON_RESPONSIVE;
+        entries.push_back(&entry);
+    }
+
+    // Interrogate the services concurrently so that a single unresponsive
+    // server costs one timeout instead of stalling every entry behind it.
+    // Warnings go to per-entry buffers and are emitted in map order below, so
+    // the output is identical to a sequential fetch.
+    std::vector<std::ostringstream> errors(entries.size());
+    std::vector<Status> statuses(entries.size(), OK);
+    constexpr size_t kMaxFetchThreads = 8;
+    const size_t numThreads = std::min(kMaxFetchThreads, entries.size());
+    std::atomic<size_t> nextEntry(0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&] {
+            for (size_t e; (e = nextEntry.fetch_add(1)) < entries.size();) {
+                statuses[e] = fetchBinderizedEntry(manager, entries[e], errors[e]);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
 
-        status |= fetchBinderizedEntry(manager, &entry);
+    Status status = OK;
+    for (size_t e = 0; e < entries.size(); ++e) {
+        status |= statuses[e];
+        err() << errors[e].str();
     }
 
     for (auto& pair : allTableEntries) {
@@ -604,10 +635,10 @@ Status ListCommand::fetchBinderized(const sp<IServiceManager> &manager) {
 }
 
 Status ListCommand::fetchBinderizedEntry(const sp<IServiceManager> &manager,
-                                         TableEntry *entry) {
+                                         TableEntry *entry, std::ostream &err) {
     Status status = OK;
     const auto handleError = [&](Status additionalError, const std::string& msg) {
-        err() << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
+        err << "Warning: Skipping \"" << entry->interfaceName << "\": " << msg << std::endl;
         status |= DUMP_BINDERIZED_ERROR | additionalError;
     };
 
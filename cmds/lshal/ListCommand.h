@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -99,8 +100,10 @@ protected:
     Status fetchManifestHals();
     Status fetchLazyHals();
 
+    // Fetch information for a single service. May run on a worker thread, so
+    // warnings are written to |err| rather than the shared error stream.
     Status fetchBinderizedEntry(const sp<::android::hidl::manager::V1_0::IServiceManager> &manager,
-                                TableEntry *entry);
+                                TableEntry *entry, std::ostream &err);
 
     // Get relevant information for a PID by parsing files under
     // /dev/binderfs/binder_logs or /d/binder.
@@ -185,8 +188,10 @@ protected:
     // If an entry exist and not empty, it contains the cached content of /proc/{pid}/cmdline.
     std::map<pid_t, std::string> mCmdlines;
 
-    // Cache for getPidInfo.
+    // Cache for getPidInfo. Guarded by mCachedPidInfosMutex because
+    // fetchBinderizedEntry runs on multiple threads.
     std::map<pid_t, BinderPidInfo> mCachedPidInfos;
+    std::mutex mCachedPidInfosMutex;
 
     // Cache for getPartition.
     std::map<pid_t, Partition> mPartitions;
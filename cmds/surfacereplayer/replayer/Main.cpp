@@ -49,6 +49,9 @@ void printHelpMenu() {
 
     std::cout << "  -n  Ignore timestamps and run through trace as fast as possible\n";
 
+    std::cout << "\n  -x [Scale]  Scale the recorded delays between increments, e.g. 0.5 "
+                 "replays at double speed and 2.0 at half speed\n";
+
     std::cout << "  -l  Indefinitely loop the replayer\n";
 
     std::cout << "  -h  Display help menu\n";
@@ -63,9 +66,10 @@ int main(int argc, char** argv) {
     bool pauseBeginning = false;
     int numThreads = DEFAULT_THREADS;
     long stopHere = -1;
+    float timeScale = 1.0f;
 
     int opt = 0;
-    while ((opt = getopt(argc, argv, "mt:s:nlh?")) != -1) {
+    while ((opt = getopt(argc, argv, "mt:s:nlx:h?")) != -1) {
         switch (opt) {
             case 'm':
                 pauseBeginning = true;
@@ -82,6 +86,13 @@ int main(int argc, char** argv) {
             case 'l':
                 loop = true;
                 break;
+            case 'x':
+                timeScale = atof(optarg);
+                if (timeScale <= 0.0f) {
+                    std::cerr << "Time scale must be positive...exiting" << std::endl;
+                    exit(1);
+                }
+                break;
             case 'h':
             case '?':
                 printHelpMenu();
@@ -102,7 +113,7 @@ int main(int argc, char** argv) {
 
     status_t status = NO_ERROR;
     do {
-        android::Replayer r(filename, pauseBeginning, numThreads, wait, stopHere);
+        android::Replayer r(filename, pauseBeginning, numThreads, wait, stopHere, timeScale);
         status = r.replay();
     } while(loop);
 
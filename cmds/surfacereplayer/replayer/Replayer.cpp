@@ -50,14 +50,15 @@ using namespace android;
 std::atomic_bool Replayer::sReplayingManually(false);
 
 Replayer::Replayer(const std::string& filename, bool replayManually, int numThreads, bool wait,
-        nsecs_t stopHere)
+        nsecs_t stopHere, float timeScale)
       : mTrace(),
         mLoaded(false),
         mIncrementIndex(0),
         mCurrentTime(0),
         mNumThreads(numThreads),
         mWaitForTimeStamps(wait),
-        mStopTimeStamp(stopHere) {
+        mStopTimeStamp(stopHere),
+        mTimeScale(timeScale) {
     srand(RAND_COLOR_SEED);
 
     std::string input;
@@ -81,14 +82,16 @@ Replayer::Replayer(const std::string& filename, bool replayManually, int numThre
     }
 }
 
-Replayer::Replayer(const Trace& t, bool replayManually, int numThreads, bool wait, nsecs_t stopHere)
+Replayer::Replayer(const Trace& t, bool replayManually, int numThreads, bool wait, nsecs_t stopHere,
+        float timeScale)
       : mTrace(t),
         mLoaded(true),
         mIncrementIndex(0),
         mCurrentTime(0),
         mNumThreads(numThreads),
         mWaitForTimeStamps(wait),
-        mStopTimeStamp(stopHere) {
+        mStopTimeStamp(stopHere),
+        mTimeScale(timeScale) {
     srand(RAND_COLOR_SEED);
     mCurrentTime = mTrace.increment(0).time_stamp();
 
@@ -654,8 +657,9 @@ void Replayer::updatePowerMode(const PowerModeUpdate& pmu, const std::shared_ptr
 }
 
 void Replayer::waitUntilTimestamp(int64_t timestamp) {
-    ALOGV("Waiting for %lld nanoseconds...", static_cast<int64_t>(timestamp - mCurrentTime));
-    std::this_thread::sleep_for(std::chrono::nanoseconds(timestamp - mCurrentTime));
+    const auto delay = static_cast<nsecs_t>(float(timestamp - mCurrentTime) * mTimeScale);
+    ALOGV("Waiting for %lld nanoseconds...", static_cast<int64_t>(delay));
+    std::this_thread::sleep_for(std::chrono::nanoseconds(delay));
 }
 
 status_t Replayer::loadSurfaceComposerClient() {
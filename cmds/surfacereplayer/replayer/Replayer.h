@@ -55,9 +55,10 @@ typedef google::protobuf::RepeatedPtrField<DisplayChange> DisplayChanges;
 class Replayer {
   public:
     Replayer(const std::string& filename, bool replayManually = false,
-            int numThreads = DEFAULT_THREADS, bool wait = true, nsecs_t stopHere = -1);
+            int numThreads = DEFAULT_THREADS, bool wait = true, nsecs_t stopHere = -1,
+            float timeScale = 1.0f);
     Replayer(const Trace& trace, bool replayManually = false, int numThreads = DEFAULT_THREADS,
-            bool wait = true, nsecs_t stopHere = -1);
+            bool wait = true, nsecs_t stopHere = -1, float timeScale = 1.0f);
 
     status_t replay();
 
@@ -145,6 +146,9 @@ class Replayer {
     bool mWaitingForNextVSync;
     bool mWaitForTimeStamps;
     nsecs_t mStopTimeStamp;
+    // Recorded inter-increment delays are multiplied by this before waiting,
+    // so values below 1 replay the trace faster than it was captured.
+    float mTimeScale = 1.0f;
     bool mHasStopped;
 
     std::mutex mLayerLock;
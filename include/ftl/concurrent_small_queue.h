@@ -0,0 +1,178 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace android::ftl {
+
+// Bounded queue with statically allocated storage for N elements, for cross-thread handoff
+// without contending a mutex on the fast path. Producers and consumers synchronize through
+// per-slot sequence counters (Dmitry Vyukov's bounded MPMC algorithm), so try_push and try_pop
+// are lock-free and never allocate. The blocking pop parks the consumer on a condition variable
+// (futex-backed on bionic), which producers only touch when a consumer is actually waiting, so
+// an uncontended push is a handful of atomic operations.
+//
+// N must be a power of two.
+//
+// Example usage:
+//
+//   ftl::ConcurrentSmallQueue<int, 4> queue;
+//   assert(queue.max_size() == 4u);
+//   assert(!queue.try_pop());
+//
+//   assert(queue.try_push(1));
+//   assert(queue.try_push(2));
+//   assert(queue.try_pop() == 1);
+//
+//   assert(queue.try_push(3));
+//   assert(queue.try_push(4));
+//   assert(queue.try_push(5));
+//   assert(!queue.try_push(6));  // Full.
+//
+//   assert(queue.pop() == 2);    // Would block if the queue were empty.
+//
+template <typename T, std::size_t N>
+class ConcurrentSmallQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+ public:
+  ConcurrentSmallQueue() {
+    for (std::size_t i = 0; i < N; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~ConcurrentSmallQueue() {
+    while (try_pop()) {
+    }
+  }
+
+  ConcurrentSmallQueue(const ConcurrentSmallQueue&) = delete;
+  ConcurrentSmallQueue& operator=(const ConcurrentSmallQueue&) = delete;
+
+  static constexpr std::size_t max_size() { return N; }
+
+  // Enqueues an element constructed from the arguments. Returns false if the queue is full.
+  // Lock-free unless a consumer is blocked in pop(). Safe to call from multiple threads.
+  template <typename... Args>
+  bool try_push(Args&&... args) {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[tail & kMask];
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(tail);
+      if (difference == 0) {
+        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+          new (&slot.storage) T(std::forward<Args>(args)...);
+          slot.sequence.store(tail + 1, std::memory_order_release);
+          wake_consumer();
+          return true;
+        }
+      } else if (difference < 0) {
+        // The slot still holds an element from the previous lap, i.e. the queue is full.
+        return false;
+      } else {
+        tail = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Dequeues the oldest element, or returns std::nullopt if the queue is empty. Lock-free.
+  // Safe to call from multiple threads, though the intended use is a single consumer.
+  std::optional<T> try_pop() {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[head & kMask];
+      const auto sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(head + 1);
+      if (difference == 0) {
+        if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+          T& element = *std::launder(reinterpret_cast<T*>(&slot.storage));
+          std::optional<T> result{std::move(element)};
+          element.~T();
+          slot.sequence.store(head + N, std::memory_order_release);
+          return result;
+        }
+      } else if (difference < 0) {
+        return std::nullopt;
+      } else {
+        head = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Dequeues the oldest element, blocking while the queue is empty.
+  T pop() {
+    while (true) {
+      if (auto element = try_pop()) {
+        return std::move(*element);
+      }
+      std::unique_lock lock(mutex_);
+      waiters_.fetch_add(1, std::memory_order_relaxed);
+      // Pairs with the fence in wake_consumer: either a concurrent producer observes the waiter
+      // count and notifies under the mutex, or the try_pop below observes its element.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (auto element = try_pop()) {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return std::move(*element);
+      }
+      not_empty_.wait(lock);
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct Slot {
+    std::atomic<std::size_t> sequence;
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+  };
+
+  static constexpr std::size_t kMask = N - 1;
+
+  void wake_consumer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) > 0) {
+      // Taking the mutex serializes with the waiter between its registration and its wait, so
+      // the notification cannot be lost.
+      std::lock_guard lock(mutex_);
+      not_empty_.notify_one();
+    }
+  }
+
+  Slot slots_[N];
+
+  // On separate cache lines so producers and consumers do not false-share their cursors.
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  alignas(64) std::atomic<std::size_t> head_{0};
+
+  alignas(64) std::atomic<std::size_t> waiters_{0};
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+};
+
+}  // namespace android::ftl
@@ -74,6 +74,16 @@ using future_result_t = typename future_result<T>::type;
 //
 //   assert(chain.get() == 'b');
 //
+// A chain can be split into a std::shared_future so that multiple consumers may wait on and
+// query the result:
+//
+//   std::shared_future<int> shared = ftl::chain(ftl::yield(3))
+//                                        .then([](int x) { return x * 10; })
+//                                        .share();
+//
+//   assert(shared.get() == 30);
+//   assert(shared.get() == 30);
+//
 template <typename T>
 struct Chain {
   // Implicit conversion.
@@ -96,6 +106,8 @@ struct Chain {
         std::move(future), std::forward<F>(op));
   }
 
+  std::shared_future<T> share() && { return future.share(); }
+
   std::future<T> future;
 };
 
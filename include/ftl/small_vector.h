@@ -210,6 +210,20 @@ class SmallVector final : ArrayTraits<T>, ArrayComparators<SmallVector> {
     insert<kInsertStatic, kInsertDynamic>(std::move(v));
   }
 
+  // Extends the capacity to fit a given number of elements. If count exceeds the static capacity,
+  // the vector is promoted to dynamic storage of that capacity, relocating the elements only once
+  // rather than again on the insertion that would otherwise overflow the static capacity.
+  //
+  // All iterators are invalidated if the vector is promoted or its dynamic storage is reallocated.
+  //
+  void reserve(size_type count) {
+    if (Dynamic* const vector = std::get_if<Dynamic>(&vector_)) {
+      vector->reserve(count);
+    } else if (count > N) {
+      promote(std::get<Static>(vector_), count);
+    }
+  }
+
   // Removes the last element. The vector must not be empty, or the call is erroneous.
   //
   // The last() and end() iterators are invalidated.
@@ -244,18 +258,19 @@ class SmallVector final : ArrayTraits<T>, ArrayComparators<SmallVector> {
 
     auto& vector = std::get<Static>(vector_);
     if (vector.full()) {
-      return (promote(vector).*InsertDynamic)(std::forward<Args>(args)...);
+      // Allocate double capacity to reduce probability of reallocation.
+      return (promote(vector, Static::max_size() * 2).*
+              InsertDynamic)(std::forward<Args>(args)...);
     } else {
       return (vector.*InsertStatic)(std::forward<Args>(args)...);
     }
   }
 
-  Dynamic& promote(Static& static_vector) {
-    assert(static_vector.full());
+  Dynamic& promote(Static& static_vector, size_type capacity) {
+    assert(capacity > static_vector.size());
 
-    // Allocate double capacity to reduce probability of reallocation.
     Dynamic vector;
-    vector.reserve(Static::max_size() * 2);
+    vector.reserve(capacity);
     std::move(static_vector.begin(), static_vector.end(), std::back_inserter(vector));
 
     return vector_.template emplace<Dynamic>(std::move(vector));
@@ -67,8 +67,9 @@ private:
     std::unique_ptr<HalConnector> mHalConnector;
 
     // Shared pointers to keep global pointer and allow local copies to be used in
-    // different threads
-    std::shared_ptr<HalWrapper> mConnectedHal GUARDED_BY(mConnectedHalMutex) = nullptr;
+    // different threads. Read via std::atomic_load so steady-state calls skip
+    // the mutex; the mutex still serializes (re)connecting.
+    std::shared_ptr<HalWrapper> mConnectedHal = nullptr;
     const std::shared_ptr<HalWrapper> mDefaultHal = std::make_shared<EmptyHalWrapper>();
 
     std::shared_ptr<HalWrapper> initHal();
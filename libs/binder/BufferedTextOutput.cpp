@@ -143,12 +143,26 @@ BufferedTextOutput::~BufferedTextOutput()
 status_t BufferedTextOutput::print(const char* txt, size_t len)
 {
     //printf("BufferedTextOutput: printing %d\n", len);
-    
-    AutoMutex _l(mLock);
+
+    // With MULTITHREADED each thread accumulates into its own BufferState, so
+    // appends (and their reallocs) need no lock at all; mLock then only
+    // serializes the writeLines() calls so concurrent threads still emit whole
+    // lines. If we somehow fell back to the shared global state, the lock has
+    // to cover the appends as well, like it always did.
     BufferState* b = getBuffer();
-    
+    if ((mFlags&MULTITHREADED) != 0 && b != mGlobalState) {
+        return printToBuffer(b, txt, len, true);
+    }
+
+    AutoMutex _l(mLock);
+    return printToBuffer(b, txt, len, false);
+}
+
+status_t BufferedTextOutput::printToBuffer(BufferState* b, const char* txt,
+        size_t len, bool lockForWrite)
+{
     const char* const end = txt+len;
-    
+
     status_t err;
 
     while (txt < end) {
@@ -181,7 +195,12 @@ status_t BufferedTextOutput::print(const char* txt, size_t len)
                 vec.iov_base = (void*)first;
                 vec.iov_len = lastLine-first;
                 //printf("Writing %d bytes of data!\n", vec.iov_len);
-                writeLines(vec, 1);
+                if (lockForWrite) {
+                    AutoMutex _l(mLock);
+                    writeLines(vec, 1);
+                } else {
+                    writeLines(vec, 1);
+                }
                 txt = lastLine;
                 continue;
             }
@@ -200,7 +219,12 @@ status_t BufferedTextOutput::print(const char* txt, size_t len)
             vec.iov_base = b->buffer;
             vec.iov_len = b->bufferPos;
             //printf("Writing %d bytes of data!\n", vec.iov_len);
-            writeLines(vec, 1);
+            if (lockForWrite) {
+                AutoMutex _l(mLock);
+                writeLines(vec, 1);
+            } else {
+                writeLines(vec, 1);
+            }
             b->restart();
         }
     }
@@ -49,7 +49,9 @@ private:
     struct ThreadState;
 
             BufferState*getBuffer() const;
-            
+            status_t    printToBuffer(BufferState* b, const char* txt, size_t len,
+                                      bool lockForWrite);
+
     uint32_t            mFlags;
     const int32_t       mSeq;
     const int32_t       mIndex;
@@ -351,6 +351,11 @@ void BpMemoryHeap::assertReallyMapped() const
                         IInterface::asBinder(this).get(), size, fd, strerror(errno));
                 close(fd);
             } else {
+                if (flags & HINT_HUGEPAGES) {
+                    // The heap's owner asked for huge pages; hint this side's
+                    // mapping too so both processes can share them.
+                    madvise(mBase, size, MADV_HUGEPAGE);
+                }
                 mSize = size;
                 mFlags = flags;
                 mOffset = offset;
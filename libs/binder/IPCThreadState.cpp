@@ -23,10 +23,12 @@
 #include <binder/TextOutput.h>
 
 #include <android-base/macros.h>
+#include <cutils/properties.h>
 #include <cutils/sched_policy.h>
 #include <utils/CallStack.h>
 #include <utils/Log.h>
 #include <utils/SystemClock.h>
+#include <utils/Timers.h>
 #include <utils/threads.h>
 
 #include <atomic>
@@ -36,7 +38,9 @@
 #include <sched.h>
 #include <signal.h>
 #include <stdio.h>
+#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
 #include <unistd.h>
 
@@ -487,9 +491,26 @@ void IPCThreadState::flushCommands()
     }
 }
 
+void IPCThreadState::corkTransactions()
+{
+    mCorkCount++;
+}
+
+void IPCThreadState::uncorkTransactions()
+{
+    if (mCorkCount <= 0) {
+        ALOGW("uncorkTransactions() called without a matching corkTransactions()");
+        return;
+    }
+    if (--mCorkCount == 0) {
+        mCorkedPayloadBytes = 0;
+        flushCommands();
+    }
+}
+
 bool IPCThreadState::flushIfNeeded()
 {
-    if (mIsLooper || mServingStackPointer != nullptr || mIsFlushing) {
+    if (mIsLooper || mServingStackPointer != nullptr || mIsFlushing || mCorkCount > 0) {
         return false;
     }
     mIsFlushing = true;
@@ -614,6 +635,41 @@ void IPCThreadState::processPostWriteDerefs()
     mPostWriteStrongDerefs.clear();
 }
 
+// Upper bound for the adaptive pre-read spin in spinBeforeRead().
+static constexpr int64_t kMaxSpinBeforeReadUs = 50;
+
+static bool spinBeforeReadEnabled()
+{
+    static const bool enabled = property_get_bool("persist.libbinder.spin_before_read", false);
+    return enabled;
+}
+
+void IPCThreadState::spinBeforeRead()
+{
+    // Nothing to gain when there are commands to write or data left to read;
+    // the driver round-trip is happening regardless.
+    if (mIn.dataAvail() > 0 || mOut.dataSize() > 0) return;
+
+    struct pollfd pfd = {.fd = mProcess->mDriverFD, .events = POLLIN, .revents = 0};
+    const int64_t deadline = systemTime(SYSTEM_TIME_MONOTONIC) + mSpinBeforeReadUs * 1000;
+    do {
+        if (poll(&pfd, 1, 0) > 0) {
+            // Work arrived while spinning; be more patient next time.
+            mSpinBeforeReadUs *= 2;
+            if (mSpinBeforeReadUs > kMaxSpinBeforeReadUs) {
+                mSpinBeforeReadUs = kMaxSpinBeforeReadUs;
+            }
+            return;
+        }
+    } while (systemTime(SYSTEM_TIME_MONOTONIC) < deadline);
+    // Spun for nothing; shrink the budget. The floor of 1us keeps the spin
+    // armed so a change in load can grow it back.
+    mSpinBeforeReadUs /= 2;
+    if (mSpinBeforeReadUs < 1) {
+        mSpinBeforeReadUs = 1;
+    }
+}
+
 void IPCThreadState::joinThreadPool(bool isMain)
 {
     LOG_THREADPOOL("**** THREAD %p (PID %d) IS JOINING THE THREAD POOL\n", (void*)pthread_self(), getpid());
@@ -621,10 +677,20 @@ void IPCThreadState::joinThreadPool(bool isMain)
     mOut.writeInt32(isMain ? BC_ENTER_LOOPER : BC_REGISTER_LOOPER);
 
     mIsLooper = true;
+
+    // One thread per process briefly spins on a zero-timeout driver poll
+    // before each blocking read, trading a bounded amount of CPU for lower
+    // dispatch latency when a transaction arrives just as the pool goes idle.
+    if (spinBeforeReadEnabled() && !mProcess->mPollingSpinnerClaimed.exchange(true)) {
+        mIsPollingSpinner = true;
+        mSpinBeforeReadUs = kMaxSpinBeforeReadUs;
+    }
+
     status_t result;
     do {
         processPendingDerefs();
         // now get the next command to be processed, waiting if necessary
+        if (mIsPollingSpinner) spinBeforeRead();
         result = getAndExecuteCommand();
 
         if (result < NO_ERROR && result != TIMED_OUT && result != -ECONNREFUSED && result != -EBADF) {
@@ -642,6 +708,11 @@ void IPCThreadState::joinThreadPool(bool isMain)
     LOG_THREADPOOL("**** THREAD %p (PID %d) IS LEAVING THE THREAD POOL err=%d\n",
         (void*)pthread_self(), getpid(), result);
 
+    if (mIsPollingSpinner) {
+        mIsPollingSpinner = false;
+        mProcess->mPollingSpinnerClaimed.store(false);
+    }
+
     mOut.writeInt32(BC_EXIT_LOOPER);
     mIsLooper = false;
     talkWithDriver(false);
@@ -701,7 +772,26 @@ status_t IPCThreadState::transact(int32_t handle,
 
     LOG_ONEWAY(">>>> SEND from pid %d uid %d %s", getpid(), getuid(),
         (flags & TF_ONE_WAY) == 0 ? "READ REPLY" : "ONE WAY");
-    err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, nullptr);
+
+    // Only object-free oneway transactions are corked: the driver reads the
+    // payload when mOut is flushed, which with corking happens after this
+    // call returns, so the payload has to be pinned in a copy until then.
+    // Parcels carrying objects keep fd and binder ownership with the caller
+    // and go through the regular immediate path instead.
+    const bool corked = (mCorkCount > 0) && (flags & TF_ONE_WAY) != 0 &&
+            data.objectsCount() == 0;
+    if (corked) {
+        auto pinned = std::make_unique<Parcel>();
+        err = pinned->appendFrom(&data, 0, data.dataSize());
+        if (err == NO_ERROR) {
+            err = writeTransactionData(BC_TRANSACTION, flags, handle, code, *pinned, nullptr);
+        }
+        if (err == NO_ERROR) {
+            mPendingSpillParcels.push_back(std::move(pinned));
+        }
+    } else {
+        err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, nullptr);
+    }
 
     if (err != NO_ERROR) {
         if (reply) reply->setError(err);
@@ -747,6 +837,14 @@ status_t IPCThreadState::transact(int32_t handle,
             if (reply) alog << indent << *reply << dedent << endl;
             else alog << "(none requested)" << endl;
         }
+    } else if (corked) {
+        // Leave the command batched in mOut. The pinned payloads are freed by
+        // talkWithDriver once the batch reaches the driver.
+        mCorkedPayloadBytes += data.dataSize();
+        if (mCorkedPayloadBytes >= kCorkFlushThreshold) {
+            mCorkedPayloadBytes = 0;
+            flushCommands();
+        }
     } else {
         err = waitForResponse(nullptr, nullptr);
     }
@@ -849,9 +947,14 @@ IPCThreadState::IPCThreadState()
         mPropagateWorkSource(false),
         mIsLooper(false),
         mIsFlushing(false),
+        mIsPollingSpinner(false),
+        mSpinBeforeReadUs(0),
         mStrictModePolicy(0),
         mLastTransactionBinderFlags(0),
-        mCallRestriction(mProcess->mCallRestriction) {
+        mCallRestriction(mProcess->mCallRestriction),
+        mCorkCount(0),
+        mCorkedPayloadBytes(0),
+        mParcelBufferPoolCount(0) {
     pthread_setspecific(gTLS, this);
     clearCaller();
     mIn.setDataCapacity(256);
@@ -860,6 +963,22 @@ IPCThreadState::IPCThreadState()
 
 IPCThreadState::~IPCThreadState()
 {
+    while (mParcelBufferPoolCount > 0) {
+        free(mParcelBufferPool[--mParcelBufferPoolCount]);
+    }
+}
+
+uint8_t* IPCThreadState::obtainParcelBuffer()
+{
+    if (mParcelBufferPoolCount == 0) return nullptr;
+    return mParcelBufferPool[--mParcelBufferPoolCount];
+}
+
+bool IPCThreadState::recycleParcelBuffer(uint8_t* buffer)
+{
+    if (mParcelBufferPoolCount == kParcelBufferPoolCapacity) return false;
+    mParcelBufferPool[mParcelBufferPoolCount++] = buffer;
+    return true;
 }
 
 status_t IPCThreadState::sendReply(const Parcel& reply, uint32_t flags)
@@ -936,6 +1055,8 @@ status_t IPCThreadState::waitForResponse(Parcel *reply, status_t *acquireResult)
                             reinterpret_cast<const binder_size_t*>(tr.data.ptr.offsets),
                             tr.offsets_size/sizeof(binder_size_t),
                             freeBuffer);
+                        err = inflateLargeParcel(reply);
+                        if (err != NO_ERROR) goto finish;
                     } else {
                         err = *reinterpret_cast<const status_t*>(tr.data.ptr.buffer);
                         freeBuffer(nullptr,
@@ -1057,6 +1178,9 @@ status_t IPCThreadState::talkWithDriver(bool doReceive)
             else {
                 mOut.setDataSize(0);
                 processPostWriteDerefs();
+                // Spilled payloads have been copied by the driver; their
+                // ashmem fds now live in the target's buffer.
+                mPendingSpillParcels.clear();
             }
         }
         if (bwr.read_consumed > 0) {
@@ -1079,6 +1203,91 @@ status_t IPCThreadState::talkWithDriver(bool doReceive)
     return err;
 }
 
+// Payloads at least this large (and carrying no objects) are spilled into an
+// ashmem region so only the fd crosses the kernel.
+static constexpr size_t kLargeParcelThreshold = 256 * 1024;
+// Marker pair prepended to a spilled payload so the receiving libbinder can
+// recognize and inflate it; both words must match.
+static constexpr int32_t kLargeParcelMagic = 0x4c505243; // 'LPRC'
+
+static bool largeParcelPassthroughEnabled()
+{
+    static const bool enabled = property_get_bool("persist.libbinder.large_parcel", false);
+    return enabled;
+}
+
+std::unique_ptr<Parcel> IPCThreadState::spillLargeParcel(const Parcel& data)
+{
+    if (!largeParcelPassthroughEnabled()) return nullptr;
+    // The spill carries an fd, so it only applies where the transaction is
+    // allowed to carry fds (for replies, the caller set TF_ACCEPT_FDS).
+    if (!data.mAllowFds) return nullptr;
+
+    const size_t len = data.ipcDataSize();
+    auto spill = std::make_unique<Parcel>();
+    if (spill->writeInt32(kLargeParcelMagic) != NO_ERROR ||
+        spill->writeInt32(~kLargeParcelMagic) != NO_ERROR ||
+        spill->writeUint64(len) != NO_ERROR) {
+        return nullptr;
+    }
+    Parcel::WritableBlob blob;
+    if (spill->writeBlob(len, false /*mutableCopy*/, &blob) != NO_ERROR) return nullptr;
+    if (blob.fd() < 0) {
+        // writeBlob fell back to an in-place copy; nothing gained.
+        return nullptr;
+    }
+    memcpy(blob.data(), reinterpret_cast<const void*>(data.ipcData()), len);
+    return spill;
+}
+
+status_t IPCThreadState::inflateLargeParcel(Parcel* buffer)
+{
+    // Inflation is opt-in on the receiving side as well: with the property
+    // off, a payload that happens to start with the marker is left untouched
+    // instead of being reinterpreted on the sender's say-so.
+    if (!largeParcelPassthroughEnabled()) return NO_ERROR;
+    if (buffer->dataSize() < 2 * sizeof(int32_t) + sizeof(uint64_t)) return NO_ERROR;
+
+    buffer->setDataPosition(0);
+    int32_t magic, check;
+    if (buffer->readInt32(&magic) != NO_ERROR || magic != kLargeParcelMagic ||
+        buffer->readInt32(&check) != NO_ERROR || check != ~kLargeParcelMagic) {
+        buffer->setDataPosition(0);
+        return NO_ERROR;
+    }
+
+    uint64_t len;
+    status_t err = buffer->readUint64(&len);
+    if (err != NO_ERROR) return err;
+    if (len > INT32_MAX) return BAD_VALUE;
+
+    Parcel::ReadableBlob blob;
+    err = buffer->readBlob(len, &blob);
+    if (err != NO_ERROR) return err;
+
+    // Snapshot the payload into receiver-private memory before adopting it as
+    // parcel backing. Adopting the mapping itself would let the sender rewrite
+    // the parcel while it is parsed: sealing an ashmem region to PROT_READ
+    // only constrains future mmaps, so a sender can keep a writable mapping it
+    // created before sealing. One copy here still beats the two kernel copies
+    // of the plain transaction path.
+    uint8_t* payload = static_cast<uint8_t*>(malloc(len));
+    if (payload == nullptr) return NO_MEMORY;
+    memcpy(payload, blob.data(), len);
+    // The blob (and its mapping) is released when it goes out of scope; the
+    // original kernel buffer (and the ashmem fd) is freed by
+    // ipcSetDataReference below.
+    buffer->ipcSetDataReference(payload, len, nullptr, 0, freeLargeParcelPayload);
+    return NO_ERROR;
+}
+
+void IPCThreadState::freeLargeParcelPayload(Parcel* /*parcel*/, const uint8_t* data,
+                                            size_t /*dataSize*/, const binder_size_t* /*objects*/,
+                                            size_t /*objectsSize*/)
+{
+    free(const_cast<uint8_t*>(data));
+}
+
 status_t IPCThreadState::writeTransactionData(int32_t cmd, uint32_t binderFlags,
     int32_t handle, uint32_t code, const Parcel& data, status_t* statusBuffer)
 {
@@ -1098,6 +1307,18 @@ status_t IPCThreadState::writeTransactionData(int32_t cmd, uint32_t binderFlags,
         tr.data.ptr.buffer = data.ipcData();
         tr.offsets_size = data.ipcObjectsCount()*sizeof(binder_size_t);
         tr.data.ptr.offsets = data.ipcObjects();
+        if ((cmd == BC_TRANSACTION || cmd == BC_REPLY) && data.ipcObjectsCount() == 0 &&
+            data.ipcDataSize() >= kLargeParcelThreshold) {
+            std::unique_ptr<Parcel> spill = spillLargeParcel(data);
+            if (spill != nullptr) {
+                tr.data_size = spill->ipcDataSize();
+                tr.data.ptr.buffer = spill->ipcData();
+                tr.offsets_size = spill->ipcObjectsCount()*sizeof(binder_size_t);
+                tr.data.ptr.offsets = spill->ipcObjects();
+                // Keep the spill alive until the driver consumes mOut.
+                mPendingSpillParcels.push_back(std::move(spill));
+            }
+        }
     } else if (statusBuffer) {
         tr.flags |= TF_STATUS_CODE;
         *statusBuffer = err;
@@ -1136,6 +1357,14 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
     case BR_OK:
         break;
 
+    case BR_TRANSACTION_COMPLETE:
+        // Completes for corked oneway sends are not consumed by
+        // waitForResponse: the send skips it and flushCommands writes without
+        // reading, so the driver queues one per corked transaction. They
+        // surface here when the thread next drains its read buffer and are
+        // simply dropped, like in waitForResponse's oneway path.
+        break;
+
     case BR_ACQUIRE:
         refs = (RefBase::weakref_type*)mIn.readPointer();
         obj = (BBinder*)mIn.readPointer();
@@ -1224,6 +1453,11 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 tr.data_size,
                 reinterpret_cast<const binder_size_t*>(tr.data.ptr.offsets),
                 tr.offsets_size/sizeof(binder_size_t), freeBuffer);
+            if (inflateLargeParcel(&buffer) != NO_ERROR) {
+                ALOGE("Failed to inflate spilled large transaction payload");
+                result = BAD_VALUE;
+                break;
+            }
 
             const void* origServingStackPointer = mServingStackPointer;
             mServingStackPointer = &origServingStackPointer; // anything on the stack
@@ -38,6 +38,8 @@
 #include <sys/mman.h>
 #include <sys/file.h>
 
+#include <map>
+
 namespace android {
 // ----------------------------------------------------------------------------
 
@@ -152,12 +154,19 @@ private:
 
     ssize_t  alloc(size_t size, uint32_t flags);
     chunk_t* dealloc(size_t start);
+    void     indexFreeChunk(chunk_t* chunk);
+    void     unindexFreeChunk(chunk_t* chunk);
     void     dump_l(const char* what) const;
     void     dump_l(String8& res, const char* what) const;
 
     static const int    kMemoryAlign;
     mutable Mutex       mLock;
     LinkedList<chunk_t> mList;
+    // Indexes over mList so alloc() and dealloc() don't have to walk the
+    // whole chunk list. The address-ordered list is still authoritative;
+    // it is what coalescing and dump_l() traverse.
+    std::multimap<size_t, chunk_t*> mFreeChunks;   // keyed by chunk size
+    std::map<size_t, chunk_t*>      mChunksByStart;
     size_t              mHeapSize;
 };
 
@@ -282,10 +291,14 @@ SimpleBestFitAllocator::SimpleBestFitAllocator(size_t size)
 
     chunk_t* node = new chunk_t(0, mHeapSize / kMemoryAlign);
     mList.insertHead(node);
+    mChunksByStart.emplace(node->start, node);
+    indexFreeChunk(node);
 }
 
 SimpleBestFitAllocator::~SimpleBestFitAllocator()
 {
+    mFreeChunks.clear();
+    mChunksByStart.clear();
     while(!mList.isEmpty()) {
         chunk_t* removed = mList.remove(mList.head());
 #ifdef __clang_analyzer__
@@ -328,27 +341,36 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
     }
     size = (size + kMemoryAlign-1) / kMemoryAlign;
     chunk_t* free_chunk = nullptr;
-    chunk_t* cur = mList.head();
 
     size_t pagesize = getpagesize();
-    while (cur) {
-        int extra = 0;
-        if (flags & PAGE_ALIGNED)
-            extra = ( -cur->start & ((pagesize/kMemoryAlign)-1) ) ;
-
-        // best fit
-        if (cur->free && (cur->size >= (size+extra))) {
-            if ((!free_chunk) || (cur->size < free_chunk->size)) {
-                free_chunk = cur;
-            }
-            if (cur->size == size) {
-                break;
+    if (flags & PAGE_ALIGNED) {
+        // The padding needed to page-align a candidate depends on its start
+        // offset, so the size index cannot answer this query; walk the list.
+        chunk_t* cur = mList.head();
+        while (cur) {
+            int extra = ( -cur->start & ((pagesize/kMemoryAlign)-1) ) ;
+
+            // best fit
+            if (cur->free && (cur->size >= (size+extra))) {
+                if ((!free_chunk) || (cur->size < free_chunk->size)) {
+                    free_chunk = cur;
+                }
+                if (cur->size == size) {
+                    break;
+                }
             }
+            cur = cur->next;
+        }
+    } else {
+        // best fit: the smallest free chunk that can hold the request
+        auto it = mFreeChunks.lower_bound(size);
+        if (it != mFreeChunks.end()) {
+            free_chunk = it->second;
         }
-        cur = cur->next;
     }
 
     if (free_chunk) {
+        unindexFreeChunk(free_chunk);
         const size_t free_size = free_chunk->size;
         free_chunk->free = 0;
         free_chunk->size = size;
@@ -358,11 +380,15 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
                 extra = ( -free_chunk->start & ((pagesize/kMemoryAlign)-1) ) ;
             if (extra) {
                 chunk_t* split = new chunk_t(free_chunk->start, extra);
+                mChunksByStart.erase(free_chunk->start);
                 free_chunk->start += extra;
+                mChunksByStart.emplace(free_chunk->start, free_chunk);
                 mList.insertBefore(free_chunk, split);
+                mChunksByStart.emplace(split->start, split);
+                indexFreeChunk(split);
             }
 
-            ALOGE_IF((flags&PAGE_ALIGNED) && 
+            ALOGE_IF((flags&PAGE_ALIGNED) &&
                     ((free_chunk->start*kMemoryAlign)&(pagesize-1)),
                     "PAGE_ALIGNED requested, but page is not aligned!!!");
 
@@ -371,6 +397,8 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
                 chunk_t* split = new chunk_t(
                         free_chunk->start + free_chunk->size, tail_free);
                 mList.insertAfter(free_chunk, split);
+                mChunksByStart.emplace(split->start, split);
+                indexFreeChunk(split);
             }
         }
         return (free_chunk->start)*kMemoryAlign;
@@ -378,45 +406,66 @@ ssize_t SimpleBestFitAllocator::alloc(size_t size, uint32_t flags)
     return NO_MEMORY;
 }
 
+void SimpleBestFitAllocator::indexFreeChunk(chunk_t* chunk)
+{
+    mFreeChunks.emplace(chunk->size, chunk);
+}
+
+void SimpleBestFitAllocator::unindexFreeChunk(chunk_t* chunk)
+{
+    auto range = mFreeChunks.equal_range(chunk->size);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == chunk) {
+            mFreeChunks.erase(it);
+            return;
+        }
+    }
+}
+
 SimpleBestFitAllocator::chunk_t* SimpleBestFitAllocator::dealloc(size_t start)
 {
     start = start / kMemoryAlign;
-    chunk_t* cur = mList.head();
-    while (cur) {
-        if (cur->start == start) {
-            LOG_FATAL_IF(cur->free,
-                "block at offset 0x%08lX of size 0x%08X already freed",
-                cur->start*kMemoryAlign, cur->size*kMemoryAlign);
-
-            // merge freed blocks together
-            chunk_t* freed = cur;
-            cur->free = 1;
-            do {
-                chunk_t* const p = cur->prev;
-                chunk_t* const n = cur->next;
-                if (p && (p->free || !cur->size)) {
-                    freed = p;
-                    p->size += cur->size;
-                    mList.remove(cur);
-                    delete cur;
-                }
-                cur = n;
-            } while (cur && cur->free);
+    const auto& it = mChunksByStart.find(start);
+    if (it == mChunksByStart.end()) {
+        return nullptr;
+    }
 
-            #ifndef NDEBUG
-                if (!freed->free) {
-                    dump_l("dealloc (!freed->free)");
-                }
-            #endif
-            LOG_FATAL_IF(!freed->free,
-                "freed block at offset 0x%08lX of size 0x%08X is not free!",
-                freed->start * kMemoryAlign, freed->size * kMemoryAlign);
+    chunk_t* cur = it->second;
+    LOG_FATAL_IF(cur->free,
+        "block at offset 0x%08lX of size 0x%08X already freed",
+        cur->start*kMemoryAlign, cur->size*kMemoryAlign);
+
+    // merge freed blocks together
+    chunk_t* freed = cur;
+    cur->free = 1;
+    indexFreeChunk(cur);
+    do {
+        chunk_t* const p = cur->prev;
+        chunk_t* const n = cur->next;
+        if (p && (p->free || !cur->size)) {
+            freed = p;
+            // p grows; reindex it at its new size
+            if (p->free) unindexFreeChunk(p);
+            p->size += cur->size;
+            if (p->free) indexFreeChunk(p);
+            if (cur->free) unindexFreeChunk(cur);
+            mChunksByStart.erase(cur->start);
+            mList.remove(cur);
+            delete cur;
+        }
+        cur = n;
+    } while (cur && cur->free);
 
-            return freed;
+    #ifndef NDEBUG
+        if (!freed->free) {
+            dump_l("dealloc (!freed->free)");
         }
-        cur = cur->next;
-    }
-    return nullptr;
+    #endif
+    LOG_FATAL_IF(!freed->free,
+        "freed block at offset 0x%08lX of size 0x%08X is not free!",
+        freed->start * kMemoryAlign, freed->size * kMemoryAlign);
+
+    return freed;
 }
 
 void SimpleBestFitAllocator::dump(const char* what) const
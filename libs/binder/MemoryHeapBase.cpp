@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -129,6 +130,23 @@ status_t MemoryHeapBase::mapfd(int fd, bool writeableByCaller, size_t size, off_
             return -errno;
         }
         //ALOGD("mmap(fd=%d, base=%p, size=%zu)", fd, base, size);
+        if (mFlags & HINT_HUGEPAGES) {
+            // Best-effort: requires shmem THP support in the kernel. When the
+            // hint can't be honored the heap just keeps regular pages.
+            if (madvise(base, size, MADV_HUGEPAGE) != 0) {
+                ALOGW("madvise(MADV_HUGEPAGE) on fd=%d size=%zu failed (%s)",
+                        fd, size, strerror(errno));
+            }
+        }
+        if (mFlags & PREFAULT) {
+            // Touch every page so first use doesn't pay a major-fault storm.
+            // Done after the hugepage hint so the faults can allocate huge
+            // pages, and with reads so mappings of arbitrary fds stay intact.
+            const size_t pagesize = getpagesize();
+            for (size_t where = 0; where < size; where += pagesize) {
+                (void)*(static_cast<volatile uint8_t*>(base) + where);
+            }
+        }
         mBase = base;
         mNeedUnmap = true;
     } else  {
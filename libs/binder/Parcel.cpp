@@ -31,6 +31,8 @@
 #include <sys/resource.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include <binder/Binder.h>
 #include <binder/BpBinder.h>
 #include <binder/IPCThreadState.h>
@@ -598,6 +600,44 @@ constexpr int32_t kHeader = B_PACK_CHARS('V', 'N', 'D', 'R');
 constexpr int32_t kHeader = B_PACK_CHARS('S', 'Y', 'S', 'T');
 #endif
 
+// Interface descriptors normally come from static storage
+// (IMPLEMENT_META_INTERFACE), so the same few strings are hashed over and
+// over; intern the hash in a small per-thread cache. Entries are validated
+// against a stored copy of the descriptor rather than trusting the pointer,
+// since nothing stops a caller from passing a temporary String16.
+static uint64_t interfaceDescriptorHash(const char16_t* str, size_t len) {
+    constexpr size_t kMaxCachedLen = 88;  // longer than any framework descriptor
+    constexpr size_t kCacheSize = 16;     // plenty for the interfaces one thread serves
+    struct Entry {
+        size_t len;
+        uint64_t hash;
+        char16_t str[kMaxCachedLen];
+    };
+    static thread_local Entry cache[kCacheSize] = {};
+
+    Entry* entry = nullptr;
+    if (len > 0 && len <= kMaxCachedLen) {
+        // str[0] spreads interfaces sharing a package prefix length.
+        entry = &cache[(len ^ str[0]) % kCacheSize];
+        if (entry->len == len && !memcmp(entry->str, str, len * sizeof(char16_t))) {
+            return entry->hash;
+        }
+    }
+
+    // FNV-1a over the UTF-16 code units.
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ str[i]) * 1099511628211ull;
+    }
+
+    if (entry != nullptr) {
+        entry->len = len;
+        entry->hash = hash;
+        memcpy(entry->str, str, len * sizeof(char16_t));
+    }
+    return hash;
+}
+
 // Write RPC headers.  (previously just the interface token)
 status_t Parcel::writeInterfaceToken(const String16& interface)
 {
@@ -612,6 +652,11 @@ status_t Parcel::writeInterfaceToken(const char16_t* str, size_t len) {
         writeInt32(threadState->shouldPropagateWorkSource() ? threadState->getCallingWorkSourceUid()
                                                             : IPCThreadState::kUnsetWorkSource);
         writeInt32(kHeader);
+        // Pre-hashed descriptor, so the receiving side can reject a wrong
+        // interface with one integer compare. The kHeader check above already
+        // guarantees both ends run the same libbinder, so the extra word is
+        // not seen by older copies.
+        writeInt64(static_cast<int64_t>(interfaceDescriptorHash(str, len)));
     }
 
     // currently the interface identification token is just its name as a string
@@ -685,6 +730,18 @@ bool Parcel::enforceInterface(const char16_t* interface,
                   header);
             return false;
         }
+        // Descriptor hash. On a match the UTF-16 compare below is skipped:
+        // the token only guards against accidentally crossed interfaces (a
+        // hostile caller could just write the right string), and a 64-bit
+        // accidental collision is not a practical concern. A mismatch falls
+        // through to the string compare for the diagnostic message.
+        uint64_t hash = static_cast<uint64_t>(readInt64());
+        if (hash == interfaceDescriptorHash(interface, len)) {
+            // Still consume the descriptor string from the parcel.
+            size_t parcel_interface_len;
+            readString16Inplace(&parcel_interface_len);
+            return true;
+        }
     }
 
     // Interface descriptor.
@@ -1197,6 +1254,15 @@ status_t Parcel::writeUniqueFileDescriptor(const base::unique_fd& fd) {
     return writeDupFileDescriptor(fd.get());
 }
 
+status_t Parcel::writeUniqueFileDescriptor(base::unique_fd&& fd) {
+    status_t err = writeFileDescriptor(fd.get(), true /*takeOwnership*/);
+    if (err == OK) {
+        // The parcel now owns the descriptor and will close it on destruction.
+        fd.release();
+    }
+    return err;
+}
+
 status_t Parcel::writeBlob(size_t len, bool mutableCopy, WritableBlob* outBlob)
 {
     if (len > INT32_MAX) {
@@ -1365,17 +1431,19 @@ status_t Parcel::validateReadData(size_t upperBound) const
 data_sorted:
         // Expect to check only against the next object
         if (mNextObjectHint < mObjectsSize && upperBound > mObjects[mNextObjectHint]) {
-            // For some reason the current read position is greater than the next object
-            // hint. Iterate until we find the right object
-            size_t nextObject = mNextObjectHint;
-            do {
-                if (mDataPos < mObjects[nextObject] + sizeof(flat_binder_object)) {
-                    // Requested info overlaps with an object
-                    ALOGE("Attempt to read from protected data in Parcel %p", this);
-                    return PERMISSION_DENIED;
-                }
-                nextObject++;
-            } while (nextObject < mObjectsSize && upperBound > mObjects[nextObject]);
+            // The current read position is past the next object hint. Since
+            // mObjects is sorted, binary-search for the first object at or past
+            // upperBound; only the last object before it can overlap the
+            // requested range, so out-of-order reads of object-heavy parcels
+            // cost O(log n) instead of a linear rescan.
+            size_t nextObject = std::lower_bound(mObjects + mNextObjectHint,
+                                                 mObjects + mObjectsSize,
+                                                 (binder_size_t)upperBound) - mObjects;
+            if (mDataPos < mObjects[nextObject - 1] + sizeof(flat_binder_object)) {
+                // Requested info overlaps with an object
+                ALOGE("Attempt to read from protected data in Parcel %p", this);
+                return PERMISSION_DENIED;
+            }
             mNextObjectHint = nextObject;
         }
         return NO_ERROR;
@@ -1909,6 +1977,50 @@ status_t Parcel::readUniqueFileDescriptor(base::unique_fd* val) const
     return OK;
 }
 
+status_t Parcel::takeUniqueFileDescriptor(base::unique_fd* val) const
+{
+    const flat_binder_object* flat = readObject(true);
+
+    if (!flat || flat->hdr.type != BINDER_TYPE_FD) {
+        return BAD_TYPE;
+    }
+
+    if (mOwner != nullptr) {
+        // The descriptor lives in a kernel-owned, read-only buffer and would
+        // normally be closed when the buffer is freed, so record that the
+        // caller adopted it instead of closing it there.
+        const binder_size_t offset = reinterpret_cast<const uint8_t*>(flat) - mData;
+        if (std::find(mAdoptedFds.begin(), mAdoptedFds.end(), offset) == mAdoptedFds.end()) {
+            mAdoptedFds.push_back(offset);
+            val->reset(flat->handle);
+            return OK;
+        }
+    } else if (flat->cookie != 0) {
+        // The parcel owns the descriptor; hand it over instead of duping.
+        // Mirror the accounting that release_object() would have done when
+        // closing it.
+        if (ashmem_valid(flat->handle)) {
+            int size = ashmem_get_size_region(flat->handle);
+            if (size > 0) {
+                mOpenAshmemSize -= std::min(mOpenAshmemSize, static_cast<size_t>(size));
+            }
+        }
+        val->reset(flat->handle);
+        const_cast<flat_binder_object*>(flat)->cookie = 0;
+        return OK;
+    }
+
+    // The descriptor was already adopted or is only borrowed by the parcel,
+    // so the caller gets a dup.
+    val->reset(fcntl(flat->handle, F_DUPFD_CLOEXEC, 0));
+
+    if (val->get() < 0) {
+        return BAD_VALUE;
+    }
+
+    return OK;
+}
+
 status_t Parcel::readUniqueParcelFileDescriptor(base::unique_fd* val) const
 {
     int got = readParcelFileDescriptor();
@@ -2085,6 +2197,11 @@ void Parcel::closeFileDescriptors()
         const flat_binder_object* flat
             = reinterpret_cast<flat_binder_object*>(mData+mObjects[i]);
         if (flat->hdr.type == BINDER_TYPE_FD) {
+            if (std::find(mAdoptedFds.begin(), mAdoptedFds.end(), mObjects[i]) !=
+                mAdoptedFds.end()) {
+                // Ownership was transferred to the reader.
+                continue;
+            }
             //ALOGI("Closing fd: %ld", flat->handle);
             close(flat->handle);
         }
@@ -2181,6 +2298,58 @@ void Parcel::print(TextOutput& to, uint32_t /*flags*/) const
     to << ")";
 }
 
+// Returns a buffer of at least `desired` bytes. Small requests are served from
+// the per-thread pool in IPCThreadState when possible; `outCapacity` reports
+// the actual capacity (pooled buffers are larger than small requests) and
+// `outPooled` whether the buffer must eventually go back to the pool.
+static uint8_t* obtainParcelData(size_t desired, size_t* outCapacity, bool* outPooled) {
+    if (desired <= IPCThreadState::kParcelBufferPoolBufferSize) {
+        IPCThreadState* state = IPCThreadState::selfOrNull();
+        if (state != nullptr) {
+            uint8_t* data = state->obtainParcelBuffer();
+            if (data != nullptr) {
+                *outCapacity = IPCThreadState::kParcelBufferPoolBufferSize;
+                *outPooled = true;
+                return data;
+            }
+        }
+    }
+    uint8_t* data = (uint8_t*)malloc(desired);
+    *outCapacity = data ? desired : 0;
+    *outPooled = false;
+    return data;
+}
+
+// Returns `data` to the per-thread pool if it came from there (and the pool
+// has room), otherwise hands it back to malloc.
+static void releaseParcelData(uint8_t* data, bool pooled) {
+    if (pooled) {
+        IPCThreadState* state = IPCThreadState::selfOrNull();
+        if (state != nullptr && state->recycleParcelBuffer(data)) {
+            return;
+        }
+    }
+    free(data);
+}
+
+static uint8_t* reallocZeroFree(uint8_t* data, size_t oldCapacity, size_t newCapacity, bool zero,
+                                bool pooled) {
+    if (!zero && !pooled) {
+        return (uint8_t*)realloc(data, newCapacity);
+    }
+    uint8_t* newData = (uint8_t*)malloc(newCapacity);
+    if (!newData) {
+        return nullptr;
+    }
+
+    memcpy(newData, data, std::min(oldCapacity, newCapacity));
+    if (zero) {
+        zeroMemory(data, oldCapacity);
+    }
+    releaseParcelData(data, pooled);
+    return newData;
+}
+
 void Parcel::releaseObjects()
 {
     size_t i = mObjectsSize;
@@ -2237,7 +2406,7 @@ void Parcel::freeDataNoInit()
             if (mDeallocZero) {
                 zeroMemory(mData, mDataSize);
             }
-            free(mData);
+            releaseParcelData(mData, mDataPooled);
         }
         if (mObjects) free(mObjects);
     }
@@ -2259,21 +2428,6 @@ status_t Parcel::growData(size_t len)
             : continueWrite(std::max(newSize, (size_t) 128));
 }
 
-static uint8_t* reallocZeroFree(uint8_t* data, size_t oldCapacity, size_t newCapacity, bool zero) {
-    if (!zero) {
-        return (uint8_t*)realloc(data, newCapacity);
-    }
-    uint8_t* newData = (uint8_t*)malloc(newCapacity);
-    if (!newData) {
-        return nullptr;
-    }
-
-    memcpy(newData, data, std::min(oldCapacity, newCapacity));
-    zeroMemory(data, oldCapacity);
-    free(data);
-    return newData;
-}
-
 status_t Parcel::restartWrite(size_t desired)
 {
     if (desired > INT32_MAX) {
@@ -2287,7 +2441,20 @@ status_t Parcel::restartWrite(size_t desired)
         return continueWrite(desired);
     }
 
-    uint8_t* data = reallocZeroFree(mData, mDataCapacity, desired, mDeallocZero);
+    uint8_t* data;
+    bool pooled = false;
+    if (mDataPooled && desired > 0 && desired <= IPCThreadState::kParcelBufferPoolBufferSize) {
+        // The pooled buffer already has enough room; keep it instead of
+        // bouncing it through the heap.
+        if (mDeallocZero) {
+            zeroMemory(mData, mDataSize);
+        }
+        data = mData;
+        desired = mDataCapacity;
+        pooled = true;
+    } else {
+        data = reallocZeroFree(mData, mDataCapacity, desired, mDeallocZero, mDataPooled);
+    }
     if (!data && desired > mDataCapacity) {
         mError = NO_MEMORY;
         return NO_MEMORY;
@@ -2308,6 +2475,7 @@ status_t Parcel::restartWrite(size_t desired)
         }
         mData = data;
         mDataCapacity = desired;
+        mDataPooled = pooled;
     }
 
     mDataSize = mDataPos = 0;
@@ -2438,7 +2606,8 @@ status_t Parcel::continueWrite(size_t desired)
 
         // We own the data, so we can just do a realloc().
         if (desired > mDataCapacity) {
-            uint8_t* data = reallocZeroFree(mData, mDataCapacity, desired, mDeallocZero);
+            uint8_t* data = reallocZeroFree(mData, mDataCapacity, desired, mDeallocZero,
+                    mDataPooled);
             if (data) {
                 LOG_ALLOC("Parcel %p: continue from %zu to %zu capacity", this, mDataCapacity,
                         desired);
@@ -2446,6 +2615,7 @@ status_t Parcel::continueWrite(size_t desired)
                 gParcelGlobalAllocSize -= mDataCapacity;
                 mData = data;
                 mDataCapacity = desired;
+                mDataPooled = false;
             } else {
                 mError = NO_MEMORY;
                 return NO_MEMORY;
@@ -2463,7 +2633,9 @@ status_t Parcel::continueWrite(size_t desired)
 
     } else {
         // This is the first data.  Easy!
-        uint8_t* data = (uint8_t*)malloc(desired);
+        size_t capacity;
+        bool pooled;
+        uint8_t* data = obtainParcelData(desired, &capacity, &pooled);
         if (!data) {
             mError = NO_MEMORY;
             return NO_MEMORY;
@@ -2474,15 +2646,16 @@ status_t Parcel::continueWrite(size_t desired)
             ALOGE("continueWrite: %zu/%p/%zu/%zu", mDataCapacity, mObjects, mObjectsCapacity, desired);
         }
 
-        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, desired);
-        gParcelGlobalAllocSize += desired;
+        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, capacity);
+        gParcelGlobalAllocSize += capacity;
         gParcelGlobalAllocCount++;
 
         mData = data;
         mDataSize = mDataPos = 0;
         ALOGV("continueWrite Setting data size of %p to %zu", this, mDataSize);
         ALOGV("continueWrite Setting data pos of %p to %zu", this, mDataPos);
-        mDataCapacity = desired;
+        mDataCapacity = capacity;
+        mDataPooled = pooled;
     }
 
     return NO_ERROR;
@@ -2508,7 +2681,9 @@ void Parcel::initState()
     mFdsKnown = true;
     mAllowFds = true;
     mDeallocZero = false;
+    mDataPooled = false;
     mOwner = nullptr;
+    mAdoptedFds.clear();
     mOpenAshmemSize = 0;
     mWorkSourceRequestHeaderPosition = 0;
     mRequestHeaderPresent = false;
@@ -17,6 +17,10 @@
 #define LOG_TAG "PermissionCache"
 
 #include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
 #include <utils/Log.h>
 #include <binder/IPCThreadState.h>
 #include <binder/IServiceManager.h>
@@ -36,13 +40,20 @@ PermissionCache::PermissionCache() {
 
 status_t PermissionCache::check(bool* granted,
         const String16& permission, uid_t uid) const {
-    Mutex::Autolock _l(mLock);
+    // The hit path is lock-free: we search an immutable snapshot published by
+    // cache()/purge(), so concurrent checkPermission calls never contend on
+    // mLock.
+    std::shared_ptr<const SortedVector<Entry>> cache =
+            std::atomic_load_explicit(&mCache, std::memory_order_acquire);
+    if (cache == nullptr) {
+        return NAME_NOT_FOUND;
+    }
     Entry e;
     e.name = permission;
     e.uid  = uid;
-    ssize_t index = mCache.indexOf(e);
+    ssize_t index = cache->indexOf(e);
     if (index >= 0) {
-        *granted = mCache.itemAt(index).granted;
+        *granted = cache->itemAt(index).granted;
         return NO_ERROR;
     }
     return NAME_NOT_FOUND;
@@ -63,15 +74,52 @@ void PermissionCache::cache(const String16& permission,
     // permission checks
     e.uid  = uid;
     e.granted = granted;
-    index = mCache.indexOf(e);
-    if (index < 0) {
-        mCache.add(e);
+    std::shared_ptr<const SortedVector<Entry>> old =
+            std::atomic_load_explicit(&mCache, std::memory_order_relaxed);
+    if (old != nullptr && old->indexOf(e) >= 0) {
+        return;
     }
+    // Copy-on-write: build the updated snapshot and publish it for the
+    // lock-free readers in check().
+    auto updated = std::make_shared<SortedVector<Entry>>(
+            old != nullptr ? *old : SortedVector<Entry>());
+    updated->add(e);
+    std::atomic_store_explicit(&mCache,
+            std::shared_ptr<const SortedVector<Entry>>(std::move(updated)),
+            std::memory_order_release);
 }
 
 void PermissionCache::purge() {
     Mutex::Autolock _l(mLock);
-    mCache.clear();
+    std::atomic_store_explicit(&mCache, std::shared_ptr<const SortedVector<Entry>>(),
+            std::memory_order_release);
+}
+
+void PermissionCache::purge(uid_t uid) {
+    Mutex::Autolock _l(mLock);
+    std::shared_ptr<const SortedVector<Entry>> old =
+            std::atomic_load_explicit(&mCache, std::memory_order_relaxed);
+    if (old == nullptr) {
+        return;
+    }
+    // Entries sort by uid first, so the uid's entries are contiguous; rebuild
+    // the snapshot without them and publish it for the lock-free readers.
+    auto updated = std::make_shared<SortedVector<Entry>>();
+    bool found = false;
+    for (size_t i = 0; i < old->size(); i++) {
+        const Entry& e = old->itemAt(i);
+        if (e.uid == uid) {
+            found = true;
+        } else {
+            updated->add(e);
+        }
+    }
+    if (!found) {
+        return;
+    }
+    std::atomic_store_explicit(&mCache,
+            std::shared_ptr<const SortedVector<Entry>>(std::move(updated)),
+            std::memory_order_release);
 }
 
 bool PermissionCache::checkCallingPermission(const String16& permission) {
@@ -114,5 +162,10 @@ void PermissionCache::purgeCache() {
     pc.purge();
 }
 
+void PermissionCache::purgeCache(uid_t uid) {
+    PermissionCache& pc(PermissionCache::getInstance());
+    pc.purge(uid);
+}
+
 // ---------------------------------------------------------------------------
 } // namespace android
@@ -18,6 +18,8 @@
 
 #include <binder/PersistableBundle.h>
 
+#include <string.h>
+
 #include <limits>
 
 #include <binder/IBinder.h>
@@ -74,6 +76,65 @@ set<android::String16> getKeys(const map<android::String16, T>& map) {
     }
     return keys;
 }
+
+bool skipBytes(const Parcel* parcel, uint64_t num_bytes) {
+    size_t pos = parcel->dataPosition();
+    if (pos > parcel->dataSize() || num_bytes > parcel->dataSize() - pos) return false;
+    parcel->setDataPosition(pos + num_bytes);
+    return true;
+}
+
+/* Advances |parcel| past a single value of type |value_type| without materializing it. */
+bool skipValue(const Parcel* parcel, int32_t value_type) {
+    switch (value_type) {
+        case VAL_BOOLEAN:
+        case VAL_INTEGER: {
+            return skipBytes(parcel, sizeof(int32_t));
+        }
+        case VAL_LONG:
+        case VAL_DOUBLE: {
+            return skipBytes(parcel, sizeof(int64_t));
+        }
+        case VAL_STRING: {
+            size_t length;
+            return parcel->readString16Inplace(&length) != nullptr;
+        }
+        case VAL_BOOLEANARRAY:
+        case VAL_INTARRAY: {
+            int32_t num_elements;
+            if (parcel->readInt32(&num_elements) != NO_ERROR) return false;
+            // A negative count is a null vector; nothing else is on the wire.
+            if (num_elements <= 0) return true;
+            return skipBytes(parcel, static_cast<uint64_t>(num_elements) * sizeof(int32_t));
+        }
+        case VAL_LONGARRAY:
+        case VAL_DOUBLEARRAY: {
+            int32_t num_elements;
+            if (parcel->readInt32(&num_elements) != NO_ERROR) return false;
+            if (num_elements <= 0) return true;
+            return skipBytes(parcel, static_cast<uint64_t>(num_elements) * sizeof(int64_t));
+        }
+        case VAL_STRINGARRAY: {
+            int32_t num_elements;
+            if (parcel->readInt32(&num_elements) != NO_ERROR) return false;
+            for (; num_elements > 0; --num_elements) {
+                size_t length;
+                if (parcel->readString16Inplace(&length) == nullptr) return false;
+            }
+            return true;
+        }
+        case VAL_PERSISTABLEBUNDLE: {
+            int32_t num_bytes;
+            if (parcel->readInt32(&num_bytes) != NO_ERROR || num_bytes < 0) return false;
+            if (num_bytes == 0) return true;
+            // A non-empty nested bundle carries a magic word before its entries.
+            return skipBytes(parcel, sizeof(int32_t) + static_cast<uint64_t>(num_bytes));
+        }
+        default: {
+            return false;
+        }
+    }
+}
 }  // namespace
 
 namespace android {
@@ -98,12 +159,77 @@ namespace os {
          }                                                               \
     }
 
+PersistableBundle::PersistableBundle(const PersistableBundle& bundle) {
+    *this = bundle;
+}
+
+PersistableBundle& PersistableBundle::operator=(const PersistableBundle& bundle) {
+    if (this == &bundle) return *this;
+
+    std::lock_guard<std::mutex> lock(bundle.mLazyLock);
+    mBoolMap = bundle.mBoolMap;
+    mIntMap = bundle.mIntMap;
+    mLongMap = bundle.mLongMap;
+    mDoubleMap = bundle.mDoubleMap;
+    mStringMap = bundle.mStringMap;
+    mBoolVectorMap = bundle.mBoolVectorMap;
+    mIntVectorMap = bundle.mIntVectorMap;
+    mLongVectorMap = bundle.mLongVectorMap;
+    mDoubleVectorMap = bundle.mDoubleVectorMap;
+    mStringVectorMap = bundle.mStringVectorMap;
+    mPersistableBundleMap = bundle.mPersistableBundleMap;
+    mParcelledData = nullptr;
+    mParcelledMagic = 0;
+
+    if (bundle.mParcelledData != nullptr) {
+        // Deferred entries are copied rather than shared, so that the lazy
+        // getters of one copy never move the data position under another.
+        auto copied = std::make_unique<Parcel>();
+        if (copied->appendFrom(bundle.mParcelledData.get(), 0,
+                               bundle.mParcelledData->dataSize()) == NO_ERROR) {
+            mParcelledData = std::move(copied);
+            mParcelledMagic = bundle.mParcelledMagic;
+        } else {
+            // No memory for a copy of the deferred data; materialize the
+            // entries directly instead.
+            bundle.mParcelledData->setDataPosition(0);
+            status_t result = deserialize(bundle.mParcelledData.get());
+            if (result != NO_ERROR) {
+                ALOGE("Failed to copy deferred PersistableBundle entries: %d", result);
+            }
+        }
+    }
+    return *this;
+}
+
 status_t PersistableBundle::writeToParcel(Parcel* parcel) const {
     /*
      * Keep implementation in sync with writeToParcelInner() in
      * frameworks/base/core/java/android/os/BaseBundle.java.
      */
 
+    {
+        std::lock_guard<std::mutex> lock(mLazyLock);
+
+        // Fast path: if this bundle was read from a parcel and never inspected,
+        // relay the captured entry data as-is instead of deserializing and
+        // re-serializing all of the entries.
+        if (mParcelledData != nullptr && mapsSize() == 0) {
+            size_t length = mParcelledData->dataSize();
+            if (length > std::numeric_limits<int32_t>::max()) {
+                ALOGE("Parcel length (%zu) too large to store in 32-bit signed int", length);
+                return BAD_VALUE;
+            }
+            RETURN_IF_FAILED(parcel->writeInt32(static_cast<int32_t>(length)));
+            RETURN_IF_FAILED(parcel->writeInt32(mParcelledMagic));
+            RETURN_IF_FAILED(parcel->appendFrom(mParcelledData.get(), 0, length));
+            return NO_ERROR;
+        }
+
+        // Mixed deferred and map entries have to be merged before serializing.
+        unparcelLocked();
+    }
+
     // Special case for empty bundles.
     if (empty()) {
         RETURN_IF_FAILED(parcel->writeInt32(0));
@@ -149,6 +275,11 @@ bool PersistableBundle::empty() const {
 }
 
 size_t PersistableBundle::size() const {
+    unparcel();
+    return mapsSize();
+}
+
+size_t PersistableBundle::mapsSize() const {
     return (mBoolMap.size() +
             mIntMap.size() +
             mLongMap.size() +
@@ -163,6 +294,7 @@ size_t PersistableBundle::size() const {
 }
 
 size_t PersistableBundle::erase(const String16& key) {
+    unparcel();
     RETURN_IF_ENTRY_ERASED(mBoolMap, key);
     RETURN_IF_ENTRY_ERASED(mIntMap, key);
     RETURN_IF_ENTRY_ERASED(mLongMap, key);
@@ -232,90 +364,127 @@ void PersistableBundle::putPersistableBundle(const String16& key, const Persista
 }
 
 bool PersistableBundle::getBoolean(const String16& key, bool* out) const {
+    std::lock_guard<std::mutex> lock(mLazyLock);
+    if (Parcel* value = findLazyValueLocked(key, VAL_BOOLEAN)) {
+        return value->readBool(out) == NO_ERROR;
+    }
     return getValue(key, out, mBoolMap);
 }
 
 bool PersistableBundle::getInt(const String16& key, int32_t* out) const {
+    std::lock_guard<std::mutex> lock(mLazyLock);
+    if (Parcel* value = findLazyValueLocked(key, VAL_INTEGER)) {
+        return value->readInt32(out) == NO_ERROR;
+    }
     return getValue(key, out, mIntMap);
 }
 
 bool PersistableBundle::getLong(const String16& key, int64_t* out) const {
+    std::lock_guard<std::mutex> lock(mLazyLock);
+    if (Parcel* value = findLazyValueLocked(key, VAL_LONG)) {
+        return value->readInt64(out) == NO_ERROR;
+    }
     return getValue(key, out, mLongMap);
 }
 
 bool PersistableBundle::getDouble(const String16& key, double* out) const {
+    std::lock_guard<std::mutex> lock(mLazyLock);
+    if (Parcel* value = findLazyValueLocked(key, VAL_DOUBLE)) {
+        return value->readDouble(out) == NO_ERROR;
+    }
     return getValue(key, out, mDoubleMap);
 }
 
 bool PersistableBundle::getString(const String16& key, String16* out) const {
+    std::lock_guard<std::mutex> lock(mLazyLock);
+    if (Parcel* value = findLazyValueLocked(key, VAL_STRING)) {
+        return value->readString16(out) == NO_ERROR;
+    }
     return getValue(key, out, mStringMap);
 }
 
 bool PersistableBundle::getBooleanVector(const String16& key, vector<bool>* out) const {
+    unparcel();
     return getValue(key, out, mBoolVectorMap);
 }
 
 bool PersistableBundle::getIntVector(const String16& key, vector<int32_t>* out) const {
+    unparcel();
     return getValue(key, out, mIntVectorMap);
 }
 
 bool PersistableBundle::getLongVector(const String16& key, vector<int64_t>* out) const {
+    unparcel();
     return getValue(key, out, mLongVectorMap);
 }
 
 bool PersistableBundle::getDoubleVector(const String16& key, vector<double>* out) const {
+    unparcel();
     return getValue(key, out, mDoubleVectorMap);
 }
 
 bool PersistableBundle::getStringVector(const String16& key, vector<String16>* out) const {
+    unparcel();
     return getValue(key, out, mStringVectorMap);
 }
 
 bool PersistableBundle::getPersistableBundle(const String16& key, PersistableBundle* out) const {
+    unparcel();
     return getValue(key, out, mPersistableBundleMap);
 }
 
 set<String16> PersistableBundle::getBooleanKeys() const {
+    unparcel();
     return getKeys(mBoolMap);
 }
 
 set<String16> PersistableBundle::getIntKeys() const {
+    unparcel();
     return getKeys(mIntMap);
 }
 
 set<String16> PersistableBundle::getLongKeys() const {
+    unparcel();
     return getKeys(mLongMap);
 }
 
 set<String16> PersistableBundle::getDoubleKeys() const {
+    unparcel();
     return getKeys(mDoubleMap);
 }
 
 set<String16> PersistableBundle::getStringKeys() const {
+    unparcel();
     return getKeys(mStringMap);
 }
 
 set<String16> PersistableBundle::getBooleanVectorKeys() const {
+    unparcel();
     return getKeys(mBoolVectorMap);
 }
 
 set<String16> PersistableBundle::getIntVectorKeys() const {
+    unparcel();
     return getKeys(mIntVectorMap);
 }
 
 set<String16> PersistableBundle::getLongVectorKeys() const {
+    unparcel();
     return getKeys(mLongVectorMap);
 }
 
 set<String16> PersistableBundle::getDoubleVectorKeys() const {
+    unparcel();
     return getKeys(mDoubleVectorMap);
 }
 
 set<String16> PersistableBundle::getStringVectorKeys() const {
+    unparcel();
     return getKeys(mStringVectorMap);
 }
 
 set<String16> PersistableBundle::getPersistableBundleKeys() const {
+    unparcel();
     return getKeys(mPersistableBundleMap);
 }
 
@@ -393,11 +562,6 @@ status_t PersistableBundle::writeToParcelInner(Parcel* parcel) const {
 }
 
 status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t length) {
-    /*
-     * Note: we don't actually use length for anything other than an empty PersistableBundle
-     * check, since we do not actually need to copy in an entire Parcel, unlike in the Java
-     * implementation.
-     */
     if (length == 0) {
         // Empty PersistableBundle or end of data.
         return NO_ERROR;
@@ -410,6 +574,73 @@ status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t len
         return BAD_VALUE;
     }
 
+    // If a previous read is still deferred, fold it into the maps first so
+    // that the merge semantics of repeated reads are preserved.
+    unparcel();
+
+    /*
+     * Defer converting the entries into the member maps until the bundle is
+     * actually inspected, like unparcel() in
+     * frameworks/base/core/java/android/os/BaseBundle.java. Bundles that are
+     * only ever relayed to another process never pay for deserialization.
+     * |length| covers the entry data only, not the magic word.
+     */
+    size_t start_pos = parcel->dataPosition();
+    auto parcelled_data = std::make_unique<Parcel>();
+    RETURN_IF_FAILED(parcelled_data->appendFrom(parcel, start_pos, length));
+    parcel->setDataPosition(start_pos + length);
+    mParcelledData = std::move(parcelled_data);
+    mParcelledMagic = magic;
+    return NO_ERROR;
+}
+
+void PersistableBundle::unparcel() const {
+    std::lock_guard<std::mutex> lock(mLazyLock);
+    unparcelLocked();
+}
+
+void PersistableBundle::unparcelLocked() const {
+    if (mParcelledData == nullptr) return;
+
+    std::unique_ptr<Parcel> parcelled_data = std::move(mParcelledData);
+    mParcelledData = nullptr;
+    parcelled_data->setDataPosition(0);
+    status_t result = const_cast<PersistableBundle*>(this)->deserialize(parcelled_data.get());
+    if (result != NO_ERROR) {
+        ALOGE("Failed to deserialize deferred PersistableBundle entries: %d", result);
+    }
+}
+
+Parcel* PersistableBundle::findLazyValueLocked(const String16& key, int32_t type) const {
+    if (mParcelledData == nullptr) return nullptr;
+
+    Parcel* parcel = mParcelledData.get();
+    parcel->setDataPosition(0);
+
+    int32_t num_entries;
+    if (parcel->readInt32(&num_entries) != NO_ERROR) return nullptr;
+
+    for (; num_entries > 0; --num_entries) {
+        size_t key_length;
+        const char16_t* entry_key = parcel->readString16Inplace(&key_length);
+        if (entry_key == nullptr) return nullptr;
+
+        int32_t value_type;
+        if (parcel->readInt32(&value_type) != NO_ERROR) return nullptr;
+
+        if (key_length == key.size() &&
+            memcmp(entry_key, key.string(), key_length * sizeof(char16_t)) == 0) {
+            // A match of the wrong type falls back to the map lookup, like a
+            // stale map entry would after unparcel().
+            return value_type == type ? parcel : nullptr;
+        }
+
+        if (!skipValue(parcel, value_type)) return nullptr;
+    }
+    return nullptr;
+}
+
+status_t PersistableBundle::deserialize(const Parcel* parcel) {
     /*
      * To keep this implementation in sync with unparcel() in
      * frameworks/base/core/java/android/os/BaseBundle.java, the number of
@@ -234,26 +234,29 @@ void ProcessState::setCallRestriction(CallRestriction restriction) {
     mCallRestriction = restriction;
 }
 
-ProcessState::handle_entry* ProcessState::lookupHandleLocked(int32_t handle)
+ProcessState::handle_entry* ProcessState::lookupHandleLocked(HandleTableShard& shard,
+                                                             int32_t handle)
 {
-    const size_t N=mHandleToObject.size();
-    if (N <= (size_t)handle) {
+    const size_t index = (size_t)handle / kHandleTableShards;
+    const size_t N = shard.entries.size();
+    if (N <= index) {
         handle_entry e;
         e.binder = nullptr;
         e.refs = nullptr;
-        status_t err = mHandleToObject.insertAt(e, N, handle+1-N);
+        status_t err = shard.entries.insertAt(e, N, index+1-N);
         if (err < NO_ERROR) return nullptr;
     }
-    return &mHandleToObject.editItemAt(handle);
+    return &shard.entries.editItemAt(index);
 }
 
 sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
 {
     sp<IBinder> result;
 
-    AutoMutex _l(mLock);
+    HandleTableShard& shard = mHandleTable[(size_t)handle % kHandleTableShards];
+    AutoMutex _l(shard.lock);
 
-    handle_entry* e = lookupHandleLocked(handle);
+    handle_entry* e = lookupHandleLocked(shard, handle);
 
     if (e != nullptr) {
         // We need to create a new BpBinder if there isn't currently one, OR we
@@ -318,9 +321,10 @@ sp<IBinder> ProcessState::getStrongProxyForHandle(int32_t handle)
 
 void ProcessState::expungeHandle(int32_t handle, IBinder* binder)
 {
-    AutoMutex _l(mLock);
+    HandleTableShard& shard = mHandleTable[(size_t)handle % kHandleTableShards];
+    AutoMutex _l(shard.lock);
 
-    handle_entry* e = lookupHandleLocked(handle);
+    handle_entry* e = lookupHandleLocked(shard, handle);
 
     // This handle may have already been replaced with a new BpBinder
     // (if someone failed the AttemptIncWeak() above); we don't want
@@ -421,6 +425,7 @@ ProcessState::ProcessState(const char *driver)
     , mStarvationStartTimeMs(0)
     , mThreadPoolStarted(false)
     , mThreadPoolSeq(1)
+    , mPollingSpinnerClaimed(false)
     , mCallRestriction(CallRestriction::NONE)
 {
     if (mDriverFD >= 0) {
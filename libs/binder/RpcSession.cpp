@@ -100,11 +100,40 @@ status_t RpcSession::getRemoteMaxThreads(size_t* maxThreads) {
 
 status_t RpcSession::transact(const RpcAddress& address, uint32_t code, const Parcel& data,
                               Parcel* reply, uint32_t flags) {
-    ExclusiveConnection connection(sp<RpcSession>::fromExisting(this),
-                                   (flags & IBinder::FLAG_ONEWAY) ? ConnectionUse::CLIENT_ASYNC
-                                                                  : ConnectionUse::CLIENT);
-    return state()->transact(connection.fd(), address, code, data,
-                             sp<RpcSession>::fromExisting(this), reply, flags);
+    if (flags & IBinder::FLAG_ONEWAY) {
+        ExclusiveConnection connection(sp<RpcSession>::fromExisting(this),
+                                       ConnectionUse::CLIENT_ASYNC);
+        return state()->transact(connection.fd(), address, code, data,
+                                 sp<RpcSession>::fromExisting(this), reply, flags);
+    }
+
+    // Two-way calls hold the connection exclusively only while the request is
+    // on the wire. The reply is matched by transaction id in waitForReply, so
+    // other threads can pipeline their own calls over this connection while we
+    // wait, and throughput scales with server threads rather than with the
+    // number of client connections.
+    sp<RpcConnection> connection;
+    uint32_t transactionId;
+    {
+        ExclusiveConnection exclusive(sp<RpcSession>::fromExisting(this), ConnectionUse::CLIENT);
+        connection = exclusive.get();
+        status_t status = state()->sendTransact(exclusive.fd(), address, code, data,
+                                                sp<RpcSession>::fromExisting(this), flags,
+                                                &transactionId);
+        if (status != OK) return status;
+
+        if (!state()->peerSupportsTransactionIds()) {
+            // Until the peer has echoed a transaction id it may be a legacy
+            // peer whose replies all carry id 0 and match FIFO. Releasing the
+            // connection here would let another thread pipeline a call and
+            // cross-wire the replies, so keep the pre-multiplexing behavior of
+            // one outstanding call until id support is demonstrated.
+            return state()->waitForReply(exclusive.fd(), sp<RpcSession>::fromExisting(this),
+                                         transactionId, reply);
+        }
+    }
+    return state()->waitForReply(connection->fd, sp<RpcSession>::fromExisting(this), transactionId,
+                                 reply);
 }
 
 status_t RpcSession::sendDecStrong(const RpcAddress& address) {
@@ -18,6 +18,7 @@
 
 #include "RpcState.h"
 
+#include <android-base/macros.h>
 #include <binder/BpBinder.h>
 #include <binder/RpcServer.h>
 
@@ -203,8 +204,13 @@ RpcState::CommandData::CommandData(size_t size) : mSize(size) {
     mData.reset(new (std::nothrow) uint8_t[size]);
 }
 
-bool RpcState::rpcSend(const base::unique_fd& fd, const char* what, const void* data, size_t size) {
-    LOG_RPC_DETAIL("Sending %s on fd %d: %s", what, fd.get(), hexString(data, size).c_str());
+bool RpcState::rpcSend(const base::unique_fd& fd, const char* what, iovec* iovs, size_t niovs) {
+    size_t size = 0;
+    for (size_t i = 0; i < niovs; i++) {
+        LOG_RPC_DETAIL("Sending %s on fd %d: %s", what, fd.get(),
+                       hexString(iovs[i].iov_base, iovs[i].iov_len).c_str());
+        size += iovs[i].iov_len;
+    }
 
     if (size > std::numeric_limits<ssize_t>::max()) {
         ALOGE("Cannot send %s at size %zu (too big)", what, size);
@@ -212,19 +218,43 @@ bool RpcState::rpcSend(const base::unique_fd& fd, const char* what, const void*
         return false;
     }
 
-    ssize_t sent = TEMP_FAILURE_RETRY(send(fd.get(), data, size, MSG_NOSIGNAL));
-
-    if (sent < 0 || sent != static_cast<ssize_t>(size)) {
-        ALOGE("Failed to send %s (sent %zd of %zu bytes) on fd %d, error: %s", what, sent, size,
-              fd.get(), strerror(errno));
-
-        terminate();
-        return false;
+    // Gather everything into a single sendmsg; loop to advance the iovecs in
+    // the (rare, blocking-socket) case of a short write.
+    size_t sentTotal = 0;
+    while (niovs > 0) {
+        msghdr msg{
+                .msg_iov = iovs,
+                .msg_iovlen = static_cast<decltype(msghdr::msg_iovlen)>(niovs),
+        };
+        ssize_t sent = TEMP_FAILURE_RETRY(sendmsg(fd.get(), &msg, MSG_NOSIGNAL));
+        if (sent <= 0) {
+            ALOGE("Failed to send %s (sent %zu of %zu bytes) on fd %d, error: %s", what, sentTotal,
+                  size, fd.get(), strerror(errno));
+            terminate();
+            return false;
+        }
+        sentTotal += sent;
+        while (sent > 0 && niovs > 0) {
+            if (static_cast<size_t>(sent) >= iovs[0].iov_len) {
+                sent -= iovs[0].iov_len;
+                iovs++;
+                niovs--;
+            } else {
+                iovs[0].iov_base = static_cast<uint8_t*>(iovs[0].iov_base) + sent;
+                iovs[0].iov_len -= sent;
+                sent = 0;
+            }
+        }
     }
 
     return true;
 }
 
+bool RpcState::rpcSend(const base::unique_fd& fd, const char* what, const void* data, size_t size) {
+    iovec iov{const_cast<void*>(data), size};
+    return rpcSend(fd, what, &iov, 1);
+}
+
 bool RpcState::rpcRec(const base::unique_fd& fd, const char* what, void* data, size_t size) {
     if (size > std::numeric_limits<ssize_t>::max()) {
         ALOGE("Cannot rec %s at size %zu (too big)", what, size);
@@ -316,6 +346,23 @@ status_t RpcState::getSessionId(const base::unique_fd& fd, const sp<RpcSession>&
 status_t RpcState::transact(const base::unique_fd& fd, const RpcAddress& address, uint32_t code,
                             const Parcel& data, const sp<RpcSession>& session, Parcel* reply,
                             uint32_t flags) {
+    uint32_t transactionId;
+    status_t status = sendTransact(fd, address, code, data, session, flags, &transactionId);
+    if (status != OK) return status;
+
+    if (flags & IBinder::FLAG_ONEWAY) {
+        return OK; // do not wait for result
+    }
+
+    LOG_ALWAYS_FATAL_IF(reply == nullptr, "Reply parcel must be used for synchronous transaction.");
+
+    return waitForReply(fd, session, transactionId, reply);
+}
+
+status_t RpcState::sendTransact(const base::unique_fd& fd, const RpcAddress& address, uint32_t code,
+                                const Parcel& data, const sp<RpcSession>& session, uint32_t flags,
+                                uint32_t* outTransactionId) {
+    (void)session;
     uint64_t asyncNumber = 0;
 
     if (!address.isZero()) {
@@ -347,38 +394,40 @@ status_t RpcState::transact(const base::unique_fd& fd, const RpcAddress& address
             .asyncNumber = asyncNumber,
     };
 
-    CommandData transactionData(sizeof(RpcWireTransaction) + data.dataSize());
-    if (!transactionData.valid()) {
-        return NO_MEMORY;
+    const size_t bodySize = sizeof(RpcWireTransaction) + data.dataSize();
+    if (bodySize > std::numeric_limits<uint32_t>::max()) {
+        ALOGE("Transaction size too big %zu", bodySize);
+        return BAD_VALUE;
     }
 
-    memcpy(transactionData.data() + 0, &transaction, sizeof(RpcWireTransaction));
-    memcpy(transactionData.data() + sizeof(RpcWireTransaction), data.data(), data.dataSize());
-
-    if (transactionData.size() > std::numeric_limits<uint32_t>::max()) {
-        ALOGE("Transaction size too big %zu", transactionData.size());
-        return BAD_VALUE;
+    uint32_t transactionId = 0;
+    if ((flags & IBinder::FLAG_ONEWAY) == 0) {
+        // id 0 is reserved for peers which predate multiplexing
+        do {
+            transactionId = mNextTransactionId.fetch_add(1, std::memory_order_relaxed);
+        } while (transactionId == 0);
     }
 
     RpcWireHeader command{
             .command = RPC_COMMAND_TRANSACT,
-            .bodySize = static_cast<uint32_t>(transactionData.size()),
+            .bodySize = static_cast<uint32_t>(bodySize),
+            .transactionId = transactionId,
     };
 
-    if (!rpcSend(fd, "transact header", &command, sizeof(command))) {
-        return DEAD_OBJECT;
-    }
-    if (!rpcSend(fd, "command body", transactionData.data(), transactionData.size())) {
+    // Send the parcel body directly from its own buffer rather than
+    // flattening into an intermediate allocation; rpcSend gathers the pieces
+    // into a single sendmsg.
+    iovec iovs[]{
+            {&command, sizeof(command)},
+            {&transaction, sizeof(transaction)},
+            {const_cast<uint8_t*>(data.data()), data.dataSize()},
+    };
+    if (!rpcSend(fd, "transaction", iovs, arraysize(iovs))) {
         return DEAD_OBJECT;
     }
 
-    if (flags & IBinder::FLAG_ONEWAY) {
-        return OK; // do not wait for result
-    }
-
-    LOG_ALWAYS_FATAL_IF(reply == nullptr, "Reply parcel must be used for synchronous transaction.");
-
-    return waitForReply(fd, session, reply);
+    *outTransactionId = transactionId;
+    return OK;
 }
 
 static void cleanup_reply_data(Parcel* p, const uint8_t* data, size_t dataSize,
@@ -391,28 +440,108 @@ static void cleanup_reply_data(Parcel* p, const uint8_t* data, size_t dataSize,
 }
 
 status_t RpcState::waitForReply(const base::unique_fd& fd, const sp<RpcSession>& session,
-                                Parcel* reply) {
+                                uint32_t transactionId, Parcel* reply) {
     RpcWireHeader command;
-    while (true) {
+    CommandData data(0);
+
+    // Several two-way calls may be outstanding on this connection. One waiter
+    // at a time is elected to read it; replies destined for other waiters are
+    // stashed and handed over under mWaitMutex, so replies can be matched out
+    // of order.
+    bool haveReply = false;
+    bool isReader = false;
+    {
+        std::unique_lock<std::mutex> _l(mWaitMutex);
+        ConnectionWaitState& state = mConnectionWaitStates[fd.get()];
+        state.waiters++;
+        while (true) {
+            if (auto it = state.readyReplies.find(transactionId); it != state.readyReplies.end()) {
+                command = it->second.first;
+                data = std::move(it->second.second);
+                state.readyReplies.erase(it);
+                haveReply = true;
+                break;
+            }
+            if (state.readerActive) {
+                if (state.readerThread == std::this_thread::get_id()) {
+                    // Nested transaction: we are the active reader (a server
+                    // command called back into us), so read our own reply
+                    // directly instead of deadlocking on ourselves. The outer
+                    // frame stays registered as the reader.
+                    break;
+                }
+                mWaitCv.wait(_l);
+                continue;
+            }
+            state.readerActive = true;
+            state.readerThread = std::this_thread::get_id();
+            isReader = true;
+            break;
+        }
+    }
+
+    status_t readStatus = OK;
+    while (!haveReply && readStatus == OK) {
         if (!rpcRec(fd, "command header", &command, sizeof(command))) {
-            return DEAD_OBJECT;
+            readStatus = DEAD_OBJECT;
+            break;
         }
 
-        if (command.command == RPC_COMMAND_REPLY) break;
+        if (command.command != RPC_COMMAND_REPLY) {
+            readStatus = processServerCommand(fd, session, command);
+            continue;
+        }
 
-        status_t status = processServerCommand(fd, session, command);
-        if (status != OK) return status;
-    }
+        CommandData body(command.bodySize);
+        if (!body.valid()) {
+            readStatus = NO_MEMORY;
+            break;
+        }
+        if (!rpcRec(fd, "reply body", body.data(), command.bodySize)) {
+            readStatus = DEAD_OBJECT;
+            break;
+        }
 
-    CommandData data(command.bodySize);
-    if (!data.valid()) {
-        return NO_MEMORY;
+        if (command.transactionId != 0) {
+            // The peer echoes ids, so its replies match out of order and
+            // future calls may release the connection while they wait.
+            mPeerSupportsTransactionIds.store(true, std::memory_order_relaxed);
+        }
+
+        // id 0 comes from a peer which predates multiplexing; such peers are
+        // only ever sent one call at a time (see RpcSession::transact), so it
+        // is ours.
+        if (command.transactionId == transactionId || command.transactionId == 0) {
+            data = std::move(body);
+            haveReply = true;
+        } else {
+            std::lock_guard<std::mutex> _l(mWaitMutex);
+            mConnectionWaitStates[fd.get()].readyReplies.emplace(command.transactionId,
+                                                                 std::make_pair(command,
+                                                                                std::move(body)));
+            mWaitCv.notify_all();
+        }
     }
 
-    if (!rpcRec(fd, "reply body", data.data(), command.bodySize)) {
-        return DEAD_OBJECT;
+    {
+        std::lock_guard<std::mutex> _l(mWaitMutex);
+        auto it = mConnectionWaitStates.find(fd.get());
+        LOG_ALWAYS_FATAL_IF(it == mConnectionWaitStates.end(), "Lost wait state for fd %d",
+                            fd.get());
+        if (isReader) {
+            // a nested reader leaves the outer frame as the registered reader
+            it->second.readerActive = false;
+        }
+        it->second.waiters--;
+        if (it->second.waiters == 0 && it->second.readyReplies.empty()) {
+            mConnectionWaitStates.erase(it);
+        }
+        // wake someone else up to take over reading (or to observe the error)
+        mWaitCv.notify_all();
     }
 
+    if (readStatus != OK) return readStatus;
+
     if (command.bodySize < sizeof(RpcWireReply)) {
         ALOGE("Expecting %zu but got %" PRId32 " bytes for RpcWireReply. Terminating!",
               sizeof(RpcWireReply), command.bodySize);
@@ -451,9 +580,11 @@ status_t RpcState::sendDecStrong(const base::unique_fd& fd, const RpcAddress& ad
             .command = RPC_COMMAND_DEC_STRONG,
             .bodySize = sizeof(RpcWireAddress),
     };
-    if (!rpcSend(fd, "dec ref header", &cmd, sizeof(cmd))) return DEAD_OBJECT;
-    if (!rpcSend(fd, "dec ref body", &addr.viewRawEmbedded(), sizeof(RpcWireAddress)))
-        return DEAD_OBJECT;
+    iovec iovs[]{
+            {&cmd, sizeof(cmd)},
+            {const_cast<RpcWireAddress*>(&addr.viewRawEmbedded()), sizeof(RpcWireAddress)},
+    };
+    if (!rpcSend(fd, "dec ref", iovs, arraysize(iovs))) return DEAD_OBJECT;
     return OK;
 }
 
@@ -498,7 +629,7 @@ status_t RpcState::processTransact(const base::unique_fd& fd, const sp<RpcSessio
         return DEAD_OBJECT;
     }
 
-    return processTransactInternal(fd, session, std::move(transactionData));
+    return processTransactInternal(fd, session, std::move(transactionData), command.transactionId);
 }
 
 static void do_nothing_to_transact_data(Parcel* p, const uint8_t* data, size_t dataSize,
@@ -511,7 +642,7 @@ static void do_nothing_to_transact_data(Parcel* p, const uint8_t* data, size_t d
 }
 
 status_t RpcState::processTransactInternal(const base::unique_fd& fd, const sp<RpcSession>& session,
-                                           CommandData transactionData) {
+                                           CommandData transactionData, uint32_t transactionId) {
     if (transactionData.size() < sizeof(RpcWireTransaction)) {
         ALOGE("Expecting %zu but got %zu bytes for RpcWireTransaction. Terminating!",
               sizeof(RpcWireTransaction), transactionData.size());
@@ -665,7 +796,8 @@ status_t RpcState::processTransactInternal(const base::unique_fd& fd, const sp<R
                         const_cast<BinderNode::AsyncTodo&>(it->second.asyncTodo.top()).data);
                 it->second.asyncTodo.pop();
                 _l.unlock();
-                return processTransactInternal(fd, session, std::move(data));
+                // queued transactions are oneway, so they carry no reply id
+                return processTransactInternal(fd, session, std::move(data), 0);
             }
         }
         return OK;
@@ -675,28 +807,28 @@ status_t RpcState::processTransactInternal(const base::unique_fd& fd, const sp<R
             .status = replyStatus,
     };
 
-    CommandData replyData(sizeof(RpcWireReply) + reply.dataSize());
-    if (!replyData.valid()) {
-        return NO_MEMORY;
-    }
-    memcpy(replyData.data() + 0, &rpcReply, sizeof(RpcWireReply));
-    memcpy(replyData.data() + sizeof(RpcWireReply), reply.data(), reply.dataSize());
-
-    if (replyData.size() > std::numeric_limits<uint32_t>::max()) {
-        ALOGE("Reply size too big %zu", transactionData.size());
+    const size_t bodySize = sizeof(RpcWireReply) + reply.dataSize();
+    if (bodySize > std::numeric_limits<uint32_t>::max()) {
+        ALOGE("Reply size too big %zu", bodySize);
         terminate();
         return BAD_VALUE;
     }
 
     RpcWireHeader cmdReply{
             .command = RPC_COMMAND_REPLY,
-            .bodySize = static_cast<uint32_t>(replyData.size()),
+            .bodySize = static_cast<uint32_t>(bodySize),
+            .transactionId = transactionId,
     };
 
-    if (!rpcSend(fd, "reply header", &cmdReply, sizeof(RpcWireHeader))) {
-        return DEAD_OBJECT;
-    }
-    if (!rpcSend(fd, "reply body", replyData.data(), replyData.size())) {
+    // As on the transact path, gather the reply parcel straight off its own
+    // buffer instead of copying it into a throwaway allocation. Status-only
+    // replies then cost a header and an empty parcel, nothing more.
+    iovec iovs[]{
+            {&cmdReply, sizeof(RpcWireHeader)},
+            {&rpcReply, sizeof(RpcWireReply)},
+            {const_cast<uint8_t*>(reply.data()), reply.dataSize()},
+    };
+    if (!rpcSend(fd, "reply", iovs, arraysize(iovs))) {
         return DEAD_OBJECT;
     }
     return OK;
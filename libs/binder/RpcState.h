@@ -19,14 +19,19 @@
 #include <binder/IBinder.h>
 #include <binder/Parcel.h>
 #include <binder/RpcSession.h>
+#include <sys/uio.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <queue>
+#include <thread>
 
-namespace android {
+#include "RpcWireFormat.h"
 
-struct RpcWireHeader;
+namespace android {
 
 /**
  * Log a lot more information about RPC calls, when debugging issues. Usually,
@@ -61,6 +66,28 @@ public:
     [[nodiscard]] status_t transact(const base::unique_fd& fd, const RpcAddress& address,
                                     uint32_t code, const Parcel& data,
                                     const sp<RpcSession>& session, Parcel* reply, uint32_t flags);
+    /**
+     * Writes the transaction and returns without waiting for the reply. For
+     * two-way calls, *outTransactionId identifies the reply; pass it to
+     * waitForReply. This allows the caller to release its exclusive hold on
+     * the connection while waiting, so two-way calls from other threads can be
+     * pipelined on the same connection.
+     */
+    [[nodiscard]] status_t sendTransact(const base::unique_fd& fd, const RpcAddress& address,
+                                        uint32_t code, const Parcel& data,
+                                        const sp<RpcSession>& session, uint32_t flags,
+                                        uint32_t* outTransactionId);
+    [[nodiscard]] status_t waitForReply(const base::unique_fd& fd, const sp<RpcSession>& session,
+                                        uint32_t transactionId, Parcel* reply);
+    /**
+     * Whether the peer has echoed a transaction id back in a reply. Until it
+     * has, it may be a legacy peer whose replies all carry id 0 and are
+     * matched FIFO, so callers must not release the connection between
+     * sendTransact and waitForReply.
+     */
+    bool peerSupportsTransactionIds() const {
+        return mPeerSupportsTransactionIds.load(std::memory_order_relaxed);
+    }
     [[nodiscard]] status_t sendDecStrong(const base::unique_fd& fd, const RpcAddress& address);
     [[nodiscard]] status_t getAndExecuteCommand(const base::unique_fd& fd,
                                                 const sp<RpcSession>& session);
@@ -115,12 +142,14 @@ private:
         size_t mSize;
     };
 
+    // Gathers all iovecs into a single sendmsg call so that a header and its
+    // body reach the socket as one syscall (and usually one TCP segment).
+    [[nodiscard]] bool rpcSend(const base::unique_fd& fd, const char* what, iovec* iovs,
+                               size_t niovs);
     [[nodiscard]] bool rpcSend(const base::unique_fd& fd, const char* what, const void* data,
                                size_t size);
     [[nodiscard]] bool rpcRec(const base::unique_fd& fd, const char* what, void* data, size_t size);
 
-    [[nodiscard]] status_t waitForReply(const base::unique_fd& fd, const sp<RpcSession>& session,
-                                        Parcel* reply);
     [[nodiscard]] status_t processServerCommand(const base::unique_fd& fd,
                                                 const sp<RpcSession>& session,
                                                 const RpcWireHeader& command);
@@ -183,6 +212,26 @@ private:
     bool mTerminated = false;
     // binders known by both sides of a session
     std::map<RpcAddress, BinderNode> mNodeForAddress;
+
+    // Multiplexing state: several two-way calls may be outstanding on one
+    // connection. At most one thread (the elected reader) reads a connection
+    // at a time; replies for other waiters are stashed in readyReplies and
+    // handed over under mWaitMutex.
+    struct ConnectionWaitState {
+        size_t waiters = 0;
+        bool readerActive = false;
+        // which thread holds the read side (for nested transactions, the
+        // active reader must be allowed to read its own nested reply)
+        std::thread::id readerThread;
+        std::map<uint32_t, std::pair<RpcWireHeader, CommandData>> readyReplies;
+    };
+
+    std::atomic<uint32_t> mNextTransactionId = 1;
+    std::atomic<bool> mPeerSupportsTransactionIds = false;
+    std::mutex mWaitMutex;
+    std::condition_variable mWaitCv;
+    // keyed by connection fd; entries are erased once idle
+    std::map<int, ConnectionWaitState> mConnectionWaitStates;
 };
 
 } // namespace android
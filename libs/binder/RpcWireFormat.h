@@ -60,7 +60,13 @@ struct RpcWireHeader {
     uint32_t command; // RPC_COMMAND_*
     uint32_t bodySize;
 
-    uint32_t reserved[2];
+    // For RPC_COMMAND_TRANSACT and RPC_COMMAND_REPLY: matches a reply to its
+    // transaction so that several two-way calls can be in flight on one
+    // connection at a time. Zero for oneway transactions (and for peers which
+    // predate multiplexing, which are matched to the only outstanding waiter).
+    uint32_t transactionId;
+
+    uint32_t reserved[1];
 };
 
 struct RpcWireAddress {
@@ -35,7 +35,11 @@ public:
 
     // flags returned by getFlags()
     enum {
-        READ_ONLY   = 0x00000001
+        READ_ONLY   = 0x00000001,
+        // hint that the heap should be backed by transparent huge pages.
+        // travels with the heap so every process mapping it applies the same
+        // hint; best-effort, falls back to regular pages where unsupported.
+        HINT_HUGEPAGES = 0x00000002
     };
 
     virtual int         getHeapID() const = 0;
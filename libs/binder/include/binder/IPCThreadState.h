@@ -21,6 +21,9 @@
 #include <binder/ProcessState.h>
 #include <utils/Vector.h>
 
+#include <memory>
+#include <vector>
+
 #if defined(_WIN32)
 typedef  int  uid_t;
 #endif
@@ -119,6 +122,16 @@ public:
             void                flushCommands();
             bool                flushIfNeeded();
 
+            // Batches oneway transactions issued by this thread: between
+            // corkTransactions() and the matching uncorkTransactions(),
+            // consecutive oneway calls accumulate in the out buffer and reach
+            // the driver with a single ioctl at uncork time (or earlier, once
+            // the batch grows past an internal threshold). Cork calls nest;
+            // only the outermost uncork flushes. Synchronous transactions are
+            // unaffected and flush any pending batch as a side effect.
+            void                corkTransactions();
+            void                uncorkTransactions();
+
             void                joinThreadPool(bool isMain = true);
             
             // Stop the local process.
@@ -169,6 +182,20 @@ public:
             // This constant needs to be kept in sync with Binder.UNSET_WORKSOURCE from the Java
             // side.
             static const int32_t kUnsetWorkSource = -1;
+
+            // Parcels allocate their data buffers through a small per-thread
+            // pool of fixed-size buffers so that the common small transaction
+            // never touches malloc. Buffers handed out here are always exactly
+            // kParcelBufferPoolBufferSize bytes.
+            static constexpr size_t kParcelBufferPoolBufferSize = 4096;
+
+            // Returns a pooled buffer of kParcelBufferPoolBufferSize bytes, or
+            // nullptr if the pool is empty (caller falls back to malloc).
+            uint8_t*            obtainParcelBuffer();
+            // Takes ownership of a buffer previously obtained from
+            // obtainParcelBuffer. Returns false if the pool is full, in which
+            // case the caller must free the buffer itself.
+            bool                recycleParcelBuffer(uint8_t* buffer);
 private:
                                 IPCThreadState();
                                 ~IPCThreadState();
@@ -190,10 +217,29 @@ private:
 
             void                clearCaller();
 
+            // Briefly polls the driver before parking in the blocking read;
+            // run by the one looper thread that claimed
+            // ProcessState::mPollingSpinnerClaimed.
+            void                spinBeforeRead();
+
+            // Large object-free payloads are spilled into an ashmem region so
+            // that only the fd crosses the kernel instead of the whole buffer
+            // being copied twice; see writeTransactionData. Returns null when
+            // pass-through does not apply (feature disabled, fds not allowed,
+            // or the spill failed) and the regular copy path must be used.
+            std::unique_ptr<Parcel> spillLargeParcel(const Parcel& data);
+
     static  void                threadDestructor(void *st);
     static  void                freeBuffer(Parcel* parcel,
                                            const uint8_t* data, size_t dataSize,
                                            const binder_size_t* objects, size_t objectsSize);
+            // Counterpart of spillLargeParcel: if `buffer` is a spilled
+            // payload, re-point it at a private snapshot of the region.
+    static  status_t            inflateLargeParcel(Parcel* buffer);
+    static  void                freeLargeParcelPayload(Parcel* parcel,
+                                                       const uint8_t* data, size_t dataSize,
+                                                       const binder_size_t* objects,
+                                                       size_t objectsSize);
 
     const   sp<ProcessState>    mProcess;
             Vector<BBinder*>    mPendingStrongDerefs;
@@ -214,9 +260,29 @@ private:
             bool                mPropagateWorkSource;
             bool                mIsLooper;
             bool mIsFlushing;
+            // Whether this thread holds the pre-read spin role, and its
+            // current adaptive spin budget; see spinBeforeRead().
+            bool                mIsPollingSpinner;
+            int64_t             mSpinBeforeReadUs;
             int32_t             mStrictModePolicy;
             int32_t             mLastTransactionBinderFlags;
             CallRestriction     mCallRestriction;
+
+            // Cork nesting depth and the payload bytes pinned by the current
+            // batch; see corkTransactions(). The batch auto-flushes when the
+            // pinned payload exceeds kCorkFlushThreshold, well under the
+            // driver's per-process async buffer budget.
+    static  constexpr size_t    kCorkFlushThreshold = 64 * 1024;
+            int32_t             mCorkCount;
+            size_t              mCorkedPayloadBytes;
+
+    static  constexpr size_t    kParcelBufferPoolCapacity = 4;
+            uint8_t*            mParcelBufferPool[kParcelBufferPoolCapacity];
+            size_t              mParcelBufferPoolCount;
+
+            // Spilled large-parcel payloads; must stay alive until the driver
+            // has consumed the corresponding transaction from mOut.
+            std::vector<std::unique_ptr<Parcel>> mPendingSpillParcels;
 };
 
 } // namespace android
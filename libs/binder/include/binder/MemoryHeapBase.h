@@ -31,10 +31,16 @@ class MemoryHeapBase : public virtual BnMemoryHeap
 public:
     enum {
         READ_ONLY = IMemoryHeap::READ_ONLY,
+        // ask the kernel to back the heap with transparent huge pages. shared
+        // with IMemoryHeap so remote mappings get the same hint.
+        HINT_HUGEPAGES = IMemoryHeap::HINT_HUGEPAGES,
         // memory won't be mapped locally, but will be mapped in the remote
         // process.
         DONT_MAP_LOCALLY = 0x00000100,
-        NO_CACHING = 0x00000200
+        NO_CACHING = 0x00000200,
+        // fault the whole heap in at construction so first use doesn't pay
+        // for it. local to this process; not part of IMemoryHeap flags.
+        PREFAULT = 0x00000400
     };
 
     /*
@@ -200,6 +200,18 @@ public:
                             const std::unique_ptr<std::vector<std::unique_ptr<std::string>>>& val) __attribute__((deprecated("use std::optional version instead")));
     status_t            writeUtf8VectorAsUtf16Vector(const std::vector<std::string>& val);
 
+    // Span forms of the primitive-vector methods: parcel a caller-owned array
+    // of a packed primitive type (int32_t, float, ...) as a single memcpy
+    // without materializing a std::vector. Wire-compatible with the
+    // corresponding vector methods, so one side may use spans and the other
+    // vectors. readRawSpan() expects exactly `count` elements on the wire;
+    // transmit the count out of band (or with a fixed batch size) when it is
+    // not known to the reader.
+    template <typename T>
+    status_t            writeRawSpan(const T* values, size_t count);
+    template <typename T>
+    status_t            readRawSpan(T* values, size_t count) const;
+
     status_t            writeStrongBinderVector(const std::optional<std::vector<sp<IBinder>>>& val);
     status_t            writeStrongBinderVector(const std::unique_ptr<std::vector<sp<IBinder>>>& val) __attribute__((deprecated("use std::optional version instead")));
     status_t            writeStrongBinderVector(const std::vector<sp<IBinder>>& val);
@@ -294,6 +306,13 @@ public:
     status_t            writeUniqueFileDescriptor(
                             const base::unique_fd& fd);
 
+    // Place a file descriptor into the parcel, transferring ownership to the
+    // parcel without creating a dup. The descriptor will be closed when the
+    // parcel is destroyed. On error the descriptor is left in the caller's
+    // hands.
+    status_t            writeUniqueFileDescriptor(
+                            base::unique_fd&& fd);
+
     // Place a vector of file desciptors into the parcel. Each descriptor is
     // dup'd as in writeDupFileDescriptor
     status_t            writeUniqueFileDescriptorVector(
@@ -495,6 +514,13 @@ public:
     status_t            readUniqueFileDescriptor(
                             base::unique_fd* val) const;
 
+    // Retrieve a smart file descriptor from the parcel, adopting the
+    // descriptor stored in the parcel instead of creating a dup whenever the
+    // parcel can relinquish ownership of it. If the parcel cannot give the
+    // descriptor up - it only borrowed it, or it was already adopted - the
+    // caller gets a dup, as with readUniqueFileDescriptor().
+    status_t            takeUniqueFileDescriptor(base::unique_fd* val) const;
+
     // Retrieve a Java "parcel file descriptor" from the parcel.
     status_t            readUniqueParcelFileDescriptor(base::unique_fd* val) const;
 
@@ -1124,6 +1150,10 @@ private:
 
     mutable bool        mRequestHeaderPresent;
 
+    // whether mData was obtained from the per-thread buffer pool in
+    // IPCThreadState; pooled buffers are recycled instead of freed
+    bool                mDataPooled;
+
     mutable size_t      mWorkSourceRequestHeaderPosition;
 
     mutable bool        mFdsKnown;
@@ -1136,6 +1166,11 @@ private:
 
     release_func        mOwner;
 
+    // Object offsets of file descriptors that a reader adopted with
+    // takeUniqueFileDescriptor() out of a kernel-owned buffer; these must not
+    // be closed when the buffer is freed.
+    mutable std::vector<binder_size_t> mAdoptedFds;
+
     sp<RpcSession> mSession;
 
     class Blob {
@@ -1222,7 +1257,7 @@ public:
     };
 
 private:
-    size_t mOpenAshmemSize;
+    mutable size_t mOpenAshmemSize;
 
 public:
     // TODO: Remove once ABI can be changed.
@@ -1232,6 +1267,33 @@ public:
 
 // ---------------------------------------------------------------------------
 
+template <typename T>
+status_t Parcel::writeRawSpan(const T* values, size_t count) {
+    static_assert(is_pointer_equivalent_array_v<T>,
+                  "writeRawSpan is restricted to packed primitive types");
+    if (count > static_cast<size_t>(std::numeric_limits<int32_t>::max())) return BAD_VALUE;
+    constexpr size_t limit = std::numeric_limits<size_t>::max() / sizeof(T);
+    if (count > limit) return BAD_VALUE;
+    const status_t status = writeInt32(static_cast<int32_t>(count));
+    if (status != OK) return status;
+    return write(values, count * sizeof(T));
+}
+
+template <typename T>
+status_t Parcel::readRawSpan(T* values, size_t count) const {
+    static_assert(is_pointer_equivalent_array_v<T>,
+                  "readRawSpan is restricted to packed primitive types");
+    int32_t size;
+    const status_t status = readInt32(&size);
+    if (status != OK) return status;
+    if (size < 0) return UNEXPECTED_NULL;
+    if (static_cast<size_t>(size) != count) return BAD_VALUE;
+    const void* data = readInplace(count * sizeof(T));
+    if (data == nullptr) return BAD_VALUE;
+    memcpy(values, data, count * sizeof(T));
+    return OK;
+}
+
 template<typename T>
 status_t Parcel::write(const Flattenable<T>& val) {
     const FlattenableHelper<T> helper(val);
@@ -21,6 +21,8 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include <memory>
+
 #include <utils/String16.h>
 #include <utils/Singleton.h>
 #include <utils/SortedVector.h>
@@ -48,16 +50,23 @@ class PermissionCache : Singleton<PermissionCache> {
             return (uid == e.uid) ? (name < e.name) : (uid < e.uid);
         }
     };
+    // serializes writers only; the hit path in check() is lock-free
     mutable Mutex mLock;
     // we pool all the permission names we see, as many permissions checks
     // will have identical names
     SortedVector< String16 > mPermissionNamesPool;
-    // this is our cache per say. it stores pooled names.
-    SortedVector< Entry > mCache;
+    // this is our cache per say. it stores pooled names. readers work on an
+    // immutable snapshot; writers publish a new one under mLock
+    // (copy-on-write).
+    std::shared_ptr<const SortedVector< Entry >> mCache;
 
     // free the whole cache, but keep the permission name pool
     void purge();
 
+    // drop only the entries cached for the given uid, keeping other uids'
+    // grants valid
+    void purge(uid_t uid);
+
     status_t check(bool* granted,
             const String16& permission, uid_t uid) const;
 
@@ -75,6 +84,10 @@ public:
             pid_t pid, uid_t uid);
 
     static void purgeCache();
+
+    // Purges the cached permissions of a single uid, for callers reacting to
+    // a per-uid permission change instead of a wholesale invalidation.
+    static void purgeCache(uid_t uid);
 };
 
 // ---------------------------------------------------------------------------
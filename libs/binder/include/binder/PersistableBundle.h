@@ -17,6 +17,8 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -36,7 +38,8 @@ class PersistableBundle : public Parcelable {
 public:
     PersistableBundle() = default;
     virtual ~PersistableBundle() = default;
-    PersistableBundle(const PersistableBundle& bundle) = default;
+    PersistableBundle(const PersistableBundle& bundle);
+    PersistableBundle& operator=(const PersistableBundle& bundle);
 
     status_t writeToParcel(Parcel* parcel) const override;
     status_t readFromParcel(const Parcel* parcel) override;
@@ -93,6 +96,8 @@ public:
     std::set<String16> getPersistableBundleKeys() const;
 
     friend bool operator==(const PersistableBundle& lhs, const PersistableBundle& rhs) {
+        lhs.unparcel();
+        rhs.unparcel();
         return (lhs.mBoolMap == rhs.mBoolMap && lhs.mIntMap == rhs.mIntMap &&
                 lhs.mLongMap == rhs.mLongMap && lhs.mDoubleMap == rhs.mDoubleMap &&
                 lhs.mStringMap == rhs.mStringMap && lhs.mBoolVectorMap == rhs.mBoolVectorMap &&
@@ -111,6 +116,30 @@ private:
     status_t writeToParcelInner(Parcel* parcel) const;
     status_t readFromParcelInner(const Parcel* parcel, size_t length);
 
+    /* Deserializes mParcelledData into the member maps, if present. */
+    void unparcel() const;
+    void unparcelLocked() const;
+    status_t deserialize(const Parcel* parcel);
+    Parcel* findLazyValueLocked(const String16& key, int32_t type) const;
+    size_t mapsSize() const;
+
+    /*
+     * Guards mParcelledData and the deserialization into the maps: the lazy
+     * getters walk the captured parcel and move its data position, so const
+     * reads need mutual exclusion to stay safe for concurrent use.
+     */
+    mutable std::mutex mLazyLock;
+    /*
+     * Raw entry data captured by readFromParcelInner() and deserialized into
+     * the maps on first structural access, mirroring the lazy unparcel()
+     * behavior in frameworks/base/core/java/android/os/BaseBundle.java. Each
+     * bundle owns its copy; sharing it across copies would let const reads of
+     * one copy move the data position under another.
+     */
+    mutable std::unique_ptr<Parcel> mParcelledData;
+    /* Magic word the deferred data arrived with, re-emitted by writeToParcel(). */
+    int32_t mParcelledMagic = 0;
+
     std::map<String16, bool> mBoolMap;
     std::map<String16, int32_t> mIntMap;
     std::map<String16, int64_t> mLongMap;
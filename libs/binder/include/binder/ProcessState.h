@@ -25,6 +25,8 @@
 
 #include <pthread.h>
 
+#include <atomic>
+
 // ---------------------------------------------------------------------------
 namespace android {
 
@@ -103,7 +105,17 @@ private:
                 RefBase::weakref_type* refs;
             };
 
-            handle_entry*       lookupHandleLocked(int32_t handle);
+            // The handle table is sharded so that proxy resolution from many
+            // binder threads does not funnel through a single lock. A handle
+            // lives in shard (handle % kHandleTableShards) at index
+            // (handle / kHandleTableShards).
+            static constexpr size_t kHandleTableShards = 16;
+            struct HandleTableShard {
+                Mutex lock;
+                Vector<handle_entry> entries;
+            };
+
+            handle_entry*       lookupHandleLocked(HandleTableShard& shard, int32_t handle);
 
             String8             mDriverName;
             int                 mDriverFD;
@@ -122,13 +134,17 @@ private:
             // Time when thread pool was emptied
             int64_t             mStarvationStartTimeMs;
 
-    mutable Mutex               mLock;  // protects everything below.
+            HandleTableShard    mHandleTable[kHandleTableShards];
 
-            Vector<handle_entry>mHandleToObject;
+    mutable Mutex               mLock;  // protects everything below.
 
             bool                mThreadPoolStarted;
     volatile int32_t            mThreadPoolSeq;
 
+            // Whether a looper thread has claimed the pre-read spin role;
+            // see IPCThreadState::spinBeforeRead().
+    std::atomic<bool>           mPollingSpinnerClaimed;
+
             CallRestriction     mCallRestriction;
 };
     
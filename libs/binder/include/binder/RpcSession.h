@@ -147,6 +147,7 @@ private:
         explicit ExclusiveConnection(const sp<RpcSession>& session, ConnectionUse use);
         ~ExclusiveConnection();
         const base::unique_fd& fd() { return mConnection->fd; }
+        const sp<RpcConnection>& get() { return mConnection; }
 
     private:
         static void findConnection(pid_t tid, sp<RpcConnection>* exclusive,
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/logging.h>
+#include <benchmark/benchmark.h>
+#include <binder/Binder.h>
+#include <binder/IPCThreadState.h>
+#include <binder/IServiceManager.h>
+#include <binder/Parcel.h>
+#include <binder/ProcessState.h>
+#include <utils/String16.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <vector>
+
+// Usage: atest binderLibBenchmark
+//
+// Benchmarks for the kernel binder hot paths that binderParcelBenchmark
+// (in-process Parcel vectors) and binderRpcBenchmark (socket transport) do
+// not cover: IPCThreadState round-trip latency, representative payload
+// shapes from small control messages up to 1MB blobs, fd-heavy parcels, and
+// Parcel object-table handling.
+
+using namespace android;
+
+static const char* kServiceName = "binderLibBenchmark-server";
+
+enum {
+    ECHO_BYTES_TRANSACTION = IBinder::FIRST_CALL_TRANSACTION,
+    ACK_TRANSACTION,
+};
+
+class BenchmarkService : public BBinder {
+    status_t onTransact(uint32_t code, const Parcel& data, Parcel* reply,
+                        uint32_t /*flags*/) override {
+        switch (code) {
+            case ECHO_BYTES_TRANSACTION:
+                // Object-free payload; this is a plain copy.
+                return reply->appendFrom(&data, 0, data.dataSize());
+            case ACK_TRANSACTION:
+                // Consume whatever arrived (e.g. fds) and only ack.
+                return reply->writeInt32(0);
+            default:
+                return UNKNOWN_TRANSACTION;
+        }
+    }
+};
+
+static sp<IBinder> gBinder;
+
+// Round-trip latency of the smallest possible transaction.
+void BM_pingTransaction(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        CHECK_EQ(OK, gBinder->pingBinder());
+    }
+}
+BENCHMARK(BM_pingTransaction);
+
+// Echo a raw byte payload: 64B control message up to a 1MB blob. This
+// exercises writeTransactionData, the driver copies and reply handling.
+void BM_echoBytes(benchmark::State& state) {
+    const size_t bytes = state.range(0);
+    std::vector<uint8_t> payload(bytes, 0xda);
+
+    while (state.KeepRunning()) {
+        Parcel data;
+        Parcel reply;
+        CHECK_EQ(OK, data.write(payload.data(), payload.size()));
+        CHECK_EQ(OK, gBinder->transact(ECHO_BYTES_TRANSACTION, data, &reply));
+        CHECK_EQ(reply.dataSize(), payload.size());
+    }
+    state.SetBytesProcessed(state.iterations() * bytes * 2);  // out and back
+}
+BENCHMARK(BM_echoBytes)->Arg(64)->Arg(4096)->Arg(1 << 16)->Arg(1 << 20);
+
+// Send a parcel carrying fds: object-table translation in the driver and
+// BINDER_TYPE_FD handling on both ends dominate here, not payload size.
+void BM_sendFds(benchmark::State& state) {
+    const size_t numFds = state.range(0);
+    int fd = open("/dev/null", O_RDONLY);
+    CHECK_GE(fd, 0);
+
+    while (state.KeepRunning()) {
+        Parcel data;
+        Parcel reply;
+        for (size_t i = 0; i < numFds; i++) {
+            CHECK_EQ(OK, data.writeFileDescriptor(fd, false /*takeOwnership*/));
+        }
+        CHECK_EQ(OK, gBinder->transact(ACK_TRANSACTION, data, &reply));
+    }
+
+    close(fd);
+}
+BENCHMARK(BM_sendFds)->Arg(1)->Arg(4)->Arg(16);
+
+// Object-table handling without crossing the kernel: write then re-read a
+// parcel whose object table holds N entries. Reading out of a parcel with
+// objects goes through validateReadData on every primitive read.
+void BM_parcelObjectTable(benchmark::State& state) {
+    const size_t numObjects = state.range(0);
+    int fd = open("/dev/null", O_RDONLY);
+    CHECK_GE(fd, 0);
+
+    while (state.KeepRunning()) {
+        Parcel p;
+        for (size_t i = 0; i < numObjects; i++) {
+            CHECK_EQ(OK, p.writeInt32(i));
+            CHECK_EQ(OK, p.writeFileDescriptor(fd, false /*takeOwnership*/));
+        }
+        p.setDataPosition(0);
+        for (size_t i = 0; i < numObjects; i++) {
+            int32_t val;
+            CHECK_EQ(OK, p.readInt32(&val));
+            benchmark::DoNotOptimize(p.readFileDescriptor());
+        }
+    }
+
+    close(fd);
+}
+BENCHMARK(BM_parcelObjectTable)->Arg(1)->Arg(8)->Arg(64);
+
+int main(int argc, char** argv) {
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    pid_t server = fork();
+    CHECK_GE(server, 0);
+    if (server == 0) {
+        ProcessState::self()->startThreadPool();
+        CHECK_EQ(OK,
+                 defaultServiceManager()->addService(String16(kServiceName),
+                                                     sp<BenchmarkService>::make()));
+        IPCThreadState::self()->joinThreadPool();
+        return 1;  // joinThreadPool does not return
+    }
+
+    ProcessState::self()->startThreadPool();
+    gBinder = defaultServiceManager()->getService(String16(kServiceName));
+    CHECK(gBinder != nullptr) << "Could not connect to " << kServiceName;
+
+    ::benchmark::RunSpecifiedBenchmarks();
+
+    gBinder = nullptr;
+    kill(server, SIGTERM);
+    return 0;
+}
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <binder/Parcel.h>
 #include <binder/IPCThreadState.h>
 #include <gtest/gtest.h>
@@ -101,6 +104,46 @@ TEST(Parcel, Utf8AsUtf16Write) {
     });
 }
 
+TEST(Parcel, WriteUniqueFileDescriptorMove) {
+    android::base::unique_fd fd(open("/dev/null", O_RDONLY));
+    ASSERT_TRUE(fd.ok());
+    const int rawFd = fd.get();
+
+    auto p = std::make_unique<Parcel>();
+    ASSERT_EQ(OK, p->writeUniqueFileDescriptor(std::move(fd)));
+    // Ownership moved into the parcel without a dup.
+    EXPECT_FALSE(fd.ok());
+
+    p->setDataPosition(0);
+    android::base::unique_fd taken;
+    ASSERT_EQ(OK, p->takeUniqueFileDescriptor(&taken));
+    EXPECT_EQ(rawFd, taken.get());
+
+    // The adopted descriptor outlives the parcel.
+    p.reset();
+    EXPECT_NE(-1, fcntl(taken.get(), F_GETFD));
+}
+
+TEST(Parcel, TakeUniqueFileDescriptorFallsBackToDup) {
+    android::base::unique_fd fd(open("/dev/null", O_RDONLY));
+    ASSERT_TRUE(fd.ok());
+
+    Parcel p;
+    ASSERT_EQ(OK, p.writeUniqueFileDescriptor(std::move(fd)));
+
+    p.setDataPosition(0);
+    android::base::unique_fd first;
+    ASSERT_EQ(OK, p.takeUniqueFileDescriptor(&first));
+
+    // The parcel gave up ownership above, so reading again falls back to a
+    // dup of the (still open) descriptor.
+    p.setDataPosition(0);
+    android::base::unique_fd second;
+    ASSERT_EQ(OK, p.takeUniqueFileDescriptor(&second));
+    EXPECT_NE(first.get(), second.get());
+    EXPECT_NE(-1, fcntl(second.get(), F_GETFD));
+}
+
 template <typename T>
 using readFunc = status_t (Parcel::*)(T* out) const;
 template <typename T>
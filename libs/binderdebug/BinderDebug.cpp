@@ -17,9 +17,10 @@
 #include <android-base/parseint.h>
 #include <android-base/strings.h>
 #include <binder/Binder.h>
+#include <ctype.h>
 #include <sys/types.h>
 #include <fstream>
-#include <regex>
+#include <string_view>
 
 #include <binderdebug/BinderDebug.h>
 
@@ -38,6 +39,45 @@ static std::string contextToString(BinderDebugContext context) {
     }
 }
 
+// Removes leading spaces/tabs from a line of binderfs output.
+static std::string_view trimLeft(std::string_view sv) {
+    while (!sv.empty() && (sv.front() == ' ' || sv.front() == '\t')) {
+        sv.remove_prefix(1);
+    }
+    return sv;
+}
+
+// Returns the next whitespace-delimited token and advances past it.
+static std::string_view nextToken(std::string_view* sv) {
+    *sv = trimLeft(*sv);
+    size_t end = 0;
+    while (end < sv->size() && !isspace(static_cast<unsigned char>((*sv)[end]))) {
+        end++;
+    }
+    std::string_view token = sv->substr(0, end);
+    sv->remove_prefix(end);
+    return token;
+}
+
+static bool isHex(std::string_view sv) {
+    if (sv.empty()) return false;
+    for (char c : sv) {
+        if (!isxdigit(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
+
+// Matches "context <name>" exactly, as printed between sections of the proc file.
+static bool parseContextLine(std::string_view line, std::string_view* outName) {
+    if (!base::ConsumePrefix(&line, "context ")) return false;
+    if (line.empty()) return false;
+    for (char c : line) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+    }
+    *outName = line;
+    return true;
+}
+
 static status_t scanBinderContext(pid_t pid, const std::string& contextName,
                                   std::function<void(const std::string&)> eachLine) {
     std::ifstream ifs("/dev/binderfs/binder_logs/proc/" + std::to_string(pid));
@@ -47,14 +87,13 @@ static status_t scanBinderContext(pid_t pid, const std::string& contextName,
             return -errno;
         }
     }
-    static const std::regex kContextLine("^context (\\w+)$");
 
     bool isDesiredContext = false;
     std::string line;
-    std::smatch match;
     while (getline(ifs, line)) {
-        if (std::regex_search(line, match, kContextLine)) {
-            isDesiredContext = match.str(1) == contextName;
+        std::string_view context;
+        if (parseContextLine(line, &context)) {
+            isDesiredContext = context == contextName;
             continue;
         }
         if (!isDesiredContext) {
@@ -65,14 +104,32 @@ static status_t scanBinderContext(pid_t pid, const std::string& contextName,
     return OK;
 }
 
+// Matches a numeric id with its trailing colon, e.g. the "12:" in "node 12:".
+static bool isIdToken(std::string_view token) {
+    if (token.size() < 2 || token.back() != ':') return false;
+    for (char c : token.substr(0, token.size() - 1)) {
+        if (!isdigit(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
+
 status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo* pidInfo) {
-    std::smatch match;
-    static const std::regex kReferencePrefix("^\\s*node \\d+:\\s+u([0-9a-f]+)\\s+c([0-9a-f]+)\\s+");
-    static const std::regex kThreadPrefix("^\\s*thread \\d+:\\s+l\\s+(\\d)(\\d)");
     std::string contextStr = contextToString(context);
+    // The driver emits these lines in a fixed format, so plain token scanning
+    // is enough; a regex here costs more than reading the file does when a
+    // watchdog polls every pid of interest.
     status_t ret = scanBinderContext(pid, contextStr, [&](const std::string& line) {
-        if (std::regex_search(line, match, kReferencePrefix)) {
-            const std::string& ptrString = "0x" + match.str(2); // use number after c
+        std::string_view sv = line;
+        std::string_view kind = nextToken(&sv);
+        if (kind == "node") {
+            // "node <id>: u<hex> c<hex> ..."
+            if (!isIdToken(nextToken(&sv))) return;
+            std::string_view uToken = nextToken(&sv);
+            if (uToken.size() < 2 || uToken.front() != 'u' || !isHex(uToken.substr(1))) return;
+            std::string_view cToken = nextToken(&sv);
+            if (cToken.size() < 2 || cToken.front() != 'c' || !isHex(cToken.substr(1))) return;
+            if (sv.empty()) return;
+            const std::string ptrString = "0x" + std::string(cToken.substr(1)); // number after c
             uint64_t ptr;
             if (!::android::base::ParseUint(ptrString.c_str(), &ptr)) {
                 // Should not reach here, but just be tolerant.
@@ -92,15 +149,23 @@ status_t getBinderPidInfo(BinderDebugContext context, pid_t pid, BinderPidInfo*
 
             return;
         }
-        if (std::regex_search(line, match, kThreadPrefix)) {
+        if (kind == "thread") {
+            // "thread <id>: l <state><looper> ..."
+            if (!isIdToken(nextToken(&sv))) return;
+            if (nextToken(&sv) != "l") return;
+            sv = trimLeft(sv);
+            if (sv.size() < 2 || !isdigit(static_cast<unsigned char>(sv[0])) ||
+                !isdigit(static_cast<unsigned char>(sv[1]))) {
+                return;
+            }
             // "1" is waiting in binder driver
             // "2" is poll. It's impossible to tell if these are in use.
             //     and HIDL default code doesn't use it.
-            bool isInUse = match.str(1) != "1";
+            bool isInUse = sv[0] != '1';
             // "0" is a thread that has called into binder
             // "1" is looper thread
             // "2" is main looper thread
-            bool isBinderThread = match.str(2) != "0";
+            bool isBinderThread = sv[1] != '0';
             if (!isBinderThread) {
                 return;
             }
@@ -336,6 +336,19 @@ static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
     return true;
 }
 
+// Memoized uidUpdatedSince for walks that see each uid once per bucket: the per-uid last-update
+// timestamp can't change the verdict mid-walk, so one lookup per uid suffices instead of one per
+// map key.
+static std::optional<bool> uidUpdatedSinceCached(
+        uint32_t uid, uint64_t lastUpdate, uint64_t *newLastUpdate,
+        std::unordered_map<uint32_t, bool> *cache) {
+    auto it = cache->find(uid);
+    if (it != cache->end()) return it->second;
+    auto updated = uidUpdatedSince(uid, lastUpdate, newLastUpdate);
+    if (updated.has_value()) cache->emplace(uid, *updated);
+    return updated;
+}
+
 // Retrieve the times in ns that each uid spent running at each CPU freq.
 // Return contains no value on error, otherwise it contains a map from uids to vectors of vectors
 // using the format:
@@ -364,10 +377,12 @@ getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
     for (const auto &freqList : gPolicyFreqs) mapFormat.emplace_back(freqList.size(), 0);
 
     uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
+    std::unordered_map<uint32_t, bool> uidUpdatedCache;
     std::vector<tis_val_t> vals(gNCpus);
     do {
         if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
+            auto uidUpdated =
+                    uidUpdatedSinceCached(key.uid, *lastUpdate, &newLastUpdate, &uidUpdatedCache);
             if (!uidUpdated.has_value()) return {};
             if (!*uidUpdated) continue;
         }
@@ -477,10 +492,12 @@ std::optional<std::unordered_map<uint32_t, concurrent_time_t>> getUidsUpdatedCon
     std::vector<uint64_t>::iterator activeBegin, activeEnd, policyBegin, policyEnd;
 
     uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
+    std::unordered_map<uint32_t, bool> uidUpdatedCache;
     do {
         if (key.bucket > (gNCpus - 1) / CPUS_PER_ENTRY) return {};
         if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
+            auto uidUpdated =
+                    uidUpdatedSinceCached(key.uid, *lastUpdate, &newLastUpdate, &uidUpdatedCache);
             if (!uidUpdated.has_value()) return {};
             if (!*uidUpdated) continue;
         }
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LoopbackBinder.h"
+
+namespace android {
+
+LoopbackBinder::LoopbackBinder(const sp<IBinder>& target) : mTarget(target) {}
+
+LoopbackBinder::~LoopbackBinder() {}
+
+const String16& LoopbackBinder::getInterfaceDescriptor() const {
+    return mTarget->getInterfaceDescriptor();
+}
+
+bool LoopbackBinder::isBinderAlive() const {
+    return mTarget->isBinderAlive();
+}
+
+status_t LoopbackBinder::pingBinder() {
+    return mTarget->pingBinder();
+}
+
+status_t LoopbackBinder::dump(int fd, const Vector<String16>& args) {
+    return mTarget->dump(fd, args);
+}
+
+status_t LoopbackBinder::transact(uint32_t code, const Parcel& data, Parcel* reply,
+                                  uint32_t flags) {
+    // BBinder::transact resets the data and reply positions itself, so the
+    // proxy-written parcel is consumed from the start just as it would be
+    // after crossing the driver.
+    return mTarget->transact(code, data, reply, flags);
+}
+
+status_t LoopbackBinder::linkToDeath(const sp<DeathRecipient>& recipient, void* cookie,
+                                     uint32_t flags) {
+    return mTarget->linkToDeath(recipient, cookie, flags);
+}
+
+status_t LoopbackBinder::unlinkToDeath(const wp<DeathRecipient>& recipient, void* cookie,
+                                       uint32_t flags, wp<DeathRecipient>* outRecipient) {
+    return mTarget->unlinkToDeath(recipient, cookie, flags, outRecipient);
+}
+
+void LoopbackBinder::attachObject(const void* objectID, void* object, void* cleanupCookie,
+                                  object_cleanup_func func) {
+    mTarget->attachObject(objectID, object, cleanupCookie, func);
+}
+
+void* LoopbackBinder::findObject(const void* objectID) const {
+    return mTarget->findObject(objectID);
+}
+
+void LoopbackBinder::detachObject(const void* objectID) {
+    mTarget->detachObject(objectID);
+}
+
+} // namespace android
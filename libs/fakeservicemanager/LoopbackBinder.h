@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <binder/IBinder.h>
+
+namespace android {
+
+/**
+ * An IBinder that forwards every transaction directly into a local binder,
+ * while still looking like a remote binder to interface_cast<>. Because
+ * queryLocalInterface() returns nullptr, callers get a real Bp proxy, so
+ * every call pays full Parcel marshalling and unmarshalling in both
+ * directions — but no binder kernel driver is involved. Combined with
+ * ServiceManager this lets a complete AIDL service stack be exercised (and
+ * benchmarked) in a single process, including on the host.
+ */
+class LoopbackBinder : public IBinder {
+public:
+    explicit LoopbackBinder(const sp<IBinder>& target);
+    ~LoopbackBinder() override;
+
+    const String16& getInterfaceDescriptor() const override;
+    bool isBinderAlive() const override;
+    status_t pingBinder() override;
+    status_t dump(int fd, const Vector<String16>& args) override;
+    status_t transact(uint32_t code, const Parcel& data, Parcel* reply,
+                      uint32_t flags = 0) override;
+    status_t linkToDeath(const sp<DeathRecipient>& recipient, void* cookie,
+                         uint32_t flags) override;
+    status_t unlinkToDeath(const wp<DeathRecipient>& recipient, void* cookie, uint32_t flags,
+                           wp<DeathRecipient>* outRecipient) override;
+    void attachObject(const void* objectID, void* object, void* cleanupCookie,
+                      object_cleanup_func func) override;
+    void* findObject(const void* objectID) const override;
+    void detachObject(const void* objectID) override;
+
+private:
+    const sp<IBinder> mTarget;
+};
+
+} // namespace android
@@ -18,15 +18,19 @@
 #include <gmock/gmock.h>
 
 #include <binder/Binder.h>
+#include <binder/Parcel.h>
 #include <binder/ProcessState.h>
 #include <binder/IServiceManager.h>
 
+#include "LoopbackBinder.h"
 #include "ServiceManager.h"
 
 using android::sp;
 using android::BBinder;
 using android::IBinder;
+using android::LoopbackBinder;
 using android::OK;
+using android::Parcel;
 using android::status_t;
 using android::ServiceManager;
 using android::String16;
@@ -124,3 +128,38 @@ TEST(IsDeclared, HappyHappy) {
 
     EXPECT_TRUE(sm->isDeclared(String16("foo")));
 }
+
+TEST(LoopbackBinder, LooksRemote) {
+    sp<IBinder> loopback = new LoopbackBinder(getBinder());
+
+    // interface_cast<> relies on this returning nullptr to build a Bp proxy
+    // instead of short-circuiting to the local implementation.
+    EXPECT_EQ(loopback->queryLocalInterface(String16("foo")), nullptr);
+    EXPECT_EQ(loopback->localBinder(), nullptr);
+}
+
+TEST(LoopbackBinder, TransactsThroughParcels) {
+    class EchoBinder : public BBinder {
+        status_t onTransact(uint32_t code, const Parcel& data, Parcel* reply,
+                            uint32_t flags) override {
+            if (code == FIRST_CALL_TRANSACTION) {
+                int32_t v;
+                EXPECT_EQ(OK, data.readInt32(&v));
+                return reply->writeInt32(v + 1);
+            }
+            return BBinder::onTransact(code, data, reply, flags);
+        }
+    };
+
+    sp<IBinder> loopback = new LoopbackBinder(new EchoBinder());
+    EXPECT_EQ(OK, loopback->pingBinder());
+
+    Parcel data;
+    Parcel reply;
+    EXPECT_EQ(OK, data.writeInt32(41));
+    EXPECT_EQ(OK, loopback->transact(IBinder::FIRST_CALL_TRANSACTION, data, &reply));
+
+    int32_t out = 0;
+    EXPECT_EQ(OK, reply.readInt32(&out));
+    EXPECT_EQ(42, out);
+}
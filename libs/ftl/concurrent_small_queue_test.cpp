@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ftl/concurrent_small_queue.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace android::test {
+
+using ftl::ConcurrentSmallQueue;
+
+// Keep in sync with example usage in header file.
+TEST(ConcurrentSmallQueue, Example) {
+  ftl::ConcurrentSmallQueue<int, 4> queue;
+  EXPECT_EQ(queue.max_size(), 4u);
+  EXPECT_FALSE(queue.try_pop());
+
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_EQ(queue.try_pop(), 1);
+
+  EXPECT_TRUE(queue.try_push(3));
+  EXPECT_TRUE(queue.try_push(4));
+  EXPECT_TRUE(queue.try_push(5));
+  EXPECT_FALSE(queue.try_push(6));  // Full.
+
+  EXPECT_EQ(queue.pop(), 2);
+}
+
+TEST(ConcurrentSmallQueue, Fifo) {
+  ConcurrentSmallQueue<int, 8> queue;
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(queue.try_pop(), i);
+  }
+  EXPECT_FALSE(queue.try_pop());
+}
+
+TEST(ConcurrentSmallQueue, MoveOnlyElements) {
+  ConcurrentSmallQueue<std::unique_ptr<int>, 2> queue;
+
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(42)));
+
+  auto pointer = queue.try_pop();
+  ASSERT_TRUE(pointer);
+  EXPECT_EQ(**pointer, 42);
+
+  // Elements left behind are destroyed with the queue.
+  EXPECT_TRUE(queue.try_push(std::make_unique<int>(123)));
+}
+
+TEST(ConcurrentSmallQueue, MultipleProducers) {
+  constexpr std::size_t kProducers = 4;
+  constexpr int kPushesPerProducer = 10'000;
+
+  ConcurrentSmallQueue<std::pair<std::size_t, int>, 64> queue;
+
+  std::vector<std::thread> producers;
+  for (std::size_t id = 0; id < kProducers; ++id) {
+    producers.emplace_back([&queue, id] {
+      for (int i = 0; i < kPushesPerProducer; ++i) {
+        while (!queue.try_push(id, i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Elements from each producer must be popped in the order they were pushed.
+  int latest[kProducers];
+  std::fill(std::begin(latest), std::end(latest), -1);
+
+  for (int popped = 0; popped < static_cast<int>(kProducers) * kPushesPerProducer; ++popped) {
+    const auto [id, value] = queue.pop();
+    EXPECT_LT(latest[id], value);
+    latest[id] = value;
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  for (const int last : latest) {
+    EXPECT_EQ(last, kPushesPerProducer - 1);
+  }
+  EXPECT_FALSE(queue.try_pop());
+}
+
+TEST(ConcurrentSmallQueue, BlockingPop) {
+  ConcurrentSmallQueue<int, 2> queue;
+
+  std::thread consumer([&queue] {
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+  });
+
+  // The consumer blocks until the elements arrive.
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+
+  consumer.join();
+}
+
+}  // namespace android::test
@@ -50,6 +50,13 @@ TEST(Future, Example) {
 
     EXPECT_EQ(chain.get(), 'b');
   }
+  {
+    std::shared_future<int> shared =
+        ftl::chain(ftl::yield(3)).then([](int x) { return x * 10; }).share();
+
+    EXPECT_EQ(shared.get(), 30);
+    EXPECT_EQ(shared.get(), 30);
+  }
 }
 
 namespace {
@@ -308,6 +308,32 @@ TEST(SmallVector, ReverseAppend) {
   EXPECT_TRUE(strings.dynamic());
 }
 
+TEST(SmallVector, Reserve) {
+  SmallVector<int, 3> vector = {1, 2, 3};
+  EXPECT_FALSE(vector.dynamic());
+
+  // Reserving within the static capacity is a no-op.
+  vector.reserve(3);
+  EXPECT_FALSE(vector.dynamic());
+
+  // Reserving beyond the static capacity promotes the vector.
+  vector.reserve(6);
+  EXPECT_TRUE(vector.dynamic());
+  EXPECT_EQ(vector, (SmallVector{1, 2, 3}));
+
+  // Insertion within the reserved capacity does not reallocate.
+  const auto data = vector.begin();
+  vector.push_back(4);
+  vector.push_back(5);
+  vector.push_back(6);
+  EXPECT_EQ(vector.begin(), data);
+  EXPECT_EQ(vector, (SmallVector{1, 2, 3, 4, 5, 6}));
+
+  // Reserving on a dynamic vector forwards to the underlying storage.
+  vector.reserve(10);
+  EXPECT_EQ(vector, (SmallVector{1, 2, 3, 4, 5, 6}));
+}
+
 TEST(SmallVector, Sort) {
   SmallVector strings = ftl::init::list<std::string>("pie")("quince")("tart")("red")("velvet");
   strings.push_back("cake"s);
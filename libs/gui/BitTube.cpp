@@ -17,6 +17,7 @@
 #include <private/gui/BitTube.h>
 
 #include <stdint.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -173,5 +174,74 @@ ssize_t BitTube::recvObjects(BitTube* tube, void* events, size_t count, size_t o
     return size < 0 ? size : size / static_cast<ssize_t>(objSize);
 }
 
+ssize_t BitTube::queueObjects(BitTube* tube, void const* events, size_t count, size_t objSize) {
+    const size_t size = count * objSize;
+    if (size > kSendBufferSize) {
+        // Too large to buffer. Flush what we have so ordering is preserved and send directly.
+        ssize_t err = tube->flushObjects();
+        if (err < 0) {
+            return err;
+        }
+        return sendObjects(tube, events, count, objSize);
+    }
+
+    // Mixing object sizes in one message would break the receiver's framing check, so a
+    // different size (or a full buffer) flushes the previous batch first.
+    if (tube->mQueuedBytes > 0 &&
+        (tube->mQueuedObjSize != objSize || tube->mQueuedBytes + size > kSendBufferSize)) {
+        ssize_t err = tube->flushObjects();
+        if (err < 0) {
+            return err;
+        }
+    }
+
+    memcpy(tube->mSendBuffer + tube->mQueuedBytes, events, size);
+    tube->mQueuedBytes += size;
+    tube->mQueuedObjSize = objSize;
+    return static_cast<ssize_t>(count);
+}
+
+ssize_t BitTube::flushObjects() {
+    if (mQueuedBytes == 0) {
+        return 0;
+    }
+
+    const size_t objSize = mQueuedObjSize;
+    ssize_t size = write(mSendBuffer, mQueuedBytes);
+
+    // should never happen because of SOCK_SEQPACKET
+    LOG_ALWAYS_FATAL_IF((size >= 0) && (size % static_cast<ssize_t>(objSize)),
+                        "BitTube::flushObjects(queued=%zu, size=%zu), res=%zd (partial events were "
+                        "sent!)",
+                        mQueuedBytes, objSize, size);
+
+    mQueuedBytes = 0;
+    mQueuedObjSize = 0;
+    return size < 0 ? size : size / static_cast<ssize_t>(objSize);
+}
+
+ssize_t BitTube::drainObjects(BitTube* tube, void* events, size_t count, size_t objSize) {
+    char* vaddr = reinterpret_cast<char*>(events);
+    size_t received = 0;
+    while (received < count) {
+        ssize_t size = tube->read(vaddr + received * objSize, (count - received) * objSize);
+        if (size == 0) {
+            // tube drained
+            break;
+        }
+        if (size < 0) {
+            return received > 0 ? static_cast<ssize_t>(received) : size;
+        }
+
+        // should never happen because of SOCK_SEQPACKET
+        LOG_ALWAYS_FATAL_IF(size % static_cast<ssize_t>(objSize),
+                            "BitTube::drainObjects(count=%zu, size=%zu), res=%zd (partial events "
+                            "were received!)",
+                            count, objSize, size);
+        received += size / objSize;
+    }
+    return static_cast<ssize_t>(received);
+}
+
 } // namespace gui
 } // namespace android
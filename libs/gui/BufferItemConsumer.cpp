@@ -85,6 +85,39 @@ status_t BufferItemConsumer::acquireBuffer(BufferItem *item,
     return OK;
 }
 
+status_t BufferItemConsumer::acquireBuffers(std::vector<BufferItem>* outItems,
+        size_t maxBuffers, nsecs_t presentWhen, bool waitForFence) {
+    if (!outItems || maxBuffers == 0) return BAD_VALUE;
+
+    Mutex::Autolock _l(mMutex);
+
+    for (size_t acquired = 0; acquired < maxBuffers; acquired++) {
+        BufferItem item;
+        status_t err = acquireBufferLocked(&item, presentWhen);
+        if (err != OK) {
+            if (err != NO_BUFFER_AVAILABLE) {
+                BI_LOGE("Error acquiring buffer: %s (%d)", strerror(err), err);
+            }
+            // Only surface the error if nothing was acquired; otherwise hand
+            // back the frames that were ready when we drained the queue.
+            return acquired > 0 ? OK : err;
+        }
+
+        if (waitForFence) {
+            err = item.mFence->waitForever("BufferItemConsumer::acquireBuffers");
+            if (err != OK) {
+                BI_LOGE("Failed to wait for fence of acquired buffer: %s (%d)",
+                        strerror(-err), err);
+            }
+        }
+
+        item.mGraphicBuffer = mSlots[item.mSlot].mGraphicBuffer;
+        outItems->push_back(std::move(item));
+    }
+
+    return OK;
+}
+
 status_t BufferItemConsumer::releaseBuffer(const BufferItem &item,
         const sp<Fence>& releaseFence) {
     status_t err;
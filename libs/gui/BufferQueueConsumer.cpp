@@ -179,6 +179,7 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
                 if (!front->mIsStale) {
                     // Front buffer is still in mSlots, so mark the slot as free
                     mSlots[front->mSlot].mBufferState.freeQueued();
+                    mCore->updateSlotStateMaskLocked(front->mSlot);
 
                     // After leaving shared buffer mode, the shared buffer will
                     // still be around. Mark it as no longer shared if this
@@ -281,6 +282,7 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
             } else {
                 mSlots[slot].mBufferState.acquire();
             }
+            mCore->updateSlotStateMaskLocked(slot);
             mSlots[slot].mFence = Fence::NO_FENCE;
         }
 
@@ -342,6 +344,7 @@ status_t BufferQueueConsumer::detachBuffer(int slot) {
     }
 
     mSlots[slot].mBufferState.detachConsumer();
+    mCore->updateSlotStateMaskLocked(slot);
     mCore->mActiveBuffers.erase(slot);
     mCore->mFreeSlots.insert(slot);
     mCore->clearBufferSlotLocked(slot);
@@ -414,6 +417,7 @@ status_t BufferQueueConsumer::attachBuffer(int* outSlot,
 
     mSlots[*outSlot].mGraphicBuffer = buffer;
     mSlots[*outSlot].mBufferState.attachConsumer();
+    mCore->updateSlotStateMaskLocked(*outSlot);
     mSlots[*outSlot].mNeedsReallocation = true;
     mSlots[*outSlot].mFence = Fence::NO_FENCE;
     mSlots[*outSlot].mFrameNumber = 0;
@@ -478,6 +482,7 @@ status_t BufferQueueConsumer::releaseBuffer(int slot, uint64_t frameNumber,
         mSlots[slot].mEglFence = eglFence;
         mSlots[slot].mFence = releaseFence;
         mSlots[slot].mBufferState.release();
+        mCore->updateSlotStateMaskLocked(slot);
 
         // After leaving shared buffer mode, the shared buffer will
         // still be around. Mark it as no longer shared if this
@@ -103,6 +103,8 @@ BufferQueueCore::BufferQueueCore()
         mFreeBuffers(),
         mUnusedSlots(),
         mActiveBuffers(),
+        mDequeuedSlotMask(0),
+        mAcquiredSlotMask(0),
         mDequeueCondition(),
         mDequeueBufferCannotBlock(false),
         mQueueBufferCanDrop(false),
@@ -259,6 +261,7 @@ void BufferQueueCore::clearBufferSlotLocked(int slot) {
 
     mSlots[slot].mGraphicBuffer.clear();
     mSlots[slot].mBufferState.reset();
+    updateSlotStateMaskLocked(slot);
     mSlots[slot].mRequestBufferCalled = false;
     mSlots[slot].mFrameNumber = 0;
     mSlots[slot].mAcquireCalled = false;
@@ -277,6 +280,22 @@ void BufferQueueCore::clearBufferSlotLocked(int slot) {
     }
 }
 
+void BufferQueueCore::updateSlotStateMaskLocked(int slot) {
+    static_assert(BufferQueueDefs::NUM_BUFFER_SLOTS <= 64,
+                  "slot state masks need one bit per slot");
+    const uint64_t bit = 1ULL << slot;
+    if (mSlots[slot].mBufferState.isDequeued()) {
+        mDequeuedSlotMask |= bit;
+    } else {
+        mDequeuedSlotMask &= ~bit;
+    }
+    if (mSlots[slot].mBufferState.isAcquired()) {
+        mAcquiredSlotMask |= bit;
+    } else {
+        mAcquiredSlotMask &= ~bit;
+    }
+}
+
 void BufferQueueCore::freeAllBuffersLocked() {
     for (int s : mFreeSlots) {
         clearBufferSlotLocked(s);
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <thread>
+
 #include <inttypes.h>
 
 #define LOG_TAG "BufferQueueProducer"
@@ -83,7 +86,8 @@ BufferQueueProducer::BufferQueueProducer(const sp<BufferQueueCore>& core,
     mCurrentCallbackTicket(0),
     mCallbackCondition(),
     mDequeueTimeout(-1),
-    mDequeueWaitingForAllocation(false) {}
+    mDequeueWaitingForAllocation(false),
+    mAsyncAllocationInFlight(false) {}
 
 BufferQueueProducer::~BufferQueueProducer() {}
 
@@ -117,6 +121,44 @@ status_t BufferQueueProducer::requestBuffer(int slot, sp<GraphicBuffer>* buf) {
     return NO_ERROR;
 }
 
+status_t BufferQueueProducer::requestBuffers(const std::vector<int32_t>& slots,
+                                             std::vector<RequestBufferOutput>* outputs) {
+    ATRACE_CALL();
+    BQ_LOGV("requestBuffers: %zu slots", slots.size());
+    outputs->clear();
+    outputs->reserve(slots.size());
+    std::lock_guard<std::mutex> lock(mCore->mMutex);
+
+    status_t batchError = NO_ERROR;
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("requestBuffers: BufferQueue has been abandoned");
+        batchError = NO_INIT;
+    } else if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("requestBuffers: BufferQueue has no connected producer");
+        batchError = NO_INIT;
+    }
+
+    for (int32_t slot : slots) {
+        RequestBufferOutput& output = outputs->emplace_back();
+        if (batchError != NO_ERROR) {
+            output.result = batchError;
+        } else if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+            BQ_LOGE("requestBuffers: slot index %d out of range [0, %d)",
+                    slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
+            output.result = BAD_VALUE;
+        } else if (!mSlots[slot].mBufferState.isDequeued()) {
+            BQ_LOGE("requestBuffers: slot %d is not owned by the producer "
+                    "(state = %s)", slot, mSlots[slot].mBufferState.string());
+            output.result = BAD_VALUE;
+        } else {
+            mSlots[slot].mRequestBufferCalled = true;
+            output.buffer = mSlots[slot].mGraphicBuffer;
+            output.result = NO_ERROR;
+        }
+    }
+    return NO_ERROR;
+}
+
 status_t BufferQueueProducer::setMaxDequeuedBufferCount(
         int maxDequeuedBuffers) {
     ATRACE_CALL();
@@ -140,12 +182,7 @@ status_t BufferQueueProducer::setMaxDequeuedBufferCount(
 
         // The new maxDequeuedBuffer count should not be violated by the number
         // of currently dequeued buffers
-        int dequeuedCount = 0;
-        for (int s : mCore->mActiveBuffers) {
-            if (mSlots[s].mBufferState.isDequeued()) {
-                dequeuedCount++;
-            }
-        }
+        int dequeuedCount = __builtin_popcountll(mCore->mDequeuedSlotMask);
         if (dequeuedCount > maxDequeuedBuffers) {
             BQ_LOGE("setMaxDequeuedBufferCount: the requested maxDequeuedBuffer"
                     "count (%d) exceeds the current dequeued buffer count (%d)",
@@ -282,16 +319,9 @@ status_t BufferQueueProducer::waitForFreeSlotThenRelock(FreeSlotCaller caller,
             return NO_INIT;
         }
 
-        int dequeuedCount = 0;
-        int acquiredCount = 0;
-        for (int s : mCore->mActiveBuffers) {
-            if (mSlots[s].mBufferState.isDequeued()) {
-                ++dequeuedCount;
-            }
-            if (mSlots[s].mBufferState.isAcquired()) {
-                ++acquiredCount;
-            }
-        }
+        // One bit per slot; see BufferQueueCore::updateSlotStateMaskLocked.
+        int dequeuedCount = __builtin_popcountll(mCore->mDequeuedSlotMask);
+        int acquiredCount = __builtin_popcountll(mCore->mAcquiredSlotMask);
 
         // Producers are not allowed to dequeue more than
         // mMaxDequeuedBufferCount buffers.
@@ -408,6 +438,7 @@ status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* ou
     EGLDisplay eglDisplay = EGL_NO_DISPLAY;
     EGLSyncKHR eglFence = EGL_NO_SYNC_KHR;
     bool attachedByConsumer = false;
+    bool shouldRefreshFreeBuffers = false;
 
     { // Autolock scope
         std::unique_lock<std::mutex> lock(mCore->mMutex);
@@ -490,6 +521,7 @@ status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* ou
         mSlots[found].mNeedsReallocation = false;
 
         mSlots[found].mBufferState.dequeue();
+        mCore->updateSlotStateMaskLocked(found);
 
         if ((buffer == nullptr) ||
                 buffer->needsReallocation(width, height, format, BQ_LAYER_COUNT, usage))
@@ -581,10 +613,30 @@ status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* ou
                 return NO_INIT;
             }
 
+            // This dequeue only paid for the one buffer it needed. If other
+            // free buffers were also left with the old attributes, refresh
+            // them from a background thread so later dequeues don't each take
+            // the allocation hit.
+            if (mCore->mAllowAllocation && !mCore->mSharedBufferMode) {
+                for (int slot : mCore->mFreeBuffers) {
+                    const sp<GraphicBuffer>& freeBuffer(mSlots[slot].mGraphicBuffer);
+                    if (freeBuffer != nullptr &&
+                        freeBuffer->needsReallocation(width, height, format, BQ_LAYER_COUNT,
+                                                      usage)) {
+                        shouldRefreshFreeBuffers = true;
+                        break;
+                    }
+                }
+            }
+
             VALIDATE_CONSISTENCY();
         } // Autolock scope
     }
 
+    if (shouldRefreshFreeBuffers) {
+        allocateBuffersAsync(width, height, format, usage);
+    }
+
     if (attachedByConsumer) {
         returnFlags |= BUFFER_NEEDS_REALLOCATION;
     }
@@ -661,6 +713,7 @@ status_t BufferQueueProducer::detachBuffer(int slot) {
             listener->onFrameDetached(gb->getId());
         }
         mSlots[slot].mBufferState.detachProducer();
+        mCore->updateSlotStateMaskLocked(slot);
         mCore->mActiveBuffers.erase(slot);
         mCore->mFreeSlots.insert(slot);
         mCore->clearBufferSlotLocked(slot);
@@ -675,6 +728,81 @@ status_t BufferQueueProducer::detachBuffer(int slot) {
     return NO_ERROR;
 }
 
+status_t BufferQueueProducer::detachBuffers(const std::vector<int32_t>& slots,
+                                            std::vector<status_t>* results) {
+    ATRACE_CALL();
+    BQ_LOGV("detachBuffers: %zu slots", slots.size());
+    results->clear();
+    results->reserve(slots.size());
+
+    sp<IConsumerListener> listener;
+    bool detachedAny = false;
+    {
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+
+        status_t batchError = NO_ERROR;
+        if (mCore->mIsAbandoned) {
+            BQ_LOGE("detachBuffers: BufferQueue has been abandoned");
+            batchError = NO_INIT;
+        } else if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+            BQ_LOGE("detachBuffers: BufferQueue has no connected producer");
+            batchError = NO_INIT;
+        }
+
+        listener = mCore->mConsumerListener;
+        for (int32_t slot : slots) {
+            if (batchError != NO_ERROR) {
+                results->emplace_back(batchError);
+                continue;
+            }
+            if (mCore->mSharedBufferMode || mCore->mSharedBufferSlot == slot) {
+                BQ_LOGE("detachBuffers: cannot detach a buffer in shared buffer mode");
+                results->emplace_back(BAD_VALUE);
+                continue;
+            }
+            if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+                BQ_LOGE("detachBuffers: slot index %d out of range [0, %d)",
+                        slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
+                results->emplace_back(BAD_VALUE);
+                continue;
+            } else if (!mSlots[slot].mBufferState.isDequeued()) {
+                BQ_LOGE("detachBuffers: slot %d is not owned by the producer "
+                        "(state = %s)", slot, mSlots[slot].mBufferState.string());
+                results->emplace_back(BAD_VALUE);
+                continue;
+            } else if (!mSlots[slot].mRequestBufferCalled) {
+                BQ_LOGE("detachBuffers: buffer in slot %d has not been requested",
+                        slot);
+                results->emplace_back(BAD_VALUE);
+                continue;
+            }
+
+            auto gb = mSlots[slot].mGraphicBuffer;
+            if (listener != nullptr && gb != nullptr) {
+                listener->onFrameDetached(gb->getId());
+            }
+            mSlots[slot].mBufferState.detachProducer();
+            mCore->updateSlotStateMaskLocked(slot);
+            mCore->mActiveBuffers.erase(slot);
+            mCore->mFreeSlots.insert(slot);
+            mCore->clearBufferSlotLocked(slot);
+            detachedAny = true;
+            results->emplace_back(NO_ERROR);
+        }
+        if (detachedAny) {
+            mCore->mDequeueCondition.notify_all();
+            VALIDATE_CONSISTENCY();
+        }
+    }
+
+    // One release notification for the whole batch instead of one per buffer.
+    if (detachedAny && listener != nullptr) {
+        listener->onBuffersReleased();
+    }
+
+    return NO_ERROR;
+}
+
 status_t BufferQueueProducer::detachNextBuffer(sp<GraphicBuffer>* outBuffer,
         sp<Fence>* outFence) {
     ATRACE_CALL();
@@ -791,6 +919,7 @@ status_t BufferQueueProducer::attachBuffer(int* outSlot,
 
     mSlots[*outSlot].mGraphicBuffer = buffer;
     mSlots[*outSlot].mBufferState.attachProducer();
+    mCore->updateSlotStateMaskLocked(*outSlot);
     mSlots[*outSlot].mEglFence = EGL_NO_SYNC_KHR;
     mSlots[*outSlot].mFence = Fence::NO_FENCE;
     mSlots[*outSlot].mRequestBufferCalled = true;
@@ -802,6 +931,79 @@ status_t BufferQueueProducer::attachBuffer(int* outSlot,
     return returnFlags;
 }
 
+status_t BufferQueueProducer::attachBuffers(const std::vector<sp<GraphicBuffer>>& buffers,
+                                            std::vector<AttachBufferOutput>* outputs) {
+    ATRACE_CALL();
+    BQ_LOGV("attachBuffers: %zu buffers", buffers.size());
+    outputs->clear();
+    outputs->reserve(buffers.size());
+
+    std::unique_lock<std::mutex> lock(mCore->mMutex);
+
+    status_t batchError = NO_ERROR;
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("attachBuffers: BufferQueue has been abandoned");
+        batchError = NO_INIT;
+    } else if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("attachBuffers: BufferQueue has no connected producer");
+        batchError = NO_INIT;
+    } else if (mCore->mSharedBufferMode) {
+        BQ_LOGE("attachBuffers: cannot attach a buffer in shared buffer mode");
+        batchError = BAD_VALUE;
+    }
+
+    mCore->waitWhileAllocatingLocked(lock);
+
+    for (const sp<GraphicBuffer>& buffer : buffers) {
+        AttachBufferOutput& output = outputs->emplace_back();
+        if (batchError != NO_ERROR) {
+            output.result = batchError;
+            continue;
+        }
+        if (buffer == nullptr) {
+            BQ_LOGE("attachBuffers: cannot attach NULL buffer");
+            output.result = BAD_VALUE;
+            continue;
+        }
+        if (buffer->getGenerationNumber() != mCore->mGenerationNumber) {
+            BQ_LOGE("attachBuffers: generation number mismatch [buffer %u] "
+                    "[queue %u]", buffer->getGenerationNumber(),
+                    mCore->mGenerationNumber);
+            output.result = BAD_VALUE;
+            continue;
+        }
+
+        int found;
+        // waitForFreeSlotThenRelock may drop the lock while waiting for a slot, but the
+        // batch keeps it between elements so the fast path locks only once.
+        status_t status = waitForFreeSlotThenRelock(FreeSlotCaller::Attach, lock, &found);
+        if (status != NO_ERROR) {
+            output.result = status;
+            continue;
+        }
+        if (found == BufferQueueCore::INVALID_BUFFER_SLOT) {
+            BQ_LOGE("attachBuffers: no available buffer slots");
+            output.result = -EBUSY;
+            continue;
+        }
+
+        mSlots[found].mGraphicBuffer = buffer;
+        mSlots[found].mBufferState.attachProducer();
+        mCore->updateSlotStateMaskLocked(found);
+        mSlots[found].mEglFence = EGL_NO_SYNC_KHR;
+        mSlots[found].mFence = Fence::NO_FENCE;
+        mSlots[found].mRequestBufferCalled = true;
+        mSlots[found].mAcquireCalled = false;
+        mSlots[found].mNeedsReallocation = false;
+        mCore->mActiveBuffers.insert(found);
+        output.slot = found;
+        output.result = NO_ERROR;
+    }
+    VALIDATE_CONSISTENCY();
+
+    return NO_ERROR;
+}
+
 status_t BufferQueueProducer::queueBuffer(int slot,
         const QueueBufferInput &input, QueueBufferOutput *output) {
     ATRACE_CALL();
@@ -904,6 +1106,7 @@ status_t BufferQueueProducer::queueBuffer(int slot,
 
         mSlots[slot].mFence = acquireFence;
         mSlots[slot].mBufferState.queue();
+        mCore->updateSlotStateMaskLocked(slot);
 
         // Increment the frame counter and store a local version of it
         // for use outside the lock on mCore->mMutex.
@@ -962,6 +1165,7 @@ status_t BufferQueueProducer::queueBuffer(int slot,
 
                 if (!last.mIsStale) {
                     mSlots[last.mSlot].mBufferState.freeQueued();
+                    mCore->updateSlotStateMaskLocked(last.mSlot);
 
                     // After leaving shared buffer mode, the shared buffer will
                     // still be around. Mark it as no longer shared if this
@@ -1109,6 +1313,7 @@ status_t BufferQueueProducer::cancelBuffer(int slot, const sp<Fence>& fence) {
     }
 
     mSlots[slot].mBufferState.cancel();
+    mCore->updateSlotStateMaskLocked(slot);
 
     // After leaving shared buffer mode, the shared buffer will still be around.
     // Mark it as no longer shared if this operation causes it to be free.
@@ -1408,6 +1613,7 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
         PixelFormat allocFormat = PIXEL_FORMAT_UNKNOWN;
         uint64_t allocUsage = 0;
         std::string allocName;
+        int refreshSlot = BufferQueueCore::INVALID_BUFFER_SLOT;
         { // Autolock scope
             std::unique_lock<std::mutex> lock(mCore->mMutex);
             mCore->waitWhileAllocatingLocked(lock);
@@ -1418,13 +1624,6 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
                 return;
             }
 
-            // Only allocate one buffer at a time to reduce risks of overlapping an allocation from
-            // both allocateBuffers and dequeueBuffer.
-            newBufferCount = mCore->mFreeSlots.empty() ? 0 : 1;
-            if (newBufferCount == 0) {
-                return;
-            }
-
             allocWidth = width > 0 ? width : mCore->mDefaultWidth;
             allocHeight = height > 0 ? height : mCore->mDefaultHeight;
             if (useDefaultSize && mCore->mAutoPrerotation &&
@@ -1436,6 +1635,29 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
             allocUsage = usage | mCore->mConsumerUsageBits;
             allocName.assign(mCore->mConsumerName.string(), mCore->mConsumerName.size());
 
+            // Only allocate one buffer at a time to reduce risks of overlapping an allocation from
+            // both allocateBuffers and dequeueBuffer. Prefer filling an empty slot; if all slots
+            // already hold buffers, refresh one free buffer that no longer matches the requested
+            // attributes so preallocation is still useful after a size or format change.
+            if (mCore->mFreeSlots.empty()) {
+                for (int slot : mCore->mFreeBuffers) {
+                    if (slot == mCore->mSharedBufferSlot) {
+                        continue;
+                    }
+                    const sp<GraphicBuffer>& buffer(mSlots[slot].mGraphicBuffer);
+                    if (buffer != nullptr &&
+                        buffer->needsReallocation(allocWidth, allocHeight, allocFormat,
+                                                  BQ_LAYER_COUNT, allocUsage)) {
+                        refreshSlot = slot;
+                        break;
+                    }
+                }
+                if (refreshSlot == BufferQueueCore::INVALID_BUFFER_SLOT) {
+                    return;
+                }
+            }
+            newBufferCount = 1;
+
             mCore->mIsAllocating = true;
         } // Autolock scope
 
@@ -1480,6 +1702,40 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
             }
 
             for (size_t i = 0; i < newBufferCount; ++i) {
+                if (refreshSlot != BufferQueueCore::INVALID_BUFFER_SLOT) {
+                    // dequeueBuffer may have picked up the free buffer we chose
+                    // to refresh while we were allocating. Only swap in the new
+                    // buffer if the slot is still free and still stale.
+                    const sp<GraphicBuffer>& current(mSlots[refreshSlot].mGraphicBuffer);
+                    if (std::find(mCore->mFreeBuffers.begin(), mCore->mFreeBuffers.end(),
+                                  refreshSlot) == mCore->mFreeBuffers.end() ||
+                        current == nullptr ||
+                        !current->needsReallocation(allocWidth, allocHeight, allocFormat,
+                                                    BQ_LAYER_COUNT, allocUsage)) {
+                        BQ_LOGV("allocateBuffers: slot %d changed while allocating. "
+                                "Dropping allocated buffer.", refreshSlot);
+                        continue;
+                    }
+                    if (mSlots[refreshSlot].mEglFence != EGL_NO_SYNC_KHR) {
+                        eglDestroySyncKHR(mSlots[refreshSlot].mEglDisplay,
+                                mSlots[refreshSlot].mEglFence);
+                        mSlots[refreshSlot].mEglFence = EGL_NO_SYNC_KHR;
+                    }
+                    mSlots[refreshSlot].mEglDisplay = EGL_NO_DISPLAY;
+                    mSlots[refreshSlot].mGraphicBuffer = buffers[i];
+                    mSlots[refreshSlot].mFence = Fence::NO_FENCE;
+                    mSlots[refreshSlot].mFrameNumber = 0;
+                    mSlots[refreshSlot].mRequestBufferCalled = false;
+                    mSlots[refreshSlot].mAcquireCalled = false;
+                    // The producer may have cached the old buffer for this
+                    // slot, so make the next dequeue return
+                    // BUFFER_NEEDS_REALLOCATION to force a requestBuffer call.
+                    mSlots[refreshSlot].mNeedsReallocation = true;
+
+                    BQ_LOGV("allocateBuffers: refreshed the buffer in slot %d",
+                            refreshSlot);
+                    continue;
+                }
                 if (mCore->mFreeSlots.empty()) {
                     BQ_LOGV("allocateBuffers: a slot was occupied while "
                             "allocating. Dropping allocated buffer.");
@@ -1515,6 +1771,22 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
     }
 }
 
+void BufferQueueProducer::allocateBuffersAsync(uint32_t width, uint32_t height,
+        PixelFormat format, uint64_t usage) {
+    // Only keep one background allocation pass in flight. If one is already
+    // running it will pick up any remaining stale buffers, and the next
+    // reallocating dequeue will kick a new pass with the latest attributes.
+    if (mAsyncAllocationInFlight.exchange(true)) {
+        return;
+    }
+
+    sp<BufferQueueProducer> self(this);
+    std::thread([self, width, height, format, usage]() {
+        self->allocateBuffers(width, height, format, usage);
+        self->mAsyncAllocationInFlight = false;
+    }).detach();
+}
+
 status_t BufferQueueProducer::allowAllocation(bool allow) {
     ATRACE_CALL();
     BQ_LOGV("allowAllocation: %s", allow ? "true" : "false");
@@ -88,7 +88,8 @@ ssize_t DisplayEventReceiver::getEvents(DisplayEventReceiver::Event* events,
 ssize_t DisplayEventReceiver::getEvents(gui::BitTube* dataChannel,
         Event* events, size_t count)
 {
-    return gui::BitTube::recvObjects(dataChannel, events, count);
+    // Drain across messages so a burst of queued events costs a single call.
+    return gui::BitTube::drainObjects(dataChannel, events, count);
 }
 
 ssize_t DisplayEventReceiver::sendEvents(Event const* events, size_t count) {
@@ -29,7 +29,8 @@ namespace { // Anonymous
 enum class Tag : uint32_t {
     ON_TRANSACTION_COMPLETED = IBinder::FIRST_CALL_TRANSACTION,
     ON_RELEASE_BUFFER,
-    LAST = ON_RELEASE_BUFFER,
+    ON_RELEASE_BUFFERS,
+    LAST = ON_RELEASE_BUFFERS,
 };
 
 } // Anonymous namespace
@@ -109,6 +110,32 @@ status_t JankData::readFromParcel(const Parcel* input) {
     return NO_ERROR;
 }
 
+status_t ReleaseBufferStats::writeToParcel(Parcel* output) const {
+    SAFE_PARCEL(output->writeParcelable, callbackId);
+    if (releaseFence) {
+        SAFE_PARCEL(output->writeBool, true);
+        SAFE_PARCEL(output->write, *releaseFence);
+    } else {
+        SAFE_PARCEL(output->writeBool, false);
+    }
+    SAFE_PARCEL(output->writeUint32, transformHint);
+    SAFE_PARCEL(output->writeUint32, currentMaxAcquiredBufferCount);
+    return NO_ERROR;
+}
+
+status_t ReleaseBufferStats::readFromParcel(const Parcel* input) {
+    SAFE_PARCEL(input->readParcelable, &callbackId);
+    bool hasFence = false;
+    SAFE_PARCEL(input->readBool, &hasFence);
+    if (hasFence) {
+        releaseFence = new Fence();
+        SAFE_PARCEL(input->read, *releaseFence);
+    }
+    SAFE_PARCEL(input->readUint32, &transformHint);
+    SAFE_PARCEL(input->readUint32, &currentMaxAcquiredBufferCount);
+    return NO_ERROR;
+}
+
 status_t SurfaceStats::writeToParcel(Parcel* output) const {
     SAFE_PARCEL(output->writeStrongBinder, surfaceControl);
     SAFE_PARCEL(output->writeInt64, acquireTime);
@@ -261,6 +288,11 @@ public:
                                                                   transformHint,
                                                                   currentMaxAcquiredBufferCount);
     }
+
+    void onReleaseBuffers(std::vector<ReleaseBufferStats> stats) override {
+        callRemoteAsync<decltype(
+                &ITransactionCompletedListener::onReleaseBuffers)>(Tag::ON_RELEASE_BUFFERS, stats);
+    }
 };
 
 // Out-of-line virtual method definitions to trigger vtable emission in this translation unit (see
@@ -281,6 +313,8 @@ status_t BnTransactionCompletedListener::onTransact(uint32_t code, const Parcel&
                                   &ITransactionCompletedListener::onTransactionCompleted);
         case Tag::ON_RELEASE_BUFFER:
             return callLocalAsync(data, reply, &ITransactionCompletedListener::onReleaseBuffer);
+        case Tag::ON_RELEASE_BUFFERS:
+            return callLocalAsync(data, reply, &ITransactionCompletedListener::onReleaseBuffers);
     }
 }
 
@@ -78,6 +78,27 @@ status_t layer_state_t::write(Parcel& output) const
     SAFE_PARCEL(output.writeStrongBinder, surface);
     SAFE_PARCEL(output.writeInt32, layerId);
     SAFE_PARCEL(output.writeUint64, what);
+
+    // Steady-state animation updates only touch scalar fields, so write the compact form and
+    // skip everything that isn't flagged in what. The receiver never looks at an unflagged
+    // field, it just needs the layout on both sides to match.
+    const bool scalarOnly = (what & ~eScalarOnlyChanges) == 0;
+    SAFE_PARCEL(output.writeBool, scalarOnly);
+    if (scalarOnly) {
+        SAFE_PARCEL(output.writeFloat, x);
+        SAFE_PARCEL(output.writeFloat, y);
+        SAFE_PARCEL(output.writeInt32, z);
+        SAFE_PARCEL(output.writeUint32, w);
+        SAFE_PARCEL(output.writeUint32, h);
+        SAFE_PARCEL(output.writeFloat, alpha);
+        SAFE_PARCEL(matrix.write, output);
+        SAFE_PARCEL(output.write, crop);
+        SAFE_PARCEL(output.writeFloat, cornerRadius);
+        SAFE_PARCEL(output.writeUint32, backgroundBlurRadius);
+        SAFE_PARCEL(output.writeFloat, shadowRadius);
+        return NO_ERROR;
+    }
+
     SAFE_PARCEL(output.writeFloat, x);
     SAFE_PARCEL(output.writeFloat, y);
     SAFE_PARCEL(output.writeInt32, z);
@@ -181,6 +202,24 @@ status_t layer_state_t::read(const Parcel& input)
     SAFE_PARCEL(input.readNullableStrongBinder, &surface);
     SAFE_PARCEL(input.readInt32, &layerId);
     SAFE_PARCEL(input.readUint64, &what);
+
+    bool scalarOnly = false;
+    SAFE_PARCEL(input.readBool, &scalarOnly);
+    if (scalarOnly) {
+        SAFE_PARCEL(input.readFloat, &x);
+        SAFE_PARCEL(input.readFloat, &y);
+        SAFE_PARCEL(input.readInt32, &z);
+        SAFE_PARCEL(input.readUint32, &w);
+        SAFE_PARCEL(input.readUint32, &h);
+        SAFE_PARCEL(input.readFloat, &alpha);
+        SAFE_PARCEL(matrix.read, input);
+        SAFE_PARCEL(input.read, crop);
+        SAFE_PARCEL(input.readFloat, &cornerRadius);
+        SAFE_PARCEL(input.readUint32, &backgroundBlurRadius);
+        SAFE_PARCEL(input.readFloat, &shadowRadius);
+        return NO_ERROR;
+    }
+
     SAFE_PARCEL(input.readFloat, &x);
     SAFE_PARCEL(input.readFloat, &y);
     SAFE_PARCEL(input.readInt32, &z);
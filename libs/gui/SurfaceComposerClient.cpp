@@ -380,6 +380,13 @@ void TransactionCompletedListener::onReleaseBuffer(ReleaseCallbackId callbackId,
     callback(callbackId, releaseFence, transformHint, currentMaxAcquiredBufferCount);
 }
 
+void TransactionCompletedListener::onReleaseBuffers(std::vector<ReleaseBufferStats> stats) {
+    for (const auto& releaseStats : stats) {
+        onReleaseBuffer(releaseStats.callbackId, releaseStats.releaseFence,
+                        releaseStats.transformHint, releaseStats.currentMaxAcquiredBufferCount);
+    }
+}
+
 ReleaseBufferCallback TransactionCompletedListener::popReleaseBufferCallbackLocked(
         const ReleaseCallbackId& callbackId) {
     ReleaseBufferCallback callback;
@@ -17,6 +17,8 @@
 #ifndef ANDROID_GUI_BUFFERITEMCONSUMER_H
 #define ANDROID_GUI_BUFFERITEMCONSUMER_H
 
+#include <vector>
+
 #include <gui/ConsumerBase.h>
 #include <gui/BufferQueue.h>
 
@@ -76,6 +78,22 @@ class BufferItemConsumer: public ConsumerBase
     status_t acquireBuffer(BufferItem* item, nsecs_t presentWhen,
             bool waitForFence = true);
 
+    // Gets every graphics buffer that is currently ready from the producer in
+    // a single pass, appending one filled-out BufferItem per frame to
+    // outItems. At most maxBuffers frames are acquired; the limit is also
+    // capped by the construction-time bufferCount parameter less the number of
+    // buffers already acquired. Returns NO_BUFFER_AVAILABLE if the queue of
+    // buffers is empty when the call is made.
+    //
+    // If an error occurs after at least one buffer has been acquired, OK is
+    // returned and the caller receives the frames that were ready; the items
+    // appended to outItems must be released as usual.
+    //
+    // If waitForFence is true, acquireBuffers waits on the fence of each
+    // acquired BufferItem with no timeout before returning.
+    status_t acquireBuffers(std::vector<BufferItem>* outItems, size_t maxBuffers,
+            nsecs_t presentWhen, bool waitForFence = true);
+
     // Returns an acquired buffer to the queue, allowing it to be reused. Since
     // only a fixed number of buffers may be acquired at a time, old buffers
     // must be released by calling releaseBuffer to ensure new buffers can be
@@ -114,6 +114,11 @@ private:
     // given slot.
     void clearBufferSlotLocked(int slot);
 
+    // updateSlotStateMaskLocked re-derives the dequeued/acquired mask bits
+    // for the given slot from its BufferState. Must be called after every
+    // state transition of that slot.
+    void updateSlotStateMaskLocked(int slot);
+
     // freeAllBuffersLocked frees the GraphicBuffer and sync resources for
     // all slots, even if they're currently dequeued, queued, or acquired.
     void freeAllBuffersLocked();
@@ -215,6 +220,13 @@ private:
     // mActiveBuffers contains all slots which have a non-FREE buffer attached.
     std::set<int> mActiveBuffers;
 
+    // Bitmasks (one bit per slot) mirroring which slots hold dequeued or
+    // acquired buffers, maintained by updateSlotStateMaskLocked(). They let
+    // the dequeue hot path count outstanding buffers with a popcount instead
+    // of walking mActiveBuffers and inspecting every BufferState.
+    uint64_t mDequeuedSlotMask;
+    uint64_t mAcquiredSlotMask;
+
     // mDequeueCondition is a condition variable used for dequeueBuffer in
     // synchronous mode.
     mutable std::condition_variable mDequeueCondition;
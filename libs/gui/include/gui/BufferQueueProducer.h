@@ -20,6 +20,8 @@
 #include <gui/BufferQueueDefs.h>
 #include <gui/IGraphicBufferProducer.h>
 
+#include <atomic>
+
 namespace android {
 
 class IBinder;
@@ -45,6 +47,11 @@ public:
     // flags indicating that previously-returned buffers are no longer valid.
     virtual status_t requestBuffer(int slot, sp<GraphicBuffer>* buf);
 
+    // see IGraphicBufferProducer::requestBuffers. Batched version of requestBuffer that
+    // services the whole batch under a single acquisition of the BufferQueueCore mutex.
+    virtual status_t requestBuffers(const std::vector<int32_t>& slots,
+                                    std::vector<RequestBufferOutput>* outputs) override;
+
     // see IGraphicsBufferProducer::setMaxDequeuedBufferCount
     virtual status_t setMaxDequeuedBufferCount(int maxDequeuedBuffers);
 
@@ -94,6 +101,11 @@ public:
     // See IGraphicBufferProducer::detachBuffer
     virtual status_t detachBuffer(int slot);
 
+    // See IGraphicBufferProducer::detachBuffers. Batched version of detachBuffer that takes
+    // the core mutex once and notifies the consumer once for the whole batch.
+    virtual status_t detachBuffers(const std::vector<int32_t>& slots,
+                                   std::vector<status_t>* results) override;
+
     // See IGraphicBufferProducer::detachNextBuffer
     virtual status_t detachNextBuffer(sp<GraphicBuffer>* outBuffer,
             sp<Fence>* outFence);
@@ -101,6 +113,11 @@ public:
     // See IGraphicBufferProducer::attachBuffer
     virtual status_t attachBuffer(int* outSlot, const sp<GraphicBuffer>& buffer);
 
+    // See IGraphicBufferProducer::attachBuffers. Batched version of attachBuffer that takes
+    // the core mutex once for the whole batch.
+    virtual status_t attachBuffers(const std::vector<sp<GraphicBuffer>>& buffers,
+                                   std::vector<AttachBufferOutput>* outputs) override;
+
     // queueBuffer returns a filled buffer to the BufferQueue.
     //
     // Additional data is provided in the QueueBufferInput struct.  Notably,
@@ -229,6 +246,13 @@ private:
     status_t waitForFreeSlotThenRelock(FreeSlotCaller caller, std::unique_lock<std::mutex>& lock,
             int* found) const;
 
+    // Calls allocateBuffers() with the given attributes from a detached
+    // background thread. Used after dequeueBuffer reallocates a buffer to
+    // lazily refresh any remaining free buffers that still have the old
+    // attributes, without stalling the dequeueing thread. At most one
+    // background pass runs at a time.
+    void allocateBuffersAsync(uint32_t width, uint32_t height, PixelFormat format, uint64_t usage);
+
     sp<BufferQueueCore> mCore;
 
     // This references mCore->mSlots. Lock mCore->mMutex while accessing.
@@ -275,6 +299,9 @@ private:
     // allocation to complete.
     std::condition_variable mDequeueWaitingForAllocationCondition;
 
+    // If set to true, a thread started by allocateBuffersAsync() is still running.
+    std::atomic<bool> mAsyncAllocationInFlight;
+
 }; // class BufferQueueProducer
 
 } // namespace android
@@ -83,6 +83,27 @@ struct ReleaseBufferCallbackIdHash {
     }
 };
 
+// Data for a single buffer released by SurfaceFlinger outside of a completed transaction, batched
+// so every buffer freed in the same commit can be delivered in one onReleaseBuffers call.
+class ReleaseBufferStats : public Parcelable {
+public:
+    status_t writeToParcel(Parcel* output) const override;
+    status_t readFromParcel(const Parcel* input) override;
+
+    ReleaseBufferStats() = default;
+    ReleaseBufferStats(const ReleaseCallbackId& id, const sp<Fence>& fence, uint32_t hint,
+                       uint32_t currentMaxAcquiredBuffersCount)
+          : callbackId(id),
+            releaseFence(fence),
+            transformHint(hint),
+            currentMaxAcquiredBufferCount(currentMaxAcquiredBuffersCount) {}
+
+    ReleaseCallbackId callbackId;
+    sp<Fence> releaseFence;
+    uint32_t transformHint = 0;
+    uint32_t currentMaxAcquiredBufferCount = 0;
+};
+
 class FrameEventHistoryStats : public Parcelable {
 public:
     status_t writeToParcel(Parcel* output) const override;
@@ -194,6 +215,8 @@ public:
     virtual void onReleaseBuffer(ReleaseCallbackId callbackId, sp<Fence> releaseFence,
                                  uint32_t transformHint,
                                  uint32_t currentMaxAcquiredBufferCount) = 0;
+
+    virtual void onReleaseBuffers(std::vector<ReleaseBufferStats> stats) = 0;
 };
 
 class BnTransactionCompletedListener : public SafeBnInterface<ITransactionCompletedListener> {
@@ -121,6 +121,13 @@ struct layer_state_t {
         eTrustedOverlayChanged = 0x4000'00000000,
     };
 
+    // Changes whose payload is a handful of scalars. A state that only has these bits set is
+    // serialized in a compact form that skips the fixed-cost fields (regions, input window
+    // info, listener lists, ...) which dominate Parcel time for steady-state animations.
+    static constexpr uint64_t eScalarOnlyChanges = ePositionChanged | eLayerChanged |
+            eSizeChanged | eAlphaChanged | eMatrixChanged | eShadowRadiusChanged | eCropChanged |
+            eCornerRadiusChanged | eBackgroundBlurRadiusChanged;
+
     layer_state_t();
 
     void merge(const layer_state_t& other);
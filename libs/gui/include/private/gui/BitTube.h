@@ -74,6 +74,25 @@ public:
         return recvObjects(tube, events, count, sizeof(T));
     }
 
+    // queue objects into the internal send buffer without issuing a syscall. Queued objects
+    // are sent as a single message by flushObjects(). Queuing a different object size or
+    // overflowing the buffer flushes the previous batch first, so ordering is preserved.
+    template <typename T>
+    static ssize_t queueObjects(BitTube* tube, T const* events, size_t count) {
+        return queueObjects(tube, events, count, sizeof(T));
+    }
+
+    // send everything queued by queueObjects as one message (one syscall). Returns the number
+    // of objects sent, or a negative error.
+    ssize_t flushObjects();
+
+    // receive objects until the tube is drained or count objects have been read. Unlike
+    // recvObjects, this keeps reading across messages, so a burst of events costs one call.
+    template <typename T>
+    static ssize_t drainObjects(BitTube* tube, T* events, size_t count) {
+        return drainObjects(tube, events, count, sizeof(T));
+    }
+
     // implement the Parcelable protocol. Only parcels the receive file descriptor
     status_t writeToParcel(Parcel* reply) const;
     status_t readFromParcel(const Parcel* parcel);
@@ -91,9 +110,20 @@ private:
     mutable base::unique_fd mSendFd;
     mutable base::unique_fd mReceiveFd;
 
+    // small inline buffer for queueObjects; sized so a full batch still fits in the default
+    // (4KB) socket send buffer alongside messages that were already in flight.
+    static constexpr size_t kSendBufferSize = 1024;
+    uint8_t mSendBuffer[kSendBufferSize];
+    size_t mQueuedBytes = 0;
+    size_t mQueuedObjSize = 0;
+
     static ssize_t sendObjects(BitTube* tube, void const* events, size_t count, size_t objSize);
 
     static ssize_t recvObjects(BitTube* tube, void* events, size_t count, size_t objSize);
+
+    static ssize_t queueObjects(BitTube* tube, void const* events, size_t count, size_t objSize);
+
+    static ssize_t drainObjects(BitTube* tube, void* events, size_t count, size_t objSize);
 };
 
 } // namespace gui
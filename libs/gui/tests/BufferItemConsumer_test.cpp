@@ -128,6 +128,35 @@ class BufferItemConsumerTest : public ::testing::Test {
     sp<GraphicBuffer> mBuffers[BufferQueueDefs::NUM_BUFFER_SLOTS];
 };
 
+// Test that all queued buffers are acquired in one acquireBuffers call.
+TEST_F(BufferItemConsumerTest, AcquireBuffers_DrainsQueue) {
+    int slots[kMaxLockedBuffers];
+    // Producer: queue every available buffer.
+    for (int i = 0; i < kMaxLockedBuffers; i++) {
+        DequeueBuffer(&slots[i]);
+    }
+    for (int i = 0; i < kMaxLockedBuffers; i++) {
+        QueueBuffer(slots[i]);
+    }
+
+    // Consumer: a single call returns all of the queued frames, in order.
+    std::vector<BufferItem> items;
+    status_t ret = mBIC->acquireBuffers(&items, kMaxLockedBuffers, 0, false);
+    ASSERT_EQ(NO_ERROR, ret);
+    ASSERT_EQ(static_cast<size_t>(kMaxLockedBuffers), items.size());
+    for (int i = 0; i < kMaxLockedBuffers; i++) {
+        EXPECT_EQ(slots[i], items[i].mSlot);
+    }
+
+    // Nothing is left to acquire.
+    ret = mBIC->acquireBuffers(&items, kMaxLockedBuffers, 0, false);
+    ASSERT_EQ(BufferItemConsumer::NO_BUFFER_AVAILABLE, ret);
+
+    for (const BufferItem& item : items) {
+        ReleaseBuffer(item.mSlot);
+    }
+}
+
 // Test that detaching buffer from consumer side triggers onBufferFreed.
 TEST_F(BufferItemConsumerTest, TriggerBufferFreed_DetachBufferFromConsumer) {
     int slot;
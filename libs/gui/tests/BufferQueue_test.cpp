@@ -521,6 +521,52 @@ TEST_F(BufferQueueTest, TestDisallowingAllocation) {
                                        GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr));
 }
 
+TEST_F(BufferQueueTest, AllocateBuffersRefreshesStaleFreeBuffers) {
+    createBufferQueue();
+    sp<MockConsumer> mc(new MockConsumer);
+    ASSERT_EQ(OK, mConsumer->consumerConnect(mc, true));
+    IGraphicBufferProducer::QueueBufferOutput output;
+    ASSERT_EQ(OK,
+              mProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, true, &output));
+
+    static const uint32_t WIDTH = 320;
+    static const uint32_t HEIGHT = 240;
+
+    // Queue one buffer and leave it acquired by the consumer so its slot stays
+    // occupied, then park a second buffer on the free list
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buffer;
+    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+              mProducer->dequeueBuffer(&slot, &fence, WIDTH, HEIGHT, 0,
+                                       GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr));
+    ASSERT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+    IGraphicBufferProducer::QueueBufferInput input(0, false, HAL_DATASPACE_UNKNOWN,
+            Rect(0, 0, 1, 1), NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+    ASSERT_EQ(OK, mProducer->queueBuffer(slot, input, &output));
+    BufferItem item;
+    ASSERT_EQ(OK, mConsumer->acquireBuffer(&item, 0));
+
+    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+              mProducer->dequeueBuffer(&slot, &fence, WIDTH, HEIGHT, 0,
+                                       GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr));
+    ASSERT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+    ASSERT_EQ(OK, mProducer->cancelBuffer(slot, fence));
+
+    // With no empty slots left, allocateBuffers should replace the free buffer
+    // that no longer matches the requested size
+    mProducer->allocateBuffers(WIDTH * 2, HEIGHT * 2, 0, GRALLOC_USAGE_SW_WRITE_OFTEN);
+
+    // A dequeue at the new size should not need to allocate anything
+    ASSERT_EQ(OK, mProducer->allowAllocation(false));
+    ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+              mProducer->dequeueBuffer(&slot, &fence, WIDTH * 2, HEIGHT * 2, 0,
+                                       GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr));
+    ASSERT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+    ASSERT_EQ(WIDTH * 2, buffer->getWidth());
+    ASSERT_EQ(HEIGHT * 2, buffer->getHeight());
+}
+
 TEST_F(BufferQueueTest, TestGenerationNumbers) {
     createBufferQueue();
     sp<MockConsumer> mc(new MockConsumer);
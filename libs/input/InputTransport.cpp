@@ -158,9 +158,11 @@ size_t InputMessage::size() const {
 /**
  * There could be non-zero bytes in-between InputMessage fields. Force-initialize the entire
  * memory to zero, then only copy the valid bytes on a per-field basis.
+ * Only size() bytes are ever put on the wire, so it is enough to sanitize that prefix;
+ * for motion events this avoids zeroing and copying the unused tail of the pointer array.
  */
 void InputMessage::getSanitizedCopy(InputMessage* msg) const {
-    memset(msg, 0, sizeof(*msg));
+    memset(msg, 0, size());
 
     // Write the header
     msg->header.type = header.type;
@@ -787,7 +789,6 @@ status_t InputConsumer::consume(InputEventFactoryInterface* factory, bool consum
                             const InputMessage& msg = batch.samples[i];
                             sendFinishedSignal(msg.header.seq, false);
                         }
-                        batch.samples.erase(batch.samples.begin(), batch.samples.begin() + count);
                         mBatches.erase(mBatches.begin() + batchIndex);
                     } else {
                         // We cannot append to the batch in progress, so we need to consume
@@ -811,9 +812,8 @@ status_t InputConsumer::consume(InputEventFactoryInterface* factory, bool consum
                 // Start a new batch if needed.
                 if (mMsg.body.motion.action == AMOTION_EVENT_ACTION_MOVE ||
                     mMsg.body.motion.action == AMOTION_EVENT_ACTION_HOVER_MOVE) {
-                    Batch batch;
+                    Batch& batch = mBatches.emplace_back();
                     batch.samples.push_back(mMsg);
-                    mBatches.push_back(batch);
                     if (DEBUG_TRANSPORT_ACTIONS) {
                         ALOGD("channel '%s' consumer ~ started batch event",
                               mChannel->getName().c_str());
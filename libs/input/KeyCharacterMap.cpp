@@ -18,6 +18,10 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#include <map>
+#include <mutex>
 
 #ifdef __linux__
 #include <binder/Parcel.h>
@@ -145,8 +149,35 @@ bool KeyCharacterMap::operator==(const KeyCharacterMap& other) const {
     return true;
 }
 
+// Cache of parsed key character maps, keyed by file name and format. Identical external
+// keyboards share the same .kcm file and hotplug reloads it once per connection, so keep
+// the parsed form and hand out deep copies; callers may mutate their own instance via
+// combine(). Entries are revalidated against the file's modification time so an edited
+// map is picked up on the next load.
+static std::mutex gLoadCacheLock;
+struct LoadCacheEntry {
+    std::shared_ptr<KeyCharacterMap> map;
+    time_t mtime;
+    off_t size;
+};
+static std::map<std::pair<std::string, KeyCharacterMap::Format>, LoadCacheEntry> gLoadCache;
+
 base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::load(const std::string& filename,
                                                                      Format format) {
+    struct stat st;
+    const bool haveFileTime = stat(filename.c_str(), &st) == 0;
+    if (haveFileTime) {
+        std::scoped_lock lock(gLoadCacheLock);
+        auto it = gLoadCache.find(std::make_pair(filename, format));
+        if (it != gLoadCache.end() && it->second.mtime == st.st_mtime &&
+            it->second.size == st.st_size) {
+            std::shared_ptr<KeyCharacterMap> map =
+                    std::make_shared<KeyCharacterMap>(*it->second.map);
+            map->mLoadFileName = filename;
+            return map;
+        }
+    }
+
     Tokenizer* tokenizer;
     status_t status = Tokenizer::open(String8(filename.c_str()), &tokenizer);
     if (status) {
@@ -156,6 +187,12 @@ base::Result<std::shared_ptr<KeyCharacterMap>> KeyCharacterMap::load(const std::
     auto ret = load(t.get(), format);
     if (ret.ok()) {
         (*ret)->mLoadFileName = filename;
+        if (haveFileTime) {
+            std::scoped_lock lock(gLoadCacheLock);
+            gLoadCache[std::make_pair(filename, format)] =
+                    LoadCacheEntry{std::make_shared<KeyCharacterMap>(**ret), st.st_mtime,
+                                   st.st_size};
+        }
     }
     return ret;
 }
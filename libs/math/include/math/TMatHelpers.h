@@ -224,6 +224,62 @@ CONSTEXPR MATRIX PURE fastInverse3(const MATRIX& x) {
     return inverted;
 }
 
+//------------------------------------------------------------------------------
+// 4x4 matrix inverse from the analytic adjugate, built out of the 2x2 minors
+// of the top and bottom two rows. Unlike gaussJordanInverse() this has no
+// pivot search or column swaps, so it compiles down to straight-line
+// multiply-add code on the hot 4x4 path.
+template <typename MATRIX>
+CONSTEXPR MATRIX PURE fastInverse4(const MATRIX& x) {
+    typedef typename MATRIX::value_type T;
+
+    // Our matrices are column-major: x[c][r] is the element at row r, column c.
+
+    // 2x2 minors of the top two rows...
+    const T s0 = x[0][0] * x[1][1] - x[0][1] * x[1][0];
+    const T s1 = x[0][0] * x[2][1] - x[0][1] * x[2][0];
+    const T s2 = x[0][0] * x[3][1] - x[0][1] * x[3][0];
+    const T s3 = x[1][0] * x[2][1] - x[1][1] * x[2][0];
+    const T s4 = x[1][0] * x[3][1] - x[1][1] * x[3][0];
+    const T s5 = x[2][0] * x[3][1] - x[2][1] * x[3][0];
+
+    // ... and of the bottom two rows.
+    const T c5 = x[2][2] * x[3][3] - x[2][3] * x[3][2];
+    const T c4 = x[1][2] * x[3][3] - x[1][3] * x[3][2];
+    const T c3 = x[1][2] * x[2][3] - x[1][3] * x[2][2];
+    const T c2 = x[0][2] * x[3][3] - x[0][3] * x[3][2];
+    const T c1 = x[0][2] * x[2][3] - x[0][3] * x[2][2];
+    const T c0 = x[0][2] * x[1][3] - x[0][3] * x[1][2];
+
+    // The determinant by Laplace expansion on the top two rows.
+    const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    const T invDet = T(1) / det;
+
+    MATRIX inverted(MATRIX::NO_INIT);
+
+    inverted[0][0] = ( x[1][1] * c5 - x[2][1] * c4 + x[3][1] * c3) * invDet;
+    inverted[1][0] = (-x[1][0] * c5 + x[2][0] * c4 - x[3][0] * c3) * invDet;
+    inverted[2][0] = ( x[1][3] * s5 - x[2][3] * s4 + x[3][3] * s3) * invDet;
+    inverted[3][0] = (-x[1][2] * s5 + x[2][2] * s4 - x[3][2] * s3) * invDet;
+
+    inverted[0][1] = (-x[0][1] * c5 + x[2][1] * c2 - x[3][1] * c1) * invDet;
+    inverted[1][1] = ( x[0][0] * c5 - x[2][0] * c2 + x[3][0] * c1) * invDet;
+    inverted[2][1] = (-x[0][3] * s5 + x[2][3] * s2 - x[3][3] * s1) * invDet;
+    inverted[3][1] = ( x[0][2] * s5 - x[2][2] * s2 + x[3][2] * s1) * invDet;
+
+    inverted[0][2] = ( x[0][1] * c4 - x[1][1] * c2 + x[3][1] * c0) * invDet;
+    inverted[1][2] = (-x[0][0] * c4 + x[1][0] * c2 - x[3][0] * c0) * invDet;
+    inverted[2][2] = ( x[0][3] * s4 - x[1][3] * s2 + x[3][3] * s0) * invDet;
+    inverted[3][2] = (-x[0][2] * s4 + x[1][2] * s2 - x[3][2] * s0) * invDet;
+
+    inverted[0][3] = (-x[0][1] * c3 + x[1][1] * c1 - x[2][1] * c0) * invDet;
+    inverted[1][3] = ( x[0][0] * c3 - x[1][0] * c1 + x[2][0] * c0) * invDet;
+    inverted[2][3] = (-x[0][3] * s3 + x[1][3] * s1 - x[2][3] * s0) * invDet;
+    inverted[3][3] = ( x[0][2] * s3 - x[1][2] * s1 + x[2][2] * s0) * invDet;
+
+    return inverted;
+}
+
 /**
  * Inversion function which switches on the matrix size.
  * @warning This function assumes the matrix is invertible. The result is
@@ -235,7 +291,8 @@ inline constexpr MATRIX PURE inverse(const MATRIX& matrix) {
     static_assert(MATRIX::NUM_ROWS == MATRIX::NUM_COLS, "only square matrices can be inverted");
     return (MATRIX::NUM_ROWS == 2) ? fastInverse2<MATRIX>(matrix) :
           ((MATRIX::NUM_ROWS == 3) ? fastInverse3<MATRIX>(matrix) :
-                    gaussJordanInverse<MATRIX>(matrix));
+          ((MATRIX::NUM_ROWS == 4) ? fastInverse4<MATRIX>(matrix) :
+                    gaussJordanInverse<MATRIX>(matrix)));
 }
 
 template<typename MATRIX_R, typename MATRIX_A, typename MATRIX_B>
@@ -26,7 +26,9 @@
 #include <utils/Looper.h>
 #include <utils/Timers.h>
 
+#include <atomic>
 #include <cinttypes>
+#include <limits>
 #include <mutex>
 #include <optional>
 #include <queue>
@@ -146,10 +148,21 @@ private:
 
     void scheduleCallbacks();
 
+    // Sentinel for mNextWakeupTime meaning no looper wakeup is currently armed.
+    static constexpr nsecs_t kNoWakeupScheduled = std::numeric_limits<nsecs_t>::max();
+
     std::mutex mLock;
     // Protected by mLock
     std::priority_queue<FrameCallback> mFrameCallbacks;
     std::vector<RefreshRateCallback> mRefreshRateCallbacks;
+    // Due time of the earliest armed MSG_SCHEDULE_CALLBACKS wakeup. A single
+    // armed wakeup covers every queued callback due at or after it, so posting
+    // additional callbacks does not need to arm additional looper timers.
+    nsecs_t mNextWakeupTime = kNoWakeupScheduled;
+
+    // True while a MSG_SCHEDULE_VSYNC message is in flight from another thread,
+    // so concurrent posters coalesce into a single looper wakeup.
+    std::atomic<bool> mVsyncMessagePending{false};
 
     nsecs_t mLatestVsyncPeriod = -1;
     VsyncEventData mLastVsyncEventData;
@@ -215,15 +228,25 @@ void Choreographer::postFrameCallbackDelayed(
         AChoreographer_frameCallback cb, AChoreographer_frameCallback64 cb64, void* data, nsecs_t delay) {
     nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
     FrameCallback callback{cb, cb64, data, now + delay};
+    bool needsWakeup = false;
     {
         std::lock_guard<std::mutex> _l{mLock};
         mFrameCallbacks.push(callback);
+        if (callback.dueTime > now && callback.dueTime < mNextWakeupTime) {
+            // No armed wakeup covers this callback yet; arm one below. A stale
+            // later wakeup may still fire, but scheduleCallbacks tolerates
+            // spurious wakeups.
+            mNextWakeupTime = callback.dueTime;
+            needsWakeup = true;
+        }
     }
     if (callback.dueTime <= now) {
         if (std::this_thread::get_id() != mThreadId) {
             if (mLooper != nullptr) {
-                Message m{MSG_SCHEDULE_VSYNC};
-                mLooper->sendMessage(this, m);
+                if (!mVsyncMessagePending.exchange(true)) {
+                    Message m{MSG_SCHEDULE_VSYNC};
+                    mLooper->sendMessage(this, m);
+                }
             } else {
                 scheduleVsync();
             }
@@ -232,8 +255,10 @@ void Choreographer::postFrameCallbackDelayed(
         }
     } else {
         if (mLooper != nullptr) {
-            Message m{MSG_SCHEDULE_CALLBACKS};
-            mLooper->sendMessageDelayed(delay, this, m);
+            if (needsWakeup) {
+                Message m{MSG_SCHEDULE_CALLBACKS};
+                mLooper->sendMessageDelayed(delay, this, m);
+            }
         } else {
             scheduleCallbacks();
         }
@@ -317,11 +342,18 @@ void Choreographer::scheduleCallbacks() {
     nsecs_t dueTime;
     {
         std::lock_guard<std::mutex> _l{mLock};
+        // This wakeup is being consumed; the re-arm below records any new one.
+        mNextWakeupTime = kNoWakeupScheduled;
         // If there are no pending callbacks then don't schedule a vsync
         if (mFrameCallbacks.empty()) {
             return;
         }
         dueTime = mFrameCallbacks.top().dueTime;
+        if (dueTime > now && mLooper != nullptr) {
+            // Woken up before the earliest remaining callback is due (e.g. by a
+            // stale wakeup for an already-dispatched callback); re-arm for it.
+            mNextWakeupTime = dueTime;
+        }
     }
 
     if (dueTime <= now) {
@@ -329,6 +361,10 @@ void Choreographer::scheduleCallbacks() {
         scheduleVsync();
         return;
     }
+    if (mLooper != nullptr) {
+        Message m{MSG_SCHEDULE_CALLBACKS};
+        mLooper->sendMessageDelayed(dueTime - now, this, m);
+    }
 }
 
 void Choreographer::handleRefreshRateUpdates() {
@@ -359,6 +395,7 @@ void Choreographer::handleRefreshRateUpdates() {
 void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t,
                                   VsyncEventData vsyncEventData) {
     std::vector<FrameCallback> callbacks{};
+    nsecs_t rearmDelay = -1;
     {
         std::lock_guard<std::mutex> _l{mLock};
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -366,6 +403,18 @@ void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t
             callbacks.push_back(mFrameCallbacks.top());
             mFrameCallbacks.pop();
         }
+        // Callbacks due later may have had their individual wakeups elided in
+        // favor of one that this dispatch just consumed, so make sure a wakeup
+        // is armed for the earliest remaining callback.
+        if (!mFrameCallbacks.empty() && mLooper != nullptr &&
+            mFrameCallbacks.top().dueTime < mNextWakeupTime) {
+            mNextWakeupTime = mFrameCallbacks.top().dueTime;
+            rearmDelay = mNextWakeupTime - now;
+        }
+    }
+    if (rearmDelay >= 0) {
+        Message m{MSG_SCHEDULE_CALLBACKS};
+        mLooper->sendMessageDelayed(rearmDelay, this, m);
     }
     mLastVsyncEventData = vsyncEventData;
     for (const auto& cb : callbacks) {
@@ -402,6 +451,7 @@ void Choreographer::handleMessage(const Message& message) {
         scheduleCallbacks();
         break;
     case MSG_SCHEDULE_VSYNC:
+        mVsyncMessagePending.store(false);
         scheduleVsync();
         break;
     case MSG_HANDLE_REFRESH_RATE_UPDATES:
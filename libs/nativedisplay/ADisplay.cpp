@@ -15,6 +15,7 @@
  */
 
 #include <apex/display.h>
+#include <gui/DisplayEventReceiver.h>
 #include <gui/SurfaceComposerClient.h>
 #include <ui/DisplayMode.h>
 #include <ui/DynamicDisplayInfo.h>
@@ -23,6 +24,8 @@
 #include <ui/StaticDisplayInfo.h>
 
 #include <algorithm>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <type_traits>
 #include <vector>
@@ -129,21 +132,92 @@ sp<IBinder> getToken(ADisplay* display) {
     return SurfaceComposerClient::getPhysicalDisplayToken(impl->id);
 }
 
-} // namespace
+/**
+ * The state queried from SurfaceFlinger when building a display snapshot.
+ * Kept separately from the packed output block so a cached snapshot can be
+ * repacked for each acquire without any binder round trips.
+ */
+struct DisplaySnapshot {
+    std::vector<PhysicalDisplayId> ids;
+    std::optional<PhysicalDisplayId> internalId;
+    ui::Dataspace wcgDataspace;
+    ui::PixelFormat wcgPixelFormat;
+    std::vector<std::vector<DisplayConfigImpl>> modesPerDisplay;
+    int numModes{0};
+};
 
-namespace android {
+/**
+ * Guards the cached snapshot and its invalidation channel. Acquires are rare
+ * (config-change handling, not per-frame), so one lock is fine.
+ */
+std::mutex gSnapshotMutex;
 
-int ADisplay_acquirePhysicalDisplays(ADisplay*** outDisplays) {
-    const std::vector<PhysicalDisplayId> ids = SurfaceComposerClient::getPhysicalDisplayIds();
-    const size_t size = ids.size();
+/**
+ * Event connection used purely for invalidation: vsync stays disabled, so the
+ * only traffic is hotplug (on by default) and mode-change events. Created
+ * lazily on the first acquire; if it cannot be created we simply never cache.
+ */
+std::unique_ptr<DisplayEventReceiver> gSnapshotReceiver;
+std::optional<DisplaySnapshot> gSnapshot;
+
+/**
+ * Drains any pending events from the invalidation channel and drops the
+ * cached snapshot if a display was (dis)connected or changed modes since it
+ * was taken. Must be called with gSnapshotMutex held.
+ */
+void invalidateSnapshotIfChangedLocked() {
+    if (gSnapshotReceiver == nullptr) {
+        auto receiver = std::make_unique<DisplayEventReceiver>(
+                ISurfaceComposer::eVsyncSourceApp, ISurfaceComposer::EventRegistration::modeChanged);
+        if (receiver->initCheck() != NO_ERROR) {
+            return;
+        }
+        gSnapshotReceiver = std::move(receiver);
+        // Events predating the connection can't be observed, so anything
+        // cached before it existed is of unknown freshness.
+        gSnapshot.reset();
+        return;
+    }
+
+    DisplayEventReceiver::Event events[8];
+    ssize_t n;
+    while ((n = gSnapshotReceiver->getEvents(events, std::size(events))) > 0) {
+        for (ssize_t i = 0; i < n; ++i) {
+            switch (events[i].header.type) {
+                case DisplayEventReceiver::DISPLAY_EVENT_HOTPLUG:
+                case DisplayEventReceiver::DISPLAY_EVENT_MODE_CHANGE:
+                    gSnapshot.reset();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    if (n < 0) {
+        // The channel is dead (e.g. SurfaceFlinger restarted); anything we
+        // cached may be stale and we can no longer tell, so start over.
+        gSnapshotReceiver.reset();
+        gSnapshot.reset();
+    }
+}
+
+/**
+ * Queries SurfaceFlinger for the current displays, their supported modes and
+ * composition preference. Returns the number of displays on success or a
+ * negative error code.
+ */
+int querySnapshot(DisplaySnapshot* outSnapshot) {
+    outSnapshot->ids = SurfaceComposerClient::getPhysicalDisplayIds();
+    const size_t size = outSnapshot->ids.size();
     if (size == 0) {
         return NO_INIT;
     }
 
-    std::vector<DisplayConfigImpl> modesPerDisplay[size];
-    int numModes = 0;
+    outSnapshot->modesPerDisplay.resize(size);
+    outSnapshot->numModes = 0;
     for (int i = 0; i < size; ++i) {
-        const sp<IBinder> token = SurfaceComposerClient::getPhysicalDisplayToken(ids[i]);
+        const sp<IBinder> token =
+                SurfaceComposerClient::getPhysicalDisplayToken(outSnapshot->ids[i]);
 
         ui::StaticDisplayInfo staticInfo;
         if (const status_t status = SurfaceComposerClient::getStaticDisplayInfo(token, &staticInfo);
@@ -162,30 +236,51 @@ int ADisplay_acquirePhysicalDisplays(ADisplay*** outDisplays) {
             return NO_INIT;
         }
 
-        numModes += modes.size();
-        modesPerDisplay[i].reserve(modes.size());
+        outSnapshot->numModes += modes.size();
+        outSnapshot->modesPerDisplay[i].clear();
+        outSnapshot->modesPerDisplay[i].reserve(modes.size());
         for (int j = 0; j < modes.size(); ++j) {
             const ui::DisplayMode& mode = modes[j];
-            modesPerDisplay[i].emplace_back(
+            outSnapshot->modesPerDisplay[i].emplace_back(
                     DisplayConfigImpl{static_cast<size_t>(mode.id), mode.resolution.getWidth(),
                                       mode.resolution.getHeight(), staticInfo.density,
                                       mode.refreshRate, mode.sfVsyncOffset, mode.appVsyncOffset});
         }
     }
 
-    const std::optional<PhysicalDisplayId> internalId =
-            SurfaceComposerClient::getInternalDisplayId();
+    outSnapshot->internalId = SurfaceComposerClient::getInternalDisplayId();
     ui::Dataspace defaultDataspace;
     ui::PixelFormat defaultPixelFormat;
-    ui::Dataspace wcgDataspace;
-    ui::PixelFormat wcgPixelFormat;
 
     const status_t status =
             SurfaceComposerClient::getCompositionPreference(&defaultDataspace, &defaultPixelFormat,
-                                                            &wcgDataspace, &wcgPixelFormat);
+                                                            &outSnapshot->wcgDataspace,
+                                                            &outSnapshot->wcgPixelFormat);
     if (status != NO_ERROR) {
         return status;
     }
+    return size;
+}
+
+} // namespace
+
+namespace android {
+
+int ADisplay_acquirePhysicalDisplays(ADisplay*** outDisplays) {
+    std::lock_guard lock(gSnapshotMutex);
+
+    // Re-acquire after no hotplug/mode change is served from the cached
+    // snapshot and never leaves the process.
+    invalidateSnapshotIfChangedLocked();
+    if (!gSnapshot) {
+        DisplaySnapshot snapshot;
+        if (const int ret = querySnapshot(&snapshot); ret < 0) {
+            return ret;
+        }
+        gSnapshot.emplace(std::move(snapshot));
+    }
+    const DisplaySnapshot& snapshot = *gSnapshot;
+    const size_t size = snapshot.ids.size();
 
     // Here we allocate all our required memory in one block. The layout is as
     // follows:
@@ -200,21 +295,22 @@ int ADisplay_acquirePhysicalDisplays(ADisplay*** outDisplays) {
     // contiguous block of DisplayConfigImpls specific to that display.
     DisplayImpl** const impls = reinterpret_cast<DisplayImpl**>(
             malloc((sizeof(DisplayImpl) + sizeof(DisplayImpl*)) * size +
-                   sizeof(DisplayConfigImpl) * numModes));
+                   sizeof(DisplayConfigImpl) * snapshot.numModes));
     DisplayImpl* const displayData = reinterpret_cast<DisplayImpl*>(impls + size);
     DisplayConfigImpl* configData = reinterpret_cast<DisplayConfigImpl*>(displayData + size);
 
     for (size_t i = 0; i < size; ++i) {
-        const PhysicalDisplayId id = ids[i];
-        const ADisplayType type = (internalId == id) ? ADisplayType::DISPLAY_TYPE_INTERNAL
-                                                     : ADisplayType::DISPLAY_TYPE_EXTERNAL;
-        const std::vector<DisplayConfigImpl>& configs = modesPerDisplay[i];
+        const PhysicalDisplayId id = snapshot.ids[i];
+        const ADisplayType type = (snapshot.internalId == id)
+                ? ADisplayType::DISPLAY_TYPE_INTERNAL
+                : ADisplayType::DISPLAY_TYPE_EXTERNAL;
+        const std::vector<DisplayConfigImpl>& configs = snapshot.modesPerDisplay[i];
         memcpy(configData, configs.data(), sizeof(DisplayConfigImpl) * configs.size());
 
         displayData[i] = DisplayImpl{id,
                                      type,
-                                     static_cast<ADataSpace>(wcgDataspace),
-                                     static_cast<AHardwareBuffer_Format>(wcgPixelFormat),
+                                     static_cast<ADataSpace>(snapshot.wcgDataspace),
+                                     static_cast<AHardwareBuffer_Format>(snapshot.wcgPixelFormat),
                                      configs.size(),
                                      configData};
         impls[i] = displayData + i;
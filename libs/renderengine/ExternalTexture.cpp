@@ -27,12 +27,9 @@ ExternalTexture::ExternalTexture(const sp<GraphicBuffer>& buffer, RenderEngine&
       : mBuffer(buffer), mRenderEngine(renderEngine) {
     LOG_ALWAYS_FATAL_IF(buffer == nullptr,
                         "Attempted to bind a null buffer to an external texture!");
-    // GLESRenderEngine has a separate texture cache for output buffers,
-    if (usage == Usage::WRITEABLE &&
-        (mRenderEngine.getRenderEngineType() == RenderEngine::RenderEngineType::GLES ||
-         mRenderEngine.getRenderEngineType() == RenderEngine::RenderEngineType::THREADED)) {
-        return;
-    }
+    // Mapping a writeable buffer also primes the engine's output image cache,
+    // so that the first drawLayers into the buffer does not have to create an
+    // image for it on the hot path.
     mRenderEngine.mapExternalTextureBuffer(mBuffer, usage & Usage::WRITEABLE);
 }
 
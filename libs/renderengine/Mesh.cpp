@@ -16,6 +16,8 @@
 
 #include <renderengine/Mesh.h>
 
+#include <algorithm>
+
 #include <utils/Log.h>
 
 namespace android {
@@ -33,8 +35,7 @@ Mesh::Mesh(Primitive primitive, size_t vertexCount, size_t vertexSize, size_t te
         mPrimitive(primitive),
         mIndexCount(indexCount) {
     if (vertexCount == 0) {
-        mVertices.resize(1);
-        mVertices[0] = 0.0f;
+        mInlineVertices[0] = 0.0f;
         mStride = 0;
         return;
     }
@@ -46,8 +47,7 @@ Mesh::Mesh(Primitive primitive, size_t vertexCount, size_t vertexSize, size_t te
     if ((stride < vertexSize) || (remainder != stride)) {
         ALOGE("Overflow in Mesh(..., %zu, %zu, %zu, %zu, %zu, %zu)", vertexCount, vertexSize,
               texCoordSize, cropCoordsSize, shadowColorSize, shadowParamsSize);
-        mVertices.resize(1);
-        mVertices[0] = 0.0f;
+        mInlineVertices[0] = 0.0f;
         mVertexCount = 0;
         mVertexSize = 0;
         mTexCoordsSize = 0;
@@ -58,9 +58,36 @@ Mesh::Mesh(Primitive primitive, size_t vertexCount, size_t vertexSize, size_t te
         return;
     }
 
-    mVertices.resize(stride * vertexCount);
+    // Common meshes fit into the inline storage, which keeps construction free of heap
+    // allocations; anything bigger falls back to the vectors.
+    const size_t floatCount = stride * vertexCount;
+    if (floatCount <= kInlineVertexFloats) {
+        std::fill_n(mInlineVertices, floatCount, 0.0f);
+    } else {
+        mVertices.resize(floatCount);
+    }
     mStride = stride;
-    mIndices.resize(indexCount);
+    if (indexCount <= kInlineIndices) {
+        std::fill_n(mInlineIndices, indexCount, uint16_t(0));
+    } else {
+        mIndices.resize(indexCount);
+    }
+}
+
+float* Mesh::vertexData() {
+    return mVertices.empty() ? mInlineVertices : mVertices.data();
+}
+
+float const* Mesh::vertexData() const {
+    return mVertices.empty() ? mInlineVertices : mVertices.data();
+}
+
+uint16_t* Mesh::indexData() {
+    return mIndices.empty() ? mInlineIndices : mIndices.data();
+}
+
+uint16_t const* Mesh::indexData() const {
+    return mIndices.empty() ? mInlineIndices : mIndices.data();
 }
 
 Mesh::Primitive Mesh::getPrimitive() const {
@@ -68,46 +95,46 @@ Mesh::Primitive Mesh::getPrimitive() const {
 }
 
 float const* Mesh::getPositions() const {
-    return mVertices.data();
+    return vertexData();
 }
 float* Mesh::getPositions() {
-    return mVertices.data();
+    return vertexData();
 }
 
 float const* Mesh::getTexCoords() const {
-    return mVertices.data() + mVertexSize;
+    return vertexData() + mVertexSize;
 }
 float* Mesh::getTexCoords() {
-    return mVertices.data() + mVertexSize;
+    return vertexData() + mVertexSize;
 }
 
 float const* Mesh::getCropCoords() const {
-    return mVertices.data() + mVertexSize + mTexCoordsSize;
+    return vertexData() + mVertexSize + mTexCoordsSize;
 }
 float* Mesh::getCropCoords() {
-    return mVertices.data() + mVertexSize + mTexCoordsSize;
+    return vertexData() + mVertexSize + mTexCoordsSize;
 }
 
 float const* Mesh::getShadowColor() const {
-    return mVertices.data() + mVertexSize + mTexCoordsSize + mCropCoordsSize;
+    return vertexData() + mVertexSize + mTexCoordsSize + mCropCoordsSize;
 }
 float* Mesh::getShadowColor() {
-    return mVertices.data() + mVertexSize + mTexCoordsSize + mCropCoordsSize;
+    return vertexData() + mVertexSize + mTexCoordsSize + mCropCoordsSize;
 }
 
 float const* Mesh::getShadowParams() const {
-    return mVertices.data() + mVertexSize + mTexCoordsSize + mCropCoordsSize + mShadowColorSize;
+    return vertexData() + mVertexSize + mTexCoordsSize + mCropCoordsSize + mShadowColorSize;
 }
 float* Mesh::getShadowParams() {
-    return mVertices.data() + mVertexSize + mTexCoordsSize + mCropCoordsSize + mShadowColorSize;
+    return vertexData() + mVertexSize + mTexCoordsSize + mCropCoordsSize + mShadowColorSize;
 }
 
 uint16_t const* Mesh::getIndices() const {
-    return mIndices.data();
+    return indexData();
 }
 
 uint16_t* Mesh::getIndices() {
-    return mIndices.data();
+    return indexData();
 }
 
 size_t Mesh::getVertexCount() const {
@@ -69,6 +69,25 @@ std::unique_ptr<RenderEngine> RenderEngine::create(RenderEngineCreationArgs args
 
 RenderEngine::~RenderEngine() = default;
 
+std::future<RenderEngineResult> RenderEngine::drawLayersAsync(
+        const DisplaySettings& display, std::vector<LayerSettings> layers,
+        const std::shared_ptr<ExternalTexture>& buffer, const bool useFramebufferCache,
+        base::unique_fd&& bufferFence) {
+    std::vector<const LayerSettings*> layerPointers;
+    layerPointers.reserve(layers.size());
+    for (const auto& layer : layers) {
+        layerPointers.push_back(&layer);
+    }
+
+    base::unique_fd drawFence;
+    const status_t status = drawLayers(display, layerPointers, buffer, useFramebufferCache,
+                                       std::move(bufferFence), &drawFence);
+
+    std::promise<RenderEngineResult> resultPromise;
+    resultPromise.set_value({status, std::move(drawFence)});
+    return resultPromise.get_future();
+}
+
 void RenderEngine::validateInputBufferUsage(const sp<GraphicBuffer>& buffer) {
     LOG_ALWAYS_FATAL_IF(!(buffer->getUsage() & GraphicBuffer::USAGE_HW_TEXTURE),
                         "input buffer not gpu readable");
@@ -748,9 +748,16 @@ void GLESRenderEngine::bindExternalTextureBuffer(uint32_t texName, const sp<Grap
 }
 
 void GLESRenderEngine::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
-                                                bool /*isRenderable*/) {
+                                                bool isRenderable) {
     ATRACE_CALL();
     mImageManager->cacheAsync(buffer, nullptr);
+    if (isRenderable) {
+        // The buffer may be used as a render target, so also warm the
+        // framebuffer image cache for it. Output buffers are mapped when
+        // their buffer pool is set up, well before they are first drawn to,
+        // so in steady state drawLayers finds the image already created.
+        mImageManager->primeFramebufferAsync(buffer, nullptr);
+    }
 }
 
 std::shared_ptr<ImageManager::Barrier> GLESRenderEngine::cacheExternalTextureBufferForTesting(
@@ -799,6 +806,70 @@ status_t GLESRenderEngine::cacheExternalTextureBufferInternal(const sp<GraphicBu
     return NO_ERROR;
 }
 
+status_t GLESRenderEngine::primeFramebufferImageInternal(const sp<GraphicBuffer>& buffer) {
+    if (buffer == nullptr) {
+        return BAD_VALUE;
+    }
+    ATRACE_CALL();
+
+    const uint64_t bufferId = buffer->getId();
+    const uint32_t generation = buffer->getGenerationNumber();
+    const bool isProtected = buffer->getUsage() & GRALLOC_USAGE_PROTECTED;
+    {
+        std::lock_guard<std::mutex> lock(mFramebufferImageCacheMutex);
+        for (const auto& entry : mFramebufferImageCache) {
+            if (entry.bufferId == bufferId && entry.generation == generation &&
+                entry.isProtected == isProtected) {
+                return NO_ERROR;
+            }
+        }
+        if (mFramebufferImageCache.size() >= mFramebufferImageCacheSize) {
+            // Priming is best-effort: never evict an image that the draw path
+            // put in the cache just to warm one that may not be drawn to soon.
+            return NO_ERROR;
+        }
+    }
+
+    EGLint attributes[] = {
+            isProtected ? EGL_PROTECTED_CONTENT_EXT : EGL_NONE,
+            isProtected ? EGL_TRUE : EGL_NONE,
+            EGL_NONE,
+    };
+    EGLImageKHR image = eglCreateImageKHR(mEGLDisplay, EGL_NO_CONTEXT, EGL_NATIVE_BUFFER_ANDROID,
+                                          buffer->getNativeBuffer(), attributes);
+    if (image == EGL_NO_IMAGE_KHR) {
+        ALOGE("Failed to prime framebuffer image. id=%" PRIx64 " size=%ux%u st=%u usage=%#" PRIx64
+              " fmt=%d",
+              buffer->getId(), buffer->getWidth(), buffer->getHeight(), buffer->getStride(),
+              buffer->getUsage(), buffer->getPixelFormat());
+        return NO_INIT;
+    }
+    DEBUG_EGL_IMAGE_TRACKER_CREATE();
+
+    {
+        std::lock_guard<std::mutex> lock(mFramebufferImageCacheMutex);
+        bool dropImage = mFramebufferImageCache.size() >= mFramebufferImageCacheSize;
+        for (const auto& entry : mFramebufferImageCache) {
+            if (entry.bufferId == bufferId && entry.generation == generation &&
+                entry.isProtected == isProtected) {
+                // The draw path created an image for this buffer while we were
+                // creating ours; keep the one that landed first.
+                dropImage = true;
+                break;
+            }
+        }
+        if (dropImage) {
+            eglDestroyImageKHR(mEGLDisplay, image);
+            DEBUG_EGL_IMAGE_TRACKER_DESTROY();
+            return NO_ERROR;
+        }
+        // Insert at the least-recently-used end, so that a primed image that
+        // never gets drawn to is the first to age out.
+        mFramebufferImageCache.push_front({bufferId, generation, isProtected, image});
+    }
+    return NO_ERROR;
+}
+
 void GLESRenderEngine::unmapExternalTextureBuffer(const sp<GraphicBuffer>& buffer) {
     mImageManager->releaseAsync(buffer->getId(), nullptr);
 }
@@ -811,6 +882,20 @@ std::shared_ptr<ImageManager::Barrier> GLESRenderEngine::unbindExternalTextureBu
 }
 
 void GLESRenderEngine::unbindExternalTextureBufferInternal(uint64_t bufferId) {
+    // If a framebuffer image was primed or created for this buffer, destroy
+    // it now rather than waiting for it to age out of the cache.
+    {
+        std::lock_guard<std::mutex> lock(mFramebufferImageCacheMutex);
+        for (auto it = mFramebufferImageCache.begin(); it != mFramebufferImageCache.end(); ++it) {
+            if (it->bufferId == bufferId) {
+                eglDestroyImageKHR(mEGLDisplay, it->image);
+                DEBUG_EGL_IMAGE_TRACKER_DESTROY();
+                mFramebufferImageCache.erase(it);
+                break;
+            }
+        }
+    }
+
     std::unique_ptr<Image> image;
     {
         std::lock_guard<std::mutex> lock(mRenderingMutex);
@@ -1000,7 +1085,7 @@ void GLESRenderEngine::cleanFramebufferCache() {
     glFramebuffer->allocateBuffers(1, 1, mPlaceholderDrawBuffer);
 
     while (!mFramebufferImageCache.empty()) {
-        EGLImageKHR expired = mFramebufferImageCache.front().second;
+        EGLImageKHR expired = mFramebufferImageCache.front().image;
         mFramebufferImageCache.pop_front();
         eglDestroyImageKHR(mEGLDisplay, expired);
         DEBUG_EGL_IMAGE_TRACKER_DESTROY();
@@ -1044,12 +1129,29 @@ EGLImageKHR GLESRenderEngine::createFramebufferImageIfNeeded(ANativeWindowBuffer
                                                              bool isProtected,
                                                              bool useFramebufferCache) {
     sp<GraphicBuffer> graphicBuffer = GraphicBuffer::from(nativeBuffer);
+    const uint64_t bufferId = graphicBuffer->getId();
+    const uint32_t generation = graphicBuffer->getGenerationNumber();
     if (useFramebufferCache) {
         std::lock_guard<std::mutex> lock(mFramebufferImageCacheMutex);
-        for (const auto& image : mFramebufferImageCache) {
-            if (image.first == graphicBuffer->getId()) {
-                return image.second;
+        for (auto it = mFramebufferImageCache.begin(); it != mFramebufferImageCache.end(); ++it) {
+            if (it->bufferId != bufferId) {
+                continue;
+            }
+            if (it->generation == generation && it->isProtected == isProtected) {
+                // Move the entry to the back, so that eviction kicks out the
+                // least recently used image rather than the oldest one.
+                FramebufferImageCacheEntry entry = *it;
+                mFramebufferImageCache.erase(it);
+                mFramebufferImageCache.push_back(entry);
+                return entry.image;
             }
+            // Same buffer, but it was reallocated or its protected state
+            // changed underneath us. Drop the stale image and create a fresh
+            // one below.
+            eglDestroyImageKHR(mEGLDisplay, it->image);
+            DEBUG_EGL_IMAGE_TRACKER_DESTROY();
+            mFramebufferImageCache.erase(it);
+            break;
         }
     }
     EGLint attributes[] = {
@@ -1062,13 +1164,22 @@ EGLImageKHR GLESRenderEngine::createFramebufferImageIfNeeded(ANativeWindowBuffer
     if (useFramebufferCache) {
         if (image != EGL_NO_IMAGE_KHR) {
             std::lock_guard<std::mutex> lock(mFramebufferImageCacheMutex);
+            // The ImageManager may prime an image while the main thread
+            // creates one for the same buffer; keep whichever landed first.
+            for (const auto& entry : mFramebufferImageCache) {
+                if (entry.bufferId == bufferId && entry.generation == generation &&
+                    entry.isProtected == isProtected) {
+                    eglDestroyImageKHR(mEGLDisplay, image);
+                    return entry.image;
+                }
+            }
             if (mFramebufferImageCache.size() >= mFramebufferImageCacheSize) {
-                EGLImageKHR expired = mFramebufferImageCache.front().second;
+                EGLImageKHR expired = mFramebufferImageCache.front().image;
                 mFramebufferImageCache.pop_front();
                 eglDestroyImageKHR(mEGLDisplay, expired);
                 DEBUG_EGL_IMAGE_TRACKER_DESTROY();
             }
-            mFramebufferImageCache.push_back({graphicBuffer->getId(), image});
+            mFramebufferImageCache.push_back({bufferId, generation, isProtected, image});
         }
     }
 
@@ -1608,8 +1719,8 @@ void GLESRenderEngine::dump(std::string& result) {
         StringAppendF(&result, "RenderEngine framebuffer image cache size: %zu\n",
                       mFramebufferImageCache.size());
         StringAppendF(&result, "Dumping buffer ids...\n");
-        for (const auto& [id, unused] : mFramebufferImageCache) {
-            StringAppendF(&result, "0x%" PRIx64 "\n", id);
+        for (const auto& entry : mFramebufferImageCache) {
+            StringAppendF(&result, "0x%" PRIx64 "\n", entry.bufferId);
         }
     }
 }
@@ -1765,8 +1876,8 @@ std::optional<uint64_t> GLESRenderEngine::getBufferIdForTextureNameForTesting(ui
 bool GLESRenderEngine::isFramebufferImageCachedForTesting(uint64_t bufferId) {
     std::lock_guard<std::mutex> lock(mFramebufferImageCacheMutex);
     return std::any_of(mFramebufferImageCache.cbegin(), mFramebufferImageCache.cend(),
-                       [=](std::pair<uint64_t, EGLImageKHR> image) {
-                           return image.first == bufferId;
+                       [=](const FramebufferImageCacheEntry& entry) {
+                           return entry.bufferId == bufferId;
                        });
 }
 
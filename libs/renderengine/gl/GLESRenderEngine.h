@@ -138,7 +138,10 @@ private:
     bool waitSync(EGLSyncKHR sync, EGLint flags);
     status_t cacheExternalTextureBufferInternal(const sp<GraphicBuffer>& buffer)
             EXCLUDES(mRenderingMutex);
-    void unbindExternalTextureBufferInternal(uint64_t bufferId) EXCLUDES(mRenderingMutex);
+    void unbindExternalTextureBufferInternal(uint64_t bufferId) EXCLUDES(mRenderingMutex)
+            EXCLUDES(mFramebufferImageCacheMutex);
+    status_t primeFramebufferImageInternal(const sp<GraphicBuffer>& buffer)
+            EXCLUDES(mFramebufferImageCacheMutex);
     status_t bindFrameBuffer(Framebuffer* framebuffer);
     void unbindFrameBuffer(Framebuffer* framebuffer);
     void bindExternalTextureImage(uint32_t texName, const Image& image);
@@ -220,12 +223,23 @@ private:
     bool mInProtectedContext = false;
     // If set to true, then enables tracing flush() and finish() to systrace.
     bool mTraceGpuCompletion = false;
-    // Maximum size of mFramebufferImageCache. If more images would be cached, then (approximately)
-    // the last recently used buffer should be kicked out.
+    // Maximum size of mFramebufferImageCache. If more images would be cached, then the least
+    // recently used image is kicked out.
     uint32_t mFramebufferImageCacheSize = 0;
 
-    // Cache of output images, keyed by corresponding GraphicBuffer ID.
-    std::deque<std::pair<uint64_t, EGLImageKHR>> mFramebufferImageCache
+    // Cache of output images, keyed by corresponding GraphicBuffer ID, in LRU order with the
+    // most recently used entry at the back. An entry is only reused if the buffer's generation
+    // number and protected state still match; otherwise the stale image is destroyed and
+    // recreated. Entries for output buffers are primed asynchronously by the ImageManager when
+    // the buffer is first mapped as renderable, and destroyed when the buffer is unmapped, so
+    // in steady state drawLayers never creates framebuffer images.
+    struct FramebufferImageCacheEntry {
+        uint64_t bufferId;
+        uint32_t generation;
+        bool isProtected;
+        EGLImageKHR image;
+    };
+    std::deque<FramebufferImageCacheEntry> mFramebufferImageCache
             GUARDED_BY(mFramebufferImageCacheMutex);
     // The only reason why we have this mutex is so that we don't segfault when
     // dumping info.
@@ -86,6 +86,22 @@ void ImageManager::releaseAsync(uint64_t bufferId, const std::shared_ptr<Barrier
     queueOperation(std::move(entry));
 }
 
+void ImageManager::primeFramebufferAsync(const sp<GraphicBuffer>& buffer,
+                                         const std::shared_ptr<Barrier>& barrier) {
+    if (buffer == nullptr) {
+        {
+            std::lock_guard<std::mutex> lock(barrier->mutex);
+            barrier->isOpen = true;
+            barrier->result = BAD_VALUE;
+        }
+        barrier->condition.notify_one();
+        return;
+    }
+    ATRACE_CALL();
+    QueueEntry entry = {QueueEntry::Operation::PrimeFramebuffer, buffer, buffer->getId(), barrier};
+    queueOperation(std::move(entry));
+}
+
 void ImageManager::queueOperation(const QueueEntry&& entry) {
     {
         std::lock_guard<std::mutex> lock(mMutex);
@@ -129,6 +145,9 @@ void ImageManager::threadMain() {
             case QueueEntry::Operation::Insert:
                 result = mEngine->cacheExternalTextureBufferInternal(entry.buffer);
                 break;
+            case QueueEntry::Operation::PrimeFramebuffer:
+                result = mEngine->primeFramebufferImageInternal(entry.buffer);
+                break;
         }
         if (entry.barrier != nullptr) {
             {
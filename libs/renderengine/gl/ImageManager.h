@@ -47,10 +47,15 @@ public:
             EXCLUDES(mMutex);
     status_t cache(const sp<GraphicBuffer>& buffer);
     void releaseAsync(uint64_t bufferId, const std::shared_ptr<Barrier>& barrier) EXCLUDES(mMutex);
+    // Creates the output framebuffer image for the buffer ahead of time, so
+    // that drawLayers doesn't have to create it when the buffer is first used
+    // as a render target.
+    void primeFramebufferAsync(const sp<GraphicBuffer>& buffer,
+                               const std::shared_ptr<Barrier>& barrier) EXCLUDES(mMutex);
 
 private:
     struct QueueEntry {
-        enum class Operation { Delete, Insert };
+        enum class Operation { Delete, Insert, PrimeFramebuffer };
 
         Operation op = Operation::Delete;
         sp<GraphicBuffer> buffer = nullptr;
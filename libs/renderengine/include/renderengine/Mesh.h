@@ -143,6 +143,19 @@ private:
     float* getShadowParams();
     uint16_t* getIndices();
 
+    float* vertexData();
+    float const* vertexData() const;
+    uint16_t* indexData();
+    uint16_t const* indexData() const;
+
+    // The standard 4-vertex layer quad fits in the inline arrays below even with all
+    // attributes enabled (stride of 13 floats), so constructing it performs no heap
+    // allocation. Larger meshes (fill regions, shadow geometry) spill into the vectors.
+    static constexpr size_t kInlineVertexFloats = 64;
+    static constexpr size_t kInlineIndices = 16;
+    float mInlineVertices[kInlineVertexFloats];
+    uint16_t mInlineIndices[kInlineIndices];
+    // Used only when the mesh does not fit into the inline storage; empty otherwise.
     std::vector<float> mVertices;
     size_t mVertexCount;
     size_t mVertexSize;
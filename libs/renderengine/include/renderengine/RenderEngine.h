@@ -54,6 +54,13 @@
  */
 #define PROPERTY_SKIA_ATRACE_ENABLED "debug.renderengine.skia_atrace_enabled"
 
+/**
+ * Path to the file backing the persistent shader cache in the SkiaGL version of the RE.
+ * The directory must be writable by the RenderEngine process. An empty value (the default)
+ * disables persistence, leaving only Skia's in-memory cache.
+ */
+#define PROPERTY_DEBUG_RENDERENGINE_SHADER_CACHE_PATH "debug.renderengine.shader_cache_path"
+
 struct ANativeWindowBuffer;
 
 namespace android {
@@ -82,6 +89,15 @@ enum class Protection {
     PROTECTED = 2,
 };
 
+// The result of a drawLayersAsync call, delivered through the returned future once the
+// implementation has flushed the frame.
+struct RenderEngineResult {
+    // NO_ERROR when drawing was successful, matching the return value of drawLayers.
+    status_t status;
+    // Fence that fires when the buffer has been drawn to and is ready to be examined.
+    base::unique_fd drawFence;
+};
+
 class RenderEngine {
 public:
     enum class ContextPriority {
@@ -170,6 +186,20 @@ public:
                                 const bool useFramebufferCache, base::unique_fd&& bufferFence,
                                 base::unique_fd* drawFence) = 0;
 
+    // Variant of drawLayers that does not require the caller to wait for the frame. The layer
+    // settings are passed by value so the call records a self-contained snapshot of the frame;
+    // the caller is free to mutate or destroy its own copies as soon as this returns, e.g. to
+    // start assembling the next frame. The same single-caller assumptions as drawLayers apply.
+    //
+    // The base implementation draws synchronously and returns a ready future, so the threaded
+    // engine is the only implementation where the caller genuinely overlaps with rendering.
+    // The caller only needs to wait on the returned future at the point where it consumes the
+    // resulting status and draw fence.
+    virtual std::future<RenderEngineResult> drawLayersAsync(
+            const DisplaySettings& display, std::vector<LayerSettings> layers,
+            const std::shared_ptr<ExternalTexture>& buffer, const bool useFramebufferCache,
+            base::unique_fd&& bufferFence);
+
     // Clean-up method that should be called on the main thread after the
     // drawFence returned by drawLayers fires. This method will free up
     // resources used by the most recently drawn frame. If the frame is still
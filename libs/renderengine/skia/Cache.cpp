@@ -292,6 +292,43 @@ static void drawPIPImageLayer(SkiaRenderEngine* renderengine, const DisplaySetti
                              base::unique_fd(), nullptr);
 }
 
+// HDR sources make needsToneMapping() true and route through a LinearEffect
+// runtime shader keyed on (input dataspace, output dataspace,
+// undoPremultipliedAlpha). Compiling those variants here keeps the first HDR
+// video frame after boot from stalling on SkSL compilation; subsequent boots
+// hit the program binaries persisted by ShaderCache.
+static void drawHDRLayers(SkiaRenderEngine* renderengine, const DisplaySettings& display,
+                          const std::shared_ptr<ExternalTexture>& dstTexture,
+                          const std::shared_ptr<ExternalTexture>& srcTexture) {
+    const Rect& displayRect = display.physicalDisplay;
+    FloatRect rect(0, 0, displayRect.width(), displayRect.height());
+    LayerSettings layer{
+            .geometry =
+                    Geometry{
+                            .boundaries = rect,
+                            .roundedCornersCrop = rect,
+                    },
+            .source = PixelSource{.buffer =
+                                          Buffer{
+                                                  .buffer = srcTexture,
+                                                  .maxLuminanceNits = 1000.f,
+                                                  .usePremultipliedAlpha = 1,
+                                          }},
+            .alpha = 1,
+    };
+
+    auto layers = std::vector<const LayerSettings*>{&layer};
+    for (auto dataspace : {ui::Dataspace::BT2020_ITU_PQ, ui::Dataspace::BT2020_ITU_HLG}) {
+        layer.sourceDataspace = dataspace;
+        // Covers both values of undoPremultipliedAlpha in the LinearEffect key.
+        for (bool isOpaque : {true, false}) {
+            layer.source.buffer.isOpaque = isOpaque;
+            renderengine->drawLayers(display, layers, dstTexture, kUseFrameBufferCache,
+                                     base::unique_fd(), nullptr);
+        }
+    }
+}
+
 static void drawHolePunchLayer(SkiaRenderEngine* renderengine, const DisplaySettings& display,
                             const std::shared_ptr<ExternalTexture>& dstTexture) {
     const Rect& displayRect = display.physicalDisplay;
@@ -421,6 +458,10 @@ void Cache::primeShaderCache(SkiaRenderEngine* renderengine) {
 
         drawPIPImageLayer(renderengine, display, dstTexture, externalTexture);
 
+        // HDR video plays through an external texture, so warm the tone
+        // mapping (LinearEffect) shader variants with one.
+        drawHDRLayers(renderengine, display, dstTexture, externalTexture);
+
         const nsecs_t timeAfter = systemTime();
         const float compileTimeMs = static_cast<float>(timeAfter - timeBefore) / 1.0E6;
         const int shadersCompiled = renderengine->reportShadersCompiled();
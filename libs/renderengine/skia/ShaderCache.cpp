@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShaderCache.h"
+
+#include <FileBlobCache.h>
+#include <log/log.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace android {
+namespace renderengine {
+namespace skia {
+
+namespace {
+
+// Limits sized for the reduced shader variation set RenderEngine compiles: a few dozen
+// programs whose binaries are typically a handful of kilobytes each.
+constexpr size_t kMaxKeySize = 1024;
+constexpr size_t kMaxValueSize = 256 * 1024;
+constexpr size_t kMaxTotalSize = 2 * 1024 * 1024;
+
+// Reserved key for the entry holding the driver identity blob. Skia's cache keys are
+// multi-word shader descriptions, so a single-byte key cannot collide with them.
+constexpr uint8_t kIdentityKey = 'I';
+
+// How long to wait after a store before flushing the cache to disk. Shader compiles arrive
+// in bursts (priming, first use of a new effect), and a single deferred write captures the
+// whole burst.
+constexpr auto kDeferredSaveDelay = std::chrono::seconds(4);
+
+} // namespace
+
+ShaderCache& ShaderCache::get() {
+    static ShaderCache sCache;
+    return sCache;
+}
+
+void ShaderCache::setFilename(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFilename = filename;
+}
+
+void ShaderCache::initShaderDiskCache(const void* identity, ssize_t size) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mFilename.empty() || identity == nullptr || size <= 0) {
+        return;
+    }
+
+    // FileBlobCache mmaps the backing file and unflattens its contents up front, so this is
+    // the only point at which the cache touches the disk for reads.
+    mBlobCache =
+            std::make_unique<FileBlobCache>(kMaxKeySize, kMaxValueSize, kMaxTotalSize, mFilename);
+    validateCacheLocked(identity, static_cast<size_t>(size));
+    mInitialized = true;
+}
+
+void ShaderCache::validateCacheLocked(const void* identity, size_t size) {
+    std::vector<uint8_t> saved(size);
+    const size_t bytes = mBlobCache->get(&kIdentityKey, sizeof(kIdentityKey), saved.data(), size);
+    if (bytes == size && std::memcmp(saved.data(), identity, size) == 0) {
+        return;
+    }
+
+    // Binaries from another driver build would fail to load (or worse), so start over.
+    if (bytes != 0) {
+        ALOGD("Driver identity changed; discarding shader cache contents");
+    }
+    mBlobCache->clear();
+    mBlobCache->set(&kIdentityKey, sizeof(kIdentityKey), identity, size);
+}
+
+sk_sp<SkData> ShaderCache::load(const SkData& key) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mInitialized) {
+        return nullptr;
+    }
+
+    const size_t valueSize = mBlobCache->get(key.data(), key.size(), nullptr, 0);
+    if (valueSize == 0) {
+        return nullptr;
+    }
+
+    sk_sp<SkData> data = SkData::MakeUninitialized(valueSize);
+    if (mBlobCache->get(key.data(), key.size(), data->writable_data(), valueSize) != valueSize) {
+        return nullptr;
+    }
+    return data;
+}
+
+void ShaderCache::store(const SkData& key, const SkData& data, const SkString& /*description*/) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mInitialized) {
+        return;
+    }
+
+    mBlobCache->set(key.data(), key.size(), data.data(), data.size());
+
+    if (!mSavePending) {
+        mSavePending = true;
+        // Flush to disk off the critical path. Stores that land while the write is pending
+        // are picked up by the same flush.
+        std::thread deferredSaveThread([this] {
+            std::this_thread::sleep_for(kDeferredSaveDelay);
+            std::lock_guard<std::mutex> lock(mMutex);
+            mBlobCache->writeToFile();
+            mSavePending = false;
+        });
+        deferredSaveThread.detach();
+    }
+}
+
+} // namespace skia
+} // namespace renderengine
+} // namespace android
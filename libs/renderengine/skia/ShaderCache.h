@@ -0,0 +1,84 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <GrContextOptions.h>
+#include <SkData.h>
+#include <android-base/thread_annotations.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace android {
+
+class FileBlobCache;
+
+namespace renderengine {
+namespace skia {
+
+// ShaderCache gives Skia a persistent on-disk store for the program binaries it compiles, so
+// that the shaders warmed up by Cache::primeShaderCache (or compiled on first use) survive
+// reboots. The backing file is loaded once at initialization, and is rewritten by a detached
+// background thread a few seconds after new shaders arrive, so neither startup nor composition
+// ever waits on disk I/O.
+//
+// A program binary is only loadable by the exact driver build that produced it, so the cache
+// is keyed by a driver identity blob; when the identity changes (e.g. after a driver update)
+// the saved contents are discarded and rebuilt. The cache stays inert until
+// initShaderDiskCache is called, which keeps tests and configurations without a writable
+// cache path on the purely in-memory path Skia already provides.
+class ShaderCache : public GrContextOptions::PersistentCache {
+public:
+    static ShaderCache& get();
+
+    // Sets the file backing the cache. Must be called before initShaderDiskCache; an empty
+    // filename leaves the cache disabled.
+    void setFilename(const std::string& filename);
+
+    // Loads the saved cache contents from disk and enables load/store. The identity blob must
+    // change whenever the GPU driver build does; the GL vendor/renderer/version strings work
+    // well. Does nothing if no filename was configured.
+    void initShaderDiskCache(const void* identity, ssize_t size);
+
+    // GrContextOptions::PersistentCache implementation. Both are no-ops until
+    // initShaderDiskCache has run.
+    sk_sp<SkData> load(const SkData& key) override;
+    void store(const SkData& key, const SkData& data, const SkString& description) override;
+
+private:
+    ShaderCache() = default;
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    // Clears any contents written by a different driver build and records the current
+    // identity in their place.
+    void validateCacheLocked(const void* identity, size_t size) REQUIRES(mMutex);
+
+    std::mutex mMutex;
+    std::string mFilename GUARDED_BY(mMutex);
+    std::unique_ptr<FileBlobCache> mBlobCache GUARDED_BY(mMutex);
+    bool mInitialized GUARDED_BY(mMutex) = false;
+    // Whether a deferred write of the cache contents is already scheduled, so a burst of
+    // compiles only produces a single file rewrite.
+    bool mSavePending GUARDED_BY(mMutex) = false;
+};
+
+} // namespace skia
+} // namespace renderengine
+} // namespace android
@@ -35,6 +35,7 @@
 #include <SkShadowUtils.h>
 #include <SkSurface.h>
 #include <android-base/stringprintf.h>
+#include <cutils/properties.h>
 #include <gl/GrGLInterface.h>
 #include <gui/TraceUtils.h>
 #include <sync/sync.h>
@@ -43,6 +44,7 @@
 #include <ui/GraphicBuffer.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <memory>
@@ -50,6 +52,7 @@
 #include "../gl/GLExtensions.h"
 #include "Cache.h"
 #include "ColorSpaces.h"
+#include "ShaderCache.h"
 #include "SkBlendMode.h"
 #include "SkImageInfo.h"
 #include "filters/BlurFilter.h"
@@ -219,6 +222,19 @@ std::unique_ptr<SkiaGLRenderEngine> SkiaGLRenderEngine::create(
                  "can't create protected placeholder pbuffer");
     }
 
+    // Set up the persistent shader cache before the GrContexts are created, so the first
+    // compile of every shader can be served from disk. Program binaries are only loadable by
+    // the exact driver build that wrote them, so key the cache by the driver's identification
+    // strings.
+    char shaderCachePath[PROPERTY_VALUE_MAX];
+    property_get(PROPERTY_DEBUG_RENDERENGINE_SHADER_CACHE_PATH, shaderCachePath, "");
+    if (shaderCachePath[0] != '\0') {
+        const std::string driverIdentity = std::string(extensions.getVendor()) +
+                extensions.getRenderer() + extensions.getVersion();
+        ShaderCache::get().setFilename(shaderCachePath);
+        ShaderCache::get().initShaderDiskCache(driverIdentity.c_str(), driverIdentity.size());
+    }
+
     // initialize the renderer while GL is current
     std::unique_ptr<SkiaGLRenderEngine> engine =
             std::make_unique<SkiaGLRenderEngine>(args, display, ctxt, placeholder, protectedContext,
@@ -280,14 +296,16 @@ EGLConfig SkiaGLRenderEngine::chooseEglConfig(EGLDisplay display, int format, bo
 }
 
 sk_sp<SkData> SkiaGLRenderEngine::SkSLCacheMonitor::load(const SkData& key) {
-    // This "cache" does not actually cache anything. It just allows us to
-    // monitor Skia's internal cache. So this method always returns null.
-    return nullptr;
+    // Delegate to the on-disk cache, which is a no-op unless a backing file was configured
+    // at engine creation time. A hit here means the driver skips compiling the shader, so
+    // store() below is never called for it and the compile counters stay accurate.
+    return ShaderCache::get().load(key);
 }
 
 void SkiaGLRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData& data,
                                                  const SkString& description) {
     mShadersCachedSinceLastCall++;
+    ShaderCache::get().store(key, data, description);
 }
 
 void SkiaGLRenderEngine::assertShadersCompiled(int numShaders) {
@@ -539,6 +557,21 @@ void SkiaGLRenderEngine::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffe
     mGraphicBufferExternalRefs[buffer->getId()]++;
 
     if (const auto& iter = cache.find(buffer->getId()); iter == cache.end()) {
+        // If this buffer cycled back through a BufferQueue slot then its texture may still be
+        // in the recycle pool, in which case the import can be skipped entirely. Renderable
+        // textures are created differently, so a recycled (possibly sample-only) texture
+        // cannot stand in for one; drop the stale entry in that case instead.
+        for (auto it = mRecycledTextures.begin(); it != mRecycledTextures.end(); ++it) {
+            if (it->first == buffer->getId()) {
+                std::shared_ptr<AutoBackendTexture::LocalRef> recycled = std::move(it->second);
+                mRecycledTextures.erase(it);
+                if (!isRenderable) {
+                    cache.insert({buffer->getId(), std::move(recycled)});
+                    return;
+                }
+                break;
+            }
+        }
         std::shared_ptr<AutoBackendTexture::LocalRef> imageTextureRef =
                 std::make_shared<AutoBackendTexture::LocalRef>(grContext,
                                                                buffer->toAHardwareBuffer(),
@@ -573,6 +606,14 @@ void SkiaGLRenderEngine::unmapExternalTextureBuffer(const sp<GraphicBuffer>& buf
         useProtectedContext(buffer->getUsage() & GRALLOC_USAGE_PROTECTED);
 
         if (iter->second == 0) {
+            // Move the texture into the recycle pool instead of destroying it, in case the
+            // same buffer is imported again shortly. Protected textures are excluded so they
+            // are torn down in the protected context we just switched to.
+            if (const auto& texIter = mTextureCache.find(buffer->getId());
+                texIter != mTextureCache.end() &&
+                (buffer->getUsage() & GRALLOC_USAGE_PROTECTED) == 0) {
+                mRecycledTextures.emplace_back(buffer->getId(), std::move(texIter->second));
+            }
             mTextureCache.erase(buffer->getId());
             mGraphicBufferExternalRefs.erase(buffer->getId());
         }
@@ -587,12 +628,17 @@ void SkiaGLRenderEngine::unmapExternalTextureBuffer(const sp<GraphicBuffer>& buf
 
 bool SkiaGLRenderEngine::canSkipPostRenderCleanup() const {
     std::lock_guard<std::mutex> lock(mRenderingMutex);
-    return mTextureCleanupMgr.isEmpty();
+    return mTextureCleanupMgr.isEmpty() && mRecycledTextures.size() <= kMaxRecycledTextures;
 }
 
 void SkiaGLRenderEngine::cleanupPostRender() {
     ATRACE_CALL();
     std::lock_guard<std::mutex> lock(mRenderingMutex);
+    // Evict the oldest recycled textures here rather than when they are unmapped, so that the
+    // driver-side teardown is batched at the frame boundary instead of stalling mid-frame.
+    while (mRecycledTextures.size() > kMaxRecycledTextures) {
+        mRecycledTextures.pop_front();
+    }
     mTextureCleanupMgr.cleanup();
 }
 
@@ -785,12 +831,71 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
     const bool ctModifiesAlpha =
             displayColorTransform && !displayColorTransform->isAlphaUnchanged();
 
+    // Frames that consist of a single opaque buffer covering the entire output (GPU-composed
+    // video playback, the rotation animation) don't need the general path below: skip the
+    // clear, the blur bookkeeping and the shader graph construction and issue one direct
+    // textured draw instead. Captures take the general path so they keep its annotations.
+    if (layers.size() == 1 && !displayColorTransform && display.clearRegion.isEmpty() &&
+        display.physicalDisplay ==
+                Rect(buffer->getBuffer()->getWidth(), buffer->getBuffer()->getHeight()) &&
+        !mCapture->isCaptureRunning() && canBlitSingleLayer(layers.front(), display)) {
+        const LayerSettings* layer = layers.front();
+        const auto& item = layer->source.buffer;
+        validateInputBufferUsage(item.buffer->getBuffer());
+
+        std::shared_ptr<AutoBackendTexture::LocalRef> imageTextureRef = nullptr;
+        if (const auto& iter = cache.find(item.buffer->getBuffer()->getId());
+            iter != cache.end()) {
+            imageTextureRef = iter->second;
+        } else {
+            imageTextureRef = std::make_shared<
+                    AutoBackendTexture::LocalRef>(grContext,
+                                                  item.buffer->getBuffer()->toAHardwareBuffer(),
+                                                  false, mTextureCleanupMgr);
+        }
+
+        // These formats cannot be sampled as opaque (see the workaround in the general path),
+        // so only blit the formats that can.
+        if (imageTextureRef->colorType() != kRGBA_1010102_SkColorType &&
+            imageTextureRef->colorType() != kRGBA_F16_SkColorType) {
+            ATRACE_NAME("DrawLayerBlit");
+            if (item.fence != nullptr) {
+                waitFence(item.fence->get());
+            }
+
+            const ui::Dataspace layerDataspace =
+                    mUseColorManagement ? layer->sourceDataspace : dstDataspace;
+            sk_sp<SkImage> image =
+                    imageTextureRef->makeImage(layerDataspace, kOpaque_SkAlphaType, grContext);
+
+            SkAutoCanvasRestore acr(dstCanvas, true);
+            initCanvas(dstCanvas, display);
+            dstCanvas->concat(getSkM44(layer->geometry.positionTransform).asM33());
+
+            SkPaint paint;
+            paint.setBlendMode(SkBlendMode::kSrc);
+            const SkSamplingOptions sampling = item.useTextureFiltering
+                    ? SkSamplingOptions({SkFilterMode::kLinear, SkMipmapMode::kNone})
+                    : SkSamplingOptions();
+            dstCanvas->drawImageRect(image, getSkRect(layer->geometry.boundaries), sampling,
+                                     &paint);
+
+            // this frame has no blur layer, so drop any cached blur state (see the general
+            // path below)
+            mBlurCache = {};
+
+            mCapture->endCapture();
+            return flushAndSubmit(grContext, dstSurface, drawFence);
+        }
+    }
+
     // Find if any layers have requested blur, we'll use that info to decide when to render to an
     // offscreen buffer and when to render to the native buffer.
     sk_sp<SkSurface> activeSurface(dstSurface);
     SkCanvas* canvas = dstCanvas;
     SkiaCapture::OffscreenState offscreenCaptureState;
     const LayerSettings* blurCompositionLayer = nullptr;
+    bool frameHasBlur = false;
     if (mBlurFilter) {
         bool requiresCompositionLayer = false;
         for (const auto& layer : layers) {
@@ -798,6 +903,7 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
             if (!layerHasBlur(layer, ctModifiesAlpha)) {
                 continue;
             }
+            frameHasBlur = true;
             if (layer->backgroundBlurRadius > 0 &&
                 layer->backgroundBlurRadius < BlurFilter::kMaxCrossFadeRadius) {
                 requiresCompositionLayer = true;
@@ -843,6 +949,11 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
         canvas->drawRegion(clearRegion, paint);
     }
 
+    // Copies of the layers drawn beneath the first blur layer, for validating mBlurCache on
+    // the next frame. Only maintained while this frame contains a blur layer.
+    std::vector<LayerSettings> layersBelowBlur;
+    bool sawBlurLayer = false;
+
     for (const auto& layer : layers) {
         ATRACE_FORMAT("DrawLayer: %s", layer->name.c_str());
 
@@ -857,6 +968,12 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
             }
         }
 
+        // Record every layer beneath the first blur layer so that the next frame can tell
+        // whether the content under the blur is unchanged. frameHasBlur implies mBlurFilter.
+        if (frameHasBlur && !sawBlurLayer && !layerHasBlur(layer, ctModifiesAlpha)) {
+            layersBelowBlur.push_back(*layer);
+        }
+
         sk_sp<SkImage> blurInput;
         if (blurCompositionLayer == layer) {
             LOG_ALWAYS_FATAL_IF(activeSurface == dstSurface);
@@ -910,6 +1027,8 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
                                  layer->geometry.roundedCornersRadius);
         if (mBlurFilter && layerHasBlur(layer, ctModifiesAlpha)) {
             std::unordered_map<uint32_t, sk_sp<SkImage>> cachedBlurs;
+            const bool isFirstBlurLayer = !sawBlurLayer;
+            sawBlurLayer = true;
 
             // if multiple layers have blur, then we need to take a snapshot now because
             // only the lowest layer will have blurImage populated earlier
@@ -919,6 +1038,17 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
             // rect to be blurred in the coordinate space of blurInput
             const auto blurRect = canvas->getTotalMatrix().mapRect(bounds.rect());
 
+            // The blurred images from the previous blur frame can be reused if everything
+            // that was rendered beneath the blur is unchanged. Only the first blur layer is
+            // cached; higher ones would need the layers in between (including this one)
+            // validated as well, and the first is where the expensive static-background case
+            // (e.g. the notification shade) lands.
+            const bool canReuseCachedBlur = isFirstBlurLayer && mBlurCache.context == grContext &&
+                    mBlurCache.blurRect == blurRect && mBlurCache.display == display &&
+                    mBlurCache.layersBelow.size() == layersBelowBlur.size() &&
+                    std::equal(mBlurCache.layersBelow.begin(), mBlurCache.layersBelow.end(),
+                               layersBelowBlur.begin());
+
             // if the clip needs to be applied then apply it now and make sure
             // it is restored before we attempt to draw any shadows.
             SkAutoCanvasRestore acr(canvas, true);
@@ -930,9 +1060,18 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
             if (blurRect.width() > 0 && blurRect.height() > 0) {
                 if (layer->backgroundBlurRadius > 0) {
                     ATRACE_NAME("BackgroundBlur");
-                    auto blurredImage =
-                            mBlurFilter->generate(grContext, layer->backgroundBlurRadius, blurInput,
-                                                  blurRect);
+                    sk_sp<SkImage> blurredImage;
+                    if (canReuseCachedBlur) {
+                        const auto it = mBlurCache.images.find(layer->backgroundBlurRadius);
+                        if (it != mBlurCache.images.end()) {
+                            blurredImage = it->second;
+                        }
+                    }
+                    if (!blurredImage) {
+                        blurredImage = mBlurFilter->generate(grContext,
+                                                             layer->backgroundBlurRadius, blurInput,
+                                                             blurRect);
+                    }
 
                     cachedBlurs[layer->backgroundBlurRadius] = blurredImage;
 
@@ -942,6 +1081,12 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
 
                 canvas->concat(getSkM44(layer->blurRegionTransform).asM33());
                 for (auto region : layer->blurRegions) {
+                    if (cachedBlurs[region.blurRadius] == nullptr && canReuseCachedBlur) {
+                        const auto it = mBlurCache.images.find(region.blurRadius);
+                        if (it != mBlurCache.images.end()) {
+                            cachedBlurs[region.blurRadius] = it->second;
+                        }
+                    }
                     if (cachedBlurs[region.blurRadius] == nullptr) {
                         ATRACE_NAME("BlurRegion");
                         cachedBlurs[region.blurRadius] =
@@ -954,6 +1099,14 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
                                                 cachedBlurs[region.blurRadius], blurInput);
                 }
             }
+
+            if (isFirstBlurLayer) {
+                mBlurCache.context = grContext;
+                mBlurCache.display = display;
+                mBlurCache.layersBelow = std::move(layersBelowBlur);
+                mBlurCache.blurRect = blurRect;
+                mBlurCache.images = std::move(cachedBlurs);
+            }
         }
 
         if (layer->shadow.length > 0) {
@@ -1123,12 +1276,23 @@ status_t SkiaGLRenderEngine::drawLayers(const DisplaySettings& display,
             activeSurface->flush();
         }
     }
+    // Once a frame renders without blur (e.g. the shade closed), drop the cached blur state so
+    // that it does not pin the GPU images or the layer buffers referenced by the cached copies.
+    if (!sawBlurLayer && mBlurCache.context != nullptr) {
+        mBlurCache = {};
+    }
+
     surfaceAutoSaveRestore.restore();
     mCapture->endCapture();
+    LOG_ALWAYS_FATAL_IF(activeSurface != dstSurface);
+    return flushAndSubmit(grContext, dstSurface, drawFence);
+}
+
+status_t SkiaGLRenderEngine::flushAndSubmit(GrDirectContext* grContext, sk_sp<SkSurface> dstSurface,
+                                            base::unique_fd* drawFence) {
     {
         ATRACE_NAME("flush surface");
-        LOG_ALWAYS_FATAL_IF(activeSurface != dstSurface);
-        activeSurface->flush();
+        dstSurface->flush();
     }
 
     if (drawFence != nullptr) {
@@ -1260,6 +1424,43 @@ inline bool SkiaGLRenderEngine::layerHasBlur(const LayerSettings* layer,
     return false;
 }
 
+// Returns true if the layer is a plain opaque buffer that covers the entire clip with no
+// effects, so that drawLayers can blit it directly instead of building the general per-layer
+// shader graph. The caller is responsible for the display-wide conditions (single layer, no
+// display color transform, no clear region, clip covering the output buffer).
+inline bool SkiaGLRenderEngine::canBlitSingleLayer(const LayerSettings* layer,
+                                                   const DisplaySettings& display) {
+    const auto& item = layer->source.buffer;
+    if (!item.buffer || !item.isOpaque || layer->skipContentDraw) {
+        return false;
+    }
+    // the blit samples the buffer untransformed and draws it without blending
+    if (layer->alpha != 1.0f || layer->colorTransform != mat4() ||
+        item.textureTransform != mat4()) {
+        return false;
+    }
+    // anything requiring extra draw passes or a runtime effect takes the general path
+    if (layer->backgroundBlurRadius > 0 || !layer->blurRegions.empty() ||
+        layer->shadow.length > 0 || layer->geometry.roundedCornersRadius > 0 ||
+        layer->stretchEffect.hasEffect()) {
+        return false;
+    }
+    if ((mUseColorManagement &&
+         needsToneMapping(layer->sourceDataspace, display.outputDataspace)) ||
+        (display.sdrWhitePointNits > 0.f && display.sdrWhitePointNits != display.maxLuminance)) {
+        return false;
+    }
+    // The blit replaces every destination pixel without a preceding clear, so the transformed
+    // bounds must cover the clip. mapRect only reflects coverage when rects map to rects, which
+    // restricts the fast path to 90 degree multiples, mirroring and translation.
+    const SkMatrix transform = getSkM44(layer->geometry.positionTransform).asM33();
+    if (!transform.rectStaysRect()) {
+        return false;
+    }
+    return transform.mapRect(getSkRect(layer->geometry.boundaries))
+            .contains(getSkRect(display.clip));
+}
+
 inline SkColor SkiaGLRenderEngine::getSkColor(const vec4& color) {
     return SkColorSetARGB(color.a * 255, color.r * 255, color.g * 255, color.b * 255);
 }
@@ -1493,6 +1694,8 @@ void SkiaGLRenderEngine::dump(std::string& result) {
         for (const auto& [id, unused] : mTextureCache) {
             StringAppendF(&result, "- 0x%" PRIx64 "\n", id);
         }
+        StringAppendF(&result, "RenderEngine recycled texture pool size: %zu\n",
+                      mRecycledTextures.size());
         StringAppendF(&result, "\n");
 
         SkiaMemoryReporter gpuProtectedReporter(gpuResourceMap, true);
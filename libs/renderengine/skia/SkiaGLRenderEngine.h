@@ -21,12 +21,14 @@
 #include <EGL/eglext.h>
 #include <GLES2/gl2.h>
 #include <GrDirectContext.h>
+#include <SkImage.h>
 #include <SkSurface.h>
 #include <android-base/thread_annotations.h>
 #include <renderengine/ExternalTexture.h>
 #include <renderengine/RenderEngine.h>
 #include <sys/types.h>
 
+#include <deque>
 #include <mutex>
 #include <unordered_map>
 
@@ -94,12 +96,16 @@ private:
     inline std::pair<SkRRect, SkRRect> getBoundsAndClip(const FloatRect& bounds,
                                                         const FloatRect& crop, float cornerRadius);
     inline bool layerHasBlur(const LayerSettings* layer, bool colorTransformModifiesAlpha);
+    inline bool canBlitSingleLayer(const LayerSettings* layer, const DisplaySettings& display);
     inline SkColor getSkColor(const vec4& color);
     inline SkM44 getSkM44(const mat4& matrix);
     inline SkPoint3 getSkPoint3(const vec3& vector);
     inline GrDirectContext* getActiveGrContext() const;
 
     base::unique_fd flush();
+    // Flushes the surface, creates the draw fence and submits the frame to the GPU.
+    status_t flushAndSubmit(GrDirectContext* grContext, sk_sp<SkSurface> dstSurface,
+                            base::unique_fd* drawFence);
     // waitFence attempts to wait in the GPU, and if unable to waits on the CPU instead.
     void waitFence(base::borrowed_fd fenceFd);
     bool waitGpuFence(base::borrowed_fd fenceFd);
@@ -122,6 +128,24 @@ private:
     EGLSurface mProtectedPlaceholderSurface;
     BlurFilter* mBlurFilter = nullptr;
 
+    // The downsampled blur images generated for the first (lowest) blur layer of the most
+    // recent frame that drew one, together with everything that determined their content. The
+    // canvas is cleared and fully redrawn on every frame, so while the display settings and
+    // the layers beneath the blur layer compare equal, the snapshot under the blur is
+    // unchanged and the Kawase passes can be skipped in favor of the cached images. Content
+    // updates invalidate the cache naturally, because latching a new buffer changes the
+    // ExternalTexture that the layer settings reference (the same assumption that
+    // ClientCompositionRequestCache relies on).
+    struct BlurCache {
+        GrDirectContext* context = nullptr;
+        DisplaySettings display;
+        std::vector<LayerSettings> layersBelow;
+        SkRect blurRect = SkRect::MakeEmpty();
+        // Blurred images from the last blur frame, keyed by blur radius.
+        std::unordered_map<uint32_t, sk_sp<SkImage>> images;
+    };
+    BlurCache mBlurCache GUARDED_BY(mRenderingMutex);
+
     const PixelFormat mDefaultPixelFormat;
     const bool mUseColorManagement;
 
@@ -138,6 +162,17 @@ private:
     std::unordered_map<LinearEffect, sk_sp<SkRuntimeEffect>, LinearEffectHasher> mRuntimeEffects;
     AutoBackendTexture::CleanupManager mTextureCleanupMgr GUARDED_BY(mRenderingMutex);
 
+    // Textures for GraphicBuffers that were recently unmapped, kept alive in case the same
+    // buffer is imported again. BufferQueue producers such as camera preview cycle a fixed set
+    // of buffers through their slots, so a buffer that just left mTextureCache is likely to
+    // come right back; recycling its texture avoids re-running the EGLImage import. A texture
+    // is tied to the memory of the buffer it was created from, so entries can only be reused
+    // for the identical buffer ID. Oldest entries past kMaxRecycledTextures are destroyed in
+    // cleanupPostRender, batching the driver work at frame boundaries.
+    static constexpr size_t kMaxRecycledTextures = 16;
+    std::deque<std::pair<GraphicBufferId, std::shared_ptr<AutoBackendTexture::LocalRef>>>
+            mRecycledTextures GUARDED_BY(mRenderingMutex);
+
     StretchShaderFactory mStretchShaderFactory;
     // Mutex guarding rendering operations, so that:
     // 1. GL operations aren't interleaved, and
@@ -156,8 +191,8 @@ private:
     // Object to capture commands send to Skia.
     std::unique_ptr<SkiaCapture> mCapture;
 
-    // Implements PersistentCache as a way to monitor what SkSL shaders Skia has
-    // cached.
+    // Implements PersistentCache to monitor what SkSL shaders Skia compiles, and forwards
+    // them to the on-disk ShaderCache so compiles are skipped across reboots.
     class SkSLCacheMonitor : public GrContextOptions::PersistentCache {
     public:
         SkSLCacheMonitor() = default;
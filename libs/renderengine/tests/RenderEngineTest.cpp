@@ -504,6 +504,9 @@ public:
     template <typename SourceVariant>
     void fillBufferAndBlurBackground();
 
+    template <typename SourceVariant>
+    void fillBufferAndBlurBackgroundTwice();
+
     template <typename SourceVariant>
     void fillSmallLayerAndBlurBackground();
 
@@ -991,6 +994,56 @@ void RenderEngineTest::fillBufferAndBlurBackground() {
     }
 }
 
+template <typename SourceVariant>
+void RenderEngineTest::fillBufferAndBlurBackgroundTwice() {
+    auto blurRadius = 50;
+    auto center = DEFAULT_DISPLAY_WIDTH / 2;
+
+    renderengine::DisplaySettings settings;
+    settings.outputDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    settings.physicalDisplay = fullscreenRect();
+    settings.clip = fullscreenRect();
+
+    std::vector<const renderengine::LayerSettings*> layers;
+
+    renderengine::LayerSettings backgroundLayer;
+    backgroundLayer.sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    backgroundLayer.geometry.boundaries = fullscreenRect().toFloatRect();
+    SourceVariant::fillColor(backgroundLayer, 0.0f, 1.0f, 0.0f, this);
+    backgroundLayer.alpha = 1.0f;
+    layers.push_back(&backgroundLayer);
+
+    renderengine::LayerSettings leftLayer;
+    leftLayer.sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    leftLayer.geometry.boundaries =
+            Rect(DEFAULT_DISPLAY_WIDTH / 2, DEFAULT_DISPLAY_HEIGHT).toFloatRect();
+    SourceVariant::fillColor(leftLayer, 1.0f, 0.0f, 0.0f, this);
+    leftLayer.alpha = 1.0f;
+    layers.push_back(&leftLayer);
+
+    renderengine::LayerSettings blurLayer;
+    blurLayer.sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    blurLayer.geometry.boundaries = fullscreenRect().toFloatRect();
+    blurLayer.backgroundBlurRadius = blurRadius;
+    SourceVariant::fillColor(blurLayer, 0.0f, 0.0f, 1.0f, this);
+    blurLayer.alpha = 0;
+    layers.push_back(&blurLayer);
+
+    // Drawing the same layers twice exercises any cached blur state from the first frame; the
+    // second frame must produce the same output as the first.
+    invokeDraw(settings, layers);
+    invokeDraw(settings, layers);
+
+    // solid color
+    expectBufferColor(Rect(0, 0, 1, 1), 255, 0, 0, 255, 0 /* tolerance */);
+
+    if (mRE->supportsBackgroundBlur()) {
+        // blurred color (downsampling should result in the center color being close to 128)
+        expectBufferColor(Rect(center - 1, center - 5, center + 1, center + 5), 128, 128, 0, 255,
+                          50 /* tolerance */);
+    }
+}
+
 template <typename SourceVariant>
 void RenderEngineTest::fillSmallLayerAndBlurBackground() {
     auto blurRadius = 50;
@@ -1374,6 +1427,20 @@ TEST_P(RenderEngineTest, drawLayers_doesNotCacheFramebuffer) {
 
     initializeRenderEngine();
 
+    // Use an output buffer that is not mapped as renderable, so that mapping it
+    // does not prime it into the framebuffer image cache.
+    mBuffer = std::make_shared<
+            renderengine::
+                    ExternalTexture>(new GraphicBuffer(DEFAULT_DISPLAY_WIDTH,
+                                                       DEFAULT_DISPLAY_HEIGHT,
+                                                       HAL_PIXEL_FORMAT_RGBA_8888, 1,
+                                                       GRALLOC_USAGE_SW_READ_OFTEN |
+                                                               GRALLOC_USAGE_SW_WRITE_OFTEN |
+                                                               GRALLOC_USAGE_HW_RENDER |
+                                                               GRALLOC_USAGE_HW_TEXTURE,
+                                                       "output"),
+                                     *mRE, renderengine::ExternalTexture::Usage::READABLE);
+
     renderengine::DisplaySettings settings;
     settings.outputDataspace = ui::Dataspace::V0_SRGB_LINEAR;
     settings.physicalDisplay = fullscreenRect();
@@ -1462,6 +1529,11 @@ TEST_P(RenderEngineTest, drawLayers_fillBufferAndBlurBackground_colorSource) {
     fillBufferAndBlurBackground<ColorSourceVariant>();
 }
 
+TEST_P(RenderEngineTest, drawLayers_fillBufferAndBlurBackgroundTwice_colorSource) {
+    initializeRenderEngine();
+    fillBufferAndBlurBackgroundTwice<ColorSourceVariant>();
+}
+
 TEST_P(RenderEngineTest, drawLayers_fillSmallLayerAndBlurBackground_colorSource) {
     initializeRenderEngine();
     fillSmallLayerAndBlurBackground<ColorSourceVariant>();
@@ -1542,6 +1614,11 @@ TEST_P(RenderEngineTest, drawLayers_fillBufferAndBlurBackground_opaqueBufferSour
     fillBufferAndBlurBackground<BufferSourceVariant<ForceOpaqueBufferVariant>>();
 }
 
+TEST_P(RenderEngineTest, drawLayers_fillBufferAndBlurBackgroundTwice_opaqueBufferSource) {
+    initializeRenderEngine();
+    fillBufferAndBlurBackgroundTwice<BufferSourceVariant<ForceOpaqueBufferVariant>>();
+}
+
 TEST_P(RenderEngineTest, drawLayers_fillSmallLayerAndBlurBackground_opaqueBufferSource) {
     initializeRenderEngine();
     fillSmallLayerAndBlurBackground<BufferSourceVariant<ForceOpaqueBufferVariant>>();
@@ -1622,6 +1699,11 @@ TEST_P(RenderEngineTest, drawLayers_fillBufferAndBlurBackground_bufferSource) {
     fillBufferAndBlurBackground<BufferSourceVariant<RelaxOpaqueBufferVariant>>();
 }
 
+TEST_P(RenderEngineTest, drawLayers_fillBufferAndBlurBackgroundTwice_bufferSource) {
+    initializeRenderEngine();
+    fillBufferAndBlurBackgroundTwice<BufferSourceVariant<RelaxOpaqueBufferVariant>>();
+}
+
 TEST_P(RenderEngineTest, drawLayers_fillSmallLayerAndBlurBackground_bufferSource) {
     initializeRenderEngine();
     fillSmallLayerAndBlurBackground<BufferSourceVariant<RelaxOpaqueBufferVariant>>();
@@ -190,4 +190,28 @@ TEST_F(RenderEngineThreadedTest, drawLayers) {
     ASSERT_EQ(NO_ERROR, result);
 }
 
+TEST_F(RenderEngineThreadedTest, drawLayersAsync) {
+    renderengine::DisplaySettings settings;
+    std::vector<renderengine::LayerSettings> layers;
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::ExternalTexture>(new GraphicBuffer(), *mRenderEngine,
+                                           renderengine::ExternalTexture::Usage::READABLE |
+                                                   renderengine::ExternalTexture::Usage::WRITEABLE);
+    base::unique_fd bufferFence;
+
+    EXPECT_CALL(*mRenderEngine, drawLayers)
+            .WillOnce([](const renderengine::DisplaySettings&,
+                         const std::vector<const renderengine::LayerSettings*>&,
+                         const std::shared_ptr<renderengine::ExternalTexture>&, const bool,
+                         base::unique_fd&&, base::unique_fd*) -> status_t { return NO_ERROR; });
+
+    // The draw is queued against a snapshot of the inputs, so the call must return without
+    // waiting for the render thread; only the future blocks until the frame is flushed.
+    std::future<renderengine::RenderEngineResult> result =
+            mThreadedRE->drawLayersAsync(settings, std::move(layers), buffer, false,
+                                         std::move(bufferFence));
+    ASSERT_TRUE(result.valid());
+    ASSERT_EQ(NO_ERROR, result.get().status);
+}
+
 } // namespace android
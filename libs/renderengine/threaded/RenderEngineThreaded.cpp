@@ -322,6 +322,41 @@ status_t RenderEngineThreaded::drawLayers(const DisplaySettings& display,
     return resultFuture.get();
 }
 
+std::future<RenderEngineResult> RenderEngineThreaded::drawLayersAsync(
+        const DisplaySettings& display, std::vector<LayerSettings> layers,
+        const std::shared_ptr<ExternalTexture>& buffer, const bool useFramebufferCache,
+        base::unique_fd&& bufferFence) {
+    ATRACE_CALL();
+    const auto resultPromise = std::make_shared<std::promise<RenderEngineResult>>();
+    std::future<RenderEngineResult> resultFuture = resultPromise->get_future();
+    // The task owns a snapshot of the frame, so unlike drawLayers there is no need to wait
+    // for the render thread: the caller can start recording the next frame while this one is
+    // still being drawn, and only has to block when it consumes the status and draw fence.
+    // The move-only arguments are wrapped in shared_ptrs because Work must stay copyable.
+    const auto layersSnapshot = std::make_shared<std::vector<LayerSettings>>(std::move(layers));
+    const auto fence = std::make_shared<base::unique_fd>(std::move(bufferFence));
+    {
+        std::lock_guard lock(mThreadMutex);
+        mFunctionCalls.push([resultPromise, display, layersSnapshot, buffer, useFramebufferCache,
+                             fence](renderengine::RenderEngine& instance) {
+            ATRACE_NAME("REThreaded::drawLayersAsync");
+            std::vector<const LayerSettings*> layerPointers;
+            layerPointers.reserve(layersSnapshot->size());
+            for (const auto& layer : *layersSnapshot) {
+                layerPointers.push_back(&layer);
+            }
+
+            base::unique_fd drawFence;
+            status_t status = instance.drawLayers(display, layerPointers, buffer,
+                                                  useFramebufferCache, std::move(*fence),
+                                                  &drawFence);
+            resultPromise->set_value({status, std::move(drawFence)});
+        });
+    }
+    mCondition.notify_one();
+    return resultFuture;
+}
+
 void RenderEngineThreaded::cleanFramebufferCache() {
     ATRACE_CALL();
     // This function is designed so it can run asynchronously, so we do not need to wait
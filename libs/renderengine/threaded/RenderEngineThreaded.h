@@ -63,6 +63,12 @@ public:
                         const bool useFramebufferCache, base::unique_fd&& bufferFence,
                         base::unique_fd* drawFence) override;
 
+    std::future<RenderEngineResult> drawLayersAsync(const DisplaySettings& display,
+                                                    std::vector<LayerSettings> layers,
+                                                    const std::shared_ptr<ExternalTexture>& buffer,
+                                                    const bool useFramebufferCache,
+                                                    base::unique_fd&& bufferFence) override;
+
     void cleanFramebufferCache() override;
     int getContextPriority() override;
     bool supportsBackgroundBlur() override;
@@ -361,14 +361,32 @@ std::unique_ptr<float3[]> ColorSpace::createLUT(uint32_t size, const ColorSpace&
 
     ColorSpaceConnector connector(src, dst);
 
+    // Each channel of the grid only ever takes `size` distinct values, and the
+    // source side of the connector (clamp + EOTF) operates per channel, so it
+    // can be hoisted out of the N^3 loop into a 1D table. This skips millions
+    // of std::function calls for large LUTs. The destination side can't be
+    // tabulated the same way without approximating: the transform matrix mixes
+    // the channels, so its inputs aren't confined to the grid values.
+    std::unique_ptr<float[]> srcLinear(new float[size]);
+    const ColorSpace::clamping_function& srcClamper = src.getClamper();
+    const ColorSpace::transfer_function& srcEOTF = src.getEOTF();
+    for (uint32_t i = 0; i < size; i++) {
+        srcLinear[i] = srcEOTF(srcClamper(static_cast<float>(i) * m));
+    }
+
+    const mat3& transform = connector.getTransform();
+    const ColorSpace::transfer_function& dstOETF = dst.getOETF();
+    const ColorSpace::clamping_function& dstClamper = dst.getClamper();
+
     for (uint32_t z = 0; z < size; z++) {
         for (int32_t y = int32_t(size - 1); y >= 0; y--) {
             for (uint32_t x = 0; x < size; x++) {
-                *data++ = connector.transform({
-                    static_cast<float>(x) * m,
-                    static_cast<float>(y) * m,
-                    static_cast<float>(z) * m,
-                });
+                float3 linear = transform * float3{srcLinear[x], srcLinear[y], srcLinear[z]};
+                *data++ = {
+                    dstClamper(dstOETF(linear.r)),
+                    dstClamper(dstOETF(linear.g)),
+                    dstClamper(dstOETF(linear.b)),
+                };
             }
         }
     }
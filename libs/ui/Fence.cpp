@@ -149,6 +149,20 @@ nsecs_t Fence::getSignalTime() const {
         return SIGNAL_TIME_INVALID;
     }
 
+    // Check the overall status with a zero-timeout wait first. While the fence
+    // is pending this is a single poll() with no allocation, whereas
+    // sync_file_info() copies out the info of every sync point on each call.
+    // Polling paths like FenceTimeline::updateSignalTimes() land here once per
+    // frame until the fence signals, so the pending case is the common one.
+    if (sync_wait(mFenceFd, 0) < 0) {
+        if (errno == ETIME) {
+            return SIGNAL_TIME_PENDING;
+        }
+        ALOGE("sync_wait(%d, 0) failed: %s", mFenceFd.get(), strerror(errno));
+        return SIGNAL_TIME_INVALID;
+    }
+
+    // The fence has signaled; query the sync points for the timestamp.
     struct sync_file_info* finfo = sync_file_info(mFenceFd);
     if (finfo == nullptr) {
         ALOGE("sync_file_info returned NULL for fd %d", mFenceFd.get());
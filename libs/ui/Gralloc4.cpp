@@ -203,7 +203,13 @@ status_t Gralloc4Mapper::lock(buffer_handle_t bufferHandle, uint64_t usage, cons
                               int acquireFence, void** outData, int32_t* outBytesPerPixel,
                               int32_t* outBytesPerStride) const {
     std::vector<ui::PlaneLayout> planeLayouts;
-    status_t err = getPlaneLayouts(bufferHandle, &planeLayouts);
+    status_t err = NO_ERROR;
+    if (outBytesPerPixel || outBytesPerStride) {
+        // The plane layouts are only needed to derive these two outputs, so skip the extra HAL
+        // metadata round trip when the caller does not ask for them. In particular the ycbcr
+        // variant of lock() below queries the plane layouts itself and calls us with neither.
+        err = getPlaneLayouts(bufferHandle, &planeLayouts);
+    }
 
     if (err == NO_ERROR && !planeLayouts.empty()) {
         if (outBytesPerPixel) {
@@ -23,11 +23,14 @@
 #include <limits.h>
 #include <stdio.h>
 
+#include <iterator>
+
 #include <grallocusage/GrallocUsageConversion.h>
 
 #include <android-base/stringprintf.h>
 #include <log/log.h>
 #include <utils/Singleton.h>
+#include <utils/Timers.h>
 #include <utils/Trace.h>
 
 #include <ui/Gralloc.h>
@@ -43,9 +46,33 @@ using base::StringAppendF;
 
 ANDROID_SINGLETON_STATIC_INSTANCE( GraphicBufferAllocator )
 
-Mutex GraphicBufferAllocator::sLock;
-KeyedVector<buffer_handle_t,
-    GraphicBufferAllocator::alloc_rec_t> GraphicBufferAllocator::sAllocList;
+GraphicBufferAllocator::AllocShard
+        GraphicBufferAllocator::sAllocShards[GraphicBufferAllocator::kAllocShardCount];
+GraphicBufferAllocator::AllocStats GraphicBufferAllocator::sAllocStats;
+
+// Upper bounds of the dump histogram buckets. Each histogram has one more
+// bucket than limits; the last bucket counts everything beyond the last limit.
+static constexpr nsecs_t kLatencyBucketLimitsNs[] = {
+        250000, 500000, ms2ns(1), ms2ns(2), ms2ns(4), ms2ns(8), ms2ns(16)};
+static constexpr uint64_t kSizeBucketLimits[] = {
+        16 << 10, 64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20, 64 << 20};
+
+template <typename T, size_t N>
+static size_t bucketFor(const T (&limits)[N], T value) {
+    size_t bucket = 0;
+    while (bucket < N && value >= limits[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+GraphicBufferAllocator::AllocShard& GraphicBufferAllocator::shardForHandle(
+        buffer_handle_t handle) {
+    // Drop the low pointer bits, which are mostly alignment, before taking
+    // the shard index.
+    const uintptr_t ptr = reinterpret_cast<uintptr_t>(handle);
+    return sAllocShards[(ptr >> 4) & (kAllocShardCount - 1)];
+}
 
 GraphicBufferAllocator::GraphicBufferAllocator() : mMapper(GraphicBufferMapper::getInstance()) {
     mAllocator = std::make_unique<const Gralloc4Allocator>(
@@ -70,35 +97,63 @@ GraphicBufferAllocator::GraphicBufferAllocator() : mMapper(GraphicBufferMapper::
 GraphicBufferAllocator::~GraphicBufferAllocator() {}
 
 uint64_t GraphicBufferAllocator::getTotalSize() const {
-    Mutex::Autolock _l(sLock);
-    uint64_t total = 0;
-    for (size_t i = 0; i < sAllocList.size(); ++i) {
-        total += sAllocList.valueAt(i).size;
-    }
-    return total;
+    return sAllocStats.totalSize.load(std::memory_order_relaxed);
 }
 
 void GraphicBufferAllocator::dump(std::string& result, bool less) const {
-    Mutex::Autolock _l(sLock);
-    KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
     uint64_t total = 0;
     result.append("GraphicBufferAllocator buffers:\n");
-    const size_t count = list.size();
     StringAppendF(&result, "%10s | %11s | %18s | %s | %8s | %10s | %s\n", "Handle", "Size",
                   "W (Stride) x H", "Layers", "Format", "Usage", "Requestor");
-    for (size_t i = 0; i < count; i++) {
-        const alloc_rec_t& rec(list.valueAt(i));
-        std::string sizeStr = (rec.size)
-                ? base::StringPrintf("%7.2f KiB", static_cast<double>(rec.size) / 1024.0)
-                : "unknown";
-        StringAppendF(&result, "%10p | %11s | %4u (%4u) x %4u | %6u | %8X | 0x%8" PRIx64 " | %s\n",
-                      list.keyAt(i), sizeStr.c_str(), rec.width, rec.stride, rec.height,
-                      rec.layerCount, rec.format, rec.usage, rec.requestorName.c_str());
-        total += rec.size;
+    for (const AllocShard& shard : sAllocShards) {
+        Mutex::Autolock _l(shard.lock);
+        const KeyedVector<buffer_handle_t, alloc_rec_t>& list(shard.list);
+        const size_t count = list.size();
+        for (size_t i = 0; i < count; i++) {
+            const alloc_rec_t& rec(list.valueAt(i));
+            std::string sizeStr = (rec.size)
+                    ? base::StringPrintf("%7.2f KiB", static_cast<double>(rec.size) / 1024.0)
+                    : "unknown";
+            StringAppendF(&result,
+                          "%10p | %11s | %4u (%4u) x %4u | %6u | %8X | 0x%8" PRIx64 " | %s\n",
+                          list.keyAt(i), sizeStr.c_str(), rec.width, rec.stride, rec.height,
+                          rec.layerCount, rec.format, rec.usage, rec.requestorName.c_str());
+            total += rec.size;
+        }
     }
     StringAppendF(&result, "Total allocated by GraphicBufferAllocator (estimate): %.2f KB\n",
                   static_cast<double>(total) / 1024.0);
 
+    const uint64_t allocations = sAllocStats.allocationCount.load(std::memory_order_relaxed);
+    const uint64_t failures = sAllocStats.failureCount.load(std::memory_order_relaxed);
+    const uint64_t totalLatencyNs = sAllocStats.totalLatencyNs.load(std::memory_order_relaxed);
+    StringAppendF(&result, "Allocations: %" PRIu64 " (%" PRIu64 " failed), mean latency %.3f ms\n",
+                  allocations, failures,
+                  allocations ? static_cast<double>(totalLatencyNs) / allocations / 1e6 : 0.0);
+
+    result.append("Latency histogram (ms):");
+    for (size_t i = 0; i < AllocStats::kLatencyBucketCount; i++) {
+        if (i < std::size(kLatencyBucketLimitsNs)) {
+            StringAppendF(&result, " <%.2f: %" PRIu64 " |",
+                          static_cast<double>(kLatencyBucketLimitsNs[i]) / 1e6,
+                          sAllocStats.latencyBuckets[i].load(std::memory_order_relaxed));
+        } else {
+            StringAppendF(&result, " more: %" PRIu64 "\n",
+                          sAllocStats.latencyBuckets[i].load(std::memory_order_relaxed));
+        }
+    }
+
+    result.append("Size histogram (KiB):");
+    for (size_t i = 0; i < AllocStats::kSizeBucketCount; i++) {
+        if (i < std::size(kSizeBucketLimits)) {
+            StringAppendF(&result, " <%" PRIu64 ": %" PRIu64 " |", kSizeBucketLimits[i] >> 10,
+                          sAllocStats.sizeBuckets[i].load(std::memory_order_relaxed));
+        } else {
+            StringAppendF(&result, " more: %" PRIu64 "\n",
+                          sAllocStats.sizeBuckets[i].load(std::memory_order_relaxed));
+        }
+    }
+
     result.append(mAllocator->dumpDebugInfo(less));
 }
 
@@ -135,9 +190,18 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     // TODO(b/72323293, b/72703005): Remove these invalid bits from callers
     usage &= ~static_cast<uint64_t>((1 << 10) | (1 << 13));
 
+    const nsecs_t allocStartTime = systemTime(CLOCK_MONOTONIC);
     status_t error = mAllocator->allocate(requestorName, width, height, format, layerCount, usage,
                                           1, stride, handle, importBuffer);
+    const nsecs_t allocDuration = systemTime(CLOCK_MONOTONIC) - allocStartTime;
+
+    sAllocStats.allocationCount.fetch_add(1, std::memory_order_relaxed);
+    sAllocStats.totalLatencyNs.fetch_add(allocDuration, std::memory_order_relaxed);
+    sAllocStats.latencyBuckets[bucketFor(kLatencyBucketLimitsNs, allocDuration)]
+            .fetch_add(1, std::memory_order_relaxed);
+
     if (error != NO_ERROR) {
+        sAllocStats.failureCount.fetch_add(1, std::memory_order_relaxed);
         ALOGE("Failed to allocate (%u x %u) layerCount %u format %d "
               "usage %" PRIx64 ": %d",
               width, height, layerCount, format, usage, error);
@@ -158,8 +222,10 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
         bufSize = static_cast<size_t>((*stride)) * height * bpp;
     }
 
-    Mutex::Autolock _l(sLock);
-    KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
+    sAllocStats.totalSize.fetch_add(bufSize, std::memory_order_relaxed);
+    sAllocStats.sizeBuckets[bucketFor(kSizeBucketLimits, static_cast<uint64_t>(bufSize))]
+            .fetch_add(1, std::memory_order_relaxed);
+
     alloc_rec_t rec;
     rec.width = width;
     rec.height = height;
@@ -169,7 +235,10 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     rec.usage = usage;
     rec.size = bufSize;
     rec.requestorName = std::move(requestorName);
-    list.add(*handle, rec);
+
+    AllocShard& shard = shardForHandle(*handle);
+    Mutex::Autolock _l(shard.lock);
+    shard.list.add(*handle, rec);
 
     return NO_ERROR;
 }
@@ -206,9 +275,13 @@ status_t GraphicBufferAllocator::free(buffer_handle_t handle)
     // mapper to get the handle.  We just need to free the handle now.
     mMapper.freeBuffer(handle);
 
-    Mutex::Autolock _l(sLock);
-    KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
-    list.removeItem(handle);
+    AllocShard& shard = shardForHandle(handle);
+    Mutex::Autolock _l(shard.lock);
+    const ssize_t idx = shard.list.indexOfKey(handle);
+    if (idx >= 0) {
+        sAllocStats.totalSize.fetch_sub(shard.list.valueAt(idx).size, std::memory_order_relaxed);
+        shard.list.removeItemsAt(idx);
+    }
 
     return NO_ERROR;
 }
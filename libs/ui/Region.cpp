@@ -252,7 +252,12 @@ bool Region::contains(int x, int y) const {
     const_iterator cur = begin();
     const_iterator const tail = end();
     while (cur != tail) {
-        if (y >= cur->top && y < cur->bottom && x >= cur->left && x < cur->right) {
+        // Rects are stored in y-x sorted order, so once we pass the band containing y
+        // no later rect can contain the point.
+        if (y < cur->top) {
+            break;
+        }
+        if (y < cur->bottom && x >= cur->left && x < cur->right) {
             return true;
         }
         cur++;
@@ -563,6 +568,213 @@ void Region::rasterizer::flushSpan()
     span.clear();
 }
 
+// ----------------------------------------------------------------------------
+// Span-based boolean kernels
+//
+// region_operator walks both regions one rect at a time through virtual calls.
+// For AND/OR/XOR on regions with more than a handful of rects we sweep the two
+// sorted band lists directly and merge x-intervals per band with tight
+// two-pointer loops, feeding the resulting rects to the rasterizer in raster
+// order. Everything is templated on the rasterizer so the inner loops inline.
+
+namespace {
+
+// Minimum rect count on both sides before the span kernels beat the generic
+// operator; below this the per-call overhead dominates anyway.
+constexpr size_t kSpanKernelMinRects = 4;
+
+// One horizontal band of a region: rects in [begin, end) share top and bottom.
+// top is mutable so a band can be consumed in vertical slices.
+struct Band {
+    const Rect* begin;
+    const Rect* end;
+    int32_t top;
+    int32_t bottom;
+};
+
+// Loads the band starting at it and advances it past the band's rects.
+Band nextBand(const Rect*& it, const Rect* end, int dy) {
+    Band band;
+    band.begin = it;
+    band.top = it->top + dy;
+    band.bottom = it->bottom + dy;
+    const int32_t top = it->top;
+    do {
+        ++it;
+    } while (it != end && it->top == top);
+    band.end = it;
+    return band;
+}
+
+template <typename RasterizerT>
+void emitBand(RasterizerT& out, const Band& band, int dx, int32_t top, int32_t bottom) {
+    for (const Rect* r = band.begin; r != band.end; ++r) {
+        out(Rect(r->left + dx, top, r->right + dx, bottom));
+    }
+}
+
+template <typename RasterizerT>
+void emitUnion(RasterizerT& out, const Band& l, const Band& r, int dx, int32_t top,
+               int32_t bottom) {
+    const Rect* p = l.begin;
+    const Rect* q = r.begin;
+    int32_t left = 0;
+    int32_t right = 0;
+    bool have = false;
+    while (p != l.end || q != r.end) {
+        int32_t il, ir;
+        if (q == r.end || (p != l.end && p->left <= q->left + dx)) {
+            il = p->left;
+            ir = p->right;
+            ++p;
+        } else {
+            il = q->left + dx;
+            ir = q->right + dx;
+            ++q;
+        }
+        if (!have) {
+            left = il;
+            right = ir;
+            have = true;
+        } else if (il <= right) {
+            if (ir > right) right = ir;
+        } else {
+            out(Rect(left, top, right, bottom));
+            left = il;
+            right = ir;
+        }
+    }
+    if (have) {
+        out(Rect(left, top, right, bottom));
+    }
+}
+
+template <typename RasterizerT>
+void emitIntersection(RasterizerT& out, const Band& l, const Band& r, int dx, int32_t top,
+                      int32_t bottom) {
+    const Rect* p = l.begin;
+    const Rect* q = r.begin;
+    while (p != l.end && q != r.end) {
+        const int32_t ql = q->left + dx;
+        const int32_t qr = q->right + dx;
+        const int32_t left = p->left > ql ? p->left : ql;
+        const int32_t right = p->right < qr ? p->right : qr;
+        if (left < right) {
+            out(Rect(left, top, right, bottom));
+        }
+        if (p->right < qr) {
+            ++p;
+        } else if (qr < p->right) {
+            ++q;
+        } else {
+            ++p;
+            ++q;
+        }
+    }
+}
+
+template <typename RasterizerT>
+void emitXor(RasterizerT& out, const Band& l, const Band& r, int dx, int32_t top, int32_t bottom) {
+    // Boundary sweep: walk the merged interval edges and emit whenever the
+    // inside-exactly-one predicate flips. Exhaustion is tracked with explicit
+    // flags rather than a sentinel coordinate: INT32_MAX is a legitimate edge
+    // (max-extent regions are valid inputs) and must still toggle the inside
+    // state like any other.
+    const Rect* p = l.begin;
+    const Rect* q = r.begin;
+    bool inL = false;
+    bool inR = false;
+    int32_t start = 0;
+    while (p != l.end || q != r.end) {
+        const bool haveP = p != l.end;
+        const bool haveQ = q != r.end;
+        const int32_t pe = haveP ? (inL ? p->right : p->left) : 0;
+        const int32_t qe = haveQ ? ((inR ? q->right : q->left) + dx) : 0;
+        const bool takeP = haveP && (!haveQ || pe <= qe);
+        const bool takeQ = haveQ && (!haveP || qe <= pe);
+        const int32_t x = takeP ? pe : qe;
+        const bool wasInside = inL != inR;
+        if (takeP) {
+            if (inL) ++p;
+            inL = !inL;
+        }
+        if (takeQ) {
+            if (inR) ++q;
+            inR = !inR;
+        }
+        const bool inside = inL != inR;
+        if (inside != wasInside) {
+            if (inside) {
+                start = x;
+            } else if (start < x) {
+                out(Rect(start, top, x, bottom));
+            }
+        }
+    }
+}
+
+template <typename RasterizerT>
+void spanBooleanOperation(uint32_t op, RasterizerT& out, const Rect* lhsRects, size_t lhsCount,
+                          const Rect* rhsRects, size_t rhsCount, int dx, int dy) {
+    const Rect* lit = lhsRects;
+    const Rect* const lend = lhsRects + lhsCount;
+    const Rect* rit = rhsRects;
+    const Rect* const rend = rhsRects + rhsCount;
+    Band l = nextBand(lit, lend, 0);
+    Band r = nextBand(rit, rend, dy);
+
+    while (true) {
+        if (l.top < r.top) {
+            const int32_t bottom = l.bottom < r.top ? l.bottom : r.top;
+            if (op != op_and) emitBand(out, l, 0, l.top, bottom);
+            l.top = bottom;
+        } else if (r.top < l.top) {
+            const int32_t bottom = r.bottom < l.top ? r.bottom : l.top;
+            if (op != op_and) emitBand(out, r, dx, r.top, bottom);
+            r.top = bottom;
+        } else {
+            const int32_t bottom = l.bottom < r.bottom ? l.bottom : r.bottom;
+            switch (op) {
+                case op_and:
+                    emitIntersection(out, l, r, dx, l.top, bottom);
+                    break;
+                case op_or:
+                    emitUnion(out, l, r, dx, l.top, bottom);
+                    break;
+                default:
+                    emitXor(out, l, r, dx, l.top, bottom);
+                    break;
+            }
+            l.top = bottom;
+            r.top = bottom;
+        }
+        if (l.top == l.bottom) {
+            if (lit == lend) break;
+            l = nextBand(lit, lend, 0);
+        }
+        if (r.top == r.bottom) {
+            if (rit == rend) break;
+            r = nextBand(rit, rend, dy);
+        }
+    }
+
+    // Flush whatever is left on the side that didn't run out.
+    if (op != op_and) {
+        if (l.top < l.bottom) emitBand(out, l, 0, l.top, l.bottom);
+        while (lit != lend) {
+            l = nextBand(lit, lend, 0);
+            emitBand(out, l, 0, l.top, l.bottom);
+        }
+        if (r.top < r.bottom) emitBand(out, r, dx, r.top, r.bottom);
+        while (rit != rend) {
+            r = nextBand(rit, rend, dy);
+            emitBand(out, r, dx, r.top, r.bottom);
+        }
+    }
+}
+
+} // namespace
+
 bool Region::validate(const Region& reg, const char* name, bool silent)
 {
     if (reg.mStorage.empty()) {
@@ -659,12 +871,19 @@ void Region::boolean_operation(uint32_t op, Region& dst,
     size_t rhs_count;
     Rect const * const rhs_rects = rhs.getArray(&rhs_count);
 
-    region_operator<Rect>::region lhs_region(lhs_rects, lhs_count);
-    region_operator<Rect>::region rhs_region(rhs_rects, rhs_count, dx, dy);
-    region_operator<Rect> operation(op, lhs_region, rhs_region);
-    { // scope for rasterizer (dtor has side effects)
+    if ((op == op_and || op == op_or || op == op_xor) &&
+        lhs_count >= kSpanKernelMinRects && rhs_count >= kSpanKernelMinRects) {
+        // scope for rasterizer (dtor has side effects)
         rasterizer r(dst);
-        operation(r);
+        spanBooleanOperation(op, r, lhs_rects, lhs_count, rhs_rects, rhs_count, dx, dy);
+    } else {
+        region_operator<Rect>::region lhs_region(lhs_rects, lhs_count);
+        region_operator<Rect>::region rhs_region(rhs_rects, rhs_count, dx, dy);
+        region_operator<Rect> operation(op, lhs_region, rhs_region);
+        { // scope for rasterizer (dtor has side effects)
+            rasterizer r(dst);
+            operation(r);
+        }
     }
 
 #if defined(VALIDATE_REGIONS)
@@ -247,51 +247,55 @@ Rect Transform::makeBounds(int w, int h) const {
     return transform( Rect(w, h) );
 }
 
-Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
-    Rect r;
-    vec2 lt( bounds.left,  bounds.top    );
-    vec2 rt( bounds.right, bounds.top    );
-    vec2 lb( bounds.left,  bounds.bottom );
-    vec2 rb( bounds.right, bounds.bottom );
+FloatRect Transform::transformBounds(const FloatRect& bounds) const {
+    const vec2 lt = transform(vec2(bounds.left,  bounds.top));
+    const vec2 rb = transform(vec2(bounds.right, bounds.bottom));
+
+    FloatRect r;
+    if (CC_LIKELY(preserveRects())) {
+        // The 2x2 part of the matrix is diagonal or anti-diagonal, so each
+        // output axis depends on a single input axis. The two transformed
+        // corners above already take both values of each input axis; the
+        // other two corners cannot contribute new extremes, so don't
+        // transform them. Region::transform hits this per dirty rect.
+        r.left   = std::min(lt[0], rb[0]);
+        r.top    = std::min(lt[1], rb[1]);
+        r.right  = std::max(lt[0], rb[0]);
+        r.bottom = std::max(lt[1], rb[1]);
+    } else {
+        const vec2 rt = transform(vec2(bounds.right, bounds.top));
+        const vec2 lb = transform(vec2(bounds.left,  bounds.bottom));
+
+        r.left   = std::min({lt[0], rt[0], lb[0], rb[0]});
+        r.top    = std::min({lt[1], rt[1], lb[1], rb[1]});
+        r.right  = std::max({lt[0], rt[0], lb[0], rb[0]});
+        r.bottom = std::max({lt[1], rt[1], lb[1], rb[1]});
+    }
+    return r;
+}
 
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
+Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
+    const FloatRect f = transformBounds(FloatRect(bounds.left, bounds.top,
+                                                  bounds.right, bounds.bottom));
 
+    Rect r;
     if (roundOutwards) {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]})));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]})));
-        r.right  = static_cast<int32_t>(ceilf(std::max({lt[0], rt[0], lb[0], rb[0]})));
-        r.bottom = static_cast<int32_t>(ceilf(std::max({lt[1], rt[1], lb[1], rb[1]})));
+        r.left   = static_cast<int32_t>(floorf(f.left));
+        r.top    = static_cast<int32_t>(floorf(f.top));
+        r.right  = static_cast<int32_t>(ceilf(f.right));
+        r.bottom = static_cast<int32_t>(ceilf(f.bottom));
     } else {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
-        r.right  = static_cast<int32_t>(floorf(std::max({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.bottom = static_cast<int32_t>(floorf(std::max({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
+        r.left   = static_cast<int32_t>(floorf(f.left + 0.5f));
+        r.top    = static_cast<int32_t>(floorf(f.top + 0.5f));
+        r.right  = static_cast<int32_t>(floorf(f.right + 0.5f));
+        r.bottom = static_cast<int32_t>(floorf(f.bottom + 0.5f));
     }
 
     return r;
 }
 
 FloatRect Transform::transform(const FloatRect& bounds) const {
-    vec2 lt(bounds.left, bounds.top);
-    vec2 rt(bounds.right, bounds.top);
-    vec2 lb(bounds.left, bounds.bottom);
-    vec2 rb(bounds.right, bounds.bottom);
-
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
-
-    FloatRect r;
-    r.left = std::min({lt[0], rt[0], lb[0], rb[0]});
-    r.top = std::min({lt[1], rt[1], lb[1], rb[1]});
-    r.right = std::max({lt[0], rt[0], lb[0], rb[0]});
-    r.bottom = std::max({lt[1], rt[1], lb[1], rb[1]});
-
-    return r;
+    return transformBounds(bounds);
 }
 
 Region Transform::transform(const Region& reg) const {
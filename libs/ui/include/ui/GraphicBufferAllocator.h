@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -93,8 +94,31 @@ protected:
                             uint64_t usage, buffer_handle_t* handle, uint32_t* stride,
                             std::string requestorName, bool importBuffer);
 
-    static Mutex sLock;
-    static KeyedVector<buffer_handle_t, alloc_rec_t> sAllocList;
+    // The allocation records exist only for dump purposes, so they are
+    // sharded by buffer handle rather than funneling every allocation and
+    // free in the process through a single global lock.
+    static constexpr size_t kAllocShardCount = 8; // must be a power of two
+    struct AllocShard {
+        mutable Mutex lock;
+        KeyedVector<buffer_handle_t, alloc_rec_t> list;
+    };
+    static AllocShard& shardForHandle(buffer_handle_t handle);
+    static AllocShard sAllocShards[kAllocShardCount];
+
+    // Allocation telemetry, maintained lock-free and reported by dump().
+    // The histograms bucket by the limits defined in the implementation;
+    // the last bucket of each histogram is unbounded.
+    struct AllocStats {
+        static constexpr size_t kLatencyBucketCount = 8;
+        static constexpr size_t kSizeBucketCount = 8;
+        std::atomic<uint64_t> totalSize{0};
+        std::atomic<uint64_t> allocationCount{0};
+        std::atomic<uint64_t> failureCount{0};
+        std::atomic<uint64_t> totalLatencyNs{0};
+        std::atomic<uint64_t> latencyBuckets[kLatencyBucketCount] = {};
+        std::atomic<uint64_t> sizeBuckets[kSizeBucketCount] = {};
+    };
+    static AllocStats sAllocStats;
 
     friend class Singleton<GraphicBufferAllocator>;
     GraphicBufferAllocator();
@@ -127,6 +127,10 @@ private:
     static bool absIsOne(float f);
     static bool isZero(float f);
 
+    // maps the corners of the bounds and returns their axis-aligned extent;
+    // only transforms two of the corners when the matrix preserves rects
+    FloatRect transformBounds(const FloatRect& bounds) const;
+
     mat33               mMatrix;
     mutable uint32_t    mType;
 };
@@ -113,4 +113,20 @@ TEST_F(GraphicBufferAllocatorTest, AllocateLargeStride) {
     ASSERT_EQ(NO_ERROR, err);
     ASSERT_EQ(expectedStride, stride);
 }
+
+TEST_F(GraphicBufferAllocatorTest, DumpIncludesAllocationStats) {
+    mAllocator.setUpAllocateExpectations(NO_ERROR, kTestWidth);
+    android::PixelFormat format = PIXEL_FORMAT_RGBA_8888;
+    uint32_t stride = 0;
+    buffer_handle_t handle;
+    status_t err = mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                       &handle, &stride, 0, "GraphicBufferAllocatorTest");
+    ASSERT_EQ(NO_ERROR, err);
+
+    std::string dump;
+    mAllocator.dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("Allocations: "));
+    EXPECT_NE(std::string::npos, dump.find("Latency histogram"));
+    EXPECT_NE(std::string::npos, dump.find("Size histogram"));
+}
 } // namespace android
@@ -16,6 +16,7 @@
 
 #define LOG_TAG "RegionTest"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <ui/Region.h>
 #include <ui/Rect.h>
@@ -53,6 +54,49 @@ protected:
         }
         EXPECT_TRUE((original ^ modified).isEmpty());
     }
+
+    void expectRegionsEqual(const Region& expected, const Region& actual) {
+        EXPECT_EQ(expected.end() - expected.begin(), actual.end() - actual.begin());
+        const Rect* e = expected.begin();
+        const Rect* a = actual.begin();
+        while (e != expected.end() && a != actual.end()) {
+            EXPECT_EQ(*e, *a);
+            e++;
+            a++;
+        }
+    }
+
+    // References for the boolean operations, computed exclusively along paths
+    // which can never take the span kernels: subtraction always goes through
+    // region_operator, and a single-rect operand is below the kernels'
+    // rect-count threshold.
+    static Region referenceAnd(const Region& lhs, const Region& rhs, int dx, int dy) {
+        Region outside(lhs);
+        outside.subtractSelf(rhs, dx, dy);
+        Region result(lhs);
+        result.subtractSelf(outside);
+        return result;
+    }
+
+    static Region referenceOr(const Region& lhs, const Region& rhs, int dx, int dy) {
+        Region result(lhs);
+        for (const Rect* r = rhs.begin(); r != rhs.end(); r++) {
+            result.orSelf(Rect(r->left + dx, r->top + dy, r->right + dx, r->bottom + dy));
+        }
+        return result;
+    }
+
+    static Region referenceXor(const Region& lhs, const Region& rhs, int dx, int dy) {
+        Region result(lhs);
+        result.subtractSelf(rhs, dx, dy);
+        Region onlyRhs(rhs);
+        onlyRhs.translateSelf(dx, dy);
+        onlyRhs.subtractSelf(lhs);
+        for (const Rect* r = onlyRhs.begin(); r != onlyRhs.end(); r++) {
+            result.orSelf(*r);
+        }
+        return result;
+    }
 };
 
 TEST_F(RegionTest, MinimalDivision_TJunction) {
@@ -167,6 +211,71 @@ TEST_F(RegionTest, EqualsToSelf) {
     ASSERT_TRUE(touchableRegion.contains(50, 50));
 }
 
+TEST_F(RegionTest, Random_BooleanOpsMatchRegionOperator) {
+    srandom(12345);
+
+    for (int iter = 0; iter < ITER_MAX; iter++) {
+        Region lhs;
+        Region rhs;
+        for (int i = 0; i < 20; i++) {
+            int32_t l = random() % 64;
+            int32_t t = random() % 64;
+            lhs.orSelf(Rect(l, t, l + 1 + random() % 16, t + 1 + random() % 16));
+            l = random() % 64;
+            t = random() % 64;
+            rhs.orSelf(Rect(l, t, l + 1 + random() % 16, t + 1 + random() % 16));
+        }
+        const int dx = static_cast<int>(random() % 9) - 4;
+        const int dy = static_cast<int>(random() % 9) - 4;
+
+        Region result(lhs);
+        result.andSelf(rhs, dx, dy);
+        expectRegionsEqual(referenceAnd(lhs, rhs, dx, dy), result);
+
+        result = lhs;
+        result.orSelf(rhs, dx, dy);
+        expectRegionsEqual(referenceOr(lhs, rhs, dx, dy), result);
+
+        result = lhs;
+        result.xorSelf(rhs, dx, dy);
+        expectRegionsEqual(referenceXor(lhs, rhs, dx, dy), result);
+    }
+}
+
+TEST_F(RegionTest, BooleanOpsWithEmptyOperand) {
+    Region multi;
+    for (int i = 0; i < 4; i++) {
+        multi.orSelf(Rect(i * 4, i * 4, i * 4 + 2, i * 4 + 2));
+    }
+    const Region empty;
+
+    EXPECT_TRUE((multi & empty).isEmpty());
+    EXPECT_TRUE((empty & multi).isEmpty());
+    expectRegionsEqual(multi, multi | empty);
+    expectRegionsEqual(multi, empty | multi);
+    expectRegionsEqual(multi, multi ^ empty);
+    expectRegionsEqual(multi, empty ^ multi);
+}
+
+TEST_F(RegionTest, XorKeepsSpansTouchingMaxExtent) {
+    // The xor kernel used INT32_MAX as an exhausted-iterator sentinel, so a
+    // legitimate edge at INT32_MAX silently dropped the last span of a band.
+    Region lhs;
+    Region rhs;
+    for (int32_t i = 0; i < 4; i++) {
+        const int32_t top = i * 2;
+        lhs.orSelf(Rect(0, top, 10, top + 1));
+        lhs.orSelf(Rect(20, top, INT32_MAX, top + 1));
+        rhs.orSelf(Rect(0, top, 15, top + 1));
+    }
+
+    Region result(lhs);
+    result.xorSelf(rhs);
+
+    EXPECT_TRUE(result.contains(INT32_MAX - 1, 0));
+    expectRegionsEqual(referenceXor(lhs, rhs, 0, 0), result);
+}
+
 TEST_F(RegionTest, RegionHash) {
     Region region1;
     region1.addRectUnchecked(10, 20, 30, 40);
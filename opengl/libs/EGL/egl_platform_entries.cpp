@@ -1345,7 +1345,8 @@ EGLBoolean eglSwapBuffersWithDamageKHRImpl(EGLDisplay dpy, EGLSurface draw, EGLi
         return s->cnx->egl.eglSwapBuffers(dp->disp.dpy, s->surface);
     }
 
-    std::vector<android_native_rect_t> androidRects((size_t)n_rects);
+    std::vector<android_native_rect_t> androidRects;
+    androidRects.reserve((size_t)n_rects);
     for (int r = 0; r < n_rects; ++r) {
         int offset = r * 4;
         int x = rects[offset];
@@ -295,31 +295,24 @@ inline int square(int x) {
     return x * x;
 }
 
-static etc1_uint32 chooseModifier(const etc1_byte* pBaseColors,
-        const etc1_byte* pIn, etc1_uint32 *pLow, int bitIndex,
-        const int* pModifierTable) {
+static etc1_uint32 chooseModifier(const etc1_byte* pDecodedColors,
+        const etc1_byte* pIn, etc1_uint32 *pLow, int bitIndex) {
     etc1_uint32 bestScore = ~0;
     int bestIndex = 0;
     int pixelR = pIn[0];
     int pixelG = pIn[1];
     int pixelB = pIn[2];
-    int r = pBaseColors[0];
-    int g = pBaseColors[1];
-    int b = pBaseColors[2];
     for (int i = 0; i < 4; i++) {
-        int modifier = pModifierTable[i];
-        int decodedG = clamp(g + modifier);
-        etc1_uint32 score = (etc1_uint32) (6 * square(decodedG - pixelG));
+        const etc1_byte* pDecoded = pDecodedColors + i * 3;
+        etc1_uint32 score = (etc1_uint32) (6 * square(pDecoded[1] - pixelG));
         if (score >= bestScore) {
             continue;
         }
-        int decodedR = clamp(r + modifier);
-        score += (etc1_uint32) (3 * square(decodedR - pixelR));
+        score += (etc1_uint32) (3 * square(pDecoded[0] - pixelR));
         if (score >= bestScore) {
             continue;
         }
-        int decodedB = clamp(b + modifier);
-        score += (etc1_uint32) square(decodedB - pixelB);
+        score += (etc1_uint32) square(pDecoded[2] - pixelB);
         if (score < bestScore) {
             bestScore = score;
             bestIndex = i;
@@ -334,7 +327,17 @@ static etc1_uint32 chooseModifier(const etc1_byte* pBaseColors,
 static
 void etc_encode_subblock_helper(const etc1_byte* pIn, etc1_uint32 inMask,
         etc_compressed* pCompressed, bool flipped, bool second,
-        const etc1_byte* pBaseColors, const int* pModifierTable) {
+        const etc1_byte* pBaseColors, const int* pModifierTable,
+        etc1_uint32 scoreBound) {
+    // The four decoded colors are shared by every pixel of the sub-block, so
+    // compute them once here rather than re-clamping per pixel per modifier.
+    etc1_byte decodedColors[12];
+    for (int i = 0; i < 4; i++) {
+        int modifier = pModifierTable[i];
+        decodedColors[i * 3] = clamp(pBaseColors[0] + modifier);
+        decodedColors[i * 3 + 1] = clamp(pBaseColors[1] + modifier);
+        decodedColors[i * 3 + 2] = clamp(pBaseColors[2] + modifier);
+    }
     int score = pCompressed->score;
     if (flipped) {
         int by = 0;
@@ -346,8 +349,14 @@ void etc_encode_subblock_helper(const etc1_byte* pIn, etc1_uint32 inMask,
             for (int x = 0; x < 4; x++) {
                 int i = x + 4 * yy;
                 if (inMask & (1 << i)) {
-                    score += chooseModifier(pBaseColors, pIn + i * 3,
-                            &pCompressed->low, yy + x * 4, pModifierTable);
+                    score += chooseModifier(decodedColors, pIn + i * 3,
+                            &pCompressed->low, yy + x * 4);
+                    if ((etc1_uint32) score >= scoreBound) {
+                        // Already no better than the best candidate so far;
+                        // take_best() would discard this one anyway.
+                        pCompressed->score = score;
+                        return;
+                    }
                 }
             }
         }
@@ -361,8 +370,12 @@ void etc_encode_subblock_helper(const etc1_byte* pIn, etc1_uint32 inMask,
                 int xx = bx + x;
                 int i = xx + 4 * y;
                 if (inMask & (1 << i)) {
-                    score += chooseModifier(pBaseColors, pIn + i * 3,
-                            &pCompressed->low, y + xx * 4, pModifierTable);
+                    score += chooseModifier(decodedColors, pIn + i * 3,
+                            &pCompressed->low, y + xx * 4);
+                    if ((etc1_uint32) score >= scoreBound) {
+                        pCompressed->score = score;
+                        return;
+                    }
                 }
             }
         }
@@ -444,8 +457,10 @@ void etc_encode_block_helper(const etc1_byte* pIn, etc1_uint32 inMask,
         temp.score = 0;
         temp.high = originalHigh | (i << 5);
         temp.low = 0;
+        // Once a candidate's partial score reaches the best score so far it
+        // can't win, so let the helper bail out early.
         etc_encode_subblock_helper(pIn, inMask, &temp, flipped, false,
-                pBaseColors, pModifierTable);
+                pBaseColors, pModifierTable, pCompressed->score);
         take_best(pCompressed, &temp);
     }
     pModifierTable = kModifierTable;
@@ -455,8 +470,11 @@ void etc_encode_block_helper(const etc1_byte* pIn, etc1_uint32 inMask,
         temp.score = firstHalf.score;
         temp.high = firstHalf.high | (i << 2);
         temp.low = firstHalf.low;
+        // The i == 0 candidate is adopted unconditionally below, so it must
+        // be scored in full; later ones only need to beat the running best.
         etc_encode_subblock_helper(pIn, inMask, &temp, flipped, true,
-                pBaseColors + 3, pModifierTable);
+                pBaseColors + 3, pModifierTable,
+                i == 0 ? ~0u : pCompressed->score);
         if (i == 0) {
             *pCompressed = temp;
         } else {
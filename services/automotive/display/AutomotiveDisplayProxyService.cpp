@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 
+#include <thread>
 #include <utility>
 
 #include <gui/bufferqueue/2.0/B2HGraphicBufferProducer.h>
@@ -28,75 +29,149 @@ namespace V1_0 {
 namespace implementation {
 
 
-Return<sp<IGraphicBufferProducer>>
-AutomotiveDisplayProxyService::getIGraphicBufferProducer(uint64_t id) {
-    auto it = mDisplays.find(id);
-    sp<IBinder> displayToken = nullptr;
-    sp<SurfaceControl> surfaceControl = nullptr;
-    if (it == mDisplays.end()) {
-        displayToken = SurfaceComposerClient::getPhysicalDisplayToken(PhysicalDisplayId(id));
-        if (displayToken == nullptr) {
-            ALOGE("Given display id, 0x%lX, is invalid.", (unsigned long)id);
-            return nullptr;
+AutomotiveDisplayProxyService::AutomotiveDisplayProxyService() {
+    // Pre-create the SurfaceControl and wrapped producer for every display
+    // that is already connected, so that the first getIGraphicBufferProducer()
+    // call from the EVS stack is a cache hit instead of a round of
+    // SurfaceComposerClient queries during camera startup.
+    {
+        std::lock_guard<std::mutex> lock(mDisplaysLock);
+        for (const auto& displayId : SurfaceComposerClient::getPhysicalDisplayIds()) {
+            primeDisplayLocked(displayId.value);
         }
+    }
 
-        // Get the resolution from stored display state.
-        ui::DisplayMode displayMode = {};
-        auto err = SurfaceComposerClient::getActiveDisplayMode(displayToken, &displayMode);
-        if (err != NO_ERROR) {
-            ALOGE("Failed to get display mode of %lX.  "
-                  "This display will be ignored.", (unsigned long)id);
-            return nullptr;
-        }
+    // Keep the cache in sync with hotplug events; displays that connect later
+    // are primed here rather than on the first client request.
+    if (mHotplugReceiver.initCheck() == NO_ERROR) {
+        mHotplugLooper = new Looper(false /* allowNonCallbacks */);
+        mHotplugLooper->addFd(mHotplugReceiver.getFd(), Looper::POLL_CALLBACK,
+                              Looper::EVENT_INPUT, handleHotplugEvents, this);
+        std::thread{[looper = mHotplugLooper]() {
+            while (true) {
+                looper->pollAll(-1 /* timeout */);
+            }
+        }}.detach();
+    } else {
+        ALOGW("Failed to set up a hotplug listener; displays connected later "
+              "will be configured on the first request instead.");
+    }
+}
 
-        ui::DisplayState displayState = {};
-        err = SurfaceComposerClient::getDisplayState(displayToken, &displayState);
-        if (err != NO_ERROR) {
-            ALOGE("Failed to get current display status of %lX.  "
-                  "This display will be ignored.", (unsigned long)id);
-            return nullptr;
-        }
 
-        auto displayWidth  = displayMode.resolution.getWidth();
-        auto displayHeight = displayMode.resolution.getHeight();
-        if ((displayState.orientation != ui::ROTATION_0) &&
-            (displayState.orientation != ui::ROTATION_180)) {
-            std::swap(displayWidth, displayHeight);
-        }
+bool AutomotiveDisplayProxyService::primeDisplayLocked(uint64_t id) {
+    sp<IBinder> displayToken =
+            SurfaceComposerClient::getPhysicalDisplayToken(PhysicalDisplayId(id));
+    if (displayToken == nullptr) {
+        ALOGE("Given display id, 0x%lX, is invalid.", (unsigned long)id);
+        return false;
+    }
 
-        sp<android::SurfaceComposerClient> surfaceClient = new SurfaceComposerClient();
-        err = surfaceClient->initCheck();
-        if (err != NO_ERROR) {
-            ALOGE("SurfaceComposerClient::initCheck error: %#x", err);
-            return nullptr;
+    // Get the resolution from stored display state.
+    ui::DisplayMode displayMode = {};
+    auto err = SurfaceComposerClient::getActiveDisplayMode(displayToken, &displayMode);
+    if (err != NO_ERROR) {
+        ALOGE("Failed to get display mode of %lX.  "
+              "This display will be ignored.", (unsigned long)id);
+        return false;
+    }
+
+    ui::DisplayState displayState = {};
+    err = SurfaceComposerClient::getDisplayState(displayToken, &displayState);
+    if (err != NO_ERROR) {
+        ALOGE("Failed to get current display status of %lX.  "
+              "This display will be ignored.", (unsigned long)id);
+        return false;
+    }
+
+    auto displayWidth  = displayMode.resolution.getWidth();
+    auto displayHeight = displayMode.resolution.getHeight();
+    if ((displayState.orientation != ui::ROTATION_0) &&
+        (displayState.orientation != ui::ROTATION_180)) {
+        std::swap(displayWidth, displayHeight);
+    }
+
+    sp<android::SurfaceComposerClient> surfaceClient = new SurfaceComposerClient();
+    err = surfaceClient->initCheck();
+    if (err != NO_ERROR) {
+        ALOGE("SurfaceComposerClient::initCheck error: %#x", err);
+        return false;
+    }
+
+    // Create a SurfaceControl instance
+    sp<SurfaceControl> surfaceControl = surfaceClient->createSurface(
+            String8::format("AutomotiveDisplay::%lX", (unsigned long)id),
+            displayWidth, displayHeight,
+            PIXEL_FORMAT_RGBX_8888, ISurfaceComposerClient::eOpaque);
+    if (surfaceControl == nullptr || !surfaceControl->isValid()) {
+        ALOGE("Failed to create SurfaceControl.");
+        return false;
+    }
+
+    // SurfaceControl::getSurface is guaranteed to be not null.  Wrap the
+    // producer once; the HIDL wrapper is stateless and safe to hand out to
+    // every client of this display.
+    sp<IGraphicBufferProducer> producer =
+            new ::android::hardware::graphics::bufferqueue::V2_0::utils::
+                B2HGraphicBufferProducer(
+                        surfaceControl->getSurface()->getIGraphicBufferProducer());
+
+    // Store
+    DisplayDesc descriptor = {displayToken, surfaceControl, producer};
+    mDisplays.insert_or_assign(id, std::move(descriptor));
+    return true;
+}
+
+
+int AutomotiveDisplayProxyService::handleHotplugEvents(int /* fd */, int /* events */,
+                                                       void* data) {
+    auto* service = static_cast<AutomotiveDisplayProxyService*>(data);
+
+    constexpr size_t SIZE = 8;
+    ::android::DisplayEventReceiver::Event buffer[SIZE];
+    ssize_t n;
+    while ((n = service->mHotplugReceiver.getEvents(buffer, SIZE)) > 0) {
+        for (ssize_t i = 0; i < n; ++i) {
+            const auto& event = buffer[i];
+            if (event.header.type !=
+                ::android::DisplayEventReceiver::DISPLAY_EVENT_HOTPLUG) {
+                continue;
+            }
+
+            const uint64_t id = event.header.displayId.value;
+            std::lock_guard<std::mutex> lock(service->mDisplaysLock);
+            // Drop the stale descriptor either way; on connection, rebuild it
+            // with the new resolution and orientation.
+            service->mDisplays.erase(id);
+            if (event.hotplug.connected) {
+                service->primeDisplayLocked(id);
+            }
         }
+    }
+
+    return 1; // keep the callback
+}
 
-        // Create a SurfaceControl instance
-        surfaceControl = surfaceClient->createSurface(
-                String8::format("AutomotiveDisplay::%lX", (unsigned long)id),
-                displayWidth, displayHeight,
-                PIXEL_FORMAT_RGBX_8888, ISurfaceComposerClient::eOpaque);
-        if (surfaceControl == nullptr || !surfaceControl->isValid()) {
-            ALOGE("Failed to create SurfaceControl.");
+
+Return<sp<IGraphicBufferProducer>>
+AutomotiveDisplayProxyService::getIGraphicBufferProducer(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mDisplaysLock);
+    auto it = mDisplays.find(id);
+    if (it == mDisplays.end()) {
+        // Not primed yet -- e.g. the display connected before this service
+        // started listening.  Fall back to building the descriptor on demand.
+        if (!primeDisplayLocked(id)) {
             return nullptr;
         }
-
-        // Store
-        DisplayDesc descriptor = {displayToken, surfaceControl};
-        mDisplays.insert_or_assign(id, std::move(descriptor));
-    } else {
-        displayToken = it->second.token;
-        surfaceControl = it->second.surfaceControl;
+        it = mDisplays.find(id);
     }
 
-    // SurfaceControl::getSurface is guaranteed to be not null.
-    auto targetSurface = surfaceControl->getSurface();
-    return new ::android::hardware::graphics::bufferqueue::V2_0::utils::
-               B2HGraphicBufferProducer(targetSurface->getIGraphicBufferProducer());
+    return it->second.producer;
 }
 
 
 Return<bool> AutomotiveDisplayProxyService::showWindow(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mDisplaysLock);
     auto it = mDisplays.find(id);
     if (it == mDisplays.end()) {
         ALOGE("Given display token is invalid or unknown.");
@@ -123,6 +198,7 @@ Return<bool> AutomotiveDisplayProxyService::showWindow(uint64_t id) {
 
 
 Return<bool> AutomotiveDisplayProxyService::hideWindow(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mDisplaysLock);
     auto it = mDisplays.find(id);
     if (it == mDisplays.end()) {
         ALOGE("Given display token is invalid or unknown.");
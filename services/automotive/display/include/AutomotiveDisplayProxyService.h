@@ -16,12 +16,15 @@
 #pragma once
 
 #include <android/frameworks/automotive/display/1.0/IAutomotiveDisplayProxyService.h>
+#include <gui/DisplayEventReceiver.h>
 #include <gui/IGraphicBufferProducer.h>
 #include <gui/ISurfaceComposer.h>
 #include <gui/Surface.h>
 #include <gui/SurfaceComposerClient.h>
 #include <ui/DisplayMode.h>
 #include <ui/DisplayState.h>
+#include <utils/Looper.h>
+#include <mutex>
 #include <tuple>
 #include <vector>
 
@@ -40,11 +43,14 @@ using ::android::sp;
 typedef struct DisplayDesc {
     sp<IBinder>        token;
     sp<SurfaceControl> surfaceControl;
+    sp<IGraphicBufferProducer> producer;
 } DisplayDesc;
 
 
 class AutomotiveDisplayProxyService : public IAutomotiveDisplayProxyService {
 public:
+    AutomotiveDisplayProxyService();
+
     Return<sp<IGraphicBufferProducer>> getIGraphicBufferProducer(uint64_t id) override;
     Return<bool> showWindow(uint64_t id) override;
     Return<bool> hideWindow(uint64_t id) override;
@@ -54,7 +60,18 @@ public:
 private:
     uint8_t getDisplayPort(const uint64_t id) { return (id & 0xF); }
 
+    // Creates the SurfaceControl and wrapped producer for a display and stores
+    // them in mDisplays.  Must be called with mDisplaysLock held.
+    bool primeDisplayLocked(uint64_t id);
+
+    // Looper callback draining hotplug events from mHotplugReceiver.
+    static int handleHotplugEvents(int fd, int events, void* data);
+
+    std::mutex mDisplaysLock;
     std::unordered_map<uint64_t, DisplayDesc> mDisplays;
+
+    ::android::DisplayEventReceiver mHotplugReceiver;
+    sp<Looper> mHotplugLooper;
 };
 
 }  // namespace implementation
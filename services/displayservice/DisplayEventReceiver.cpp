@@ -20,6 +20,7 @@
 
 #include <android-base/logging.h>
 #include <android/frameworks/displayservice/1.0/BpHwEventCallback.h>
+#include <utils/AndroidThreads.h>
 
 #include <thread>
 
@@ -33,7 +34,10 @@ sp<Looper> getLooper() {
     static sp<Looper> looper = []() {
         sp<Looper> looper = new Looper(false /* allowNonCallbacks */);
 
-        std::thread{[&](){
+        std::thread{[looper](){
+            // Vsync dispatch tolerates little jitter, so run at the same elevated
+            // priority the framework uses for its own display event threads.
+            androidSetThreadPriority(0 /* self */, ANDROID_PRIORITY_URGENT_DISPLAY);
             int pollResult = looper->pollAll(-1 /* timeout */);
             LOG(ERROR) << "Looper::pollAll returns unexpected " << pollResult;
         }}.detach();
@@ -89,7 +93,15 @@ int DisplayEventReceiver::AttachedEvent::handleEvent(int fd, int events, void* /
         return 1; // keep the callback
     }
 
-    constexpr size_t SIZE = 1;
+    // Drain the queue in batched reads and coalesce vsyncs, like
+    // ::android::DisplayEventDispatcher does for framework clients: a backlog
+    // becomes a single callback with the most recent timestamp instead of a
+    // burst of one-way calls delivering stale vsyncs.
+    constexpr size_t SIZE = 16;
+
+    bool gotVsync = false;
+    uint64_t vsyncTimestamp = 0;
+    uint32_t vsyncCount = 0;
 
     ssize_t n;
     FwkReceiver::Event buf[SIZE];
@@ -102,12 +114,11 @@ int DisplayEventReceiver::AttachedEvent::handleEvent(int fd, int events, void* /
 
             switch(buf[i].header.type) {
                 case FwkReceiver::DISPLAY_EVENT_VSYNC: {
-                    auto ret = mCallback->onVsync(timestamp, event.vsync.count);
-                    if (!ret.isOk()) {
-                        LOG(ERROR) << "AttachedEvent handleEvent fails on onVsync callback"
-                                   << " because of " << ret.description();
-                        return 0;  // remove the callback
-                    }
+                    // Later vsyncs overwrite earlier ones; only the most recent
+                    // one is worth a callback.
+                    gotVsync = true;
+                    vsyncTimestamp = timestamp;
+                    vsyncCount = event.vsync.count;
                 } break;
                 case FwkReceiver::DISPLAY_EVENT_HOTPLUG: {
                     auto ret = mCallback->onHotplug(timestamp, event.hotplug.connected);
@@ -124,6 +135,15 @@ int DisplayEventReceiver::AttachedEvent::handleEvent(int fd, int events, void* /
         }
     }
 
+    if (gotVsync) {
+        auto ret = mCallback->onVsync(vsyncTimestamp, vsyncCount);
+        if (!ret.isOk()) {
+            LOG(ERROR) << "AttachedEvent handleEvent fails on onVsync callback"
+                       << " because of " << ret.description();
+            return 0;  // remove the callback
+        }
+    }
+
     return 1; // keep on going
 }
 
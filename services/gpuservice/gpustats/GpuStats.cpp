@@ -147,19 +147,20 @@ void GpuStats::insertTargetStats(const std::string& appPackageName,
 
     std::lock_guard<std::mutex> lock(mLock);
     registerStatsdCallbacksIfNeeded();
-    if (!mAppStats.count(appStatsKey)) {
+    const auto it = mAppStats.find(appStatsKey);
+    if (it == mAppStats.end()) {
         return;
     }
 
     switch (stats) {
         case GpuStatsInfo::Stats::CPU_VULKAN_IN_USE:
-            mAppStats[appStatsKey].cpuVulkanInUse = true;
+            it->second.cpuVulkanInUse = true;
             break;
         case GpuStatsInfo::Stats::FALSE_PREROTATION:
-            mAppStats[appStatsKey].falsePrerotation = true;
+            it->second.falsePrerotation = true;
             break;
         case GpuStatsInfo::Stats::GLES_1_IN_USE:
-            mAppStats[appStatsKey].gles1InUse = true;
+            it->second.gles1InUse = true;
             break;
         default:
             break;
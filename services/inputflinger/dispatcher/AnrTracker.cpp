@@ -24,6 +24,7 @@ static T max(const T& a, const T& b) {
 }
 
 void AnrTracker::insert(nsecs_t timeoutTime, sp<IBinder> token) {
+    mTimeoutsByToken[token].insert(timeoutTime);
     mAnrTimeouts.insert(std::make_pair(timeoutTime, std::move(token)));
 }
 
@@ -36,17 +37,27 @@ void AnrTracker::erase(nsecs_t timeoutTime, const sp<IBinder>& token) {
     auto it = mAnrTimeouts.find(pair);
     if (it != mAnrTimeouts.end()) {
         mAnrTimeouts.erase(it);
+
+        auto tokenIt = mTimeoutsByToken.find(token);
+        auto timeIt = tokenIt->second.find(timeoutTime);
+        tokenIt->second.erase(timeIt);
+        if (tokenIt->second.empty()) {
+            mTimeoutsByToken.erase(tokenIt);
+        }
     }
 }
 
 void AnrTracker::eraseToken(const sp<IBinder>& token) {
-    for (auto it = mAnrTimeouts.begin(); it != mAnrTimeouts.end();) {
-        if (it->second == token) {
-            it = mAnrTimeouts.erase(it);
-        } else {
-            ++it;
-        }
+    auto tokenIt = mTimeoutsByToken.find(token);
+    if (tokenIt == mTimeoutsByToken.end()) {
+        return;
+    }
+    // Batch-erase everything queued for this connection. Entries for other
+    // connections are never visited, unlike a full scan of mAnrTimeouts.
+    for (nsecs_t timeoutTime : tokenIt->second) {
+        mAnrTimeouts.erase(mAnrTimeouts.find(std::make_pair(timeoutTime, token)));
     }
+    mTimeoutsByToken.erase(tokenIt);
 }
 
 bool AnrTracker::empty() const {
@@ -68,6 +79,7 @@ const sp<IBinder>& AnrTracker::firstToken() const {
 
 void AnrTracker::clear() {
     mAnrTimeouts.clear();
+    mTimeoutsByToken.clear();
 }
 
 } // namespace android::inputdispatcher
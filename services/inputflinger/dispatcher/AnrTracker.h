@@ -20,6 +20,7 @@
 #include <binder/IBinder.h>
 #include <utils/Timers.h>
 #include <set>
+#include <unordered_map>
 
 namespace android::inputdispatcher {
 
@@ -53,6 +54,17 @@ private:
     // from the same connection and same timestamp, but different sequence numbers.
     // We are not tracking sequence numbers, and just allow duplicates to exist.
     std::multiset<std::pair<nsecs_t /*timeoutTime*/, sp<IBinder> /*connectionToken*/>> mAnrTimeouts;
+
+    template <typename T>
+    struct StrongPointerHash {
+        std::size_t operator()(const sp<T>& b) const { return std::hash<T*>{}(b.get()); }
+    };
+
+    // Secondary index: the timeout times queued for each connection token, kept in sync with
+    // mAnrTimeouts. Erasing all entries for a connection then only touches that connection's
+    // entries instead of walking the entire set.
+    std::unordered_map<sp<IBinder>, std::multiset<nsecs_t>, StrongPointerHash<IBinder>>
+            mTimeoutsByToken;
 };
 
 } // namespace android::inputdispatcher
@@ -324,15 +324,15 @@ static std::unique_ptr<DispatchEntry> createDispatchEntry(const InputTarget& inp
             // Use identity transform for events that are not pointer events because their axes
             // values do not represent on-screen coordinates, so they should not have any window
             // transformations applied to them.
-            return std::make_unique<DispatchEntry>(eventEntry, inputTargetFlags, identityTransform,
-                                                   1.0f /*globalScaleFactor*/,
+            return std::make_unique<DispatchEntry>(std::move(eventEntry), inputTargetFlags,
+                                                   identityTransform, 1.0f /*globalScaleFactor*/,
                                                    inputTarget.displaySize);
         }
     }
 
     if (inputTarget.useDefaultPointerTransform()) {
         const ui::Transform& transform = inputTarget.getDefaultPointerTransform();
-        return std::make_unique<DispatchEntry>(eventEntry, inputTargetFlags, transform,
+        return std::make_unique<DispatchEntry>(std::move(eventEntry), inputTargetFlags, transform,
                                                inputTarget.globalScaleFactor,
                                                inputTarget.displaySize);
     }
@@ -365,8 +365,8 @@ static std::unique_ptr<DispatchEntry> createDispatchEntry(const InputTarget& inp
         pointerCoords[pointerIndex].transform(inverseFirstTransform);
     }
 
-    std::unique_ptr<MotionEntry> combinedMotionEntry =
-            std::make_unique<MotionEntry>(motionEntry.id, motionEntry.eventTime,
+    std::shared_ptr<MotionEntry> combinedMotionEntry =
+            std::make_shared<MotionEntry>(motionEntry.id, motionEntry.eventTime,
                                           motionEntry.deviceId, motionEntry.source,
                                           motionEntry.displayId, motionEntry.policyFlags,
                                           motionEntry.action, motionEntry.actionButton,
@@ -574,6 +574,10 @@ void InputDispatcher::dispatchOnce() {
         std::scoped_lock _l(mLock);
         mDispatcherIsAlive.notify_all();
 
+        // Move any events the InputReader has staged since the last cycle into the
+        // inbound queue before deciding what to do.
+        drainStagedInboundEventsLocked();
+
         // Run a dispatch loop if there are no pending commands.
         // The dispatch loop might enqueue commands to run afterwards.
         if (!haveCommandsLocked()) {
@@ -926,7 +930,7 @@ bool InputDispatcher::shouldPruneInboundQueueLocked(const MotionEntry& motionEnt
     return false;
 }
 
-bool InputDispatcher::enqueueInboundEventLocked(std::unique_ptr<EventEntry> newEntry) {
+bool InputDispatcher::enqueueInboundEventLocked(std::shared_ptr<EventEntry> newEntry) {
     bool needWake = mInboundQueue.empty();
     mInboundQueue.push_back(std::move(newEntry));
     EventEntry& entry = *(mInboundQueue.back());
@@ -979,6 +983,36 @@ bool InputDispatcher::enqueueInboundEventLocked(std::unique_ptr<EventEntry> newE
     return needWake;
 }
 
+void InputDispatcher::stageInboundEvent(std::shared_ptr<EventEntry> entry) {
+    bool needWake;
+    { // acquire staging lock
+        std::scoped_lock _l(mStagedQueueLock);
+        needWake = mStagedInboundQueue.empty();
+        mStagedInboundQueue.push_back(std::move(entry));
+    } // release staging lock
+
+    // Only the push that makes the staging queue non-empty needs to wake the looper;
+    // any previously staged events have already triggered a wake that has not been
+    // consumed yet, and the dispatcher drains the whole staging queue at once.
+    if (needWake) {
+        mLooper->wake();
+    }
+}
+
+bool InputDispatcher::drainStagedInboundEventsLocked() {
+    std::deque<std::shared_ptr<EventEntry>> staged;
+    { // acquire staging lock
+        std::scoped_lock _l(mStagedQueueLock);
+        staged.swap(mStagedInboundQueue);
+    } // release staging lock
+
+    bool needWake = false;
+    for (std::shared_ptr<EventEntry>& entry : staged) {
+        needWake |= enqueueInboundEventLocked(std::move(entry));
+    }
+    return needWake;
+}
+
 void InputDispatcher::addRecentEventLocked(std::shared_ptr<EventEntry> entry) {
     // Do not store sensor event in recent queue to avoid flooding the queue.
     if (entry->type != EventEntry::Type::SENSOR) {
@@ -1178,6 +1212,17 @@ void InputDispatcher::postCommandLocked(std::unique_ptr<CommandEntry> commandEnt
 }
 
 void InputDispatcher::drainInboundQueueLocked() {
+    // Drop any events that are still staged, without running the enqueue bookkeeping
+    // (app switch tracking, queue pruning) for events that are about to be released.
+    std::deque<std::shared_ptr<EventEntry>> staged;
+    { // acquire staging lock
+        std::scoped_lock _l(mStagedQueueLock);
+        staged.swap(mStagedInboundQueue);
+    } // release staging lock
+    for (std::shared_ptr<EventEntry>& entry : staged) {
+        releaseInboundEventLocked(std::move(entry));
+    }
+
     while (!mInboundQueue.empty()) {
         std::shared_ptr<EventEntry> entry = mInboundQueue.front();
         mInboundQueue.pop_front();
@@ -1220,7 +1265,7 @@ std::shared_ptr<KeyEntry> InputDispatcher::synthesizeKeyRepeatLocked(nsecs_t cur
             (POLICY_FLAG_RAW_MASK | POLICY_FLAG_PASS_TO_USER | POLICY_FLAG_TRUSTED);
 
     std::shared_ptr<KeyEntry> newEntry =
-            std::make_unique<KeyEntry>(mIdGenerator.nextId(), currentTime, entry->deviceId,
+            std::make_shared<KeyEntry>(mIdGenerator.nextId(), currentTime, entry->deviceId,
                                        entry->source, entry->displayId, policyFlags, entry->action,
                                        entry->flags, entry->keyCode, entry->scanCode,
                                        entry->metaState, entry->repeatCount + 1, entry->downTime);
@@ -1528,6 +1573,9 @@ bool InputDispatcher::flushSensor(int deviceId, InputDeviceSensorType sensorType
     { // acquire lock
         std::scoped_lock _l(mLock);
 
+        // Pull in any staged events first so that staged sensor events are flushed too.
+        drainStagedInboundEventsLocked();
+
         for (auto it = mInboundQueue.begin(); it != mInboundQueue.end(); it++) {
             std::shared_ptr<EventEntry> entry = *it;
             if (entry->type == EventEntry::Type::SENSOR) {
@@ -1631,8 +1679,8 @@ void InputDispatcher::enqueueDragEventLocked(const sp<InputWindowHandle>& window
     pointerCoords.copyFrom(motionEntry.pointerCoords[0]);
     pointerCoords.transform(windowHandle->getInfo()->transform);
 
-    std::unique_ptr<DragEntry> dragEntry =
-            std::make_unique<DragEntry>(mIdGenerator.nextId(), motionEntry.eventTime,
+    std::shared_ptr<DragEntry> dragEntry =
+            std::make_shared<DragEntry>(mIdGenerator.nextId(), motionEntry.eventTime,
                                         windowHandle->getToken(), isExiting, pointerCoords.getX(),
                                         pointerCoords.getY());
 
@@ -2801,7 +2849,7 @@ void InputDispatcher::prepareDispatchCycleLocked(nsecs_t currentTime,
 
         const MotionEntry& originalMotionEntry = static_cast<const MotionEntry&>(*eventEntry);
         if (inputTarget.pointerIds.count() != originalMotionEntry.pointerCount) {
-            std::unique_ptr<MotionEntry> splitMotionEntry =
+            std::shared_ptr<MotionEntry> splitMotionEntry =
                     splitMotionEvent(originalMotionEntry, inputTarget.pointerIds);
             if (!splitMotionEntry) {
                 return; // split event was dropped
@@ -2873,7 +2921,7 @@ void InputDispatcher::enqueueDispatchEntryLocked(const sp<Connection>& connectio
     // This is a new event.
     // Enqueue a new dispatch entry onto the outbound queue for this connection.
     std::unique_ptr<DispatchEntry> dispatchEntry =
-            createDispatchEntry(inputTarget, eventEntry, inputTargetFlags);
+            createDispatchEntry(inputTarget, std::move(eventEntry), inputTargetFlags);
 
     // Use the eventEntry from dispatchEntry since the entry may have changed and can now be a
     // different EventEntry than what was passed in.
@@ -3592,7 +3640,7 @@ void InputDispatcher::synthesizePointerDownEventsForConnectionLocked(
     startDispatchCycleLocked(currentTime, connection);
 }
 
-std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
+std::shared_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
         const MotionEntry& originalMotionEntry, BitSet32 pointerIds) {
     ALOG_ASSERT(pointerIds.value != 0);
 
@@ -3668,8 +3716,8 @@ std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
                                            originalMotionEntry.id, newId);
         ATRACE_NAME(message.c_str());
     }
-    std::unique_ptr<MotionEntry> splitMotionEntry =
-            std::make_unique<MotionEntry>(newId, originalMotionEntry.eventTime,
+    std::shared_ptr<MotionEntry> splitMotionEntry =
+            std::make_shared<MotionEntry>(newId, originalMotionEntry.eventTime,
                                           originalMotionEntry.deviceId, originalMotionEntry.source,
                                           originalMotionEntry.displayId,
                                           originalMotionEntry.policyFlags, action,
@@ -3698,18 +3746,9 @@ void InputDispatcher::notifyConfigurationChanged(const NotifyConfigurationChange
     ALOGD("notifyConfigurationChanged - eventTime=%" PRId64, args->eventTime);
 #endif
 
-    bool needWake;
-    { // acquire lock
-        std::scoped_lock _l(mLock);
-
-        std::unique_ptr<ConfigurationChangedEntry> newEntry =
-                std::make_unique<ConfigurationChangedEntry>(args->id, args->eventTime);
-        needWake = enqueueInboundEventLocked(std::move(newEntry));
-    } // release lock
-
-    if (needWake) {
-        mLooper->wake();
-    }
+    std::shared_ptr<ConfigurationChangedEntry> newEntry =
+            std::make_shared<ConfigurationChangedEntry>(args->id, args->eventTime);
+    stageInboundEvent(std::move(newEntry));
 }
 
 /**
@@ -3793,37 +3832,22 @@ void InputDispatcher::notifyKey(const NotifyKeyArgs* args) {
               std::to_string(t.duration().count()).c_str());
     }
 
-    bool needWake;
-    { // acquire lock
-        mLock.lock();
-
-        if (shouldSendKeyToInputFilterLocked(args)) {
-            mLock.unlock();
-
-            policyFlags |= POLICY_FLAG_FILTERED;
-            if (!mPolicy->filterInputEvent(&event, policyFlags)) {
-                return; // event was consumed by the filter
-            }
-
-            mLock.lock();
+    if (shouldSendKeyToInputFilter(args)) {
+        policyFlags |= POLICY_FLAG_FILTERED;
+        if (!mPolicy->filterInputEvent(&event, policyFlags)) {
+            return; // event was consumed by the filter
         }
+    }
 
-        std::unique_ptr<KeyEntry> newEntry =
-                std::make_unique<KeyEntry>(args->id, args->eventTime, args->deviceId, args->source,
-                                           args->displayId, policyFlags, args->action, flags,
-                                           keyCode, args->scanCode, metaState, repeatCount,
-                                           args->downTime);
-
-        needWake = enqueueInboundEventLocked(std::move(newEntry));
-        mLock.unlock();
-    } // release lock
+    std::shared_ptr<KeyEntry> newEntry =
+            std::make_shared<KeyEntry>(args->id, args->eventTime, args->deviceId, args->source,
+                                       args->displayId, policyFlags, args->action, flags, keyCode,
+                                       args->scanCode, metaState, repeatCount, args->downTime);
 
-    if (needWake) {
-        mLooper->wake();
-    }
+    stageInboundEvent(std::move(newEntry));
 }
 
-bool InputDispatcher::shouldSendKeyToInputFilterLocked(const NotifyKeyArgs* args) {
+bool InputDispatcher::shouldSendKeyToInputFilter(const NotifyKeyArgs* args) {
     return mInputFilterEnabled;
 }
 
@@ -3870,50 +3894,35 @@ void InputDispatcher::notifyMotion(const NotifyMotionArgs* args) {
               std::to_string(t.duration().count()).c_str());
     }
 
-    bool needWake;
-    { // acquire lock
-        mLock.lock();
-
-        if (shouldSendMotionToInputFilterLocked(args)) {
-            mLock.unlock();
+    if (shouldSendMotionToInputFilter(args)) {
+        MotionEvent event;
+        ui::Transform transform;
+        event.initialize(args->id, args->deviceId, args->source, args->displayId, INVALID_HMAC,
+                         args->action, args->actionButton, args->flags, args->edgeFlags,
+                         args->metaState, args->buttonState, args->classification, transform,
+                         args->xPrecision, args->yPrecision, args->xCursorPosition,
+                         args->yCursorPosition, AMOTION_EVENT_INVALID_DISPLAY_SIZE,
+                         AMOTION_EVENT_INVALID_DISPLAY_SIZE, args->downTime, args->eventTime,
+                         args->pointerCount, args->pointerProperties, args->pointerCoords);
 
-            MotionEvent event;
-            ui::Transform transform;
-            event.initialize(args->id, args->deviceId, args->source, args->displayId, INVALID_HMAC,
-                             args->action, args->actionButton, args->flags, args->edgeFlags,
-                             args->metaState, args->buttonState, args->classification, transform,
-                             args->xPrecision, args->yPrecision, args->xCursorPosition,
-                             args->yCursorPosition, AMOTION_EVENT_INVALID_DISPLAY_SIZE,
-                             AMOTION_EVENT_INVALID_DISPLAY_SIZE, args->downTime, args->eventTime,
-                             args->pointerCount, args->pointerProperties, args->pointerCoords);
-
-            policyFlags |= POLICY_FLAG_FILTERED;
-            if (!mPolicy->filterInputEvent(&event, policyFlags)) {
-                return; // event was consumed by the filter
-            }
-
-            mLock.lock();
+        policyFlags |= POLICY_FLAG_FILTERED;
+        if (!mPolicy->filterInputEvent(&event, policyFlags)) {
+            return; // event was consumed by the filter
         }
+    }
 
-        // Just enqueue a new motion event.
-        std::unique_ptr<MotionEntry> newEntry =
-                std::make_unique<MotionEntry>(args->id, args->eventTime, args->deviceId,
-                                              args->source, args->displayId, policyFlags,
-                                              args->action, args->actionButton, args->flags,
-                                              args->metaState, args->buttonState,
-                                              args->classification, args->edgeFlags,
-                                              args->xPrecision, args->yPrecision,
-                                              args->xCursorPosition, args->yCursorPosition,
-                                              args->downTime, args->pointerCount,
-                                              args->pointerProperties, args->pointerCoords, 0, 0);
+    // Just enqueue a new motion event.
+    std::shared_ptr<MotionEntry> newEntry =
+            std::make_shared<MotionEntry>(args->id, args->eventTime, args->deviceId, args->source,
+                                          args->displayId, policyFlags, args->action,
+                                          args->actionButton, args->flags, args->metaState,
+                                          args->buttonState, args->classification, args->edgeFlags,
+                                          args->xPrecision, args->yPrecision,
+                                          args->xCursorPosition, args->yCursorPosition,
+                                          args->downTime, args->pointerCount,
+                                          args->pointerProperties, args->pointerCoords, 0, 0);
 
-        needWake = enqueueInboundEventLocked(std::move(newEntry));
-        mLock.unlock();
-    } // release lock
-
-    if (needWake) {
-        mLooper->wake();
-    }
+    stageInboundEvent(std::move(newEntry));
 }
 
 void InputDispatcher::notifySensor(const NotifySensorArgs* args) {
@@ -3924,24 +3933,13 @@ void InputDispatcher::notifySensor(const NotifySensorArgs* args) {
           NamedEnum::string(args->sensorType).c_str());
 #endif
 
-    bool needWake;
-    { // acquire lock
-        mLock.lock();
-
-        // Just enqueue a new sensor event.
-        std::unique_ptr<SensorEntry> newEntry =
-                std::make_unique<SensorEntry>(args->id, args->eventTime, args->deviceId,
-                                              args->source, 0 /* policyFlags*/, args->hwTimestamp,
-                                              args->sensorType, args->accuracy,
-                                              args->accuracyChanged, args->values);
+    // Just enqueue a new sensor event.
+    std::shared_ptr<SensorEntry> newEntry =
+            std::make_shared<SensorEntry>(args->id, args->eventTime, args->deviceId, args->source,
+                                          0 /* policyFlags*/, args->hwTimestamp, args->sensorType,
+                                          args->accuracy, args->accuracyChanged, args->values);
 
-        needWake = enqueueInboundEventLocked(std::move(newEntry));
-        mLock.unlock();
-    } // release lock
-
-    if (needWake) {
-        mLooper->wake();
-    }
+    stageInboundEvent(std::move(newEntry));
 }
 
 void InputDispatcher::notifyVibratorState(const NotifyVibratorStateArgs* args) {
@@ -3952,7 +3950,7 @@ void InputDispatcher::notifyVibratorState(const NotifyVibratorStateArgs* args) {
     mPolicy->notifyVibratorState(args->deviceId, args->isOn);
 }
 
-bool InputDispatcher::shouldSendMotionToInputFilterLocked(const NotifyMotionArgs* args) {
+bool InputDispatcher::shouldSendMotionToInputFilter(const NotifyMotionArgs* args) {
     return mInputFilterEnabled;
 }
 
@@ -3974,18 +3972,9 @@ void InputDispatcher::notifyDeviceReset(const NotifyDeviceResetArgs* args) {
           args->deviceId);
 #endif
 
-    bool needWake;
-    { // acquire lock
-        std::scoped_lock _l(mLock);
-
-        std::unique_ptr<DeviceResetEntry> newEntry =
-                std::make_unique<DeviceResetEntry>(args->id, args->eventTime, args->deviceId);
-        needWake = enqueueInboundEventLocked(std::move(newEntry));
-    } // release lock
-
-    if (needWake) {
-        mLooper->wake();
-    }
+    std::shared_ptr<DeviceResetEntry> newEntry =
+            std::make_shared<DeviceResetEntry>(args->id, args->eventTime, args->deviceId);
+    stageInboundEvent(std::move(newEntry));
 }
 
 void InputDispatcher::notifyPointerCaptureChanged(const NotifyPointerCaptureChangedArgs* args) {
@@ -3994,17 +3983,9 @@ void InputDispatcher::notifyPointerCaptureChanged(const NotifyPointerCaptureChan
           args->request.enable ? "true" : "false");
 #endif
 
-    bool needWake;
-    { // acquire lock
-        std::scoped_lock _l(mLock);
-        auto entry = std::make_unique<PointerCaptureChangedEntry>(args->id, args->eventTime,
-                                                                  args->request);
-        needWake = enqueueInboundEventLocked(std::move(entry));
-    } // release lock
-
-    if (needWake) {
-        mLooper->wake();
-    }
+    auto entry = std::make_shared<PointerCaptureChangedEntry>(args->id, args->eventTime,
+                                                              args->request);
+    stageInboundEvent(std::move(entry));
 }
 
 InputEventInjectionResult InputDispatcher::injectInputEvent(
@@ -4033,7 +4014,7 @@ InputEventInjectionResult InputDispatcher::injectInputEvent(
         resolvedDeviceId = event->getDeviceId();
     }
 
-    std::queue<std::unique_ptr<EventEntry>> injectedEntries;
+    std::queue<std::shared_ptr<EventEntry>> injectedEntries;
     switch (event->getType()) {
         case AINPUT_EVENT_TYPE_KEY: {
             const KeyEvent& incomingKey = static_cast<const KeyEvent&>(*event);
@@ -4070,8 +4051,8 @@ InputEventInjectionResult InputDispatcher::injectInputEvent(
             }
 
             mLock.lock();
-            std::unique_ptr<KeyEntry> injectedEntry =
-                    std::make_unique<KeyEntry>(incomingKey.getId(), incomingKey.getEventTime(),
+            std::shared_ptr<KeyEntry> injectedEntry =
+                    std::make_shared<KeyEntry>(incomingKey.getId(), incomingKey.getEventTime(),
                                                resolvedDeviceId, incomingKey.getSource(),
                                                incomingKey.getDisplayId(), policyFlags, action,
                                                flags, keyCode, incomingKey.getScanCode(), metaState,
@@ -4110,8 +4091,8 @@ InputEventInjectionResult InputDispatcher::injectInputEvent(
             mLock.lock();
             const nsecs_t* sampleEventTimes = motionEvent.getSampleEventTimes();
             const PointerCoords* samplePointerCoords = motionEvent.getSamplePointerCoords();
-            std::unique_ptr<MotionEntry> injectedEntry =
-                    std::make_unique<MotionEntry>(motionEvent.getId(), *sampleEventTimes,
+            std::shared_ptr<MotionEntry> injectedEntry =
+                    std::make_shared<MotionEntry>(motionEvent.getId(), *sampleEventTimes,
                                                   resolvedDeviceId, motionEvent.getSource(),
                                                   motionEvent.getDisplayId(), policyFlags, action,
                                                   actionButton, flags, motionEvent.getMetaState(),
@@ -4130,8 +4111,8 @@ InputEventInjectionResult InputDispatcher::injectInputEvent(
             for (size_t i = motionEvent.getHistorySize(); i > 0; i--) {
                 sampleEventTimes += 1;
                 samplePointerCoords += pointerCount;
-                std::unique_ptr<MotionEntry> nextInjectedEntry =
-                        std::make_unique<MotionEntry>(motionEvent.getId(), *sampleEventTimes,
+                std::shared_ptr<MotionEntry> nextInjectedEntry =
+                        std::make_shared<MotionEntry>(motionEvent.getId(), *sampleEventTimes,
                                                       resolvedDeviceId, motionEvent.getSource(),
                                                       motionEvent.getDisplayId(), policyFlags,
                                                       action, actionButton, flags,
@@ -5122,6 +5103,16 @@ void InputDispatcher::dumpDispatchStateLocked(std::string& dump) {
         dump += INDENT "InboundQueue: <empty>\n";
     }
 
+    { // acquire staging lock
+        std::scoped_lock _l(mStagedQueueLock);
+        if (!mStagedInboundQueue.empty()) {
+            dump += StringPrintf(INDENT "StagedInboundQueue: length=%zu\n",
+                                 mStagedInboundQueue.size());
+        } else {
+            dump += INDENT "StagedInboundQueue: <empty>\n";
+        }
+    } // release staging lock
+
     if (!mReplacedKeys.empty()) {
         dump += INDENT "ReplacedKeys:\n";
         for (const std::pair<KeyReplacement, int32_t>& pair : mReplacedKeys) {
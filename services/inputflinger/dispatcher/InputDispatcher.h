@@ -50,6 +50,7 @@
 #include <utils/RefBase.h>
 #include <utils/Timers.h>
 #include <utils/threads.h>
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <optional>
@@ -169,6 +170,14 @@ private:
     std::deque<std::shared_ptr<EventEntry>> mRecentQueue GUARDED_BY(mLock);
     std::deque<std::unique_ptr<CommandEntry>> mCommandQueue GUARDED_BY(mLock);
 
+    // Staging area for events produced by the InputReader. The notify* methods append
+    // here under mStagedQueueLock, which is only ever held for a few pointer operations,
+    // and the dispatcher thread moves the entries into mInboundQueue at the start of each
+    // dispatch cycle. This keeps event production from ever blocking on mLock while the
+    // dispatcher is in the middle of a long dispatch cycle.
+    std::mutex mStagedQueueLock;
+    std::deque<std::shared_ptr<EventEntry>> mStagedInboundQueue GUARDED_BY(mStagedQueueLock);
+
     DropReason mLastDropReason GUARDED_BY(mLock);
 
     const IdGenerator mIdGenerator;
@@ -181,7 +190,15 @@ private:
     void dispatchOnceInnerLocked(nsecs_t* nextWakeupTime) REQUIRES(mLock);
 
     // Enqueues an inbound event.  Returns true if mLooper->wake() should be called.
-    bool enqueueInboundEventLocked(std::unique_ptr<EventEntry> entry) REQUIRES(mLock);
+    bool enqueueInboundEventLocked(std::shared_ptr<EventEntry> entry) REQUIRES(mLock);
+
+    // Appends an event produced by the InputReader to the staging queue and wakes the
+    // dispatcher if the staging queue was empty. Does not acquire mLock.
+    void stageInboundEvent(std::shared_ptr<EventEntry> entry);
+
+    // Moves staged events into mInboundQueue. Returns true if mLooper->wake() should be
+    // called.
+    bool drainStagedInboundEventsLocked() REQUIRES(mLock);
 
     // Cleans up input state when dropping an inbound event.
     void dropInboundEventLocked(const EventEntry& entry, DropReason dropReason) REQUIRES(mLock);
@@ -298,8 +315,8 @@ private:
     std::chrono::nanoseconds getDispatchingTimeoutLocked(const sp<IBinder>& token) REQUIRES(mLock);
 
     // Input filter processing.
-    bool shouldSendKeyToInputFilterLocked(const NotifyKeyArgs* args) REQUIRES(mLock);
-    bool shouldSendMotionToInputFilterLocked(const NotifyMotionArgs* args) REQUIRES(mLock);
+    bool shouldSendKeyToInputFilter(const NotifyKeyArgs* args);
+    bool shouldSendMotionToInputFilter(const NotifyMotionArgs* args);
 
     // Inbound event processing.
     void drainInboundQueueLocked() REQUIRES(mLock);
@@ -309,7 +326,8 @@ private:
     // Dispatch state.
     bool mDispatchEnabled GUARDED_BY(mLock);
     bool mDispatchFrozen GUARDED_BY(mLock);
-    bool mInputFilterEnabled GUARDED_BY(mLock);
+    // Read by the notify* methods without holding mLock.
+    std::atomic<bool> mInputFilterEnabled;
     bool mInTouchMode GUARDED_BY(mLock);
     float mMaximumObscuringOpacityForTouch GUARDED_BY(mLock);
     android::os::BlockUntrustedTouchesMode mBlockUntrustedTouchesMode GUARDED_BY(mLock);
@@ -574,7 +592,7 @@ private:
             REQUIRES(mLock);
 
     // Splitting motion events across windows.
-    std::unique_ptr<MotionEntry> splitMotionEvent(const MotionEntry& originalMotionEntry,
+    std::shared_ptr<MotionEntry> splitMotionEvent(const MotionEntry& originalMotionEntry,
                                                   BitSet32 pointerIds);
 
     // Reset and drop everything the dispatcher is doing.
@@ -95,15 +95,21 @@ private:
     std::vector<char> mBuffer;
 };
 
-LatencyAggregator::LatencyAggregator() {
-    AStatsManager_setPullAtomCallback(android::util::INPUT_EVENT_LATENCY_SKETCH, nullptr,
-                                      LatencyAggregator::pullAtomCallback, this);
+static std::unique_ptr<KllQuantile> createSketch() {
     dist_proc::aggregation::KllQuantileOptions options;
     options.set_inv_eps(100); // Request precision of 1.0%, instead of default 0.1%
+    return KllQuantile::Create(options);
+}
+
+LatencyAggregator::LatencyAggregator() {
     for (size_t i = 0; i < SketchIndex::SIZE; i++) {
-        mDownSketches[i] = KllQuantile::Create(options);
-        mMoveSketches[i] = KllQuantile::Create(options);
+        mDownSketches[i] = createSketch();
+        mMoveSketches[i] = createSketch();
     }
+    // Register the pull callback only after the sketches exist, since statsd may pull from
+    // another thread as soon as the callback is set.
+    AStatsManager_setPullAtomCallback(android::util::INPUT_EVENT_LATENCY_SKETCH, nullptr,
+                                      LatencyAggregator::pullAtomCallback, this);
 }
 
 LatencyAggregator::~LatencyAggregator() {
@@ -126,6 +132,7 @@ void LatencyAggregator::processTimeline(const InputEventTimeline& timeline) {
 }
 
 void LatencyAggregator::processStatistics(const InputEventTimeline& timeline) {
+    std::scoped_lock lock(mLock);
     // Before we do any processing, check that we have not yet exceeded MAX_SIZE
     if (mNumSketchEventsProcessed >= MAX_EVENTS_FOR_STATISTICS) {
         return;
@@ -167,11 +174,28 @@ void LatencyAggregator::processStatistics(const InputEventTimeline& timeline) {
 }
 
 AStatsManager_PullAtomCallbackReturn LatencyAggregator::pullData(AStatsEventList* data) {
+    // Freeze the current sketches by swapping in fresh ones, then serialize the frozen
+    // snapshots without holding the lock. Serialization takes on the order of a millisecond
+    // for all sketches, which is too long to stall event processing for.
+    std::array<std::unique_ptr<KllQuantile>, SketchIndex::SIZE> downSketches;
+    std::array<std::unique_ptr<KllQuantile>, SketchIndex::SIZE> moveSketches;
+    { // acquire lock
+        std::scoped_lock lock(mLock);
+        for (size_t i = 0; i < SketchIndex::SIZE; i++) {
+            downSketches[i] = std::move(mDownSketches[i]);
+            moveSketches[i] = std::move(mMoveSketches[i]);
+            mDownSketches[i] = createSketch();
+            mMoveSketches[i] = createSketch();
+        }
+        // Start new aggregations
+        mNumSketchEventsProcessed = 0;
+    } // release lock
+
     std::array<std::unique_ptr<SafeBytesField>, SketchIndex::SIZE> serializedDownData;
     std::array<std::unique_ptr<SafeBytesField>, SketchIndex::SIZE> serializedMoveData;
     for (size_t i = 0; i < SketchIndex::SIZE; i++) {
-        serializedDownData[i] = std::make_unique<SafeBytesField>(*mDownSketches[i]);
-        serializedMoveData[i] = std::make_unique<SafeBytesField>(*mMoveSketches[i]);
+        serializedDownData[i] = std::make_unique<SafeBytesField>(*downSketches[i]);
+        serializedMoveData[i] = std::make_unique<SafeBytesField>(*moveSketches[i]);
     }
     android::util::
             addAStatsEvent(data, android::util::INPUT_EVENT_LATENCY_SKETCH,
@@ -196,12 +220,6 @@ AStatsManager_PullAtomCallbackReturn LatencyAggregator::pullData(AStatsEventList
                                    ->getBytesField(),
                            serializedMoveData[SketchIndex::END_TO_END]->getBytesField());
 
-    for (size_t i = 0; i < SketchIndex::SIZE; i++) {
-        mDownSketches[i]->Reset();
-        mMoveSketches[i]->Reset();
-    }
-    // Start new aggregations
-    mNumSketchEventsProcessed = 0;
     return AStatsManager_PULL_SUCCESS;
 }
 
@@ -257,6 +275,7 @@ void LatencyAggregator::processSlowEvent(const InputEventTimeline& timeline) {
 }
 
 std::string LatencyAggregator::dump(const char* prefix) {
+    std::scoped_lock lock(mLock);
     std::string sketchDump = StringPrintf("%s  Sketches:\n", prefix);
     for (size_t i = 0; i < SketchIndex::SIZE; i++) {
         const int64_t numDown = mDownSketches[i]->num_values();
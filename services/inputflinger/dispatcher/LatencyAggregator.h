@@ -17,6 +17,9 @@
 #ifndef _UI_INPUT_INPUTDISPATCHER_LATENCYAGGREGATOR_H
 #define _UI_INPUT_INPUTDISPATCHER_LATENCYAGGREGATOR_H
 
+#include <mutex>
+
+#include <android-base/thread_annotations.h>
 #include <kll.h>
 #include <statslog.h>
 #include <utils/Timers.h>
@@ -75,14 +78,19 @@ private:
     size_t mNumEventsSinceLastSlowEventReport = 0;
 
     // ---------- Statistics handling ----------
+    // Sketches are populated on the dispatcher thread but pulled from a statsd callback
+    // thread, so they are protected by a lock. The pull path swaps the sketches out while
+    // holding the lock and serializes the frozen copies after releasing it, so event
+    // processing is never blocked on proto serialization.
+    std::mutex mLock;
     void processStatistics(const InputEventTimeline& timeline);
     // Sketches
     std::array<std::unique_ptr<dist_proc::aggregation::KllQuantile>, SketchIndex::SIZE>
-            mDownSketches;
+            mDownSketches GUARDED_BY(mLock);
     std::array<std::unique_ptr<dist_proc::aggregation::KllQuantile>, SketchIndex::SIZE>
-            mMoveSketches;
+            mMoveSketches GUARDED_BY(mLock);
     // How many events have been processed so far
-    size_t mNumSketchEventsProcessed = 0;
+    size_t mNumSketchEventsProcessed GUARDED_BY(mLock) = 0;
 };
 
 } // namespace android::inputdispatcher
@@ -49,6 +49,7 @@
 #include <utils/Log.h>
 #include <utils/Timers.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <regex>
 
@@ -1463,8 +1464,6 @@ size_t EventHub::getEvents(int timeoutMillis, RawEvent* buffer, size_t bufferSiz
 
     std::scoped_lock _l(mLock);
 
-    struct input_event readBuffer[bufferSize];
-
     RawEvent* event = buffer;
     size_t capacity = bufferSize;
     bool awoken = false;
@@ -1603,8 +1602,9 @@ size_t EventHub::getEvents(int timeoutMillis, RawEvent* buffer, size_t bufferSiz
             }
             // This must be an input event
             if (eventItem.events & EPOLLIN) {
+                const size_t eventsToRead = std::min(capacity, EVENT_BUFFER_SIZE);
                 int32_t readSize =
-                        read(device->fd, readBuffer, sizeof(struct input_event) * capacity);
+                        read(device->fd, mReadBuffer, sizeof(struct input_event) * eventsToRead);
                 if (readSize == 0 || (readSize < 0 && errno == ENODEV)) {
                     // Device was removed before INotify noticed.
                     ALOGW("could not get event, removed? (fd: %d size: %" PRId32
@@ -1622,10 +1622,13 @@ size_t EventHub::getEvents(int timeoutMillis, RawEvent* buffer, size_t bufferSiz
                     int32_t deviceId = device->id == mBuiltInKeyboardId ? 0 : device->id;
 
                     size_t count = size_t(readSize) / sizeof(struct input_event);
+                    // All events in this batch arrived via the same read() call, so stamp
+                    // them with a single read time instead of querying the clock per event.
+                    const nsecs_t readTime = systemTime(SYSTEM_TIME_MONOTONIC);
                     for (size_t i = 0; i < count; i++) {
-                        struct input_event& iev = readBuffer[i];
+                        struct input_event& iev = mReadBuffer[i];
                         event->when = processEventTimestamp(iev);
-                        event->readTime = systemTime(SYSTEM_TIME_MONOTONIC);
+                        event->readTime = readTime;
                         event->deviceId = deviceId;
                         event->type = iev.type;
                         event->code = iev.code;
@@ -378,6 +378,10 @@ void InputDevice::process(const RawEvent* rawEvents, size_t count) {
     // have side-effects that must be interleaved.  For example, joystick movement events and
     // gamepad button presses are handled by different mappers but they should be dispatched
     // in the order received.
+    // Batches produced by InputReader::processEventsLocked never mix eventHub devices, so
+    // resolve the subdevice's mappers once per batch instead of once per event.
+    int32_t mappersDeviceId = -1;
+    MapperVector* mappers = nullptr;
     for (const RawEvent* rawEvent = rawEvents; count != 0; rawEvent++) {
 #if DEBUG_RAW_EVENTS
         ALOGD("Input event: device=%d type=0x%04x code=0x%04x value=0x%08x when=%" PRId64,
@@ -400,9 +404,16 @@ void InputDevice::process(const RawEvent* rawEvents, size_t count) {
             mDropUntilNextSync = true;
             reset(rawEvent->when);
         } else {
-            for_each_mapper_in_subdevice(rawEvent->deviceId, [rawEvent](InputMapper& mapper) {
-                mapper.process(rawEvent);
-            });
+            if (mappers == nullptr || mappersDeviceId != rawEvent->deviceId) {
+                mappersDeviceId = rawEvent->deviceId;
+                auto deviceIt = mDevices.find(rawEvent->deviceId);
+                mappers = deviceIt != mDevices.end() ? &deviceIt->second.second : nullptr;
+            }
+            if (mappers != nullptr) {
+                for (auto& mapperPtr : *mappers) {
+                    mapperPtr->process(rawEvent);
+                }
+            }
         }
         --count;
     }
@@ -708,6 +708,12 @@ private:
     // Maximum number of signalled FDs to handle at a time.
     static const int EPOLL_MAX_EVENTS = 16;
 
+    // Maximum number of input events to read from a device fd per read() call, and the
+    // preallocated buffer they are read into. getEvents() is the only reader and always runs
+    // with mLock held, so the buffer is reused across calls without reallocation.
+    static constexpr size_t EVENT_BUFFER_SIZE = 256;
+    struct input_event mReadBuffer[EVENT_BUFFER_SIZE];
+
     // The array of pending epoll events and the index of the next event to be handled.
     struct epoll_event mPendingEventItems[EPOLL_MAX_EVENTS];
     size_t mPendingEventCount;
@@ -116,6 +116,23 @@ TEST(AnrTrackerTest, MultipleTokens_IdenticalTimes) {
     ASSERT_TRUE(token1 == tracker.firstToken() || token2 == tracker.firstToken());
 }
 
+TEST(AnrTrackerTest, DuplicateEntries_EraseOneThenToken) {
+    AnrTracker tracker;
+
+    sp<IBinder> token1 = new BBinder();
+    sp<IBinder> token2 = new BBinder();
+
+    tracker.insert(2, token1);
+    tracker.insert(2, token1);
+    tracker.insert(3, token2);
+
+    tracker.erase(2, token1);
+    tracker.eraseToken(token1);
+
+    ASSERT_EQ(3, tracker.firstTimeout());
+    ASSERT_EQ(token2, tracker.firstToken());
+}
+
 TEST(AnrTrackerTest, MultipleTokens_IdenticalTimesRemove) {
     AnrTracker tracker;
 
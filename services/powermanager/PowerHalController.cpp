@@ -24,6 +24,8 @@
 #include <powermanager/PowerHalLoader.h>
 #include <utils/Log.h>
 
+#include <memory>
+
 using namespace android::hardware::power;
 
 namespace android {
@@ -61,15 +63,25 @@ void PowerHalController::init() {
 // Check validity of current handle to the power HAL service, and create a new
 // one if necessary.
 std::shared_ptr<HalWrapper> PowerHalController::initHal() {
+    // Steady state: the handle is connected and only needs an atomic read, so
+    // per-call hint senders never contend on the mutex.
+    std::shared_ptr<HalWrapper> handle = std::atomic_load(&mConnectedHal);
+    if (handle != nullptr) {
+        return handle;
+    }
+
     std::lock_guard<std::mutex> lock(mConnectedHalMutex);
-    if (mConnectedHal == nullptr) {
-        mConnectedHal = mHalConnector->connect();
-        if (mConnectedHal == nullptr) {
+    // Check again in case another thread reconnected while we waited.
+    handle = std::atomic_load(&mConnectedHal);
+    if (handle == nullptr) {
+        handle = mHalConnector->connect();
+        if (handle == nullptr) {
             // Unable to connect to Power HAL service. Fallback to default.
             return mDefaultHal;
         }
+        std::atomic_store(&mConnectedHal, handle);
     }
-    return mConnectedHal;
+    return handle;
 }
 
 // Check if a call to Power HAL function failed; if so, log the failure and
@@ -80,7 +92,7 @@ HalResult<T> PowerHalController::processHalResult(HalResult<T> result, const cha
         ALOGE("%s failed: %s", fnName, result.errorMessage());
         std::lock_guard<std::mutex> lock(mConnectedHalMutex);
         // Drop Power HAL handle. This will force future api calls to reconnect.
-        mConnectedHal = nullptr;
+        std::atomic_store(&mConnectedHal, std::shared_ptr<HalWrapper>(nullptr));
         mHalConnector->reset();
     }
     return result;
@@ -465,9 +465,10 @@ void Fusion::predict(const vec3_t& w, float dT) {
     const mat33_t I33dT(dT);
     const mat33_t wx(crossMatrix(we, 0));
     const mat33_t wx2(wx*wx);
-    const float lwedT = length(we)*dT;
+    const float lwe = length(we);
+    const float lwedT = lwe*dT;
     const float hlwedT = 0.5f*lwedT;
-    const float ilwe = 1.f/length(we);
+    const float ilwe = 1.f/lwe;
     const float k0 = (1-cosf(lwedT))*(ilwe*ilwe);
     const float k1 = sinf(lwedT);
     const float k2 = cosf(hlwedT);
@@ -487,7 +488,26 @@ void Fusion::predict(const vec3_t& w, float dT) {
     if (x0.w < 0)
         x0 = -x0;
 
-    P = Phi*P*transpose(Phi) + GQGt;
+    // P = Phi*P*transpose(Phi) + GQGt
+    //
+    // The lower blocks of Phi are constant (0 and I33), so expand the block
+    // product by hand instead of paying for the generic 2x2 block multiply:
+    //
+    //   P00' = Phi00*P00*Phi00' + M + M' + Phi10*P11*Phi10' + GQGt00
+    //   P01' = Phi00*P01 + Phi10*P11 + GQGt01
+    //   P11' = P11 + GQGt11
+    //
+    // with M = Phi00*P01*Phi10'. Using scaleCovariance() for the quadratic
+    // terms and mirroring M keeps P00 and P11 exactly symmetric, so
+    // checkState() only trips on genuine divergence rather than on
+    // accumulated rounding noise.
+    const mat33_t Phi00P01(Phi[0][0]*P[1][0]);
+    const mat33_t M(Phi00P01*transpose(Phi[1][0]));
+    P[0][0] = scaleCovariance(Phi[0][0], P[0][0]) + M + transpose(M)
+            + scaleCovariance(Phi[1][0], P[1][1]) + GQGt[0][0];
+    P[1][0] = Phi00P01 + Phi[1][0]*P[1][1] + GQGt[1][0];
+    P[0][1] = transpose(P[1][0]);
+    P[1][1] += GQGt[1][1];
 
     checkState();
 }
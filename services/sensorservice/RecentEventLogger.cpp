@@ -54,16 +54,26 @@ void RecentEventLogger::setLastEventStale() {
     mIsLastEventCurrent = false;
 }
 
-std::string RecentEventLogger::dump() const {
+std::vector<RecentEventLogger::SensorEventLog> RecentEventLogger::snapshotEvents() const {
     std::lock_guard<std::mutex> lk(mLock);
+    std::vector<SensorEventLog> events;
+    events.reserve(mRecentEvents.size());
+    for (size_t i = 0; i < mRecentEvents.size(); ++i) {
+        events.push_back(mRecentEvents[i]);
+    }
+    return events;
+}
+
+std::string RecentEventLogger::dump() const {
+    const std::vector<SensorEventLog> events = snapshotEvents();
 
     //TODO: replace String8 with std::string completely in this function
     String8 buffer;
 
-    buffer.appendFormat("last %zu events\n", mRecentEvents.size());
+    buffer.appendFormat("last %zu events\n", events.size());
     int j = 0;
-    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
-        const auto& ev = mRecentEvents[i];
+    for (int i = events.size() - 1; i >= 0; --i) {
+        const auto& ev = events[i];
         struct tm * timeinfo = localtime(&(ev.mWallTime.tv_sec));
         buffer.appendFormat("\t%2d (ts=%.9f, wall=%02d:%02d:%02d.%03d) ",
                 ++j, ev.mEvent.timestamp/1e9, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
@@ -95,11 +105,11 @@ std::string RecentEventLogger::dump() const {
  */
 void RecentEventLogger::dump(util::ProtoOutputStream* proto) const {
     using namespace service::SensorEventsProto;
-    std::lock_guard<std::mutex> lk(mLock);
+    const std::vector<SensorEventLog> events = snapshotEvents();
 
-    proto->write(RecentEventsLog::RECENT_EVENTS_COUNT, int(mRecentEvents.size()));
-    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
-        const auto& ev = mRecentEvents[i];
+    proto->write(RecentEventsLog::RECENT_EVENTS_COUNT, int(events.size()));
+    for (int i = events.size() - 1; i >= 0; --i) {
+        const auto& ev = events[i];
         const uint64_t token = proto->start(RecentEventsLog::EVENTS);
         proto->write(Event::TIMESTAMP_SEC, float(ev.mEvent.timestamp) / 1e9f);
         proto->write(Event::WALL_TIMESTAMP_MS, ev.mWallTime.tv_sec * 1000LL
@@ -24,6 +24,7 @@
 #include <utils/String8.h>
 
 #include <mutex>
+#include <vector>
 
 namespace android {
 namespace SensorServiceUtil {
@@ -68,6 +69,11 @@ protected:
     bool mIsLastEventCurrent;
 
 private:
+    // Copy the ring contents while briefly holding mLock. Dump formatting is
+    // slow and addEvent() runs on the HAL event thread, so the dumps format a
+    // snapshot instead of holding the lock for their whole duration.
+    std::vector<SensorEventLog> snapshotEvents() const;
+
     static size_t logSizeBySensorType(int sensorType);
 };
 
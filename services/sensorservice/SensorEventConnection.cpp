@@ -297,6 +297,9 @@ status_t SensorService::SensorEventConnection::sendEvents(
 
     int count = 0;
     Mutex::Autolock _l(mConnectionLock);
+    // Snapshot the sensor access state once per batch; hasSensorAccess() consults the uid
+    // policy under its own lock, which is too expensive to repeat for every copied event.
+    const bool hasAccess = hasSensorAccess();
     if (scratch) {
         size_t i=0;
         while (i<numEvents) {
@@ -312,12 +315,13 @@ status_t SensorService::SensorEventConnection::sendEvents(
 
             // Check if this connection has registered for this sensor. If not continue to the
             // next sensor_event.
-            if (mSensorInfo.count(sensor_handle) == 0) {
+            auto sensorInfoIt = mSensorInfo.find(sensor_handle);
+            if (sensorInfoIt == mSensorInfo.end()) {
                 ++i;
                 continue;
             }
 
-            FlushInfo& flushInfo = mSensorInfo[sensor_handle];
+            FlushInfo& flushInfo = sensorInfoIt->second;
             // Check if there is a pending flush_complete event for this sensor on this connection.
             if (buffer[i].type == SENSOR_TYPE_META_DATA && flushInfo.mFirstFlushPending == true &&
                     mapFlushEventsToConnections[i] == this) {
@@ -347,7 +351,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                 } else {
                     // Regular sensor event, just copy it to the scratch buffer after checking
                     // the AppOp.
-                    if (hasSensorAccess() && noteOpIfRequired(buffer[i])) {
+                    if (hasAccess && noteOpIfRequired(buffer[i])) {
                         scratch[count++] = buffer[i];
                     }
                 }
@@ -358,7 +362,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                                         buffer[i].meta_data.sensor == sensor_handle)));
         }
     } else {
-        if (hasSensorAccess()) {
+        if (hasAccess) {
             scratch = const_cast<sensors_event_t *>(buffer);
             count = numEvents;
         } else {
@@ -548,9 +552,15 @@ void SensorService::SensorEventConnection::appendEventsToCacheLocked(sensors_eve
 }
 
 void SensorService::SensorEventConnection::sendPendingFlushEventsLocked() {
-    ASensorEvent flushCompleteEvent;
-    memset(&flushCompleteEvent, 0, sizeof(flushCompleteEvent));
-    flushCompleteEvent.type = SENSOR_TYPE_META_DATA;
+    // Coalesce the pending flush complete events of all sensors on this connection into as few
+    // socket writes as possible. Each write wakes the client once, so sending the events one at
+    // a time made a connection flushing several sensors pay one wakeup per event.
+    constexpr int kMaxFlushEventsPerWrite = 16;
+    ASensorEvent flushEvents[kMaxFlushEventsPerWrite];
+    FlushInfo* flushOwners[kMaxFlushEventsPerWrite];
+    int numEvents = 0;
+    int numWakeUpEvents = 0;
+
     // Loop through all the sensors for this connection and check if there are any pending
     // flush complete events to be sent.
     for (auto& it : mSensorInfo) {
@@ -561,23 +571,50 @@ void SensorService::SensorEventConnection::sendPendingFlushEventsLocked() {
         }
 
         FlushInfo& flushInfo = it.second;
-        while (flushInfo.mPendingFlushEventsToSend > 0) {
+        const bool wakeUpSensor = si->getSensor().isWakeUpSensor();
+        // Snapshot the count: writeFlushCompleteBatchLocked() decrements it as batches go out.
+        const int pendingEvents = flushInfo.mPendingFlushEventsToSend;
+        for (int i = 0; i < pendingEvents; i++) {
+            ASensorEvent& flushCompleteEvent = flushEvents[numEvents];
+            memset(&flushCompleteEvent, 0, sizeof(flushCompleteEvent));
+            flushCompleteEvent.type = SENSOR_TYPE_META_DATA;
             flushCompleteEvent.meta_data.sensor = handle;
-            bool wakeUpSensor = si->getSensor().isWakeUpSensor();
             if (wakeUpSensor) {
-               ++mWakeLockRefCount;
-               flushCompleteEvent.flags |= WAKE_UP_SENSOR_EVENT_NEEDS_ACK;
+                flushCompleteEvent.flags |= WAKE_UP_SENSOR_EVENT_NEEDS_ACK;
+                ++numWakeUpEvents;
             }
-            ssize_t size = SensorEventQueue::write(mChannel, &flushCompleteEvent, 1);
-            if (size < 0) {
-                if (wakeUpSensor) --mWakeLockRefCount;
-                return;
+            flushOwners[numEvents] = &flushInfo;
+            if (++numEvents == kMaxFlushEventsPerWrite) {
+                if (!writeFlushCompleteBatchLocked(flushEvents, flushOwners, numEvents,
+                                                   numWakeUpEvents)) {
+                    return;
+                }
+                numEvents = 0;
+                numWakeUpEvents = 0;
             }
-            ALOGD_IF(DEBUG_CONNECTIONS, "sent dropped flush complete event==%d ",
-                    flushCompleteEvent.meta_data.sensor);
-            flushInfo.mPendingFlushEventsToSend--;
         }
     }
+    if (numEvents > 0) {
+        writeFlushCompleteBatchLocked(flushEvents, flushOwners, numEvents, numWakeUpEvents);
+    }
+}
+
+bool SensorService::SensorEventConnection::writeFlushCompleteBatchLocked(
+        ASensorEvent const* events, FlushInfo* const* owners, int count, int numWakeUpEvents) {
+    mWakeLockRefCount += numWakeUpEvents;
+    ssize_t size = SensorEventQueue::write(mChannel, events, count);
+    if (size < 0) {
+        // Nothing was sent (SOCK_SEQPACKET writes are all-or-nothing); the pending counts are
+        // untouched so the events will be retried on the next call.
+        mWakeLockRefCount -= numWakeUpEvents;
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        owners[i]->mPendingFlushEventsToSend--;
+        ALOGD_IF(DEBUG_CONNECTIONS, "sent dropped flush complete event==%d ",
+                events[i].meta_data.sensor);
+    }
+    return true;
 }
 
 void SensorService::SensorEventConnection::writeToSocketFromCache() {
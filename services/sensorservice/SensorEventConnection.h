@@ -100,6 +100,12 @@ private:
     // emulates the behavior of flush().
     void sendPendingFlushEventsLocked();
 
+    // Write a batch of flush_complete events to the socket in a single send so that the client is
+    // woken up once per batch instead of once per event. On success decrements each event's
+    // owning FlushInfo::mPendingFlushEventsToSend. Returns false if the write failed.
+    bool writeFlushCompleteBatchLocked(ASensorEvent const* events, FlushInfo* const* owners,
+                                       int count, int numWakeUpEvents);
+
     // Writes events from mEventCache to the socket.
     void writeToSocketFromCache();
 
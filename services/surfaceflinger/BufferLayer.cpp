@@ -517,7 +517,7 @@ bool BufferLayer::latchBuffer(bool& recomputeVisibleRegions, nsecs_t latchTime,
     // try again later
     if (!fenceHasSignaled()) {
         ATRACE_NAME("!fenceHasSignaled()");
-        mFlinger->signalLayerUpdate();
+        mFlinger->signalLayerUpdate(this);
         return false;
     }
 
@@ -832,18 +832,19 @@ void BufferLayer::updateCloneBufferInfo() {
     // the cloned. This is because some properties of drawingState can change when latchBuffer is
     // called. However, copying the drawingState would also overwrite the cloned layer's relatives
     // and touchableRegionCrop. Therefore, temporarily store the relatives so they can be set in
-    // the cloned drawingState again.
+    // the cloned drawingState again. The fields are moved out and back rather than copied since
+    // the copy is about to be overwritten anyway and inputInfo embeds a Region.
     wp<Layer> tmpZOrderRelativeOf = mDrawingState.zOrderRelativeOf;
-    SortedVector<wp<Layer>> tmpZOrderRelatives = mDrawingState.zOrderRelatives;
+    SortedVector<wp<Layer>> tmpZOrderRelatives = std::move(mDrawingState.zOrderRelatives);
     wp<Layer> tmpTouchableRegionCrop = mDrawingState.touchableRegionCrop;
-    InputWindowInfo tmpInputInfo = mDrawingState.inputInfo;
+    InputWindowInfo tmpInputInfo = std::move(mDrawingState.inputInfo);
 
     mDrawingState = clonedFrom->mDrawingState;
 
     mDrawingState.touchableRegionCrop = tmpTouchableRegionCrop;
     mDrawingState.zOrderRelativeOf = tmpZOrderRelativeOf;
-    mDrawingState.zOrderRelatives = tmpZOrderRelatives;
-    mDrawingState.inputInfo = tmpInputInfo;
+    mDrawingState.zOrderRelatives = std::move(tmpZOrderRelatives);
+    mDrawingState.inputInfo = std::move(tmpInputInfo);
 }
 
 void BufferLayer::setTransformHint(ui::Transform::RotationFlags displayTransformHint) {
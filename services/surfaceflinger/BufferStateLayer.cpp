@@ -43,16 +43,22 @@ namespace android {
 
 using PresentState = frametimeline::SurfaceFrame::PresentState;
 namespace {
-void callReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
-                               const sp<GraphicBuffer>& buffer, uint64_t framenumber,
-                               const sp<Fence>& releaseFence, uint32_t transformHint,
-                               uint32_t currentMaxAcquiredBufferCount) {
+void queueReleaseBufferCallback(TransactionCallbackInvoker& invoker,
+                                const sp<ITransactionCompletedListener>& listener,
+                                const sp<GraphicBuffer>& buffer, uint64_t framenumber,
+                                const sp<Fence>& releaseFence, uint32_t transformHint,
+                                uint32_t currentMaxAcquiredBufferCount) {
     if (!listener) {
         return;
     }
-    listener->onReleaseBuffer({buffer->getId(), framenumber},
-                              releaseFence ? releaseFence : Fence::NO_FENCE, transformHint,
-                              currentMaxAcquiredBufferCount);
+    // Queue instead of calling the listener directly so all the buffers freed in the same
+    // commit go out as one binder call when the callbacks for the commit are sent.
+    invoker.queueReleaseBufferCallback(listener,
+                                       ReleaseBufferStats({buffer->getId(), framenumber},
+                                                          releaseFence ? releaseFence
+                                                                       : Fence::NO_FENCE,
+                                                          transformHint,
+                                                          currentMaxAcquiredBufferCount));
 }
 } // namespace
 
@@ -67,11 +73,12 @@ BufferStateLayer::~BufferStateLayer() {
     // original layer and the clone should be removed at the same time so there shouldn't be any
     // issue with the clone layer trying to use the texture.
     if (mBufferInfo.mBuffer != nullptr && !isClone()) {
-        callReleaseBufferCallback(mDrawingState.releaseBufferListener,
-                                  mBufferInfo.mBuffer->getBuffer(), mBufferInfo.mFrameNumber,
-                                  mBufferInfo.mFence, mTransformHint,
-                                  mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(
-                                          mOwnerUid));
+        queueReleaseBufferCallback(mFlinger->getTransactionCallbackInvoker(),
+                                   mDrawingState.releaseBufferListener,
+                                   mBufferInfo.mBuffer->getBuffer(), mBufferInfo.mFrameNumber,
+                                   mBufferInfo.mFence, mTransformHint,
+                                   mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(
+                                           mOwnerUid));
     }
 }
 
@@ -442,11 +449,13 @@ bool BufferStateLayer::setBuffer(const std::shared_ptr<renderengine::ExternalTex
             // before swapping to drawing state, then the first buffer will be
             // dropped and we should decrement the pending buffer count and
             // call any release buffer callbacks if set.
-            callReleaseBufferCallback(mDrawingState.releaseBufferListener,
-                                      mDrawingState.buffer->getBuffer(), mDrawingState.frameNumber,
-                                      mDrawingState.acquireFence, mTransformHint,
-                                      mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(
-                                              mOwnerUid));
+            queueReleaseBufferCallback(mFlinger->getTransactionCallbackInvoker(),
+                                       mDrawingState.releaseBufferListener,
+                                       mDrawingState.buffer->getBuffer(),
+                                       mDrawingState.frameNumber, mDrawingState.acquireFence,
+                                       mTransformHint,
+                                       mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(
+                                               mOwnerUid));
             decrementPendingBufferCount();
             if (mDrawingState.bufferSurfaceFrameTX != nullptr &&
                 mDrawingState.bufferSurfaceFrameTX->getPresentState() != PresentState::Presented) {
@@ -557,7 +566,7 @@ bool BufferStateLayer::setSidebandStream(const sp<NativeHandle>& sidebandStream)
     setTransactionFlags(eTransactionNeeded);
     if (!mSidebandStreamChanged.exchange(true)) {
         // mSidebandStreamChanged was false
-        mFlinger->signalLayerUpdate();
+        mFlinger->signalLayerUpdate(this);
     }
     return true;
 }
@@ -709,7 +718,7 @@ uint64_t BufferStateLayer::getHeadFrameNumber(nsecs_t /* expectedPresentTime */)
 
 void BufferStateLayer::setAutoRefresh(bool autoRefresh) {
     if (!mAutoRefresh.exchange(autoRefresh)) {
-        mFlinger->signalLayerUpdate();
+        mFlinger->signalLayerUpdate(this);
     }
 }
 
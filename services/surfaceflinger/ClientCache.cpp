@@ -31,30 +31,30 @@ ANDROID_SINGLETON_STATIC_INSTANCE(ClientCache);
 
 ClientCache::ClientCache() : mDeathRecipient(new CacheDeathRecipient) {}
 
-bool ClientCache::getBuffer(const client_cache_t& cacheId,
-                            ClientCacheBuffer** outClientCacheBuffer) {
-    auto& [processToken, id] = cacheId;
-    if (processToken == nullptr) {
-        ALOGE("failed to get buffer, invalid (nullptr) process token");
-        return false;
+std::shared_ptr<ClientCache::ProcessCache> ClientCache::getProcessCache(
+        const wp<IBinder>& processToken) {
+    // Consecutive cache accesses on a thread overwhelmingly come from the same process, so each
+    // thread remembers the last shard it resolved and reuses it until a process removal
+    // invalidates the generation. A stale reference is at worst equivalent to the access having
+    // raced ahead of the removal: lookups miss because removeProcess clears the shard.
+    static thread_local wp<IBinder> lastToken;
+    static thread_local std::shared_ptr<ProcessCache> lastProcess;
+    static thread_local uint32_t lastGeneration = 0;
+
+    const uint32_t generation = mGeneration.load(std::memory_order_acquire);
+    if (lastProcess && lastGeneration == generation && lastToken == processToken) {
+        return lastProcess;
     }
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
-        ALOGE("failed to get buffer, invalid process token");
-        return false;
-    }
-
-    auto& processBuffers = it->second.second;
 
-    auto bufItr = processBuffers.find(id);
-    if (bufItr == processBuffers.end()) {
-        ALOGV("failed to get buffer, invalid buffer id");
-        return false;
+    std::lock_guard lock(mMutex);
+    auto it = mProcesses.find(processToken);
+    if (it == mProcesses.end()) {
+        return nullptr;
     }
-
-    ClientCacheBuffer& buf = bufItr->second;
-    *outClientCacheBuffer = &buf;
-    return true;
+    lastToken = processToken;
+    lastProcess = it->second;
+    lastGeneration = generation;
+    return it->second;
 }
 
 bool ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer) {
@@ -69,35 +69,35 @@ bool ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& bu
         return false;
     }
 
-    std::lock_guard lock(mMutex);
-    sp<IBinder> token;
-
-    // If this is a new process token, set a death recipient. If the client process dies, we will
-    // get a callback through binderDied.
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
-        token = processToken.promote();
-        if (!token) {
-            ALOGE("failed to cache buffer: invalid token");
-            return false;
-        }
+    std::shared_ptr<ProcessCache> process = getProcessCache(processToken);
+    if (!process) {
+        std::lock_guard lock(mMutex);
+        auto it = mProcesses.find(processToken);
+        if (it != mProcesses.end()) {
+            process = it->second;
+        } else {
+            // If this is a new process token, set a death recipient. If the client process dies,
+            // we will get a callback through binderDied.
+            sp<IBinder> token = processToken.promote();
+            if (!token) {
+                ALOGE("failed to cache buffer: invalid token");
+                return false;
+            }
 
-        status_t err = token->linkToDeath(mDeathRecipient);
-        if (err != NO_ERROR) {
-            ALOGE("failed to cache buffer: could not link to death");
-            return false;
+            status_t err = token->linkToDeath(mDeathRecipient);
+            if (err != NO_ERROR) {
+                ALOGE("failed to cache buffer: could not link to death");
+                return false;
+            }
+            process = std::make_shared<ProcessCache>();
+            process->token = std::move(token);
+            const auto [itr, success] = mProcesses.emplace(processToken, process);
+            LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
         }
-        auto [itr, success] =
-                mBuffers.emplace(processToken,
-                                 std::make_pair(token,
-                                                std::unordered_map<uint64_t, ClientCacheBuffer>()));
-        LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
-        it = itr;
     }
 
-    auto& processBuffers = it->second.second;
-
-    if (processBuffers.size() > BUFFER_CACHE_MAX_SIZE) {
+    std::lock_guard lock(process->mutex);
+    if (process->buffers.size() > BUFFER_CACHE_MAX_SIZE) {
         ALOGE("failed to cache buffer: cache is full");
         return false;
     }
@@ -105,7 +105,7 @@ bool ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& bu
     LOG_ALWAYS_FATAL_IF(mRenderEngine == nullptr,
                         "Attempted to build the ClientCache before a RenderEngine instance was "
                         "ready!");
-    processBuffers[id].buffer = std::make_shared<
+    process->buffers[id].buffer = std::make_shared<
             renderengine::ExternalTexture>(buffer, *mRenderEngine,
                                            renderengine::ExternalTexture::Usage::READABLE);
     return true;
@@ -113,23 +113,34 @@ bool ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& bu
 
 void ClientCache::erase(const client_cache_t& cacheId) {
     auto& [processToken, id] = cacheId;
+    if (processToken == nullptr) {
+        ALOGE("failed to erase buffer, invalid (nullptr) process token");
+        return;
+    }
+
+    const auto process = getProcessCache(processToken);
+    if (!process) {
+        ALOGE("failed to erase buffer, invalid process token");
+        return;
+    }
+
     std::vector<sp<ErasedRecipient>> pendingErase;
     {
-        std::lock_guard lock(mMutex);
-        ClientCacheBuffer* buf = nullptr;
-        if (!getBuffer(cacheId, &buf)) {
+        std::lock_guard lock(process->mutex);
+        auto bufItr = process->buffers.find(id);
+        if (bufItr == process->buffers.end()) {
             ALOGE("failed to erase buffer, could not retrieve buffer");
             return;
         }
 
-        for (auto& recipient : buf->recipients) {
+        for (auto& recipient : bufItr->second.recipients) {
             sp<ErasedRecipient> erasedRecipient = recipient.promote();
             if (erasedRecipient) {
                 pendingErase.push_back(erasedRecipient);
             }
         }
 
-        mBuffers[processToken].second.erase(id);
+        process->buffers.erase(bufItr);
     }
 
     for (auto& recipient : pendingErase) {
@@ -138,58 +149,92 @@ void ClientCache::erase(const client_cache_t& cacheId) {
 }
 
 std::shared_ptr<renderengine::ExternalTexture> ClientCache::get(const client_cache_t& cacheId) {
-    std::lock_guard lock(mMutex);
+    auto& [processToken, id] = cacheId;
+    if (processToken == nullptr) {
+        ALOGE("failed to get buffer, invalid (nullptr) process token");
+        return nullptr;
+    }
+
+    const auto process = getProcessCache(processToken);
+    if (!process) {
+        ALOGE("failed to get buffer, invalid process token");
+        return nullptr;
+    }
 
-    ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
-        ALOGE("failed to get buffer, could not retrieve buffer");
+    std::lock_guard lock(process->mutex);
+    auto bufItr = process->buffers.find(id);
+    if (bufItr == process->buffers.end()) {
+        ALOGV("failed to get buffer, invalid buffer id");
         return nullptr;
     }
 
-    return buf->buffer;
+    return bufItr->second.buffer;
 }
 
 bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
                                           const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    auto& [processToken, id] = cacheId;
+    const auto process = processToken != nullptr ? getProcessCache(processToken) : nullptr;
+    if (!process) {
+        ALOGV("failed to register erased recipient, could not retrieve buffer");
+        return false;
+    }
 
-    ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    std::lock_guard lock(process->mutex);
+    auto bufItr = process->buffers.find(id);
+    if (bufItr == process->buffers.end()) {
         ALOGV("failed to register erased recipient, could not retrieve buffer");
         return false;
     }
-    buf->recipients.insert(recipient);
+    bufItr->second.recipients.insert(recipient);
     return true;
 }
 
 void ClientCache::unregisterErasedRecipient(const client_cache_t& cacheId,
                                             const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    auto& [processToken, id] = cacheId;
+    const auto process = processToken != nullptr ? getProcessCache(processToken) : nullptr;
+    if (!process) {
+        ALOGE("failed to unregister erased recipient");
+        return;
+    }
 
-    ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    std::lock_guard lock(process->mutex);
+    auto bufItr = process->buffers.find(id);
+    if (bufItr == process->buffers.end()) {
         ALOGE("failed to unregister erased recipient");
         return;
     }
 
-    buf->recipients.erase(recipient);
+    bufItr->second.recipients.erase(recipient);
 }
 
 void ClientCache::removeProcess(const wp<IBinder>& processToken) {
-    std::vector<std::pair<sp<ErasedRecipient>, client_cache_t>> pendingErase;
+    if (processToken == nullptr) {
+        ALOGE("failed to remove process, invalid (nullptr) process token");
+        return;
+    }
+
+    std::shared_ptr<ProcessCache> process;
     {
-        if (processToken == nullptr) {
-            ALOGE("failed to remove process, invalid (nullptr) process token");
-            return;
-        }
         std::lock_guard lock(mMutex);
-        auto itr = mBuffers.find(processToken);
-        if (itr == mBuffers.end()) {
+        auto itr = mProcesses.find(processToken);
+        if (itr == mProcesses.end()) {
             ALOGE("failed to remove process, could not find process");
             return;
         }
 
-        for (auto& [id, clientCacheBuffer] : itr->second.second) {
+        process = std::move(itr->second);
+        mProcesses.erase(itr);
+        // Invalidate the thread-local shard references so no thread keeps resolving this token
+        // to the removed shard.
+        mGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    std::vector<std::pair<sp<ErasedRecipient>, client_cache_t>> pendingErase;
+    {
+        std::lock_guard lock(process->mutex);
+        for (auto& [id, clientCacheBuffer] : process->buffers) {
             client_cache_t cacheId = {processToken, id};
             for (auto& recipient : clientCacheBuffer.recipients) {
                 sp<ErasedRecipient> erasedRecipient = recipient.promote();
@@ -198,7 +243,8 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
                 }
             }
         }
-        mBuffers.erase(itr);
+        // Clear the shard so any thread still holding a stale reference misses its lookups.
+        process->buffers.clear();
     }
 
     for (auto& [recipient, cacheId] : pendingErase) {
@@ -212,11 +258,11 @@ void ClientCache::CacheDeathRecipient::binderDied(const wp<IBinder>& who) {
 
 void ClientCache::dump(std::string& result) {
     std::lock_guard lock(mMutex);
-    for (auto i : mBuffers) {
-        const sp<IBinder>& cacheOwner = i.second.first;
-        StringAppendF(&result," Cache owner: %p\n", cacheOwner.get());
-        auto &buffers = i.second.second;
-        for (auto& [id, clientCacheBuffer] : buffers) {
+    for (const auto& [processToken, process] : mProcesses) {
+        StringAppendF(&result, " Cache owner: %p\n", process->token.get());
+
+        std::lock_guard processLock(process->mutex);
+        for (auto& [id, clientCacheBuffer] : process->buffers) {
             StringAppendF(&result, "\t ID: %d, Width/Height: %d,%d\n", (int)id,
                           (int)clientCacheBuffer.buffer->getBuffer()->getWidth(),
                           (int)clientCacheBuffer.buffer->getBuffer()->getHeight());
@@ -24,7 +24,9 @@
 #include <utils/RefBase.h>
 #include <utils/Singleton.h>
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <unordered_map>
@@ -61,16 +63,30 @@ public:
     void dump(std::string& result);
 
 private:
-    std::mutex mMutex;
-
     struct ClientCacheBuffer {
         std::shared_ptr<renderengine::ExternalTexture> buffer;
         std::set<wp<ErasedRecipient>> recipients;
     };
-    std::map<wp<IBinder> /*caching process*/,
-             std::pair<sp<IBinder> /*strong ref to caching process*/,
-                       std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>>>
-            mBuffers GUARDED_BY(mMutex);
+
+    // Per-process shard of the cache. Buffer operations only take the shard's own mutex, so
+    // transactions from different clients do not contend with each other, and the global mutex is
+    // only needed to resolve a process token to its shard.
+    struct ProcessCache {
+        sp<IBinder> token; // strong ref to the caching process
+        std::mutex mutex;
+        std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer> buffers GUARDED_BY(mutex);
+    };
+
+    // Returns the shard for the given process, or nullptr if the process has no cached buffers.
+    // In the steady state this resolves through a thread-local reference without taking mMutex.
+    std::shared_ptr<ProcessCache> getProcessCache(const wp<IBinder>& processToken);
+
+    std::mutex mMutex;
+    std::map<wp<IBinder> /*caching process*/, std::shared_ptr<ProcessCache>> mProcesses
+            GUARDED_BY(mMutex);
+    // Bumped whenever a process is removed, invalidating the thread-local shard references held
+    // by getProcessCache.
+    std::atomic<uint32_t> mGeneration{0};
 
     class CacheDeathRecipient : public IBinder::DeathRecipient {
     public:
@@ -79,9 +95,6 @@ private:
 
     sp<CacheDeathRecipient> mDeathRecipient;
     renderengine::RenderEngine* mRenderEngine = nullptr;
-
-    bool getBuffer(const client_cache_t& cacheId, ClientCacheBuffer** outClientCacheBuffer)
-            REQUIRES(mMutex);
 };
 
 }; // namespace android
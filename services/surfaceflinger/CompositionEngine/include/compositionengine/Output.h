@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <bitset>
 #include <cstdint>
 #include <iterator>
 #include <optional>
@@ -148,6 +149,83 @@ public:
         Region aboveOpaqueLayers;
         // The region of the output which should be considered dirty
         Region dirtyRegion;
+
+        // A coarse grid over the layer stack space, where a set bit means the
+        // tile is entirely covered by an opaque layer above. Lets a fully
+        // occluded layer be rejected with a bitmask test before any Region
+        // algebra runs, which matters for deep stacks sitting under a
+        // full-screen opaque layer.
+        static constexpr size_t kOpaqueTileGridDim = 16;
+        Rect opaqueTileGridBounds{Rect::INVALID_RECT};
+        std::bitset<kOpaqueTileGridDim * kOpaqueTileGridDim> opaqueTiles;
+
+        // Marks the tiles that lie entirely inside the given opaque rect.
+        void addOpaqueRect(const Rect& opaqueRect) {
+            Rect rect;
+            int32_t tileWidth, tileHeight;
+            if (!clipToGrid(opaqueRect, rect, tileWidth, tileHeight)) {
+                return;
+            }
+            // The last row/column of tiles is clipped by the grid bounds, so a
+            // rect reaching the edge of the grid covers them entirely.
+            const size_t beginX = static_cast<size_t>(
+                    (rect.left - opaqueTileGridBounds.left + tileWidth - 1) / tileWidth);
+            const size_t endX = rect.right == opaqueTileGridBounds.right
+                    ? kOpaqueTileGridDim
+                    : static_cast<size_t>((rect.right - opaqueTileGridBounds.left) / tileWidth);
+            const size_t beginY = static_cast<size_t>(
+                    (rect.top - opaqueTileGridBounds.top + tileHeight - 1) / tileHeight);
+            const size_t endY = rect.bottom == opaqueTileGridBounds.bottom
+                    ? kOpaqueTileGridDim
+                    : static_cast<size_t>((rect.bottom - opaqueTileGridBounds.top) / tileHeight);
+            for (size_t y = beginY; y < endY; y++) {
+                for (size_t x = beginX; x < endX; x++) {
+                    opaqueTiles.set(y * kOpaqueTileGridDim + x);
+                }
+            }
+        }
+
+        // Returns true if every tile the given rect touches is already opaque,
+        // in which case a layer with that footprint cannot be visible. This is
+        // conservative: a false return says nothing either way.
+        bool isFullyOccluded(const Rect& visibleBounds) const {
+            Rect rect;
+            int32_t tileWidth, tileHeight;
+            if (!clipToGrid(visibleBounds, rect, tileWidth, tileHeight) || rect != visibleBounds) {
+                return false;
+            }
+            const size_t beginX =
+                    static_cast<size_t>((rect.left - opaqueTileGridBounds.left) / tileWidth);
+            const size_t endX = static_cast<size_t>(
+                    (rect.right - opaqueTileGridBounds.left + tileWidth - 1) / tileWidth);
+            const size_t beginY =
+                    static_cast<size_t>((rect.top - opaqueTileGridBounds.top) / tileHeight);
+            const size_t endY = static_cast<size_t>(
+                    (rect.bottom - opaqueTileGridBounds.top + tileHeight - 1) / tileHeight);
+            for (size_t y = beginY; y < endY; y++) {
+                for (size_t x = beginX; x < endX; x++) {
+                    if (!opaqueTiles.test(y * kOpaqueTileGridDim + x)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+    private:
+        bool clipToGrid(const Rect& rect, Rect& outRect, int32_t& outTileWidth,
+                        int32_t& outTileHeight) const {
+            if (!opaqueTileGridBounds.isValid() || opaqueTileGridBounds.isEmpty()) {
+                return false;
+            }
+            outTileWidth = (opaqueTileGridBounds.getWidth() +
+                            static_cast<int32_t>(kOpaqueTileGridDim) - 1) /
+                    static_cast<int32_t>(kOpaqueTileGridDim);
+            outTileHeight = (opaqueTileGridBounds.getHeight() +
+                             static_cast<int32_t>(kOpaqueTileGridDim) - 1) /
+                    static_cast<int32_t>(kOpaqueTileGridDim);
+            return rect.intersect(opaqueTileGridBounds, &outRect);
+        }
     };
 
     bool hasSecureDisplay{false};
@@ -264,6 +342,13 @@ public:
     // Presents the output, finalizing all composition details
     virtual void present(const CompositionRefreshArgs&) = 0;
 
+    // Runs the CPU-only half of present(): color profile selection, per-layer
+    // composition state updates, and composition planning. This only touches
+    // state owned by this output, so it can run for different outputs
+    // concurrently. present() performs these steps itself if this was not
+    // called since the last present.
+    virtual void updateAndPlanComposition(const CompositionRefreshArgs&) = 0;
+
     // Latches the front-end layer state for each output layer
     virtual void updateLayerStateFromFE(const CompositionRefreshArgs&) const = 0;
 
@@ -90,6 +90,12 @@ public:
     // which will fire when the buffer is ready for consumption.
     virtual void queueBuffer(base::unique_fd readyFence) = 0;
 
+    // Returns a previously dequeued buffer to the surface without presenting
+    // it, for when a speculatively composed frame turns out not to be needed.
+    // readyFence is the fence which will fire when the buffer is no longer in
+    // use by the renderer.
+    virtual void cancelBuffer(base::unique_fd readyFence) = 0;
+
     // Called after the HWC calls are made to present the display
     virtual void onPresentDisplayCompleted() = 0;
 
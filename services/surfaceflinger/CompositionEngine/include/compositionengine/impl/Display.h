@@ -22,6 +22,7 @@
 #include <compositionengine/DisplayColorProfile.h>
 #include <compositionengine/DisplayCreationArgs.h>
 #include <compositionengine/RenderSurface.h>
+#include <compositionengine/impl/HwcAsyncWorker.h>
 #include <compositionengine/impl/Output.h>
 #include <ui/PixelFormat.h>
 #include <ui/Size.h>
@@ -51,6 +52,10 @@ public:
     void setColorTransform(const CompositionRefreshArgs&) override;
     void setColorProfile(const ColorProfile&) override;
     void chooseCompositionStrategy() override;
+    bool canPredictCompositionStrategy(const CompositionRefreshArgs&) override;
+    std::future<bool> chooseCompositionStrategyAsync() override;
+    void applyPredictedCompositionStrategy() override;
+    void applyFallbackCompositionStrategy() override;
     bool getSkipColorTransform() const override;
     compositionengine::Output::FrameFences presentAndGetFrameFences() override;
     void setExpensiveRenderingExpected(bool) override;
@@ -67,12 +72,19 @@ public:
     void createClientCompositionCache(uint32_t cacheSize) override;
 
     // Internal helpers used by chooseCompositionStrategy()
+    using DeviceRequestedChanges = android::HWComposer::DeviceRequestedChanges;
     using ChangedTypes = android::HWComposer::DeviceRequestedChanges::ChangedTypes;
     using DisplayRequests = android::HWComposer::DeviceRequestedChanges::DisplayRequests;
     using LayerRequests = android::HWComposer::DeviceRequestedChanges::LayerRequests;
     using ClientTargetProperty = android::HWComposer::DeviceRequestedChanges::ClientTargetProperty;
     virtual bool anyLayersRequireClientComposition() const;
     virtual bool allLayersRequireClientComposition() const;
+    virtual bool getDeviceCompositionChanges(
+            HalDisplayId, bool frameUsesClientComposition,
+            std::chrono::steady_clock::time_point earliestPresentTime,
+            const std::shared_ptr<FenceTime>& previousPresentFence,
+            std::optional<DeviceRequestedChanges>* outChanges);
+    virtual void applyCompositionStrategy(const std::optional<DeviceRequestedChanges>&);
     virtual void applyChangedTypesToLayers(const ChangedTypes&);
     virtual void applyDisplayRequests(const DisplayRequests&);
     virtual void applyLayerRequestsToLayers(const LayerRequests&);
@@ -93,6 +105,18 @@ private:
     composer::DisplayExtnIntf *mDisplayExtnIntf = nullptr;
     void beginDraw();
     void endDraw();
+
+    // Composition strategy prediction state. The worker thread only runs
+    // between chooseCompositionStrategyAsync() and the point where the future
+    // it returned becomes ready, so the members it writes are synchronized
+    // with the main thread by that future.
+    std::unique_ptr<HwcAsyncWorker> mStrategyPredictionWorker;
+    std::optional<DeviceRequestedChanges> mPreviousDeviceRequestedChanges;
+    std::optional<DeviceRequestedChanges> mPredictedChanges;
+    bool mPreviousDeviceRequestedSuccess = false;
+    bool mPredictCompositionStrategy = false;
+    nsecs_t mValidateDurationEwmaNs = 0;
+    nsecs_t mStrategyPredictionThresholdNs = 0;
     ColorProfile mColorProfile = {ui::ColorMode::NATIVE, ui::Dataspace::UNKNOWN,
                                   ui::RenderIntent::COLORIMETRIC, ui::Dataspace::UNKNOWN};
 };
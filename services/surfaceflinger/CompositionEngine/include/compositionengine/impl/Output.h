@@ -22,7 +22,9 @@
 #include <compositionengine/impl/OutputCompositionState.h>
 #include <compositionengine/impl/planner/Planner.h>
 #include <renderengine/DisplaySettings.h>
+#include <renderengine/ExternalTexture.h>
 #include <renderengine/LayerSettings.h>
+#include <future>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -73,6 +75,7 @@ public:
 
     void prepare(const CompositionRefreshArgs&, LayerFESet&) override;
     void present(const CompositionRefreshArgs&) override;
+    void updateAndPlanComposition(const CompositionRefreshArgs&) override;
 
     void rebuildLayerStacks(const CompositionRefreshArgs&, LayerFESet&) override;
     void collectVisibleLayers(const CompositionRefreshArgs&,
@@ -109,6 +112,16 @@ protected:
     std::optional<size_t> findCurrentOutputLayerForLayer(
             const sp<compositionengine::LayerFE>&) const;
     void chooseCompositionStrategy() override;
+    // Predictive composition strategy hooks. When an output can predict its
+    // strategy, present() starts device validation on a worker thread and
+    // composes the client layers against the previous frame's strategy in
+    // parallel, re-rendering only if the prediction missed.
+    virtual bool canPredictCompositionStrategy(const CompositionRefreshArgs&);
+    virtual std::future<bool> chooseCompositionStrategyAsync();
+    virtual void applyPredictedCompositionStrategy();
+    virtual void applyFallbackCompositionStrategy();
+    void prepareFrameAsync(const CompositionRefreshArgs&);
+    void finishPrepareFrame();
     bool getSkipColorTransform() const override;
     compositionengine::Output::FrameFences presentAndGetFrameFences() override;
     std::vector<LayerFE::LayerSettings> generateClientCompositionRequests(
@@ -139,9 +152,20 @@ private:
     std::unique_ptr<compositionengine::RenderSurface> mRenderSurface;
 
     ReleasedLayers mReleasedLayers;
+    // Set when updateAndPlanComposition was called ahead of present() (possibly
+    // from a worker thread), so present() does not repeat that work.
+    bool mCompositionStatePlanned = false;
     OutputLayer* mLayerRequestingBackgroundBlur = nullptr;
     std::unique_ptr<ClientCompositionRequestCache> mClientCompositionRequestCache;
     std::unique_ptr<planner::Planner> mPlanner;
+    // State from prepareFrameAsync(): the ready fence of a speculative render
+    // whose predicted strategy was confirmed, or the buffer (and its draw
+    // fence) of one that missed, for composeSurfaces() to reuse instead of
+    // dequeuing a second buffer for the same frame.
+    bool mComposingSpeculatively = false;
+    std::optional<base::unique_fd> mPredictedReadyFence;
+    std::shared_ptr<renderengine::ExternalTexture> mSpeculativeTex;
+    base::unique_fd mSpeculativeTexFence;
 };
 
 // This template factory function standardizes the implementation details of the
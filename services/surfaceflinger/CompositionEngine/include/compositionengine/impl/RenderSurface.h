@@ -63,6 +63,7 @@ public:
     std::shared_ptr<renderengine::ExternalTexture> dequeueBuffer(
             base::unique_fd* bufferFence) override;
     void queueBuffer(base::unique_fd readyFence) override;
+    void cancelBuffer(base::unique_fd readyFence) override;
     void onPresentDisplayCompleted() override;
     void flip() override;
 
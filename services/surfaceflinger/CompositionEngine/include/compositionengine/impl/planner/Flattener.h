@@ -88,7 +88,8 @@ public:
 private:
     size_t calculateDisplayCost(const std::vector<const LayerState*>& layers) const;
 
-    void resetActivities(NonBufferHash, std::chrono::steady_clock::time_point now);
+    void resetActivities(const std::vector<const LayerState*>& layers, NonBufferHash,
+                         std::chrono::steady_clock::time_point now);
 
     NonBufferHash computeLayersHash() const;
 
@@ -304,6 +304,19 @@ private:
 
     std::vector<ApproximateStack> mApproximateStacks;
 
+    // Memoized results of the approximate-match search, keyed by the flattened stack
+    // fingerprint. Mostly-static content repeats the same few fingerprints frame after frame,
+    // so this turns the linear walk over approximate stacks and candidates into a small lookup
+    // for repeats. Entries age out in LRU order, and the table is flushed whenever the
+    // predictions change in a way that could alter a search result.
+    struct ApproximateMemo {
+        NonBufferHash stackHash;
+        // The matched prediction, or nullopt to memoize a failed search.
+        std::optional<NonBufferHash> predictionHash;
+    };
+    static constexpr const size_t MAX_APPROXIMATE_MEMOS = 8;
+    mutable std::deque<ApproximateMemo> mApproximateMemos;
+
     mutable size_t mExactHitCount = 0;
     mutable size_t mApproximateHitCount = 0;
     mutable size_t mMissCount = 0;
@@ -43,6 +43,7 @@ public:
     MOCK_METHOD2(prepareFrame, void(bool, bool));
     MOCK_METHOD1(dequeueBuffer, std::shared_ptr<renderengine::ExternalTexture>(base::unique_fd*));
     MOCK_METHOD1(queueBuffer, void(base::unique_fd));
+    MOCK_METHOD1(cancelBuffer, void(base::unique_fd));
     MOCK_METHOD1(flipClientTarget, void(bool flip));
     MOCK_METHOD0(onPresentDisplayCompleted, void());
     MOCK_METHOD0(flip, void());
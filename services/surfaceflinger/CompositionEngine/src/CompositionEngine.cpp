@@ -24,6 +24,8 @@
 #include <renderengine/RenderEngine.h>
 #include <utils/Trace.h>
 
+#include <future>
+
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wconversion"
@@ -107,6 +109,26 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
 
     updateLayerStateFromFE(args);
 
+    // Derive and plan each output's composition state. This half of present()
+    // only touches state owned by the respective output, so when several
+    // displays refresh in the same frame the work for the additional outputs
+    // runs on worker threads and joins before the outputs start issuing HWC
+    // and RenderEngine work below, which must stay on this thread.
+    if (args.outputs.size() > 1) {
+        std::vector<std::future<void>> workers;
+        workers.reserve(args.outputs.size() - 1);
+        for (size_t i = 1; i < args.outputs.size(); i++) {
+            workers.push_back(std::async(std::launch::async,
+                                         [&output = args.outputs[i], &args]() {
+                                             output->updateAndPlanComposition(args);
+                                         }));
+        }
+        args.outputs.front()->updateAndPlanComposition(args);
+        for (auto& worker : workers) {
+            worker.wait();
+        }
+    }
+
     for (const auto& output : args.outputs) {
         output->present(args);
     }
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <compositionengine/CompositionEngine.h>
 #include <compositionengine/CompositionRefreshArgs.h>
@@ -77,6 +78,12 @@ void Display::setConfiguration(const compositionengine::DisplayCreationArgs& arg
 
     mDisplayExtnIntf = args.displayExtnIntf;
     ALOGI("Display::setConfiguration: mDisplayExtnIntf: %p", mDisplayExtnIntf);
+
+    mPredictCompositionStrategy =
+            base::GetBoolProperty("debug.sf.predict_hwc_composition_strategy", true);
+    mStrategyPredictionThresholdNs =
+            base::GetIntProperty<nsecs_t>("debug.sf.hwc_strategy_prediction_threshold_us", 1000) *
+            1000;
 }
 
 bool Display::isValid() const {
@@ -266,19 +273,117 @@ void Display::chooseCompositionStrategy() {
     }
 
     // Get any composition changes requested by the HWC device, and apply them.
-    std::optional<android::HWComposer::DeviceRequestedChanges> changes;
-    auto& hwc = getCompositionEngine().getHwComposer();
+    std::optional<DeviceRequestedChanges> changes;
+    beginDraw();
+    mPreviousDeviceRequestedSuccess =
+            getDeviceCompositionChanges(*halDisplayId, anyLayersRequireClientComposition(),
+                                        getState().earliestPresentTime,
+                                        getState().previousPresentFence, &changes);
+    if (!mPreviousDeviceRequestedSuccess) {
+        mPreviousDeviceRequestedChanges.reset();
+        return;
+    }
+    applyCompositionStrategy(changes);
+    mPreviousDeviceRequestedChanges = std::move(changes);
+}
+
+bool Display::canPredictCompositionStrategy(const CompositionRefreshArgs& refreshArgs) {
+    if (!mPredictCompositionStrategy || mIsDisconnected || !getState().isEnabled ||
+        refreshArgs.devOptFlashDirtyRegionsDelay) {
+        return false;
+    }
+
+    // A failed or missing previous validate means there is no strategy to
+    // predict from.
+    if (!mPreviousDeviceRequestedSuccess) {
+        return false;
+    }
+
+    if (!HalDisplayId::tryCast(mId)) {
+        return false;
+    }
+
+    // Only overlap validation with client composition when validation is slow
+    // enough to threaten the frame deadline; for fast validates the re-render
+    // cost of a missed prediction outweighs the overlap.
+    return mValidateDurationEwmaNs >= mStrategyPredictionThresholdNs;
+}
 
+std::future<bool> Display::chooseCompositionStrategyAsync() {
+    ATRACE_CALL();
+    ALOGV(__FUNCTION__);
+
+    if (!mStrategyPredictionWorker) {
+        mStrategyPredictionWorker = std::make_unique<HwcAsyncWorker>();
+    }
+
+    // Snapshot the prediction and everything validation needs on this thread.
+    // The worker only talks to the HWC, so it can run while this thread
+    // renders the client layers.
+    mPredictedChanges = mPreviousDeviceRequestedChanges;
+    const auto halDisplayId = HalDisplayId::tryCast(mId);
+    const bool frameUsesClientComposition = anyLayersRequireClientComposition();
+    const auto earliestPresentTime = getState().earliestPresentTime;
+    const auto previousPresentFence = getState().previousPresentFence;
     beginDraw();
-    if (status_t result =
-                hwc.getDeviceCompositionChanges(*halDisplayId, anyLayersRequireClientComposition(),
-                                                getState().earliestPresentTime,
-                                                getState().previousPresentFence, &changes);
-        result != NO_ERROR) {
+
+    return mStrategyPredictionWorker->send([this, halDisplayId = *halDisplayId,
+                                            frameUsesClientComposition, earliestPresentTime,
+                                            previousPresentFence] {
+        std::optional<DeviceRequestedChanges> changes;
+        mPreviousDeviceRequestedSuccess =
+                getDeviceCompositionChanges(halDisplayId, frameUsesClientComposition,
+                                            earliestPresentTime, previousPresentFence, &changes);
+        if (!mPreviousDeviceRequestedSuccess) {
+            mPreviousDeviceRequestedChanges.reset();
+            return false;
+        }
+        const bool predictionHit = changes == mPredictedChanges;
+        mPreviousDeviceRequestedChanges = std::move(changes);
+        return predictionHit;
+    });
+}
+
+void Display::applyPredictedCompositionStrategy() {
+    // Reset to the base (client-only) settings, then re-apply the last
+    // strategy the device requested.
+    Output::chooseCompositionStrategy();
+    applyCompositionStrategy(mPredictedChanges);
+}
+
+void Display::applyFallbackCompositionStrategy() {
+    // Runs after the prediction future has resolved, so the members written
+    // by the worker are safe to read again.
+    Output::chooseCompositionStrategy();
+    if (mPreviousDeviceRequestedSuccess) {
+        applyCompositionStrategy(mPreviousDeviceRequestedChanges);
+    }
+}
+
+bool Display::getDeviceCompositionChanges(
+        HalDisplayId halDisplayId, bool frameUsesClientComposition,
+        std::chrono::steady_clock::time_point earliestPresentTime,
+        const std::shared_ptr<FenceTime>& previousPresentFence,
+        std::optional<DeviceRequestedChanges>* outChanges) {
+    auto& hwc = getCompositionEngine().getHwComposer();
+    const nsecs_t startTime = systemTime();
+    const status_t result =
+            hwc.getDeviceCompositionChanges(halDisplayId, frameUsesClientComposition,
+                                            earliestPresentTime, previousPresentFence, outChanges);
+    const nsecs_t duration = systemTime() - startTime;
+    // Exponential moving average of the validate duration, used to decide
+    // whether overlapping validation with client composition is worthwhile.
+    mValidateDurationEwmaNs =
+            mValidateDurationEwmaNs == 0 ? duration : (mValidateDurationEwmaNs * 7 + duration) / 8;
+    if (result != NO_ERROR) {
         ALOGE("chooseCompositionStrategy failed for %s: %d (%s)", getName().c_str(), result,
               strerror(-result));
-        return;
+        return false;
     }
+    return true;
+}
+
+void Display::applyCompositionStrategy(const std::optional<DeviceRequestedChanges>& changes) {
     if (changes) {
         applyChangedTypesToLayers(changes->changedTypes);
         applyDisplayRequests(changes->displayRequests);
@@ -429,19 +429,34 @@ void Output::present(const compositionengine::CompositionRefreshArgs& refreshArg
     ATRACE_CALL();
     ALOGV(__FUNCTION__);
 
-    updateColorProfile(refreshArgs);
-    updateCompositionState(refreshArgs);
-    planComposition();
+    if (!mCompositionStatePlanned) {
+        updateAndPlanComposition(refreshArgs);
+    }
+    mCompositionStatePlanned = false;
     writeCompositionState(refreshArgs);
     setColorTransform(refreshArgs);
     beginFrame();
-    prepareFrame();
+    if (canPredictCompositionStrategy(refreshArgs)) {
+        prepareFrameAsync(refreshArgs);
+    } else {
+        prepareFrame();
+    }
     devOptRepaintFlash(refreshArgs);
     finishFrame(refreshArgs);
     postFramebuffer();
     renderCachedSets(refreshArgs);
 }
 
+void Output::updateAndPlanComposition(const compositionengine::CompositionRefreshArgs& refreshArgs) {
+    ATRACE_CALL();
+    ALOGV(__FUNCTION__);
+
+    updateColorProfile(refreshArgs);
+    updateCompositionState(refreshArgs);
+    planComposition();
+    mCompositionStatePlanned = true;
+}
+
 void Output::rebuildLayerStacks(const compositionengine::CompositionRefreshArgs& refreshArgs,
                                 LayerFESet& layerFESet) {
     ATRACE_CALL();
@@ -456,6 +471,7 @@ void Output::rebuildLayerStacks(const compositionengine::CompositionRefreshArgs&
 
     // Process the layers to determine visibility and coverage
     compositionengine::Output::CoverageState coverage{layerFESet};
+    coverage.opaqueTileGridBounds = outputState.layerStackSpace.content;
     collectVisibleLayers(refreshArgs, coverage);
 
     // Compute the resulting coverage for this output, and store it for later
@@ -567,6 +583,15 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
         return;
     }
 
+    // Cheap occlusion cull: if every tile the layer (and its shadow) touches is
+    // already entirely opaque, the Region algebra below would reduce the
+    // visible region to empty anyway. The coverage accumulators do not need an
+    // update either, as the layer's footprint is already contained in both
+    // aboveOpaqueLayers and aboveCoveredLayers.
+    if (coverage.isFullyOccluded(visibleRegion.bounds())) {
+        return;
+    }
+
     // Remove the transparent area from the visible region
     if (!layerFEState->isOpaque) {
         if (tr.preserveRects()) {
@@ -649,6 +674,10 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
 
     // Update accumAboveOpaqueLayers for next (lower) layer
     coverage.aboveOpaqueLayers.orSelf(opaqueRegion);
+    if (!opaqueRegion.isEmpty()) {
+        // The opaque region is a single rect here (the layer's footprint).
+        coverage.addOpaqueRect(opaqueRegion.bounds());
+    }
 
     // Compute the visible non-transparent region
     Region visibleNonTransparentRegion = visibleRegion.subtract(transparentRegion);
@@ -1003,11 +1032,63 @@ void Output::prepareFrame() {
     }
 
     chooseCompositionStrategy();
+    finishPrepareFrame();
+}
+
+void Output::prepareFrameAsync(const compositionengine::CompositionRefreshArgs& refreshArgs) {
+    ATRACE_CALL();
+    ALOGV(__FUNCTION__);
+
+    // Kick device validation off on a worker thread, then compose the client
+    // layers against the strategy the device requested last frame -- in the
+    // steady state it asks for the same thing again.
+    auto strategyPrediction = chooseCompositionStrategyAsync();
+    applyPredictedCompositionStrategy();
+    finishPrepareFrame();
+
+    mComposingSpeculatively = true;
+    auto optReadyFence = composeSurfaces(Region::INVALID_REGION, refreshArgs);
+    mComposingSpeculatively = false;
+
+    if (strategyPrediction.get() && optReadyFence) {
+        ATRACE_NAME("compositionStrategyPredictionHit");
+        // The speculative render already produced this frame's client target;
+        // finishFrame() only needs its ready fence.
+        mSpeculativeTex.reset();
+        mPredictedReadyFence = std::move(optReadyFence);
+        return;
+    }
+
+    ATRACE_NAME("compositionStrategyPredictionMiss");
+    // Adopt the strategy the device actually requested and compose again in
+    // finishFrame(). The buffer the speculative render drew into cannot be
+    // un-dequeued, so either hand it back to composeSurfaces() for the
+    // re-render (gated by the speculative draw fence) or cancel it if the
+    // new strategy needs no client target at all.
+    applyFallbackCompositionStrategy();
+    finishPrepareFrame();
+    mPredictedReadyFence.reset();
 
+    if (!mSpeculativeTex) {
+        return;
+    }
+    base::unique_fd speculativeFence =
+            optReadyFence ? std::move(*optReadyFence) : base::unique_fd();
+    const auto& outputState = getState();
+    if (outputState.usesClientComposition || outputState.flipClientTarget) {
+        mSpeculativeTexFence = std::move(speculativeFence);
+    } else {
+        mRenderSurface->cancelBuffer(std::move(speculativeFence));
+        mSpeculativeTex.reset();
+    }
+}
+
+void Output::finishPrepareFrame() {
     if (mPlanner) {
         mPlanner->reportFinalPlan(getOutputLayersOrderedByZ());
     }
 
+    const auto& outputState = getState();
     mRenderSurface->prepareFrame(outputState.usesClientComposition,
                                  outputState.usesDeviceComposition);
 }
@@ -1046,7 +1127,15 @@ void Output::finishFrame(const compositionengine::CompositionRefreshArgs& refres
 
     // Repaint the framebuffer (if needed), getting the optional fence for when
     // the composition completes.
-    auto optReadyFence = composeSurfaces(Region::INVALID_REGION, refreshArgs);
+    std::optional<base::unique_fd> optReadyFence;
+    if (mPredictedReadyFence) {
+        // prepareFrameAsync() already composed this frame while the device
+        // confirmed the predicted strategy.
+        optReadyFence = std::move(mPredictedReadyFence);
+        mPredictedReadyFence.reset();
+    } else {
+        optReadyFence = composeSurfaces(Region::INVALID_REGION, refreshArgs);
+    }
     if (!optReadyFence) {
         return;
     }
@@ -1100,22 +1189,40 @@ std::optional<base::unique_fd> Output::composeSurfaces(
 
     std::shared_ptr<renderengine::ExternalTexture> tex;
 
+    bool reusedSpeculativeBuffer = false;
+
     // If we aren't doing client composition on this output, but do have a
     // flipClientTarget request for this frame on this output, we still need to
     // dequeue a buffer.
     if (hasClientComposition || outputState.flipClientTarget) {
-        tex = mRenderSurface->dequeueBuffer(&fd);
-        if (tex == nullptr) {
-            ALOGW("Dequeuing buffer for display [%s] failed, bailing out of "
-                  "client composition for this frame",
-                  mName.c_str());
-            return {};
+        if (mSpeculativeTex) {
+            // Reuse the buffer a missed strategy prediction already dequeued
+            // and drew into; its draw fence gates any further use.
+            tex = std::move(mSpeculativeTex);
+            fd = std::move(mSpeculativeTexFence);
+            reusedSpeculativeBuffer = true;
+        } else {
+            tex = mRenderSurface->dequeueBuffer(&fd);
+            if (tex == nullptr) {
+                ALOGW("Dequeuing buffer for display [%s] failed, bailing out of "
+                      "client composition for this frame",
+                      mName.c_str());
+                return {};
+            }
+        }
+        if (mComposingSpeculatively) {
+            mSpeculativeTex = tex;
         }
     }
 
     base::unique_fd readyFence;
     if (!hasClientComposition) {
         setExpensiveRenderingExpected(false);
+        if (reusedSpeculativeBuffer) {
+            // The speculative draw may still be writing into the reused
+            // buffer, so its fence must still gate consumption.
+            return std::move(fd);
+        }
         return readyFence;
     }
 
@@ -1160,6 +1267,11 @@ std::optional<base::unique_fd> Output::composeSurfaces(
                                                    clientCompositionLayers)) {
             outputCompositionState.reusedClientComposition = true;
             setExpensiveRenderingExpected(false);
+            if (reusedSpeculativeBuffer) {
+                // The matching cache entry was added by the speculative draw
+                // into this same buffer, which may still be in flight.
+                return std::move(fd);
+            }
             return readyFence;
         }
         mClientCompositionRequestCache->add(tex->getBuffer()->getId(), clientCompositionDisplay,
@@ -1178,12 +1290,16 @@ std::optional<base::unique_fd> Output::composeSurfaces(
         setExpensiveRenderingExpected(true);
     }
 
-    std::vector<const renderengine::LayerSettings*> clientCompositionLayerPointers;
-    clientCompositionLayerPointers.reserve(clientCompositionLayers.size());
+    // Hand RenderEngine its own copy of the layer settings, sliced down to the base struct it
+    // reads. On the threaded engine the queued frame then owns its inputs, so this thread is
+    // free to keep working (and to reuse clientCompositionLayers) while the frame draws; the
+    // only wait is below, where the draw fence is needed to queue the buffer.
+    std::vector<renderengine::LayerSettings> layerSettings;
+    layerSettings.reserve(clientCompositionLayers.size());
     std::transform(clientCompositionLayers.begin(), clientCompositionLayers.end(),
-                   std::back_inserter(clientCompositionLayerPointers),
-                   [](LayerFE::LayerSettings& settings) -> renderengine::LayerSettings* {
-                       return &settings;
+                   std::back_inserter(layerSettings),
+                   [](const LayerFE::LayerSettings& settings) -> renderengine::LayerSettings {
+                       return settings;
                    });
 
     const nsecs_t renderEngineStart = systemTime();
@@ -1194,9 +1310,13 @@ std::optional<base::unique_fd> Output::composeSurfaces(
     // probably to encapsulate the output buffer into a structure that dispatches resource cleanup
     // over to RenderEngine, in which case this flag can be removed from the drawLayers interface.
     const bool useFramebufferCache = outputState.layerStackInternal;
-    status_t status =
-            renderEngine.drawLayers(clientCompositionDisplay, clientCompositionLayerPointers, tex,
-                                    useFramebufferCache, std::move(fd), &readyFence);
+    std::future<renderengine::RenderEngineResult> drawLayersResult =
+            renderEngine.drawLayersAsync(clientCompositionDisplay, std::move(layerSettings), tex,
+                                         useFramebufferCache, std::move(fd));
+
+    renderengine::RenderEngineResult drawResult = drawLayersResult.get();
+    const status_t status = drawResult.status;
+    readyFence = std::move(drawResult.drawFence);
 
     if (status != NO_ERROR && mClientCompositionRequestCache) {
         // If rendering was not successful, remove the request from the cache.
@@ -1405,6 +1525,26 @@ void Output::chooseCompositionStrategy() {
     outputState.reusedClientComposition = false;
 }
 
+bool Output::canPredictCompositionStrategy(const compositionengine::CompositionRefreshArgs&) {
+    // The base output implementation has no device to validate against, so
+    // there is nothing to overlap with client composition.
+    return false;
+}
+
+std::future<bool> Output::chooseCompositionStrategyAsync() {
+    std::promise<bool> prediction;
+    prediction.set_value(false);
+    return prediction.get_future();
+}
+
+void Output::applyPredictedCompositionStrategy() {
+    chooseCompositionStrategy();
+}
+
+void Output::applyFallbackCompositionStrategy() {
+    chooseCompositionStrategy();
+}
+
 bool Output::getSkipColorTransform() const {
     return true;
 }
@@ -256,6 +256,16 @@ void RenderSurface::queueBuffer(base::unique_fd readyFence) {
     }
 }
 
+void RenderSurface::cancelBuffer(base::unique_fd readyFence) {
+    if (mTexture == nullptr) {
+        return;
+    }
+
+    mNativeWindow->cancelBuffer(mNativeWindow.get(), mTexture->getBuffer()->getNativeBuffer(),
+                                readyFence.release());
+    mTexture = nullptr;
+}
+
 void RenderSurface::onPresentDisplayCompleted() {
     mDisplaySurface->onFrameCommitted();
 }
@@ -86,7 +86,7 @@ NonBufferHash Flattener::flattenLayers(const std::vector<const LayerState*>& lay
     // 3. A stricter equality check demonstrates that the layer stack really did change, since the
     // hashed geometry does not guarantee uniqueness.
     if (mCurrentGeometry != hash || (!mLayers.empty() && !isSameStack(layers, mLayers))) {
-        resetActivities(hash, now);
+        resetActivities(layers, hash, now);
         mFlattenedDisplayCost += unflattenedDisplayCost;
         return hash;
     }
@@ -233,19 +233,68 @@ size_t Flattener::calculateDisplayCost(const std::vector<const LayerState*>& lay
     return displayCost;
 }
 
-void Flattener::resetActivities(NonBufferHash hash, time_point now) {
+void Flattener::resetActivities(const std::vector<const LayerState*>& layers, NonBufferHash hash,
+                                time_point now) {
     ALOGV("[%s]", __func__);
 
     mCurrentGeometry = hash;
     mLastGeometryUpdate = now;
 
-    for (const CachedSet& cachedSet : mLayers) {
-        if (cachedSet.getLayerCount() > 1) {
-            ++mInvalidatedCachedSetAges[cachedSet.getAge()];
+    std::vector<CachedSet> oldSets = std::move(mLayers);
+    mLayers.clear();
+
+    // A geometry change somewhere in the stack does not necessarily touch every cached set, so
+    // salvage the rendered sets whose constituent layers all survive unchanged, still contiguous
+    // and in the same order, instead of re-rendering them after another active-layer timeout. The
+    // per-constituent hash snapshot taken when the layer entered the flattener detects changes
+    // even though the underlying LayerState objects are updated in place. Sets referencing layers
+    // outside themselves (hole punch, blur) are not salvaged, as those layers may be gone.
+    std::unordered_map<int32_t, size_t> salvageable;
+    for (size_t i = 0; i < oldSets.size(); i++) {
+        const CachedSet& set = oldSets[i];
+        if (set.getLayerCount() > 1 && set.hasReadyBuffer() && !set.getHolePunchLayer() &&
+            !set.getBlurLayer()) {
+            salvageable.emplace(set.getFirstLayer().getState()->getId(), i);
         }
     }
 
-    mLayers.clear();
+    std::vector<bool> salvaged(oldSets.size(), false);
+    mLayers.reserve(layers.size());
+    for (size_t i = 0; i < layers.size();) {
+        CachedSet* set = nullptr;
+        if (const auto it = salvageable.find(layers[i]->getId()); it != salvageable.end()) {
+            const auto& constituents = oldSets[it->second].getConstituentLayers();
+            if (i + constituents.size() <= layers.size()) {
+                set = &oldSets[it->second];
+                for (size_t j = 0; j < constituents.size(); j++) {
+                    // A buffer updated on this very frame would leave the rendered texture stale,
+                    // as the merge pass only checks for updates on the frames in between.
+                    if (constituents[j].getState()->getId() != layers[i + j]->getId() ||
+                        constituents[j].getHash() != layers[i + j]->getHash() ||
+                        layers[i + j]->getFramesSinceBufferUpdate() == 0) {
+                        set = nullptr;
+                        break;
+                    }
+                }
+            }
+            if (set) {
+                salvaged[it->second] = true;
+            }
+        }
+        if (set) {
+            i += set->getLayerCount();
+            mLayers.emplace_back(std::move(*set));
+        } else {
+            mLayers.emplace_back(layers[i], now);
+            ++i;
+        }
+    }
+
+    for (size_t i = 0; i < oldSets.size(); i++) {
+        if (!salvaged[i] && oldSets[i].getLayerCount() > 1) {
+            ++mInvalidatedCachedSetAges[oldSets[i].getAge()];
+        }
+    }
 
     if (mNewCachedSet) {
         ++mInvalidatedCachedSetAges[mNewCachedSet->getAge()];
@@ -164,9 +164,26 @@ std::optional<Predictor::PredictedPlan> Predictor::getPredictedPlan(
         return std::nullopt;
     }
 
-    // Then check for approximate matches
-    if (std::optional<NonBufferHash> approximateMatch = getApproximateMatch(layers);
-        approximateMatch) {
+    // Then check for approximate matches. The search result is memoized by the stack
+    // fingerprint, so the linear walk below only runs when the stack genuinely changes.
+    std::optional<NonBufferHash> approximateMatch;
+    if (const auto memoIter = std::find_if(mApproximateMemos.begin(), mApproximateMemos.end(),
+                                           [hash](const ApproximateMemo& memo) {
+                                               return memo.stackHash == hash;
+                                           });
+        memoIter != mApproximateMemos.end()) {
+        approximateMatch = memoIter->predictionHash;
+        // Move the entry to the front so the least recently used one ages out.
+        std::rotate(mApproximateMemos.begin(), memoIter, memoIter + 1);
+    } else {
+        approximateMatch = getApproximateMatch(layers);
+        mApproximateMemos.push_front({hash, approximateMatch});
+        if (mApproximateMemos.size() > MAX_APPROXIMATE_MEMOS) {
+            mApproximateMemos.pop_back();
+        }
+    }
+
+    if (approximateMatch) {
         ALOGV("[%s] Found an approximate match for %zx", __func__, *approximateMatch);
         const Prediction& prediction = getPrediction(*approximateMatch);
         return PredictedPlan{.hash = *approximateMatch,
@@ -197,6 +214,8 @@ void Predictor::recordResult(std::optional<PredictedPlan> predictedPlan,
     if (mCandidates.size() > MAX_CANDIDATES) {
         mCandidates.pop_back();
     }
+    // The new candidate may match stacks whose searches previously failed.
+    mApproximateMemos.clear();
 }
 
 void Predictor::dump(std::string& result) const {
@@ -380,6 +399,9 @@ void Predictor::recordPredictedResult(PredictedPlan predictedPlan,
               to_string(result).c_str());
         prediction.recordMiss(predictedPlan.type);
         ++mMissCount;
+        // Miss counts make getApproximateMatch skip this prediction from now on, so any
+        // memoized searches that resolved to it are stale.
+        mApproximateMemos.clear();
         return;
     }
 
@@ -411,6 +433,7 @@ void Predictor::recordPredictedResult(PredictedPlan predictedPlan,
                     prediction.getExampleLayerStack().getApproximateMatch(layers);
             ALOGE_IF(!approximateMatchOpt, "Expected an approximate match");
             mApproximateStacks.emplace_back(predictedPlan.hash, *approximateMatchOpt);
+            mApproximateMemos.clear();
         }
     }
 
@@ -446,6 +469,7 @@ bool Predictor::findSimilarPrediction(const std::vector<const LayerState*>& laye
     ALOGV("[%s] Adding %zx to approximate stacks", __func__, bestMatch->hash);
 
     mApproximateStacks.emplace_back(*bestMatch);
+    mApproximateMemos.clear();
     return true;
 }
 
@@ -97,6 +97,14 @@ TEST_F(CompositionEnginePresentTest, worksWithEmptyRequest) {
 }
 
 TEST_F(CompositionEnginePresentTest, worksAsExpected) {
+    // With multiple outputs, the composition state for each output is derived
+    // and planned after the front-end state is latched and before any output
+    // is presented, but the outputs are processed concurrently in no
+    // particular order.
+    EXPECT_CALL(*mOutput1, updateAndPlanComposition(Ref(mRefreshArgs)));
+    EXPECT_CALL(*mOutput2, updateAndPlanComposition(Ref(mRefreshArgs)));
+    EXPECT_CALL(*mOutput3, updateAndPlanComposition(Ref(mRefreshArgs)));
+
     // Expect calls to in a certain sequence
     InSequence seq;
 
@@ -647,6 +647,95 @@ TEST_F(DisplayChooseCompositionStrategyTest, normalOperationWithChanges) {
     EXPECT_TRUE(state.usesDeviceComposition);
 }
 
+/*
+ * Display::canPredictCompositionStrategy()
+ * Display::chooseCompositionStrategyAsync()
+ */
+
+using DisplayPredictCompositionStrategyTest = PartialMockDisplayTestCommon;
+
+TEST_F(DisplayPredictCompositionStrategyTest, canPredictRequiresPreviousValidate) {
+    mDisplay->editState().isEnabled = true;
+    CompositionRefreshArgs refreshArgs;
+
+    // Nothing has been validated yet, so there is no strategy to predict from.
+    EXPECT_FALSE(mDisplay->canPredictCompositionStrategy(refreshArgs));
+}
+
+TEST_F(DisplayPredictCompositionStrategyTest, asyncStrategyHitsWhenDeviceRepeatsRequest) {
+    android::HWComposer::DeviceRequestedChanges changes{
+            {{nullptr, hal::Composition::CLIENT}},
+            hal::DisplayRequest::FLIP_CLIENT_TARGET,
+            {{nullptr, hal::LayerRequest::CLEAR_CLIENT_TARGET}},
+            {hal::PixelFormat::RGBA_8888, hal::Dataspace::UNKNOWN},
+    };
+
+    EXPECT_CALL(*mDisplay, anyLayersRequireClientComposition()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mDisplay, allLayersRequireClientComposition()).WillRepeatedly(Return(false));
+    // Applied once by the synchronous validate, once by the predicted apply.
+    EXPECT_CALL(*mDisplay, applyChangedTypesToLayers(changes.changedTypes)).Times(2);
+    EXPECT_CALL(*mDisplay, applyDisplayRequests(changes.displayRequests)).Times(2);
+    EXPECT_CALL(*mDisplay, applyLayerRequestsToLayers(changes.layerRequests)).Times(2);
+    EXPECT_CALL(mHwComposer,
+                getDeviceCompositionChanges(HalDisplayId(DEFAULT_DISPLAY_ID), false, _, _, _))
+            .Times(2)
+            .WillRepeatedly(DoAll(SetArgPointee<4>(changes), Return(NO_ERROR)));
+
+    // Establish a previously validated strategy to predict from.
+    mDisplay->chooseCompositionStrategy();
+
+    // The device requests the same changes again, so the prediction hits.
+    auto prediction = mDisplay->chooseCompositionStrategyAsync();
+    mDisplay->applyPredictedCompositionStrategy();
+    EXPECT_TRUE(prediction.get());
+}
+
+TEST_F(DisplayPredictCompositionStrategyTest, asyncStrategyMissAdoptsNewChanges) {
+    android::HWComposer::DeviceRequestedChanges firstChanges{
+            {{nullptr, hal::Composition::CLIENT}},
+            hal::DisplayRequest::FLIP_CLIENT_TARGET,
+            {{nullptr, hal::LayerRequest::CLEAR_CLIENT_TARGET}},
+            {hal::PixelFormat::RGBA_8888, hal::Dataspace::UNKNOWN},
+    };
+    android::HWComposer::DeviceRequestedChanges secondChanges{
+            {{nullptr, hal::Composition::DEVICE}},
+            hal::DisplayRequest::WRITE_CLIENT_TARGET_TO_OUTPUT,
+            {},
+            {hal::PixelFormat::RGBA_8888, hal::Dataspace::UNKNOWN},
+    };
+
+    EXPECT_CALL(*mDisplay, anyLayersRequireClientComposition()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mDisplay, allLayersRequireClientComposition()).WillRepeatedly(Return(false));
+
+    Sequence s;
+    EXPECT_CALL(mHwComposer,
+                getDeviceCompositionChanges(HalDisplayId(DEFAULT_DISPLAY_ID), false, _, _, _))
+            .InSequence(s)
+            .WillOnce(DoAll(SetArgPointee<4>(firstChanges), Return(NO_ERROR)));
+    EXPECT_CALL(mHwComposer,
+                getDeviceCompositionChanges(HalDisplayId(DEFAULT_DISPLAY_ID), false, _, _, _))
+            .InSequence(s)
+            .WillOnce(DoAll(SetArgPointee<4>(secondChanges), Return(NO_ERROR)));
+
+    // The first changes are applied once by the synchronous validate and once
+    // by the predicted apply; the second changes once by the fallback.
+    EXPECT_CALL(*mDisplay, applyChangedTypesToLayers(firstChanges.changedTypes)).Times(2);
+    EXPECT_CALL(*mDisplay, applyDisplayRequests(firstChanges.displayRequests)).Times(2);
+    EXPECT_CALL(*mDisplay, applyLayerRequestsToLayers(firstChanges.layerRequests)).Times(2);
+    EXPECT_CALL(*mDisplay, applyChangedTypesToLayers(secondChanges.changedTypes)).Times(1);
+    EXPECT_CALL(*mDisplay, applyDisplayRequests(secondChanges.displayRequests)).Times(1);
+    EXPECT_CALL(*mDisplay, applyLayerRequestsToLayers(secondChanges.layerRequests)).Times(1);
+
+    mDisplay->chooseCompositionStrategy();
+
+    // The device requests different changes this frame, so the prediction
+    // misses and the fallback applies what the device actually asked for.
+    auto prediction = mDisplay->chooseCompositionStrategyAsync();
+    mDisplay->applyPredictedCompositionStrategy();
+    EXPECT_FALSE(prediction.get());
+    mDisplay->applyFallbackCompositionStrategy();
+}
+
 /*
  * Display::getSkipColorTransform()
  */
@@ -66,6 +66,8 @@ public:
     MOCK_METHOD3(presentAndGetReleaseFences,
                  status_t(HalDisplayId, std::chrono::steady_clock::time_point,
                           const std::shared_ptr<FenceTime>&));
+    MOCK_METHOD1(presentAndGetReleaseFences,
+                 status_t(const std::vector<android::HWComposer::DisplayPresentRequest>&));
     MOCK_METHOD2(setPowerMode, status_t(PhysicalDisplayId, hal::PowerMode));
     MOCK_METHOD2(setActiveConfig, status_t(HalDisplayId, size_t));
     MOCK_METHOD2(setColorTransform, status_t(HalDisplayId, const mat4&));
@@ -1361,6 +1361,42 @@ TEST_F(OutputEnsureOutputLayerIfVisibleTest, takesEarlyOutIfLayerHasEmptyVisible
     ensureOutputLayerIfVisible();
 }
 
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, takesEarlyOutIfLayerFullyOccludedByOpaqueTiles) {
+    mCoverageState.opaqueTileGridBounds = Rect(0, 0, 200, 300);
+    mCoverageState.addOpaqueRect(Rect(0, 0, 200, 300));
+
+    ensureOutputLayerIfVisible();
+
+    // The cull must not perturb the coverage accumulators.
+    EXPECT_THAT(mCoverageState.aboveCoveredLayers, RegionEq(kEmptyRegion));
+    EXPECT_THAT(mCoverageState.dirtyRegion, RegionEq(kEmptyRegion));
+}
+
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, doesNotCullLayerIfOpaqueTilesOnlyPartiallyCover) {
+    mCoverageState.opaqueTileGridBounds = Rect(0, 0, 200, 300);
+    mCoverageState.addOpaqueRect(Rect(0, 0, 200, 100));
+
+    EXPECT_CALL(mOutput, getOutputLayerCount()).WillOnce(Return(0u));
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(std::nullopt), Eq(mLayer.layerFE)))
+            .WillOnce(Return(&mLayer.outputLayer));
+
+    ensureOutputLayerIfVisible();
+}
+
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, opaqueLayerMarksOpaqueTiles) {
+    mCoverageState.opaqueTileGridBounds = Rect(0, 0, 200, 300);
+
+    EXPECT_CALL(mOutput, getOutputLayerCount()).WillOnce(Return(0u));
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(std::nullopt), Eq(mLayer.layerFE)))
+            .WillOnce(Return(&mLayer.outputLayer));
+
+    ensureOutputLayerIfVisible();
+
+    // A rect strictly inside the layer's footprint only touches opaque tiles.
+    EXPECT_TRUE(mCoverageState.isFullyOccluded(Rect(20, 20, 90, 190)));
+    EXPECT_FALSE(mCoverageState.isFullyOccluded(Rect(0, 0, 200, 300)));
+}
+
 TEST_F(OutputEnsureOutputLayerIfVisibleTest, takesNotSoEarlyOutifDrawRegionEmpty) {
     mOutput.mState.displaySpace.bounds = Rect(0, 0, 0, 0);
 
@@ -1792,6 +1828,30 @@ TEST_F(OutputPresentTest, justInvokesChildFunctionsInSequence) {
     mOutput.present(args);
 }
 
+TEST_F(OutputPresentTest, skipsCompositionStateWhenPlannedAhead) {
+    CompositionRefreshArgs args;
+
+    InSequence seq;
+    EXPECT_CALL(mOutput, updateColorProfile(Ref(args)));
+    EXPECT_CALL(mOutput, updateCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, planComposition());
+
+    mOutput.updateAndPlanComposition(args);
+
+    // Since the composition state was already derived and planned, present()
+    // must not repeat that work and starts at writeCompositionState().
+    EXPECT_CALL(mOutput, writeCompositionState(Ref(args)));
+    EXPECT_CALL(mOutput, setColorTransform(Ref(args)));
+    EXPECT_CALL(mOutput, beginFrame());
+    EXPECT_CALL(mOutput, prepareFrame());
+    EXPECT_CALL(mOutput, devOptRepaintFlash(Ref(args)));
+    EXPECT_CALL(mOutput, finishFrame(Ref(args)));
+    EXPECT_CALL(mOutput, postFramebuffer());
+    EXPECT_CALL(mOutput, renderCachedSets(Ref(args)));
+
+    mOutput.present(args);
+}
+
 /*
  * Output::updateColorProfile()
  */
@@ -347,6 +347,29 @@ TEST_F(RenderSurfaceTest, queueBufferHandlesNativeWindowQueueBufferFailureOnVirt
     EXPECT_EQ(nullptr, mSurface.mutableTextureForTest().get());
 }
 
+/*
+ * RenderSurface::cancelBuffer()
+ */
+
+TEST_F(RenderSurfaceTest, cancelBufferReturnsBufferToNativeWindow) {
+    const auto buffer = std::make_shared<renderengine::ExternalTexture>(new GraphicBuffer(),
+                                                                        mRenderEngine, false);
+    mSurface.mutableTextureForTest() = buffer;
+
+    EXPECT_CALL(*mNativeWindow, cancelBuffer(buffer->getBuffer()->getNativeBuffer(), -1))
+            .WillOnce(Return(NO_ERROR));
+
+    mSurface.cancelBuffer(base::unique_fd());
+
+    EXPECT_EQ(nullptr, mSurface.mutableTextureForTest().get());
+}
+
+TEST_F(RenderSurfaceTest, cancelBufferHandlesNoBufferDequeued) {
+    mSurface.cancelBuffer(base::unique_fd());
+
+    EXPECT_EQ(nullptr, mSurface.mutableTextureForTest().get());
+}
+
 /*
  * RenderSurface::onPresentDisplayCompleted()
  */
@@ -374,6 +374,52 @@ TEST_F(FlattenerTest, flattenLayers_addLayerToFlattenedCauseReset) {
     EXPECT_EQ(nullptr, overrideBuffer3);
 }
 
+TEST_F(FlattenerTest, flattenLayers_geometryChangeElsewhereSalvagesCachedSet) {
+    auto& layerState1 = mTestLayers[0]->layerState;
+    auto& layerState2 = mTestLayers[1]->layerState;
+    auto& layerState3 = mTestLayers[2]->layerState;
+    auto& layerState4 = mTestLayers[3]->layerState;
+
+    std::vector<const LayerState*> layers = {
+            layerState1.get(),
+            layerState2.get(),
+            layerState3.get(),
+    };
+
+    initializeFlattener(layers);
+
+    // make all layers inactive
+    mTime += 200ms;
+    expectAllLayersFlattened(layers);
+
+    const auto cachedBuffer = layerState1->getOutputLayer()->getState().overrideInfo.buffer;
+
+    // Adding a layer after the cached set changes the stack geometry, but the
+    // set's own layers are untouched, so its texture is salvaged instead of
+    // being re-rendered.
+    layers.push_back(layerState4.get());
+
+    initializeOverrideBuffer(layers);
+    EXPECT_EQ(getNonBufferHash(layers),
+              mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+    mFlattener->renderCachedSets(mOutputState, std::nullopt);
+
+    // On the next frame the salvaged texture is reapplied without rendering
+    // anything new.
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _, _, _)).Times(0);
+
+    initializeOverrideBuffer(layers);
+    EXPECT_NE(getNonBufferHash(layers),
+              mFlattener->flattenLayers(layers, getNonBufferHash(layers), mTime));
+    mFlattener->renderCachedSets(mOutputState, std::nullopt);
+
+    EXPECT_NE(nullptr, cachedBuffer);
+    EXPECT_EQ(cachedBuffer, layerState1->getOutputLayer()->getState().overrideInfo.buffer);
+    EXPECT_EQ(cachedBuffer, layerState2->getOutputLayer()->getState().overrideInfo.buffer);
+    EXPECT_EQ(cachedBuffer, layerState3->getOutputLayer()->getState().overrideInfo.buffer);
+    EXPECT_EQ(nullptr, layerState4->getOutputLayer()->getState().overrideInfo.buffer);
+}
+
 TEST_F(FlattenerTest, flattenLayers_BufferUpdateToFlatten) {
     auto& layerState1 = mTestLayers[0]->layerState;
     const auto& overrideBuffer1 = layerState1->getOutputLayer()->getState().overrideInfo.buffer;
@@ -497,6 +497,12 @@ TEST_F(PredictorTest, getPredictedPlan_recordCandidateAndRetrieveApproximateMatc
     EXPECT_TRUE(predictedPlan);
     Predictor::PredictedPlan expectedPlan{hashOne, plan, Prediction::Type::Approximate};
     EXPECT_EQ(expectedPlan, predictedPlan);
+
+    // Repeated queries for the same stack fingerprint are served from the memo table and
+    // must return the same plan.
+    auto repeatedPlan = predictor.getPredictedPlan({&layerStateTwo}, hashTwo);
+    EXPECT_TRUE(repeatedPlan);
+    EXPECT_EQ(expectedPlan, repeatedPlan);
 }
 
 TEST_F(PredictorTest, recordMissedPlan_skipsApproximateMatch) {
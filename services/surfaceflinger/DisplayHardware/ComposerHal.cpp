@@ -617,6 +617,28 @@ Error Composer::presentDisplay(Display display, int* outPresentFence)
     return Error::NONE;
 }
 
+Error Composer::presentDisplays(const std::vector<Display>& displays,
+                                std::vector<int>* outPresentFences) {
+    ATRACE_NAME("HwcPresentDisplays");
+
+    for (Display display : displays) {
+        mWriter.selectDisplay(display);
+        mWriter.presentDisplay();
+    }
+
+    Error error = execute();
+    if (error != Error::NONE) {
+        return error;
+    }
+
+    outPresentFences->resize(displays.size());
+    for (size_t i = 0; i < displays.size(); i++) {
+        mReader.takePresentFence(displays[i], &(*outPresentFences)[i]);
+    }
+
+    return Error::NONE;
+}
+
 Error Composer::setActiveConfig(Display display, Config config)
 {
     auto ret = mClient->setActiveConfig(display, config);
@@ -133,6 +133,15 @@ public:
 
     virtual Error presentDisplay(Display display, int* outPresentFence) = 0;
 
+    /*
+     * Presents all of the given displays with a single command burst and a single
+     * execute, rather than one HAL round trip per display. outPresentFences is
+     * resized to match displays, with entry i holding the present fence of
+     * displays[i].
+     */
+    virtual Error presentDisplays(const std::vector<Display>& displays,
+                                  std::vector<int>* outPresentFences) = 0;
+
     virtual Error setActiveConfig(Display display, Config config) = 0;
 
     /*
@@ -385,6 +394,8 @@ public:
                            std::vector<int>* outReleaseFences) override;
 
     Error presentDisplay(Display display, int* outPresentFence) override;
+    Error presentDisplays(const std::vector<Display>& displays,
+                          std::vector<int>* outPresentFences) override;
 
     Error setActiveConfig(Display display, Config config) override;
 
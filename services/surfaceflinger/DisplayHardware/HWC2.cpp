@@ -702,8 +702,16 @@ Error Layer::setBlendMode(BlendMode mode)
         return Error::BAD_DISPLAY;
     }
 
+    if (mBlendMode == mode) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerBlendMode(mDisplay->getId(), mId, mode);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error != Error::NONE) {
+        return error;
+    }
+    mBlendMode = mode;
+    return error;
 }
 
 Error Layer::setColor(Color color) {
@@ -711,8 +719,17 @@ Error Layer::setColor(Color color) {
         return Error::BAD_DISPLAY;
     }
 
+    if (mColor && mColor->r == color.r && mColor->g == color.g && mColor->b == color.b &&
+        mColor->a == color.a) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerColor(mDisplay->getId(), mId, color);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error != Error::NONE) {
+        return error;
+    }
+    mColor = color;
+    return error;
 }
 
 Error Layer::setCompositionType(Composition type)
@@ -812,10 +829,18 @@ Error Layer::setDisplayFrame(const Rect& frame)
         return Error::BAD_DISPLAY;
     }
 
+    if (mDisplayFrame == frame) {
+        return Error::NONE;
+    }
     Hwc2::IComposerClient::Rect hwcRect{frame.left, frame.top,
         frame.right, frame.bottom};
     auto intError = mComposer.setLayerDisplayFrame(mDisplay->getId(), mId, hwcRect);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error != Error::NONE) {
+        return error;
+    }
+    mDisplayFrame = frame;
+    return error;
 }
 
 Error Layer::setPlaneAlpha(float alpha)
@@ -824,8 +849,16 @@ Error Layer::setPlaneAlpha(float alpha)
         return Error::BAD_DISPLAY;
     }
 
+    if (mPlaneAlpha == alpha) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerPlaneAlpha(mDisplay->getId(), mId, alpha);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error != Error::NONE) {
+        return error;
+    }
+    mPlaneAlpha = alpha;
+    return error;
 }
 
 Error Layer::setSidebandStream(const native_handle_t* stream)
@@ -849,10 +882,18 @@ Error Layer::setSourceCrop(const FloatRect& crop)
         return Error::BAD_DISPLAY;
     }
 
+    if (mSourceCrop == crop) {
+        return Error::NONE;
+    }
     Hwc2::IComposerClient::FRect hwcRect{
         crop.left, crop.top, crop.right, crop.bottom};
     auto intError = mComposer.setLayerSourceCrop(mDisplay->getId(), mId, hwcRect);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error != Error::NONE) {
+        return error;
+    }
+    mSourceCrop = crop;
+    return error;
 }
 
 Error Layer::setTransform(Transform transform)
@@ -861,9 +902,17 @@ Error Layer::setTransform(Transform transform)
         return Error::BAD_DISPLAY;
     }
 
+    if (mTransform == transform) {
+        return Error::NONE;
+    }
     auto intTransform = static_cast<Hwc2::Transform>(transform);
     auto intError = mComposer.setLayerTransform(mDisplay->getId(), mId, intTransform);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error != Error::NONE) {
+        return error;
+    }
+    mTransform = transform;
+    return error;
 }
 
 Error Layer::setVisibleRegion(const Region& region)
@@ -897,8 +946,16 @@ Error Layer::setZOrder(uint32_t z)
         return Error::BAD_DISPLAY;
     }
 
+    if (mZOrder == z) {
+        return Error::NONE;
+    }
     auto intError = mComposer.setLayerZOrder(mDisplay->getId(), mId, z);
-    return static_cast<Error>(intError);
+    Error error = static_cast<Error>(intError);
+    if (error != Error::NONE) {
+        return error;
+    }
+    mZOrder = z;
+    return error;
 }
 
 Error Layer::setType(uint32_t type)
@@ -582,38 +582,86 @@ sp<Fence> HWComposer::getLayerReleaseFence(HalDisplayId displayId, HWC2::Layer*
 status_t HWComposer::presentAndGetReleaseFences(
         HalDisplayId displayId, std::chrono::steady_clock::time_point earliestPresentTime,
         const std::shared_ptr<FenceTime>& previousPresentFence) {
+    return presentAndGetReleaseFences({{displayId, earliestPresentTime, previousPresentFence}});
+}
+
+status_t HWComposer::presentAndGetReleaseFences(
+        const std::vector<DisplayPresentRequest>& requests) {
     ATRACE_CALL();
 
-    RETURN_IF_INVALID_DISPLAY(displayId, BAD_INDEX);
+    std::vector<HalDisplayId> toPresent;
+    std::chrono::steady_clock::time_point earliestPresentTime;
+    bool shouldSleep = false;
 
-    auto& displayData = mDisplayData[displayId];
-    auto& hwcDisplay = displayData.hwcDisplay;
+    for (const auto& request : requests) {
+        const auto displayId = request.displayId;
+        RETURN_IF_INVALID_DISPLAY(displayId, BAD_INDEX);
 
-    if (displayData.validateWasSkipped) {
-        displayData.validateWasSkipped = false;
-        // explicitly flush all pending commands
-        auto error = static_cast<hal::Error>(mComposer->executeCommands());
-        RETURN_IF_HWC_ERROR_FOR("executeCommands", error, displayId, UNKNOWN_ERROR);
-        RETURN_IF_HWC_ERROR_FOR("present", displayData.presentError, displayId, UNKNOWN_ERROR);
+        auto& displayData = mDisplayData[displayId];
+
+        if (displayData.validateWasSkipped) {
+            displayData.validateWasSkipped = false;
+            // explicitly flush all pending commands
+            auto error = static_cast<hal::Error>(mComposer->executeCommands());
+            RETURN_IF_HWC_ERROR_FOR("executeCommands", error, displayId, UNKNOWN_ERROR);
+            RETURN_IF_HWC_ERROR_FOR("present", displayData.presentError, displayId, UNKNOWN_ERROR);
+            continue;
+        }
+
+        displayData.lastPresentFence = Fence::NO_FENCE;
+        const bool previousFramePending =
+                request.previousPresentFence->getSignalTime() == Fence::SIGNAL_TIME_PENDING;
+        if (!previousFramePending) {
+            if (!shouldSleep || request.earliestPresentTime > earliestPresentTime) {
+                earliestPresentTime = request.earliestPresentTime;
+            }
+            shouldSleep = true;
+        }
+
+        toPresent.push_back(displayId);
+    }
+
+    if (toPresent.empty()) {
         return NO_ERROR;
     }
 
-    displayData.lastPresentFence = Fence::NO_FENCE;
-    const bool previousFramePending =
-            previousPresentFence->getSignalTime() == Fence::SIGNAL_TIME_PENDING;
-    if (!previousFramePending) {
+    if (shouldSleep) {
         ATRACE_NAME("wait for earliest present time");
         std::this_thread::sleep_until(earliestPresentTime);
     }
 
-    auto error = hwcDisplay->present(&displayData.lastPresentFence);
-    RETURN_IF_HWC_ERROR_FOR("present", error, displayId, UNKNOWN_ERROR);
+    if (toPresent.size() == 1) {
+        const auto displayId = toPresent.front();
+        auto& displayData = mDisplayData[displayId];
+        auto error = displayData.hwcDisplay->present(&displayData.lastPresentFence);
+        RETURN_IF_HWC_ERROR_FOR("present", error, displayId, UNKNOWN_ERROR);
+    } else {
+        // Issue a single command burst so the HAL presents all displays with one
+        // round trip instead of one execute per display.
+        std::vector<hal::HWDisplayId> halDisplayIds;
+        halDisplayIds.reserve(toPresent.size());
+        for (const auto displayId : toPresent) {
+            halDisplayIds.push_back(mDisplayData[displayId].hwcDisplay->getId());
+        }
+
+        std::vector<int> presentFenceFds;
+        auto error = static_cast<hal::Error>(
+                mComposer->presentDisplays(halDisplayIds, &presentFenceFds));
+        RETURN_IF_HWC_ERROR_FOR("presentDisplays", error, toPresent.front(), UNKNOWN_ERROR);
+
+        for (size_t i = 0; i < toPresent.size(); i++) {
+            mDisplayData[toPresent[i]].lastPresentFence = new Fence(presentFenceFds[i]);
+        }
+    }
 
-    std::unordered_map<HWC2::Layer*, sp<Fence>> releaseFences;
-    error = hwcDisplay->getReleaseFences(&releaseFences);
-    RETURN_IF_HWC_ERROR_FOR("getReleaseFences", error, displayId, UNKNOWN_ERROR);
+    for (const auto displayId : toPresent) {
+        auto& displayData = mDisplayData[displayId];
+        std::unordered_map<HWC2::Layer*, sp<Fence>> releaseFences;
+        auto error = displayData.hwcDisplay->getReleaseFences(&releaseFences);
+        RETURN_IF_HWC_ERROR_FOR("getReleaseFences", error, displayId, UNKNOWN_ERROR);
 
-    displayData.releaseFences = std::move(releaseFences);
+        displayData.releaseFences = std::move(releaseFences);
+    }
 
     return NO_ERROR;
 }
@@ -905,6 +953,24 @@ bool HWComposer::shouldIgnoreHotplugConnect(hal::HWDisplayId hwcDisplayId,
     return false;
 }
 
+std::optional<DisplayIdentificationInfo> HWComposer::parseIdentificationDataCached(
+        uint8_t port, const DisplayIdentificationData& data) {
+    for (const auto& entry : mIdentificationInfoCache) {
+        if (entry.port == port && entry.data == data) {
+            return entry.info;
+        }
+    }
+
+    auto info = parseDisplayIdentificationData(port, data);
+    if (info) {
+        if (mIdentificationInfoCache.size() >= kMaxIdentificationInfoCacheSize) {
+            mIdentificationInfoCache.erase(mIdentificationInfoCache.begin());
+        }
+        mIdentificationInfoCache.push_back({port, data, *info});
+    }
+    return info;
+}
+
 std::optional<DisplayIdentificationInfo> HWComposer::onHotplugConnect(
         hal::HWDisplayId hwcDisplayId) {
     std::optional<DisplayIdentificationInfo> info;
@@ -916,7 +982,7 @@ std::optional<DisplayIdentificationInfo> HWComposer::onHotplugConnect(
             uint8_t port;
             DisplayIdentificationData data;
             getDisplayIdentificationData(hwcDisplayId, &port, &data);
-            if (auto newInfo = parseDisplayIdentificationData(port, data)) {
+            if (auto newInfo = parseIdentificationDataCached(port, data)) {
                 info->deviceProductInfo = std::move(newInfo->deviceProductInfo);
             } else {
                 ALOGE("Failed to parse identification data for display %" PRIu64, hwcDisplayId);
@@ -940,7 +1006,7 @@ std::optional<DisplayIdentificationInfo> HWComposer::onHotplugConnect(
         info = [this, hwcDisplayId, &port, &data, hasDisplayIdentificationData] {
             const bool isPrimary = !mInternalHwcDisplayId;
             if (mHasMultiDisplaySupport) {
-                if (const auto info = parseDisplayIdentificationData(port, data)) {
+                if (const auto info = parseIdentificationDataCached(port, data)) {
                     return *info;
                 }
                 ALOGE("Failed to parse identification data for display %" PRIu64, hwcDisplayId);
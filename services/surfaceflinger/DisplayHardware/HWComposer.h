@@ -84,6 +84,13 @@ public:
         DisplayRequests displayRequests;
         LayerRequests layerRequests;
         ClientTargetProperty clientTargetProperty;
+
+        bool operator==(const DeviceRequestedChanges& other) const {
+            return changedTypes == other.changedTypes &&
+                    displayRequests == other.displayRequests &&
+                    layerRequests == other.layerRequests &&
+                    clientTargetProperty == other.clientTargetProperty;
+        }
     };
 
     struct HWCDisplayMode {
@@ -149,6 +156,16 @@ public:
             HalDisplayId, std::chrono::steady_clock::time_point earliestPresentTime,
             const std::shared_ptr<FenceTime>& previousPresentFence) = 0;
 
+    struct DisplayPresentRequest {
+        HalDisplayId displayId;
+        std::chrono::steady_clock::time_point earliestPresentTime;
+        std::shared_ptr<FenceTime> previousPresentFence;
+    };
+
+    // Same as above for several displays at once, issuing a single HAL command burst and a
+    // single round trip instead of one per display.
+    virtual status_t presentAndGetReleaseFences(const std::vector<DisplayPresentRequest>&) = 0;
+
     // set power mode
     virtual status_t setPowerMode(PhysicalDisplayId, hal::PowerMode) = 0;
 
@@ -300,6 +317,9 @@ public:
             HalDisplayId, std::chrono::steady_clock::time_point earliestPresentTime,
             const std::shared_ptr<FenceTime>& previousPresentFence) override;
 
+    // Same as above for several displays with a single HAL round trip.
+    status_t presentAndGetReleaseFences(const std::vector<DisplayPresentRequest>&) override;
+
     // set power mode
     status_t setPowerMode(PhysicalDisplayId, hal::PowerMode mode) override;
 
@@ -430,6 +450,11 @@ private:
     std::optional<DisplayIdentificationInfo> onHotplugDisconnect(hal::HWDisplayId);
     bool shouldIgnoreHotplugConnect(hal::HWDisplayId, bool hasDisplayIdentificationData) const;
 
+    // Returns the parse result for the given identification blob, reusing the result of an
+    // earlier parse if the same display was connected before.
+    std::optional<DisplayIdentificationInfo> parseIdentificationDataCached(
+            uint8_t port, const DisplayIdentificationData& data);
+
     int32_t getAttribute(hal::HWDisplayId hwcDisplayId, hal::HWConfigId configId,
                          hal::Attribute attribute) const;
 
@@ -448,6 +473,19 @@ private:
     std::optional<hal::HWDisplayId> mExternalHwcDisplayId;
     bool mHasMultiDisplaySupport = false;
 
+    // Cached results of parseDisplayIdentificationData, keyed by the raw identification blob
+    // and the port it was read from. A display that is replugged (e.g. through a docking
+    // station) reports the same EDID every time, so the parse - and the PhysicalDisplayId
+    // derived from it, which therefore stays stable across replugs - can be reused. The full
+    // blob is kept as the key to rule out collisions; EDIDs are at most a few hundred bytes.
+    struct IdentificationInfoCacheEntry {
+        uint8_t port;
+        DisplayIdentificationData data;
+        DisplayIdentificationInfo info;
+    };
+    static constexpr size_t kMaxIdentificationInfoCacheSize = 8;
+    std::vector<IdentificationInfoCacheEntry> mIdentificationInfoCache;
+
     const size_t mMaxVirtualDisplayDimension;
     const bool mUpdateDeviceProductInfoOnHotplugReconnect;
 };
@@ -76,6 +76,10 @@ VirtualDisplaySurface::VirtualDisplaySurface(HWComposer& hwc, VirtualDisplayId d
         mQueueBufferOutput(),
         mSinkBufferWidth(0),
         mSinkBufferHeight(0),
+        mHeldOutputProducerSlot(BufferQueue::INVALID_BUFFER_SLOT),
+        mHeldOutputFence(Fence::NO_FENCE),
+        mHeldOutputFormat(0),
+        mHeldOutputUsage(0),
         mCompositionType(COMPOSITION_UNKNOWN),
         mFbFence(Fence::NO_FENCE),
         mOutputFence(Fence::NO_FENCE),
@@ -125,6 +129,7 @@ VirtualDisplaySurface::VirtualDisplaySurface(HWComposer& hwc, VirtualDisplayId d
 }
 
 VirtualDisplaySurface::~VirtualDisplaySurface() {
+    releaseHeldOutputBuffer();
     mSource[SOURCE_SCRATCH]->disconnect(NATIVE_WINDOW_API_EGL);
 }
 
@@ -287,9 +292,16 @@ void VirtualDisplaySurface::onFrameCommitted() {
         } else {
             // If the surface hadn't actually been updated, then we only went
             // through the motions of updating the display to keep our state
-            // machine happy. We cancel the buffer to avoid triggering another
-            // re-composition and causing an infinite loop.
-            mSource[SOURCE_SINK]->cancelBuffer(sslot, retireFence);
+            // machine happy. Don't queue the buffer, to avoid triggering
+            // another re-composition and causing an infinite loop; instead of
+            // cancelling it back to the sink, retain it so the next
+            // beginFrame() can skip the sink dequeue round trip. The retire
+            // fence gates the next writer.
+            VDS_LOGV("onFrameCommitted: retaining sink sslot=%d", sslot);
+            mHeldOutputProducerSlot = mOutputProducerSlot;
+            mHeldOutputFence = retireFence;
+            mHeldOutputFormat = mOutputFormat;
+            mHeldOutputUsage = mOutputUsage;
         }
     }
 
@@ -594,6 +606,9 @@ status_t VirtualDisplaySurface::connect(const sp<IProducerListener>& listener,
 }
 
 status_t VirtualDisplaySurface::disconnect(int api, DisconnectMode mode) {
+    // The disconnect frees all of the sink's slots, so hand back any retained
+    // output buffer first.
+    releaseHeldOutputBuffer();
     return mSource[SOURCE_SINK]->disconnect(api, mode);
 }
 
@@ -671,14 +686,36 @@ status_t VirtualDisplaySurface::refreshOutputBuffer() {
         mSource[SOURCE_SINK]->cancelBuffer(
                 mapProducer2SourceSlot(SOURCE_SINK, mOutputProducerSlot),
                 mOutputFence);
-    }
+        mOutputProducerSlot = -1;
+    }
+
+    bool reuseHeldBuffer = false;
+    if (mHeldOutputProducerSlot >= 0) {
+        const sp<GraphicBuffer>& heldBuffer = mProducerBuffers[mHeldOutputProducerSlot];
+        reuseHeldBuffer = heldBuffer != nullptr && mOutputFormat == mHeldOutputFormat &&
+                mOutputUsage == mHeldOutputUsage && heldBuffer->getWidth() == mSinkBufferWidth &&
+                heldBuffer->getHeight() == mSinkBufferHeight;
+    }
+    if (reuseHeldBuffer) {
+        // Reuse the output buffer retained when the previous frame was not
+        // queued to the sink, skipping the dequeue round trip.
+        VDS_LOGV("refreshOutputBuffer: reusing held pslot=%d", mHeldOutputProducerSlot);
+        mOutputProducerSlot = mHeldOutputProducerSlot;
+        mOutputFence = mHeldOutputFence;
+        mHeldOutputProducerSlot = BufferQueue::INVALID_BUFFER_SLOT;
+        mHeldOutputFence = Fence::NO_FENCE;
+    } else {
+        // Any held buffer no longer matches what we would request from the
+        // sink; hand it back before dequeueing a fresh one.
+        releaseHeldOutputBuffer();
 
-    int sslot;
-    status_t result = dequeueBuffer(SOURCE_SINK, mOutputFormat, mOutputUsage,
-            &sslot, &mOutputFence);
-    if (result < 0)
-        return result;
-    mOutputProducerSlot = mapSource2ProducerSlot(SOURCE_SINK, sslot);
+        int sslot;
+        status_t result = dequeueBuffer(SOURCE_SINK, mOutputFormat, mOutputUsage,
+                &sslot, &mOutputFence);
+        if (result < 0)
+            return result;
+        mOutputProducerSlot = mapSource2ProducerSlot(SOURCE_SINK, sslot);
+    }
 
     // On GPU-only frames, we don't have the right output buffer acquire fence
     // until after GPU calls queueBuffer(). So here we just set the buffer
@@ -686,10 +723,18 @@ status_t VirtualDisplaySurface::refreshOutputBuffer() {
     // the proper fence once we have it.
     const auto halDisplayId = HalVirtualDisplayId::tryCast(mDisplayId);
     LOG_FATAL_IF(!halDisplayId);
-    result = mHwc.setOutputBuffer(*halDisplayId, Fence::NO_FENCE,
-                                  mProducerBuffers[mOutputProducerSlot]);
+    return mHwc.setOutputBuffer(*halDisplayId, Fence::NO_FENCE,
+                                mProducerBuffers[mOutputProducerSlot]);
+}
 
-    return result;
+void VirtualDisplaySurface::releaseHeldOutputBuffer() {
+    if (mHeldOutputProducerSlot >= 0) {
+        mSource[SOURCE_SINK]->cancelBuffer(
+                mapProducer2SourceSlot(SOURCE_SINK, mHeldOutputProducerSlot),
+                mHeldOutputFence);
+        mHeldOutputProducerSlot = BufferQueue::INVALID_BUFFER_SLOT;
+        mHeldOutputFence = Fence::NO_FENCE;
+    }
 }
 
 // This slot mapping function is its own inverse, so two copies are unnecessary.
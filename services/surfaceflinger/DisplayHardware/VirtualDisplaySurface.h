@@ -141,6 +141,7 @@ private:
     void updateQueueBufferOutput(QueueBufferOutput&&);
     void resetPerFrameState();
     status_t refreshOutputBuffer();
+    void releaseHeldOutputBuffer();
 
     // Both the sink and scratch buffer pools have their own set of slots
     // ("source slots", or "sslot"). We have to merge these into the single
@@ -195,6 +196,16 @@ private:
     // dequeued from the sink, and are used when queueing the buffer.
     uint32_t mSinkBufferWidth, mSinkBufferHeight;
 
+    // Output buffer retained from a frame that was not queued to the sink
+    // (mMustRecompose was false). The next refreshOutputBuffer() reuses it
+    // instead of dequeueing from the sink again, as long as the format and
+    // usage it was dequeued with still match what we would request. This
+    // keeps no-change frames free of sink round trips.
+    int mHeldOutputProducerSlot;
+    sp<Fence> mHeldOutputFence;
+    uint32_t mHeldOutputFormat;
+    uint64_t mHeldOutputUsage;
+
     //
     // Intra-frame state
     //
@@ -24,6 +24,7 @@
 #include <utils/Log.h>
 #include <utils/Trace.h>
 
+#include <atomic>
 #include <chrono>
 #include <cinttypes>
 #include <numeric>
@@ -735,22 +736,51 @@ namespace impl {
 
 int64_t TokenManager::generateTokenForPredictions(TimelineItem&& predictions) {
     ATRACE_CALL();
-    std::scoped_lock lock(mMutex);
-    while (mPredictions.size() >= kMaxTokens) {
-        mPredictions.erase(mPredictions.begin());
-    }
-    const int64_t assignedToken = mCurrentToken++;
-    mPredictions[assignedToken] = predictions;
+    const int64_t assignedToken = mCurrentToken.fetch_add(1, std::memory_order_relaxed);
+    PredictionSlot& slot = mPredictionSlots[static_cast<size_t>(assignedToken) % kMaxTokens];
+
+    // Claim the slot by making its sequence odd. A slot is reused only after kMaxTokens newer
+    // tokens, so losing this race means the writer stalled for seconds; yield to the newer token
+    // and let this one expire rather than tear the slot.
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) ||
+        !slot.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                               std::memory_order_acq_rel)) {
+        return assignedToken;
+    }
+    // Order the odd-sequence store before the data stores; otherwise a reader
+    // could pass both sequence checks against the old even value and observe a
+    // torn slot.
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.token = assignedToken;
+    slot.predictions = predictions;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
     return assignedToken;
 }
 
 std::optional<TimelineItem> TokenManager::getPredictionsForToken(int64_t token) const {
-    std::scoped_lock lock(mMutex);
-    auto predictionsIterator = mPredictions.find(token);
-    if (predictionsIterator != mPredictions.end()) {
-        return predictionsIterator->second;
+    if (token <= FrameTimelineInfo::INVALID_VSYNC_ID) {
+        return {};
+    }
+    const PredictionSlot& slot = mPredictionSlots[static_cast<size_t>(token) % kMaxTokens];
+    while (true) {
+        const uint64_t startSequence = slot.sequence.load(std::memory_order_acquire);
+        if (startSequence & 1) {
+            // A write is in progress; it only spans a few stores.
+            continue;
+        }
+        const int64_t storedToken = slot.token;
+        const TimelineItem predictions = slot.predictions;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != startSequence) {
+            continue;
+        }
+        if (storedToken != token) {
+            // The slot was never filled or was recycled by a newer token.
+            return {};
+        }
+        return predictions;
     }
-    return {};
 }
 
 FrameTimeline::FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
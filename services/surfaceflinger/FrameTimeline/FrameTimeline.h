@@ -28,6 +28,8 @@
 #include <utils/Timers.h>
 #include <utils/Vector.h>
 
+#include <array>
+#include <atomic>
 #include <deque>
 #include <mutex>
 
@@ -330,12 +332,21 @@ private:
     // Friend class for testing
     friend class android::frametimeline::FrameTimelineTest;
 
-    void flushTokens(nsecs_t flushTime) REQUIRES(mMutex);
+    // Tokens are sequential, so the predictions live in a fixed array of slots indexed by
+    // token % kMaxTokens. This gives O(1) lookup with the same retention as a sorted map bounded
+    // to kMaxTokens entries: a token stays queryable until kMaxTokens newer tokens have recycled
+    // its slot. Each slot carries its own sequence counter, odd while a write is in progress, so
+    // lookups from binder threads are lock-free and never contend with the event threads
+    // generating tokens.
+    struct PredictionSlot {
+        std::atomic<uint64_t> sequence{0};
+        int64_t token = FrameTimelineInfo::INVALID_VSYNC_ID;
+        TimelineItem predictions;
+    };
 
-    std::map<int64_t, TimelineItem> mPredictions GUARDED_BY(mMutex);
-    int64_t mCurrentToken GUARDED_BY(mMutex);
-    mutable std::mutex mMutex;
     static constexpr size_t kMaxTokens = 500;
+    std::array<PredictionSlot, kMaxTokens> mPredictionSlots;
+    std::atomic<int64_t> mCurrentToken;
 };
 
 class FrameTimeline : public android::frametimeline::FrameTimeline {
@@ -49,11 +49,20 @@ void FrameTracer::registerDataSource() {
     FrameTracerDataSource::Register(dsd);
 }
 
+std::vector<FrameTracer::BufferEvent>& FrameTracer::eventBatchForThread() {
+    // A buffer event plus its pending fences rarely exceeds a handful of entries, so the batch
+    // reaches a steady-state capacity after the first few calls on each thread and collecting
+    // events is allocation-free from then on.
+    static thread_local std::vector<BufferEvent> batch;
+    batch.clear();
+    return batch;
+}
+
 void FrameTracer::traceNewLayer(int32_t layerId, const std::string& layerName) {
     FrameTracerDataSource::Trace([this, layerId, &layerName](FrameTracerDataSource::TraceContext) {
         if (mTraceTracker.find(layerId) == mTraceTracker.end()) {
             std::lock_guard<std::mutex> lock(mTraceMutex);
-            mTraceTracker[layerId].layerName = layerName;
+            mTraceTracker[layerId].layerName = std::make_shared<const std::string>(layerName);
         }
     });
 }
@@ -63,16 +72,22 @@ void FrameTracer::traceTimestamp(int32_t layerId, uint64_t bufferID, uint64_t fr
                                  nsecs_t duration) {
     FrameTracerDataSource::Trace([this, layerId, bufferID, frameNumber, timestamp, type,
                                   duration](FrameTracerDataSource::TraceContext ctx) {
-        std::lock_guard<std::mutex> lock(mTraceMutex);
-        if (mTraceTracker.find(layerId) == mTraceTracker.end()) {
-            return;
-        }
+        auto& batch = eventBatchForThread();
+        {
+            std::lock_guard<std::mutex> lock(mTraceMutex);
+            const auto it = mTraceTracker.find(layerId);
+            if (it == mTraceTracker.end()) {
+                return;
+            }
 
-        // Handle any pending fences for this buffer.
-        tracePendingFencesLocked(ctx, layerId, bufferID);
+            // Collect any pending fences for this buffer.
+            collectPendingFencesLocked(batch, it->second, bufferID);
 
-        // Complete current trace.
-        traceLocked(ctx, layerId, bufferID, frameNumber, timestamp, type, duration);
+            // Collect current trace.
+            batch.push_back({bufferID, frameNumber, timestamp, type, duration,
+                             it->second.layerName});
+        }
+        emitBatch(ctx, batch);
     });
 }
 
@@ -83,31 +98,36 @@ void FrameTracer::traceFence(int32_t layerId, uint64_t bufferID, uint64_t frameN
                                   startTime](FrameTracerDataSource::TraceContext ctx) {
         const nsecs_t signalTime = fence->getSignalTime();
         if (signalTime != Fence::SIGNAL_TIME_INVALID) {
-            std::lock_guard<std::mutex> lock(mTraceMutex);
-            if (mTraceTracker.find(layerId) == mTraceTracker.end()) {
-                return;
-            }
+            auto& batch = eventBatchForThread();
+            {
+                std::lock_guard<std::mutex> lock(mTraceMutex);
+                const auto it = mTraceTracker.find(layerId);
+                if (it == mTraceTracker.end()) {
+                    return;
+                }
 
-            // Handle any pending fences for this buffer.
-            tracePendingFencesLocked(ctx, layerId, bufferID);
-
-            if (signalTime != Fence::SIGNAL_TIME_PENDING) {
-                traceSpanLocked(ctx, layerId, bufferID, frameNumber, type, startTime, signalTime);
-            } else {
-                mTraceTracker[layerId].pendingFences[bufferID].push_back(
-                        {.frameNumber = frameNumber,
-                         .type = type,
-                         .fence = fence,
-                         .startTime = startTime});
+                // Collect any pending fences for this buffer.
+                collectPendingFencesLocked(batch, it->second, bufferID);
+
+                if (signalTime != Fence::SIGNAL_TIME_PENDING) {
+                    collectSpan(batch, it->second, bufferID, frameNumber, type, startTime,
+                                signalTime);
+                } else {
+                    it->second.pendingFences[bufferID].push_back({.frameNumber = frameNumber,
+                                                                  .type = type,
+                                                                  .fence = fence,
+                                                                  .startTime = startTime});
+                }
             }
+            emitBatch(ctx, batch);
         }
     });
 }
 
-void FrameTracer::tracePendingFencesLocked(FrameTracerDataSource::TraceContext& ctx,
-                                           int32_t layerId, uint64_t bufferID) {
-    if (mTraceTracker[layerId].pendingFences.count(bufferID)) {
-        auto& pendingFences = mTraceTracker[layerId].pendingFences[bufferID];
+void FrameTracer::collectPendingFencesLocked(std::vector<BufferEvent>& batch, TraceRecord& record,
+                                             uint64_t bufferID) {
+    if (record.pendingFences.count(bufferID)) {
+        auto& pendingFences = record.pendingFences[bufferID];
         for (size_t i = 0; i < pendingFences.size(); ++i) {
             auto& pendingFence = pendingFences[i];
 
@@ -121,8 +141,8 @@ void FrameTracer::tracePendingFencesLocked(FrameTracerDataSource::TraceContext&
 
             if (signalTime != Fence::SIGNAL_TIME_INVALID &&
                 systemTime() - signalTime < kFenceSignallingDeadline) {
-                traceSpanLocked(ctx, layerId, bufferID, pendingFence.frameNumber, pendingFence.type,
-                                pendingFence.startTime, signalTime);
+                collectSpan(batch, record, bufferID, pendingFence.frameNumber, pendingFence.type,
+                            pendingFence.startTime, signalTime);
             }
 
             pendingFences.erase(pendingFences.begin() + i);
@@ -131,41 +151,40 @@ void FrameTracer::tracePendingFencesLocked(FrameTracerDataSource::TraceContext&
     }
 }
 
-void FrameTracer::traceLocked(FrameTracerDataSource::TraceContext& ctx, int32_t layerId,
-                              uint64_t bufferID, uint64_t frameNumber, nsecs_t timestamp,
-                              FrameEvent::BufferEventType type, nsecs_t duration) {
-    auto packet = ctx.NewTracePacket();
-    packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
-    packet->set_timestamp(timestamp);
-    auto* event = packet->set_graphics_frame_event()->set_buffer_event();
-    event->set_buffer_id(static_cast<uint32_t>(bufferID));
-    if (frameNumber != UNSPECIFIED_FRAME_NUMBER) {
-        event->set_frame_number(frameNumber);
-    }
-    event->set_type(type);
-
-    if (mTraceTracker.find(layerId) != mTraceTracker.end() &&
-        !mTraceTracker[layerId].layerName.empty()) {
-        const std::string& layerName = mTraceTracker[layerId].layerName;
-        event->set_layer_name(layerName.c_str(), layerName.size());
-    }
-
-    if (duration > 0) {
-        event->set_duration_ns(duration);
-    }
-}
-
-void FrameTracer::traceSpanLocked(FrameTracerDataSource::TraceContext& ctx, int32_t layerId,
-                                  uint64_t bufferID, uint64_t frameNumber,
-                                  FrameEvent::BufferEventType type, nsecs_t startTime,
-                                  nsecs_t endTime) {
+void FrameTracer::collectSpan(std::vector<BufferEvent>& batch, const TraceRecord& record,
+                              uint64_t bufferID, uint64_t frameNumber,
+                              FrameEvent::BufferEventType type, nsecs_t startTime,
+                              nsecs_t endTime) {
     nsecs_t timestamp = endTime;
     nsecs_t duration = 0;
     if (startTime > 0 && startTime < endTime) {
         timestamp = startTime;
         duration = endTime - startTime;
     }
-    traceLocked(ctx, layerId, bufferID, frameNumber, timestamp, type, duration);
+    batch.push_back({bufferID, frameNumber, timestamp, type, duration, record.layerName});
+}
+
+void FrameTracer::emitBatch(FrameTracerDataSource::TraceContext& ctx,
+                            const std::vector<BufferEvent>& batch) {
+    for (const auto& bufferEvent : batch) {
+        auto packet = ctx.NewTracePacket();
+        packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
+        packet->set_timestamp(bufferEvent.timestamp);
+        auto* event = packet->set_graphics_frame_event()->set_buffer_event();
+        event->set_buffer_id(static_cast<uint32_t>(bufferEvent.bufferID));
+        if (bufferEvent.frameNumber != UNSPECIFIED_FRAME_NUMBER) {
+            event->set_frame_number(bufferEvent.frameNumber);
+        }
+        event->set_type(bufferEvent.type);
+
+        if (bufferEvent.layerName && !bufferEvent.layerName->empty()) {
+            event->set_layer_name(bufferEvent.layerName->c_str(), bufferEvent.layerName->size());
+        }
+
+        if (bufferEvent.duration > 0) {
+            event->set_duration_ns(bufferEvent.duration);
+        }
+    }
 }
 
 void FrameTracer::onDestroy(int32_t layerId) {
@@ -20,8 +20,10 @@
 #include <perfetto/tracing.h>
 #include <ui/FenceTime.h>
 
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace android {
 
@@ -81,24 +83,40 @@ private:
     };
 
     struct TraceRecord {
-        std::string layerName;
+        // Shared so collected events can reference the name after mTraceMutex is released, even
+        // if the layer is destroyed in between.
+        std::shared_ptr<const std::string> layerName;
         using BufferID = uint64_t;
         std::unordered_map<BufferID, std::vector<PendingFence>> pendingFences;
     };
 
-    // Checks if any pending fences for a layer and buffer have signalled and, if they have, creates
-    // trace points for them.
-    void tracePendingFencesLocked(FrameTracerDataSource::TraceContext& ctx, int32_t layerId,
-                                  uint64_t bufferID);
-    // Creates a trace point by translating a start time and an end time to a timestamp and
-    // duration. If startTime is later than end time it sets end time as the timestamp and the
+    // A fully resolved buffer event, collected under mTraceMutex and emitted as a proto packet
+    // after the mutex is released so serialization never runs inside the critical section.
+    struct BufferEvent {
+        uint64_t bufferID;
+        uint64_t frameNumber;
+        nsecs_t timestamp;
+        FrameEvent::BufferEventType type;
+        nsecs_t duration;
+        std::shared_ptr<const std::string> layerName;
+    };
+
+    // Preallocated per-thread batch, so collecting events does not allocate per call.
+    static std::vector<BufferEvent>& eventBatchForThread();
+
+    // Checks if any pending fences for a layer and buffer have signalled and, if they have,
+    // appends trace points for them to the batch.
+    void collectPendingFencesLocked(std::vector<BufferEvent>& batch, TraceRecord& record,
+                                    uint64_t bufferID);
+    // Appends a trace point to the batch, translating a start time and an end time to a timestamp
+    // and duration. If startTime is later than end time it sets end time as the timestamp and the
     // duration to 0. Used by traceFence().
-    void traceSpanLocked(FrameTracerDataSource::TraceContext& ctx, int32_t layerId,
-                         uint64_t bufferID, uint64_t frameNumber, FrameEvent::BufferEventType type,
-                         nsecs_t startTime, nsecs_t endTime);
-    void traceLocked(FrameTracerDataSource::TraceContext& ctx, int32_t layerId, uint64_t bufferID,
-                     uint64_t frameNumber, nsecs_t timestamp, FrameEvent::BufferEventType type,
-                     nsecs_t duration = 0);
+    static void collectSpan(std::vector<BufferEvent>& batch, const TraceRecord& record,
+                            uint64_t bufferID, uint64_t frameNumber,
+                            FrameEvent::BufferEventType type, nsecs_t startTime, nsecs_t endTime);
+    // Emits all events in the batch as proto packets through a single trace context.
+    static void emitBatch(FrameTracerDataSource::TraceContext& ctx,
+                          const std::vector<BufferEvent>& batch);
 
     std::mutex mTraceMutex;
     std::unordered_map<int32_t, TraceRecord> mTraceTracker;
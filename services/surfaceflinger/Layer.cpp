@@ -764,6 +764,7 @@ uint32_t Layer::getTransactionFlags(uint32_t flags) {
 }
 
 uint32_t Layer::setTransactionFlags(uint32_t flags) {
+    markPendingUpdate();
     return mTransactionFlags |= flags;
 }
 
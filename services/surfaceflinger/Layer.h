@@ -579,6 +579,16 @@ public:
      */
     virtual bool hasReadyFrame() const { return false; }
 
+    /*
+     * Pending-update mark, used by SurfaceFlinger::handlePageFlip to visit only layers that
+     * may have work for a latch pass (a queued frame, a pending transaction, a sideband or
+     * auto-refresh change) instead of querying every layer each vsync. The mark is consumed
+     * at the start of a visit and set again while the layer still has a frame ready, so a
+     * layer is always visited one more time after it goes idle to clear its damage.
+     */
+    void markPendingUpdate() { mPendingUpdate = true; }
+    bool consumePendingUpdate() { return mPendingUpdate.exchange(false); }
+
     virtual int32_t getQueuedFrameCount() const { return 0; }
 
     /**
@@ -1006,6 +1016,9 @@ protected:
 
     std::atomic<bool> mRemovedFromDrawingState{false};
 
+    // Set when this layer may have work for the next latch pass; see markPendingUpdate().
+    std::atomic<bool> mPendingUpdate{false};
+
     // page-flip thread (currently main thread)
     bool mProtectedByApp{false}; // application requires protected path to external sink
 
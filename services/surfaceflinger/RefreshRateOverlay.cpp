@@ -20,6 +20,7 @@
 #pragma clang diagnostic ignored "-Wextra"
 
 #include <algorithm>
+#include <cstring>
 
 #include "RefreshRateOverlay.h"
 #include "Client.h"
@@ -32,81 +33,119 @@
 
 namespace android {
 
-void RefreshRateOverlay::SevenSegmentDrawer::drawRect(const Rect& r, const half4& color,
-                                                      const sp<GraphicBuffer>& buffer,
-                                                      uint8_t* pixels) {
+void RefreshRateOverlay::SevenSegmentDrawer::drawRect(const Rect& r, uint8_t* mask) {
     for (int32_t j = r.top; j < r.bottom; j++) {
-        if (j >= buffer->getHeight()) {
+        if (j >= DIGIT_HEIGHT) {
             break;
         }
 
         for (int32_t i = r.left; i < r.right; i++) {
-            if (i >= buffer->getWidth()) {
+            if (i >= DIGIT_WIDTH) {
                 break;
             }
 
-            uint8_t* iter = pixels + 4 * (i + (buffer->getStride() * j));
-            iter[0] = uint8_t(color.r * 255);
-            iter[1] = uint8_t(color.g * 255);
-            iter[2] = uint8_t(color.b * 255);
-            iter[3] = uint8_t(color.a * 255);
+            mask[i + DIGIT_WIDTH * j] = 0xff;
         }
     }
 }
 
-void RefreshRateOverlay::SevenSegmentDrawer::drawSegment(Segment segment, int left,
-                                                         const half4& color,
-                                                         const sp<GraphicBuffer>& buffer,
-                                                         uint8_t* pixels) {
+void RefreshRateOverlay::SevenSegmentDrawer::drawSegment(Segment segment, uint8_t* mask) {
     const Rect rect = [&]() {
         switch (segment) {
             case Segment::Upper:
-                return Rect(left, 0, left + DIGIT_WIDTH, DIGIT_SPACE);
+                return Rect(0, 0, DIGIT_WIDTH, DIGIT_SPACE);
             case Segment::UpperLeft:
-                return Rect(left, 0, left + DIGIT_SPACE, DIGIT_HEIGHT / 2);
+                return Rect(0, 0, DIGIT_SPACE, DIGIT_HEIGHT / 2);
             case Segment::UpperRight:
-                return Rect(left + DIGIT_WIDTH - DIGIT_SPACE, 0, left + DIGIT_WIDTH,
-                            DIGIT_HEIGHT / 2);
+                return Rect(DIGIT_WIDTH - DIGIT_SPACE, 0, DIGIT_WIDTH, DIGIT_HEIGHT / 2);
             case Segment::Middle:
-                return Rect(left, DIGIT_HEIGHT / 2 - DIGIT_SPACE / 2, left + DIGIT_WIDTH,
+                return Rect(0, DIGIT_HEIGHT / 2 - DIGIT_SPACE / 2, DIGIT_WIDTH,
                             DIGIT_HEIGHT / 2 + DIGIT_SPACE / 2);
             case Segment::LowerLeft:
-                return Rect(left, DIGIT_HEIGHT / 2, left + DIGIT_SPACE, DIGIT_HEIGHT);
+                return Rect(0, DIGIT_HEIGHT / 2, DIGIT_SPACE, DIGIT_HEIGHT);
             case Segment::LowerRight:
-                return Rect(left + DIGIT_WIDTH - DIGIT_SPACE, DIGIT_HEIGHT / 2, left + DIGIT_WIDTH,
-                            DIGIT_HEIGHT);
+                return Rect(DIGIT_WIDTH - DIGIT_SPACE, DIGIT_HEIGHT / 2, DIGIT_WIDTH, DIGIT_HEIGHT);
             case Segment::Buttom:
-                return Rect(left, DIGIT_HEIGHT - DIGIT_SPACE, left + DIGIT_WIDTH, DIGIT_HEIGHT);
+                return Rect(0, DIGIT_HEIGHT - DIGIT_SPACE, DIGIT_WIDTH, DIGIT_HEIGHT);
         }
     }();
 
-    drawRect(rect, color, buffer, pixels);
+    drawRect(rect, mask);
 }
 
-void RefreshRateOverlay::SevenSegmentDrawer::drawDigit(int digit, int left, const half4& color,
-                                                       const sp<GraphicBuffer>& buffer,
-                                                       uint8_t* pixels) {
+void RefreshRateOverlay::SevenSegmentDrawer::drawDigit(int digit, uint8_t* mask) {
     if (digit < 0 || digit > 9) return;
 
     if (digit == 0 || digit == 2 || digit == 3 || digit == 5 || digit == 6 || digit == 7 ||
         digit == 8 || digit == 9)
-        drawSegment(Segment::Upper, left, color, buffer, pixels);
+        drawSegment(Segment::Upper, mask);
     if (digit == 0 || digit == 4 || digit == 5 || digit == 6 || digit == 8 || digit == 9)
-        drawSegment(Segment::UpperLeft, left, color, buffer, pixels);
+        drawSegment(Segment::UpperLeft, mask);
     if (digit == 0 || digit == 1 || digit == 2 || digit == 3 || digit == 4 || digit == 7 ||
         digit == 8 || digit == 9)
-        drawSegment(Segment::UpperRight, left, color, buffer, pixels);
+        drawSegment(Segment::UpperRight, mask);
     if (digit == 2 || digit == 3 || digit == 4 || digit == 5 || digit == 6 || digit == 8 ||
         digit == 9)
-        drawSegment(Segment::Middle, left, color, buffer, pixels);
+        drawSegment(Segment::Middle, mask);
     if (digit == 0 || digit == 2 || digit == 6 || digit == 8)
-        drawSegment(Segment::LowerLeft, left, color, buffer, pixels);
+        drawSegment(Segment::LowerLeft, mask);
     if (digit == 0 || digit == 1 || digit == 3 || digit == 4 || digit == 5 || digit == 6 ||
         digit == 7 || digit == 8 || digit == 9)
-        drawSegment(Segment::LowerRight, left, color, buffer, pixels);
+        drawSegment(Segment::LowerRight, mask);
     if (digit == 0 || digit == 2 || digit == 3 || digit == 5 || digit == 6 || digit == 8 ||
         digit == 9)
-        drawSegment(Segment::Buttom, left, color, buffer, pixels);
+        drawSegment(Segment::Buttom, mask);
+}
+
+const RefreshRateOverlay::SevenSegmentDrawer::Atlas&
+RefreshRateOverlay::SevenSegmentDrawer::getAtlas() {
+    static const Atlas atlas = [] {
+        Atlas atlas;
+        for (auto& digit : atlas.digits) {
+            digit.fill(0);
+        }
+        for (auto& segment : atlas.segments) {
+            segment.fill(0);
+        }
+        for (int digit = 0; digit <= 9; digit++) {
+            drawDigit(digit, atlas.digits[digit].data());
+        }
+        for (size_t segment = 0; segment < atlas.segments.size(); segment++) {
+            drawSegment(static_cast<Segment>(segment), atlas.segments[segment].data());
+        }
+        return atlas;
+    }();
+    return atlas;
+}
+
+void RefreshRateOverlay::SevenSegmentDrawer::blitMask(const uint8_t* mask, int left,
+                                                      const half4& color,
+                                                      const sp<GraphicBuffer>& buffer,
+                                                      uint8_t* pixels) {
+    const uint8_t r = uint8_t(color.r * 255);
+    const uint8_t g = uint8_t(color.g * 255);
+    const uint8_t b = uint8_t(color.b * 255);
+    const uint8_t a = uint8_t(color.a * 255);
+    for (uint32_t j = 0; j < DIGIT_HEIGHT; j++) {
+        if (j >= buffer->getHeight()) {
+            break;
+        }
+
+        for (uint32_t i = 0; i < DIGIT_WIDTH; i++) {
+            if (left + i >= buffer->getWidth()) {
+                break;
+            }
+            if (!mask[i + DIGIT_WIDTH * j]) {
+                continue;
+            }
+
+            uint8_t* iter = pixels + 4 * (left + i + (buffer->getStride() * j));
+            iter[0] = r;
+            iter[1] = g;
+            iter[2] = b;
+            iter[3] = a;
+        }
+    }
 }
 
 std::vector<sp<GraphicBuffer>> RefreshRateOverlay::SevenSegmentDrawer::drawNumber(
@@ -117,6 +156,11 @@ std::vector<sp<GraphicBuffer>> RefreshRateOverlay::SevenSegmentDrawer::drawNumbe
     const auto tens = (number / 10) % 10;
     const auto ones = number % 10;
 
+    const Atlas& atlas = getAtlas();
+    static constexpr Segment spinnerSegments[] = {Segment::Upper,     Segment::UpperRight,
+                                                  Segment::LowerRight, Segment::Buttom,
+                                                  Segment::LowerLeft,  Segment::UpperLeft};
+
     std::vector<sp<GraphicBuffer>> buffers;
     const auto loopCount = showSpinner ? 6 : 1;
     for (int i = 0; i < loopCount; i++) {
@@ -131,42 +175,24 @@ std::vector<sp<GraphicBuffer>> RefreshRateOverlay::SevenSegmentDrawer::drawNumbe
         uint8_t* pixels;
         buffer->lock(GRALLOC_USAGE_SW_WRITE_RARELY, reinterpret_cast<void**>(&pixels));
         // Clear buffer content
-        drawRect(Rect(BUFFER_WIDTH, BUFFER_HEIGHT), half4(0), buffer, pixels);
+        memset(pixels, 0, buffer->getStride() * BUFFER_HEIGHT * 4);
         int left = 0;
         if (hundreds != 0) {
-            drawDigit(hundreds, left, color, buffer, pixels);
+            blitMask(atlas.digits[hundreds].data(), left, color, buffer, pixels);
         }
         left += DIGIT_WIDTH + DIGIT_SPACE;
 
         if (tens != 0) {
-            drawDigit(tens, left, color, buffer, pixels);
+            blitMask(atlas.digits[tens].data(), left, color, buffer, pixels);
         }
         left += DIGIT_WIDTH + DIGIT_SPACE;
 
-        drawDigit(ones, left, color, buffer, pixels);
+        blitMask(atlas.digits[ones].data(), left, color, buffer, pixels);
         left += DIGIT_WIDTH + DIGIT_SPACE;
 
         if (showSpinner) {
-            switch (i) {
-                case 0:
-                    drawSegment(Segment::Upper, left, color, buffer, pixels);
-                    break;
-                case 1:
-                    drawSegment(Segment::UpperRight, left, color, buffer, pixels);
-                    break;
-                case 2:
-                    drawSegment(Segment::LowerRight, left, color, buffer, pixels);
-                    break;
-                case 3:
-                    drawSegment(Segment::Buttom, left, color, buffer, pixels);
-                    break;
-                case 4:
-                    drawSegment(Segment::LowerLeft, left, color, buffer, pixels);
-                    break;
-                case 5:
-                    drawSegment(Segment::UpperLeft, left, color, buffer, pixels);
-                    break;
-            }
+            blitMask(atlas.segments[static_cast<size_t>(spinnerSegments[i])].data(), left, color,
+                     buffer, pixels);
         }
 
         buffer->unlock();
@@ -204,6 +230,7 @@ bool RefreshRateOverlay::createLayer() {
     if (mLayer->setLayer(INT32_MAX - 2) && idx >= 0) {
         mFlinger.mDrawingState.layersSortedByZ.removeAt(idx);
         mFlinger.mDrawingState.layersSortedByZ.add(mLayer);
+        mFlinger.mDrawingState.markLayerHierarchyDirty();
     }
 
     return true;
@@ -279,11 +306,28 @@ void RefreshRateOverlay::onInvalidate() {
     mFlinger.mTransactionFlags.fetch_or(eTransactionMask);
 }
 
+void RefreshRateOverlay::primeBufferCache() {
+    // Rasterize the buffers for every supported refresh rate up front, so that
+    // changing the displayed rate later is a plain buffer swap with no
+    // allocation or drawing on the main thread.
+    for (const auto& [modeId, refreshRate] : mFlinger.mRefreshRateConfigs->getAllRefreshRates()) {
+        getOrCreateBuffers(refreshRate->getFps().getIntValue());
+    }
+}
+
 void RefreshRateOverlay::reset() {
-    mBufferCache.clear();
     const auto range = mFlinger.mRefreshRateConfigs->getSupportedRefreshRateRange();
-    mLowFps = range.min.getIntValue();
-    mHighFps = range.max.getIntValue();
+    const uint32_t lowFps = range.min.getIntValue();
+    const uint32_t highFps = range.max.getIntValue();
+    if (lowFps == mLowFps && highFps == mHighFps && !mBufferCache.empty()) {
+        // The color interpolation range didn't change, so the cached buffers
+        // are still valid and can keep being cycled.
+        return;
+    }
+    mBufferCache.clear();
+    mLowFps = lowFps;
+    mHighFps = highFps;
+    primeBufferCache();
 }
 
 } // namespace android
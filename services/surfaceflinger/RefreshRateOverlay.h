@@ -22,6 +22,7 @@
 #include <ui/Size.h>
 #include <utils/StrongPointer.h>
 
+#include <array>
 #include <unordered_map>
 
 #include "Fps.h"
@@ -55,24 +56,32 @@ private:
     private:
         enum class Segment { Upper, UpperLeft, UpperRight, Middle, LowerLeft, LowerRight, Buttom };
 
-        static void drawRect(const Rect& r, const half4& color, const sp<GraphicBuffer>& buffer,
-                             uint8_t* pixels);
-        static void drawSegment(Segment segment, int left, const half4& color,
-                                const sp<GraphicBuffer>& buffer, uint8_t* pixels);
-        static void drawDigit(int digit, int left, const half4& color,
-                              const sp<GraphicBuffer>& buffer, uint8_t* pixels);
-
         static constexpr uint32_t DIGIT_HEIGHT = 100;
         static constexpr uint32_t DIGIT_WIDTH = 64;
         static constexpr uint32_t DIGIT_SPACE = 16;
         static constexpr uint32_t BUFFER_HEIGHT = DIGIT_HEIGHT;
         static constexpr uint32_t BUFFER_WIDTH =
                 4 * DIGIT_WIDTH + 3 * DIGIT_SPACE; // Digit|Space|Digit|Space|Digit|Space|Spinner
+
+        // Alpha masks for the ten digits and the seven segments, rasterized once on
+        // first use. Drawing a number then reduces to tinted blits from the atlas.
+        struct Atlas {
+            std::array<std::array<uint8_t, DIGIT_WIDTH * DIGIT_HEIGHT>, 10> digits;
+            std::array<std::array<uint8_t, DIGIT_WIDTH * DIGIT_HEIGHT>, 7> segments;
+        };
+        static const Atlas& getAtlas();
+
+        static void drawRect(const Rect& r, uint8_t* mask);
+        static void drawSegment(Segment segment, uint8_t* mask);
+        static void drawDigit(int digit, uint8_t* mask);
+        static void blitMask(const uint8_t* mask, int left, const half4& color,
+                             const sp<GraphicBuffer>& buffer, uint8_t* pixels);
     };
 
     bool createLayer();
     const std::vector<std::shared_ptr<renderengine::ExternalTexture>>& getOrCreateBuffers(
             uint32_t fps);
+    void primeBufferCache();
 
     SurfaceFlinger& mFlinger;
     const sp<Client> mClient;
@@ -91,8 +100,8 @@ private:
     const bool mShowSpinner;
 
     // Interpolate the colors between these values.
-    uint32_t mLowFps;
-    uint32_t mHighFps;
+    uint32_t mLowFps = 0;
+    uint32_t mHighFps = 0;
 };
 
 } // namespace android
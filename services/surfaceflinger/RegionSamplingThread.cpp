@@ -32,9 +32,12 @@
 #include <ftl/future.h>
 #include <gui/IRegionSamplingListener.h>
 #include <gui/SyncScreenCaptureListener.h>
+#include <sys/resource.h>
 #include <ui/DisplayStatInfo.h>
+#include <utils/ThreadDefs.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <string>
 
 #include "DisplayDevice.h"
@@ -64,6 +67,11 @@ constexpr auto defaultRegionSamplingWorkDuration = 3ms;
 constexpr auto defaultRegionSamplingPeriod = 100ms;
 constexpr auto defaultRegionSamplingTimerTimeout = 100ms;
 constexpr auto maxRegionSamplingDelay = 100ms;
+// The sampled region is captured into a buffer downscaled by this factor per axis, so the GPU
+// performs most of the luma reduction while rendering the screenshot and the CPU only has to
+// average a small buffer. Mean luma is insensitive to the downscale since the filtered blit
+// already averages the pixels that map to each output texel.
+constexpr int32_t sampleDownscaleFactor = 8;
 // TODO: (b/127403193) duration to string conversion could probably be constexpr
 template <typename Rep, typename Per>
 inline std::string toNsString(std::chrono::duration<Rep, Per> t) {
@@ -237,7 +245,7 @@ float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t st
 }
 
 std::vector<float> RegionSamplingThread::sampleBuffer(
-        const sp<GraphicBuffer>& buffer, const Point& leftTop,
+        const sp<GraphicBuffer>& buffer, const Rect& sampledBounds,
         const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation) {
     void* data_raw = nullptr;
     buffer->lock(GRALLOC_USAGE_SW_READ_OFTEN, &data_raw);
@@ -248,11 +256,25 @@ std::vector<float> RegionSamplingThread::sampleBuffer(
     const int32_t width = buffer->getWidth();
     const int32_t height = buffer->getHeight();
     const int32_t stride = buffer->getStride();
+
+    // The capture is downscaled relative to the sampled bounds, so map each sampling area into
+    // buffer coordinates, keeping at least one pixel per axis for very small areas.
+    const auto scaleArea = [&](Rect area) {
+        area -= sampledBounds.leftTop();
+        Rect scaled(area.left * width / sampledBounds.getWidth(),
+                    area.top * height / sampledBounds.getHeight(),
+                    area.right * width / sampledBounds.getWidth(),
+                    area.bottom * height / sampledBounds.getHeight());
+        if (scaled.right <= scaled.left) scaled.right = std::min(scaled.left + 1, width);
+        if (scaled.bottom <= scaled.top) scaled.bottom = std::min(scaled.top + 1, height);
+        return scaled;
+    };
+
     std::vector<float> lumas(descriptors.size());
     std::transform(descriptors.begin(), descriptors.end(), lumas.begin(),
                    [&](auto const& descriptor) {
                        return sampleArea(data.get(), width, height, stride, orientation,
-                                         descriptor.area - leftTop);
+                                         scaleArea(descriptor.area));
                    });
     return lumas;
 }
@@ -288,10 +310,14 @@ void RegionSamplingThread::captureSample() {
     }
 
     const Rect sampledBounds = sampleRegion.bounds();
+    // Capture into a downscaled buffer so the GPU reduces the region while rendering the
+    // screenshot and only a small buffer is read back and averaged on the CPU.
+    const ui::Size sampledSize(std::max(sampledBounds.getWidth() / sampleDownscaleFactor, 1),
+                               std::max(sampledBounds.getHeight() / sampleDownscaleFactor, 1));
     constexpr bool kUseIdentityTransform = false;
 
     SurfaceFlinger::RenderAreaFuture renderAreaFuture = ftl::defer([=] {
-        return DisplayRenderArea::create(displayWeak, sampledBounds, sampledBounds.getSize(),
+        return DisplayRenderArea::create(displayWeak, sampledBounds, sampledSize,
                                          ui::Dataspace::V0_SRGB, kUseIdentityTransform);
     });
 
@@ -339,14 +365,14 @@ void RegionSamplingThread::captureSample() {
     };
 
     std::shared_ptr<renderengine::ExternalTexture> buffer = nullptr;
-    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampledBounds.getWidth() &&
-        mCachedBuffer->getBuffer()->getHeight() == sampledBounds.getHeight()) {
+    if (mCachedBuffer && mCachedBuffer->getBuffer()->getWidth() == sampledSize.getWidth() &&
+        mCachedBuffer->getBuffer()->getHeight() == sampledSize.getHeight()) {
         buffer = mCachedBuffer;
     } else {
         const uint32_t usage =
                 GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_HW_RENDER | GRALLOC_USAGE_HW_TEXTURE;
         sp<GraphicBuffer> graphicBuffer =
-                new GraphicBuffer(sampledBounds.getWidth(), sampledBounds.getHeight(),
+                new GraphicBuffer(sampledSize.getWidth(), sampledSize.getHeight(),
                                   PIXEL_FORMAT_RGBA_8888, 1, usage, "RegionSamplingThread");
         const status_t bufferStatus = graphicBuffer->initCheck();
         LOG_ALWAYS_FATAL_IF(bufferStatus != OK, "captureSample: Buffer failed to allocate: %d",
@@ -369,8 +395,8 @@ void RegionSamplingThread::captureSample() {
     }
 
     ALOGV("Sampling %zu descriptors", activeDescriptors.size());
-    std::vector<float> lumas = sampleBuffer(buffer->getBuffer(), sampledBounds.leftTop(),
-                                            activeDescriptors, orientation);
+    std::vector<float> lumas =
+            sampleBuffer(buffer->getBuffer(), sampledBounds, activeDescriptors, orientation);
     if (lumas.size() != activeDescriptors.size()) {
         ALOGW("collected %zu median luma values for %zu descriptors", lumas.size(),
               activeDescriptors.size());
@@ -387,6 +413,14 @@ void RegionSamplingThread::captureSample() {
 
 // NO_THREAD_SAFETY_ANALYSIS is because std::unique_lock presently lacks thread safety annotations.
 void RegionSamplingThread::threadMain() NO_THREAD_SAFETY_ANALYSIS {
+    // The thread inherits SurfaceFlinger's elevated display priority. Sampling
+    // is best-effort, so drop to background priority: the CPU side of a
+    // capture (buffer readback and luma reduction) then never preempts
+    // composition even when a sample lands alongside a busy frame.
+    if (setpriority(PRIO_PROCESS, 0, PRIORITY_BACKGROUND) != 0) {
+        ALOGW("Failed to set background priority on sampling thread: %s", strerror(errno));
+    }
+
     std::unique_lock<std::mutex> lock(mThreadControlMutex);
     while (mRunning) {
         if (mSampleRequested) {
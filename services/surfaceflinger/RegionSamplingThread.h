@@ -94,7 +94,7 @@ private:
         }
     };
     std::vector<float> sampleBuffer(
-            const sp<GraphicBuffer>& buffer, const Point& leftTop,
+            const sp<GraphicBuffer>& buffer, const Rect& sampledBounds,
             const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation);
 
     void doSample(std::optional<std::chrono::steady_clock::time_point> samplingDeadline);
@@ -350,11 +350,32 @@ void EventThread::onScreenAcquired() {
     mCondition.notify_all();
 }
 
+bool EventThread::PendingVSyncRing::push(const PendingVSync& vsync) {
+    const auto tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mHead.load(std::memory_order_acquire) == kCapacity) {
+        return false;
+    }
+    mEntries[tail % kCapacity] = vsync;
+    mTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+std::optional<EventThread::PendingVSync> EventThread::PendingVSyncRing::pop() {
+    const auto head = mHead.load(std::memory_order_relaxed);
+    if (head == mTail.load(std::memory_order_acquire)) {
+        return {};
+    }
+    const auto vsync = mEntries[head % kCapacity];
+    mHead.store(head + 1, std::memory_order_release);
+    return vsync;
+}
+
+size_t EventThread::PendingVSyncRing::size() const {
+    return mTail.load(std::memory_order_relaxed) - mHead.load(std::memory_order_relaxed);
+}
+
 void EventThread::onVSyncEvent(nsecs_t timestamp, nsecs_t expectedVSyncTimestamp,
                                nsecs_t deadlineTimestamp) {
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    LOG_FATAL_IF(!mVSyncState);
     const int64_t vsyncId = [&] {
         if (mTokenManager != nullptr) {
             return mTokenManager->generateTokenForPredictions(
@@ -363,8 +384,16 @@ void EventThread::onVSyncEvent(nsecs_t timestamp, nsecs_t expectedVSyncTimestamp
         return FrameTimelineInfo::INVALID_VSYNC_ID;
     }();
 
-    mPendingEvents.push_back(makeVSync(mVSyncState->displayId, timestamp, ++mVSyncState->count,
-                                       expectedVSyncTimestamp, deadlineTimestamp, vsyncId));
+    if (!mPendingVSyncs.push({timestamp, expectedVSyncTimestamp, deadlineTimestamp, vsyncId})) {
+        // The event thread has fallen a full ring behind; the stale timestamps are not worth
+        // blocking the vsync source for.
+        ALOGW("Dropping VSYNC for thread %s, pending vsync ring is full", mThreadName);
+        return;
+    }
+
+    // The payload travels outside the lock; the empty critical section orders the push with the
+    // consumer's condition check so the wakeup cannot be lost while the thread goes to sleep.
+    { std::lock_guard<std::mutex> lock(mMutex); }
     mCondition.notify_all();
 }
 
@@ -395,6 +424,12 @@ void EventThread::onFrameRateOverridesChanged(PhysicalDisplayId displayId,
     mCondition.notify_all();
 }
 
+void EventThread::setVsyncFrameRateDividers(std::unordered_map<uid_t, int> dividers) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mFrameRateDividers = std::move(dividers);
+}
+
 size_t EventThread::getEventThreadConnectionCount() {
     std::lock_guard<std::mutex> lock(mMutex);
     return mDisplayEventConnections.size();
@@ -427,6 +462,22 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
                     }
                     break;
             }
+        } else {
+            // Vsyncs from the source callback carry only timing; stamp them with the count and
+            // display owned by this thread. Entries that raced with a disconnect are dropped.
+            while (const auto vsync = mPendingVSyncs.pop()) {
+                if (!mVSyncState) {
+                    ALOGW("Dropping VSYNC for disconnected display");
+                    continue;
+                }
+                event = makeVSync(mVSyncState->displayId, vsync->timestamp,
+                                  ++mVSyncState->count, vsync->expectedVSyncTimestamp,
+                                  vsync->deadlineTimestamp, vsync->vsyncId);
+                if (mInterceptVSyncsCallback) {
+                    mInterceptVSyncsCallback(event->header.timestamp);
+                }
+                break;
+            }
         }
 
         bool vsyncRequested = false;
@@ -448,7 +499,11 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
         }
 
         if (!consumers.empty()) {
+            // Deliver with mMutex released so a slow or blocked BitTube does not hold up vsync
+            // injection or binder requests for the other connections.
+            lock.unlock();
             dispatchEvent(*event, consumers);
+            lock.lock();
             consumers.clear();
         }
 
@@ -517,7 +572,17 @@ void EventThread::threadMain(std::unique_lock<std::mutex>& lock) {
 
 bool EventThread::shouldConsumeEvent(const DisplayEventReceiver::Event& event,
                                      const sp<EventThreadConnection>& connection) const {
+    // The divider map pushed by the scheduler settles the common case locally: uids
+    // without an override never leave this thread. Only throttled connections consult the
+    // scheduler's phase predicate, so the vsyncs delivered here are the same ones
+    // isVsyncValid accepts when SurfaceFlinger gates transaction readiness and buffer
+    // latch; a local counter would drift out of phase with that predicate and starve the
+    // connection.
     const auto throttleVsync = [&] {
+        const auto it = mFrameRateDividers.find(connection->mOwnerUid);
+        if (it == mFrameRateDividers.end() || it->second <= 1) {
+            return false;
+        }
         return mThrottleVsyncCallback &&
                 mThrottleVsyncCallback(event.vsync.expectedVSyncTimestamp, connection->mOwnerUid);
     };
@@ -570,6 +635,7 @@ bool EventThread::shouldConsumeEvent(const DisplayEventReceiver::Event& event,
 
 void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
                                 const DisplayEventConsumers& consumers) {
+    DisplayEventConsumers deadConsumers;
     const uint8_t num_attempts = 3;
     for (const auto& consumer : consumers) {
         DisplayEventReceiver::Event copy = event;
@@ -591,11 +657,18 @@ void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
 
                 default:
                     // Treat EPIPE and other errors as fatal.
-                    removeDisplayEventConnectionLocked(consumer);
+                    deadConsumers.push_back(consumer);
                     needs_retry = false;
             }
         }
     }
+
+    if (!deadConsumers.empty()) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& consumer : deadConsumers) {
+            removeDisplayEventConnectionLocked(consumer);
+        }
+    }
 }
 
 void EventThread::dump(std::string& result) const {
@@ -610,11 +683,17 @@ void EventThread::dump(std::string& result) const {
         StringAppendF(&result, "none\n");
     }
 
+    StringAppendF(&result, "  pending vsyncs (count=%zu)\n", mPendingVSyncs.size());
     StringAppendF(&result, "  pending events (count=%zu):\n", mPendingEvents.size());
     for (const auto& event : mPendingEvents) {
         StringAppendF(&result, "    %s\n", toString(event).c_str());
     }
 
+    StringAppendF(&result, "  frame rate dividers (count=%zu):\n", mFrameRateDividers.size());
+    for (const auto& [uid, divider] : mFrameRateDividers) {
+        StringAppendF(&result, "    uid=%d divider=%d\n", uid, divider);
+    }
+
     StringAppendF(&result, "  connections (count=%zu):\n", mDisplayEventConnections.size());
     for (const auto& ptr : mDisplayEventConnections) {
         if (const auto connection = ptr.promote()) {
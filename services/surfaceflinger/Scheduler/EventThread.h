@@ -23,12 +23,15 @@
 #include <sys/types.h>
 #include <utils/Errors.h>
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <mutex>
 #include <optional>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "DisplayHardware/DisplayMode.h"
@@ -131,6 +134,11 @@ public:
     virtual void onFrameRateOverridesChanged(PhysicalDisplayId displayId,
                                              std::vector<FrameRateOverride> overrides) = 0;
 
+    // called when the frame rate overrides or the display refresh rate change. Maps each
+    // overridden uid to the divider between the display rate and its override; uids that
+    // are absent are not throttled and skip the per-vsync phase query entirely.
+    virtual void setVsyncFrameRateDividers(std::unordered_map<uid_t, int> dividers) = 0;
+
     virtual void dump(std::string& result) const = 0;
 
     virtual void setDuration(std::chrono::nanoseconds workDuration,
@@ -180,6 +188,8 @@ public:
     void onFrameRateOverridesChanged(PhysicalDisplayId displayId,
                                      std::vector<FrameRateOverride> overrides) override;
 
+    void setVsyncFrameRateDividers(std::unordered_map<uid_t, int> dividers) override;
+
     void dump(std::string& result) const override;
 
     void setDuration(std::chrono::nanoseconds workDuration,
@@ -196,12 +206,38 @@ private:
 
     bool shouldConsumeEvent(const DisplayEventReceiver::Event& event,
                             const sp<EventThreadConnection>& connection) const REQUIRES(mMutex);
+    // Called with mMutex released so one slow BitTube consumer does not block vsync injection
+    // or binder requests; reacquires mMutex only to drop connections that hit a fatal error.
     void dispatchEvent(const DisplayEventReceiver::Event& event,
-                       const DisplayEventConsumers& consumers) REQUIRES(mMutex);
+                       const DisplayEventConsumers& consumers);
 
     void removeDisplayEventConnectionLocked(const wp<EventThreadConnection>& connection)
             REQUIRES(mMutex);
 
+    // Timing payload for a vsync generated by the VSyncSource callback. The vsync count and
+    // display id are stamped on the event thread, which owns mVSyncState.
+    struct PendingVSync {
+        nsecs_t timestamp;
+        nsecs_t expectedVSyncTimestamp;
+        nsecs_t deadlineTimestamp;
+        int64_t vsyncId;
+    };
+
+    // Lock-free single-producer (VSyncSource callback) single-consumer (threadMain) ring, so
+    // vsync delivery does not contend on mMutex with connection dispatch.
+    class PendingVSyncRing {
+    public:
+        bool push(const PendingVSync& vsync); // producer only
+        std::optional<PendingVSync> pop();    // consumer only
+        size_t size() const;                  // approximate, for dumpsys
+
+    private:
+        static constexpr size_t kCapacity = 8; // must be a power of two
+        std::array<PendingVSync, kCapacity> mEntries;
+        std::atomic<size_t> mHead{0}; // next entry to pop
+        std::atomic<size_t> mTail{0}; // next entry to push
+    };
+
     // Implements VSyncSource::Callback
     void onVSyncEvent(nsecs_t timestamp, nsecs_t expectedVSyncTimestamp,
                       nsecs_t deadlineTimestamp) override;
@@ -221,6 +257,12 @@ private:
     std::vector<wp<EventThreadConnection>> mDisplayEventConnections GUARDED_BY(mMutex);
     std::deque<DisplayEventReceiver::Event> mPendingEvents GUARDED_BY(mMutex);
 
+    // Vsync divider per overridden uid, pushed by the scheduler when the frame rate
+    // overrides or the display refresh rate change. Filters which connections consult
+    // mThrottleVsyncCallback, so unthrottled uids pay no per-vsync callback at all.
+    std::unordered_map<uid_t, int> mFrameRateDividers GUARDED_BY(mMutex);
+    PendingVSyncRing mPendingVSyncs;
+
     // VSYNC state of connected display.
     struct VSyncState {
         explicit VSyncState(PhysicalDisplayId displayId) : displayId(displayId) {}
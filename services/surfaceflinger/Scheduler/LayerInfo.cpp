@@ -60,14 +60,105 @@ void LayerInfo::setLastPresentTime(nsecs_t lastPresentTime, nsecs_t now, LayerUp
             FrameTimeData frameTime = {.presentTime = lastPresentTime,
                                        .queueTime = mLastUpdatedTime,
                                        .pendingModeChange = pendingModeChange};
-            mFrameTimes.push_back(frameTime);
+            recordFrameTime(frameTime);
             if (mFrameTimes.size() > HISTORY_SIZE) {
-                mFrameTimes.pop_front();
+                evictOldestFrameTime();
             }
             break;
     }
 }
 
+LayerInfo::FrameTimeData::DeltaState LayerInfo::computeDeltaState(nsecs_t delta) {
+    if (delta < kMinPeriodBetweenFrames) {
+        // The frame is a duplicate; its delta counts into the next frame.
+        return {};
+    }
+
+    // Deltas longer than kMaxPeriodBetweenFrames indicate a pause and are not averaged.
+    return {.isBaseline = true,
+            .contribution = delta <= kMaxPeriodBetweenFrames ? delta : 0};
+}
+
+void LayerInfo::recordFrameTime(FrameTimeData frameTime) {
+    const auto accumulate = [&](FrameTimeStats::DeltaSum& sum, nsecs_t time,
+                                FrameTimeData::DeltaState& state) {
+        if (mFrameTimes.empty()) {
+            // The first frame in the window is always the baseline.
+            state = {.isBaseline = true, .contribution = 0};
+        } else {
+            state = computeDeltaState(time - sum.lastBaselineTime);
+            sum.add(state.contribution);
+        }
+        if (state.isBaseline) {
+            sum.lastBaselineTime = time;
+        }
+    };
+    accumulate(mFrameTimeStats.present, frameTime.presentTime, frameTime.presentDelta);
+    accumulate(mFrameTimeStats.queue, frameTime.queueTime, frameTime.queueDelta);
+
+    if (frameTime.pendingModeChange) {
+        mFrameTimeStats.framesDuringModeChange++;
+    }
+    if (frameTime.presentTime == 0) {
+        mFrameTimeStats.framesMissingPresentTime++;
+    }
+
+    mFrameTimes.push_back(frameTime);
+}
+
+void LayerInfo::evictOldestFrameTime() {
+    const FrameTimeData evicted = mFrameTimes.front();
+    mFrameTimes.pop_front();
+
+    if (evicted.pendingModeChange) {
+        mFrameTimeStats.framesDuringModeChange--;
+    }
+    if (evicted.presentTime == 0) {
+        mFrameTimeStats.framesMissingPresentTime--;
+    }
+
+    resyncDeltasAfterEviction(mFrameTimeStats.present, &FrameTimeData::presentTime,
+                              &FrameTimeData::presentDelta);
+    resyncDeltasAfterEviction(mFrameTimeStats.queue, &FrameTimeData::queueTime,
+                              &FrameTimeData::queueDelta);
+}
+
+void LayerInfo::resyncDeltasAfterEviction(FrameTimeStats::DeltaSum& sum,
+                                          nsecs_t FrameTimeData::*time,
+                                          FrameTimeData::DeltaState FrameTimeData::*delta) {
+    if (mFrameTimes.empty()) {
+        sum = {};
+        return;
+    }
+
+    // The remaining oldest frame becomes the baseline the window starts from, so its delta no
+    // longer counts.
+    auto it = mFrameTimes.begin();
+    sum.remove(((*it).*delta).contribution);
+    (*it).*delta = {.isBaseline = true, .contribution = 0};
+    nsecs_t baselineTime = (*it).*time;
+
+    // Deltas only reference earlier baselines, so walk forward re-applying the delta rules
+    // until a frame's stored state matches what a scan of the remaining window would compute;
+    // from that frame on the stored states are unaffected by the eviction. Typically only the
+    // new oldest frame needs fixing up, unless it was a duplicate of the evicted one.
+    for (++it; it != mFrameTimes.end(); ++it) {
+        const auto newState = computeDeltaState((*it).*time - baselineTime);
+        auto& state = (*it).*delta;
+        if (newState.isBaseline && state.isBaseline &&
+            newState.contribution == state.contribution) {
+            return;
+        }
+        sum.remove(state.contribution);
+        sum.add(newState.contribution);
+        state = newState;
+        if (state.isBaseline) {
+            baselineTime = (*it).*time;
+        }
+    }
+    sum.lastBaselineTime = baselineTime;
+}
+
 bool LayerInfo::isFrameTimeValid(const FrameTimeData& frameTime) const {
     return frameTime.queueTime >= std::chrono::duration_cast<std::chrono::nanoseconds>(
                                           mFrameTimeValidSince.time_since_epoch())
@@ -128,23 +219,18 @@ bool LayerInfo::hasEnoughDataForHeuristic() const {
 
 std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
     // Ignore frames captured during a mode change
-    const bool isDuringModeChange =
-            std::any_of(mFrameTimes.begin(), mFrameTimes.end(),
-                        [](const auto& frame) { return frame.pendingModeChange; });
-    if (isDuringModeChange) {
+    if (mFrameTimeStats.framesDuringModeChange > 0) {
         return std::nullopt;
     }
 
-    const bool isMissingPresentTime =
-            std::any_of(mFrameTimes.begin(), mFrameTimes.end(),
-                        [](auto frame) { return frame.presentTime == 0; });
+    const bool isMissingPresentTime = mFrameTimeStats.framesMissingPresentTime > 0;
     if (isMissingPresentTime && !mLastRefreshRate.reported.isValid()) {
         // If there are no presentation timestamps and we haven't calculated
         // one in the past then we can't calculate the refresh rate
         return std::nullopt;
     }
 
-    // Calculate the average frame time based on presentation timestamps. If those
+    // Average the frame time based on presentation timestamps. If those
     // doesn't exist, we look at the time the buffer was queued only. We can do that only if
     // we calculated a refresh rate based on presentation timestamps in the past. The reason
     // we look at the queue time is to handle cases where hwui attaches presentation timestamps
@@ -152,35 +238,13 @@ std::optional<nsecs_t> LayerInfo::calculateAverageFrameTime() const {
     // presentation timestamps we look at the queue time to see if the current refresh rate still
     // matches the content.
 
-    auto getFrameTime = isMissingPresentTime ? [](FrameTimeData data) { return data.queueTime; }
-                                             : [](FrameTimeData data) { return data.presentTime; };
-
-    nsecs_t totalDeltas = 0;
-    int numDeltas = 0;
-    auto prevFrame = mFrameTimes.begin();
-    for (auto it = mFrameTimes.begin() + 1; it != mFrameTimes.end(); ++it) {
-        const auto currDelta = getFrameTime(*it) - getFrameTime(*prevFrame);
-        if (currDelta < kMinPeriodBetweenFrames) {
-            // Skip this frame, but count the delta into the next frame
-            continue;
-        }
-
-        prevFrame = it;
-
-        if (currDelta > kMaxPeriodBetweenFrames) {
-            // Skip this frame and the current delta.
-            continue;
-        }
-
-        totalDeltas += currDelta;
-        numDeltas++;
-    }
-
-    if (numDeltas == 0) {
+    const auto& deltas = isMissingPresentTime ? mFrameTimeStats.queue : mFrameTimeStats.present;
+    if (deltas.numDeltas == 0) {
         return std::nullopt;
     }
 
-    const auto averageFrameTime = static_cast<double>(totalDeltas) / static_cast<double>(numDeltas);
+    const auto averageFrameTime =
+            static_cast<double>(deltas.totalDeltas) / static_cast<double>(deltas.numDeltas);
     return static_cast<nsecs_t>(averageFrameTime);
 }
 
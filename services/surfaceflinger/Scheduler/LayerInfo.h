@@ -192,6 +192,7 @@ public:
     void clearHistory(nsecs_t now) {
         onLayerInactive(now);
         mFrameTimes.clear();
+        mFrameTimeStats = {};
     }
 
 private:
@@ -200,6 +201,17 @@ private:
         nsecs_t presentTime; // desiredPresentTime, if provided
         nsecs_t queueTime;  // buffer queue time
         bool pendingModeChange;
+
+        // Bookkeeping for the incremental frame time averaging; see FrameTimeStats. A frame
+        // is a baseline if its delta to the previous baseline was at least
+        // kMinPeriodBetweenFrames (smaller deltas fold into the next frame), and contribution
+        // is that delta when it was also at most kMaxPeriodBetweenFrames, and 0 otherwise.
+        struct DeltaState {
+            bool isBaseline = false;
+            nsecs_t contribution = 0;
+        };
+        DeltaState presentDelta;
+        DeltaState queueDelta;
     };
 
     // Holds information about the calculated and reported refresh rate
@@ -260,6 +272,38 @@ private:
         static constexpr float MARGIN_CONSISTENT_FPS = 1.0;
     };
 
+    // Running aggregates over mFrameTimes, updated as frames are recorded and evicted so that
+    // calculateAverageFrameTime reads them instead of re-scanning the history. Deltas are
+    // tracked separately for present times and queue times, since which of the two gets
+    // averaged depends on whether any frame in the window is missing a present time.
+    struct FrameTimeStats {
+        struct DeltaSum {
+            nsecs_t totalDeltas = 0;
+            int numDeltas = 0;
+            // Timestamp of the most recent baseline frame; the next recorded frame is
+            // measured against it.
+            nsecs_t lastBaselineTime = 0;
+
+            void add(nsecs_t contribution) {
+                if (contribution != 0) {
+                    totalDeltas += contribution;
+                    numDeltas++;
+                }
+            }
+
+            void remove(nsecs_t contribution) {
+                if (contribution != 0) {
+                    totalDeltas -= contribution;
+                    numDeltas--;
+                }
+            }
+        };
+        DeltaSum present;
+        DeltaSum queue;
+        int framesDuringModeChange = 0;
+        int framesMissingPresentTime = 0;
+    };
+
     bool isFrequent(nsecs_t now) const;
     bool isAnimating(nsecs_t now) const;
     bool hasEnoughDataForHeuristic() const;
@@ -267,6 +311,19 @@ private:
     std::optional<nsecs_t> calculateAverageFrameTime() const;
     bool isFrameTimeValid(const FrameTimeData&) const;
 
+    // Applies the delta rules described on FrameTimeData::DeltaState.
+    static FrameTimeData::DeltaState computeDeltaState(nsecs_t delta);
+
+    // Appends a frame to mFrameTimes, computing its delta states and folding them into
+    // mFrameTimeStats.
+    void recordFrameTime(FrameTimeData frameTime);
+
+    // Evicts the oldest frame from mFrameTimes and re-synchronizes mFrameTimeStats with the
+    // remaining window.
+    void evictOldestFrameTime();
+    void resyncDeltasAfterEviction(FrameTimeStats::DeltaSum& sum, nsecs_t FrameTimeData::*time,
+                                   FrameTimeData::DeltaState FrameTimeData::*delta);
+
     const std::string mName;
     const uid_t mOwnerUid;
 
@@ -288,6 +345,7 @@ private:
     RefreshRateHeuristicData mLastRefreshRate;
 
     std::deque<FrameTimeData> mFrameTimes;
+    FrameTimeStats mFrameTimeStats;
     std::chrono::time_point<std::chrono::steady_clock> mFrameTimeValidSince =
             std::chrono::steady_clock::now();
     static constexpr size_t HISTORY_SIZE = RefreshRateHistory::HISTORY_SIZE;
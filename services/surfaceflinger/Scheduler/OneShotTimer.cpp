@@ -118,19 +118,26 @@ void OneShotTimer::loop() {
         state = TimerState::WAITING;
         while (state == TimerState::WAITING) {
             constexpr auto zero = std::chrono::steady_clock::duration::zero();
-            // Wait for mInterval time for semaphore signal.
-            struct timespec ts;
-            calculateTimeoutTime(std::chrono::nanoseconds(mInterval), &ts);
-            int result = sem_clockwait(&mSemaphore, CLOCK_MONOTONIC, &ts);
-            if (result && errno != ETIMEDOUT && errno != EINTR) {
-                std::stringstream ss;
-                ss << "sem_clockwait failed (" << errno << ")";
-                LOG_ALWAYS_FATAL("%s", ss.str().c_str());
+            // Wait until triggerTime for a semaphore signal. Resets that arrive
+            // while we are waiting only store mLastResetTime without posting the
+            // semaphore; we pick them up when the wait expires and push the
+            // trigger time out accordingly.
+            if (const auto waitTime = triggerTime - mClock->now(); waitTime > zero) {
+                mWaiting = true;
+                struct timespec ts;
+                calculateTimeoutTime(std::chrono::nanoseconds(waitTime), &ts);
+                int result = sem_clockwait(&mSemaphore, CLOCK_MONOTONIC, &ts);
+                if (result && errno != ETIMEDOUT && errno != EINTR) {
+                    std::stringstream ss;
+                    ss << "sem_clockwait failed (" << errno << ")";
+                    LOG_ALWAYS_FATAL("%s", ss.str().c_str());
+                }
+                mWaiting = false;
             }
 
             state = checkForResetAndStop(state);
             if (state == TimerState::RESET) {
-                triggerTime = mClock->now() + mInterval;
+                triggerTime = mLastResetTime.load() + mInterval;
                 state = TimerState::WAITING;
             } else if (state == TimerState::WAITING && (triggerTime - mClock->now()) <= zero) {
                 triggerTimeout = true;
@@ -158,9 +165,17 @@ OneShotTimer::TimerState OneShotTimer::checkForResetAndStop(TimerState state) {
 }
 
 void OneShotTimer::reset() {
+    mLastResetTime = mClock->now();
     mResetTriggered = true;
-    int result = sem_post(&mSemaphore);
-    LOG_ALWAYS_FATAL_IF(result, "sem_post failed");
+    // If the timer thread is already blocked waiting for the interval to
+    // expire, there is no need to wake it: the wait will run out, observe
+    // mResetTriggered and reschedule itself from mLastResetTime. Only an idle
+    // thread, parked on sem_wait, needs the post. This keeps the common
+    // reset-per-frame path free of thread wakeups.
+    if (!mWaiting) {
+        int result = sem_post(&mSemaphore);
+        LOG_ALWAYS_FATAL_IF(result, "sem_post failed");
+    }
 }
 
 std::string OneShotTimer::dump() const {
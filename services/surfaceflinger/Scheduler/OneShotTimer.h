@@ -103,6 +103,14 @@ private:
     // check in the main loop if they were.
     std::atomic<bool> mResetTriggered = false;
     std::atomic<bool> mStopTriggered = false;
+
+    // Time of the last reset request. The timer thread reads this to extend
+    // its deadline without needing to be woken for every reset.
+    std::atomic<std::chrono::steady_clock::time_point> mLastResetTime;
+
+    // Set by the timer thread while it is blocked waiting for the interval to
+    // expire. Resets arriving during that window skip the semaphore post.
+    std::atomic<bool> mWaiting = false;
 };
 
 } // namespace scheduler
@@ -136,6 +136,20 @@ bool RefreshRateConfigs::isVoteAllowed(const LayerRequirement& layer,
 float RefreshRateConfigs::calculateLayerScoreLocked(const LayerRequirement& layer,
                                                     const RefreshRate& refreshRate,
                                                     bool isSeamlessSwitch) const {
+    if (const auto index = getLayerScoreIndex(layer.vote, layer.desiredRefreshRate)) {
+        const auto it = mPrecomputedLayerScores.find(refreshRate.getModeId());
+        if (it != mPrecomputedLayerScores.end()) {
+            const PrecomputedScore& score = it->second[*index];
+            return isSeamlessSwitch ? score.seamless : score.seamed;
+        }
+    }
+
+    return computeLayerScoreLocked(layer, refreshRate, isSeamlessSwitch);
+}
+
+float RefreshRateConfigs::computeLayerScoreLocked(const LayerRequirement& layer,
+                                                  const RefreshRate& refreshRate,
+                                                  bool isSeamlessSwitch) const {
     if (!isVoteAllowed(layer, refreshRate)) {
         return 0;
     }
@@ -212,6 +226,56 @@ float RefreshRateConfigs::calculateLayerScoreLocked(const LayerRequirement& laye
     return 0;
 }
 
+namespace {
+// The vote types whose scores are a function of the desired refresh rate alone, and are
+// therefore precomputed for the known frame rates. Max is excluded since its score depends on
+// the app request range of the current policy, and Min/NoVote always score zero.
+constexpr RefreshRateConfigs::LayerVoteType kPrecomputedVoteTypes[] =
+        {RefreshRateConfigs::LayerVoteType::Heuristic,
+         RefreshRateConfigs::LayerVoteType::ExplicitDefault,
+         RefreshRateConfigs::LayerVoteType::ExplicitExactOrMultiple,
+         RefreshRateConfigs::LayerVoteType::ExplicitExact};
+} // namespace
+
+std::optional<size_t> RefreshRateConfigs::getLayerScoreIndex(LayerVoteType vote,
+                                                             Fps frameRate) const {
+    const auto voteIt =
+            std::find(std::begin(kPrecomputedVoteTypes), std::end(kPrecomputedVoteTypes), vote);
+    if (voteIt == std::end(kPrecomputedVoteTypes)) {
+        return std::nullopt;
+    }
+
+    for (size_t i = 0; i < mKnownFrameRates.size(); i++) {
+        if (mKnownFrameRates[i].equalsWithMargin(frameRate)) {
+            const auto voteIndex =
+                    static_cast<size_t>(std::distance(std::begin(kPrecomputedVoteTypes), voteIt));
+            return voteIndex * mKnownFrameRates.size() + i;
+        }
+    }
+    return std::nullopt;
+}
+
+void RefreshRateConfigs::precomputeLayerScoresLocked() {
+    mPrecomputedLayerScores.clear();
+
+    LayerRequirement layer;
+    for (const auto& [modeId, refreshRate] : mRefreshRates) {
+        auto& scores = mPrecomputedLayerScores[modeId];
+        scores.resize(std::size(kPrecomputedVoteTypes) * mKnownFrameRates.size());
+        for (const auto vote : kPrecomputedVoteTypes) {
+            layer.vote = vote;
+            for (const auto frameRate : mKnownFrameRates) {
+                layer.desiredRefreshRate = frameRate;
+                const auto index = getLayerScoreIndex(vote, frameRate);
+                scores[*index] = {.seamless = computeLayerScoreLocked(layer, *refreshRate,
+                                                                      /*isSeamlessSwitch*/ true),
+                                  .seamed = computeLayerScoreLocked(layer, *refreshRate,
+                                                                    /*isSeamlessSwitch*/ false)};
+            }
+        }
+    }
+}
+
 struct RefreshRateScore {
     const RefreshRate* refreshRate;
     float score;
@@ -731,6 +795,10 @@ void RefreshRateConfigs::updateDisplayModes(const DisplayModes& modes,
     }
 
     constructAvailableRefreshRates();
+
+    // The precomputed scores only depend on the mode set (and mSupportsFrameRateOverride,
+    // updated above), not on the policy, so policy changes don't need to rebuild them.
+    precomputeLayerScoresLocked();
 }
 
 bool RefreshRateConfigs::isPolicyValidLocked(const Policy& policy) const {
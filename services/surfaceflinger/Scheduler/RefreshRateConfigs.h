@@ -404,10 +404,25 @@ private:
     bool isVoteAllowed(const LayerRequirement&, const RefreshRate&) const;
 
     // calculates a score for a layer. Used to determine the display refresh rate
-    // and the frame rate override for certains applications.
+    // and the frame rate override for certains applications. Serves the score from
+    // mPrecomputedLayerScores when the layer's vote and desired refresh rate are covered by
+    // the table, and computes it otherwise.
     float calculateLayerScoreLocked(const LayerRequirement&, const RefreshRate&,
                                     bool isSeamlessSwitch) const REQUIRES(mLock);
 
+    // Computes the score for a layer without consulting mPrecomputedLayerScores. Also used to
+    // fill the table.
+    float computeLayerScoreLocked(const LayerRequirement&, const RefreshRate&,
+                                  bool isSeamlessSwitch) const REQUIRES(mLock);
+
+    // Returns the layer's index into a mode's entry in mPrecomputedLayerScores, or
+    // std::nullopt if the vote type is not precomputed or the frame rate does not match one of
+    // mKnownFrameRates.
+    std::optional<size_t> getLayerScoreIndex(LayerVoteType, Fps) const;
+
+    // Rebuilds mPrecomputedLayerScores for the current set of display modes.
+    void precomputeLayerScoresLocked() REQUIRES(mLock);
+
     // The list of refresh rates, indexed by display modes ID. This may change after this
     // object is initialized.
     AllRefreshRatesMapType mRefreshRates GUARDED_BY(mLock);
@@ -443,6 +458,21 @@ private:
     const Config mConfig;
     bool mSupportsFrameRateOverride;
 
+    // A layer's score for a display mode, precomputed for both the seamless and the seamed
+    // variant of the switch (the latter carries a small penalty).
+    struct PrecomputedScore {
+        float seamless = 0.0f;
+        float seamed = 0.0f;
+    };
+
+    // A layer's score is a pure function of its vote type, its desired refresh rate and the
+    // display mode, so the scores for the frame rates layers commonly report - mKnownFrameRates -
+    // are computed once per mode set instead of on every getBestRefreshRate call. Layers with
+    // other frame rates fall back to computeLayerScoreLocked. Indexed per mode by
+    // getLayerScoreIndex.
+    std::unordered_map<DisplayModeId, std::vector<PrecomputedScore>> mPrecomputedLayerScores
+            GUARDED_BY(mLock);
+
     struct GetBestRefreshRateInvocation {
         std::vector<LayerRequirement> layerRequirements;
         GlobalSignals globalSignals;
@@ -75,9 +75,11 @@ std::unique_ptr<scheduler::VSyncTracker> createVSyncTracker() {
     constexpr size_t vsyncTimestampHistorySize = 20;
     constexpr size_t minimumSamplesForPrediction = 6;
     constexpr uint32_t discardOutlierPercent = 20;
+    const bool enableKalmanEstimator = base::GetBoolProperty("debug.sf.vsp_kalman"s, false);
     return std::make_unique<scheduler::VSyncPredictor>(idealPeriod, vsyncTimestampHistorySize,
                                                        minimumSamplesForPrediction,
-                                                       discardOutlierPercent);
+                                                       discardOutlierPercent,
+                                                       enableKalmanEstimator);
 }
 
 std::unique_ptr<scheduler::VSyncDispatch> createVSyncDispatch(scheduler::VSyncTracker& tracker) {
@@ -237,10 +239,6 @@ bool Scheduler::isVsyncValid(nsecs_t expectedVsyncTimestamp, uid_t uid) const {
 }
 
 impl::EventThread::ThrottleVsyncCallback Scheduler::makeThrottleVsyncCallback() const {
-    if (!mRefreshRateConfigs.supportsFrameRateOverride()) {
-        return {};
-    }
-
     return [this](nsecs_t expectedVsyncTimestamp, uid_t uid) {
         return !isVsyncValid(expectedVsyncTimestamp, uid);
     };
@@ -263,13 +261,54 @@ impl::EventThread::GetVsyncPeriodFunction Scheduler::makeGetVsyncPeriodFunction(
     };
 }
 
+void Scheduler::updateVsyncFrameRateDividers(Fps displayRefreshRate) {
+    if (!mRefreshRateConfigs.supportsFrameRateOverride()) {
+        return;
+    }
+
+    std::unordered_map<uid_t, int> dividers;
+    {
+        std::lock_guard lock(mFrameRateOverridesMutex);
+        for (const auto& [uid, frameRate] : mFrameRateOverridesFromBackdoor) {
+            const auto divider =
+                    scheduler::RefreshRateConfigs::getFrameRateDivider(displayRefreshRate,
+                                                                       frameRate);
+            if (divider > 1) {
+                dividers.emplace(uid, divider);
+            }
+        }
+        for (const auto& [uid, frameRate] : mFrameRateOverridesByContent) {
+            if (mFrameRateOverridesFromBackdoor.count(uid) == 0) {
+                const auto divider =
+                        scheduler::RefreshRateConfigs::getFrameRateDivider(displayRefreshRate,
+                                                                           frameRate);
+                if (divider > 1) {
+                    dividers.emplace(uid, divider);
+                }
+            }
+        }
+    }
+
+    std::vector<android::EventThread*> threads;
+    {
+        std::lock_guard lock(mConnectionsLock);
+        threads.reserve(mConnections.size());
+        for (const auto& [handle, connection] : mConnections) {
+            threads.push_back(connection.thread.get());
+        }
+    }
+    for (auto* thread : threads) {
+        thread->setVsyncFrameRateDividers(dividers);
+    }
+}
+
 Scheduler::ConnectionHandle Scheduler::createConnection(
         const char* connectionName, frametimeline::TokenManager* tokenManager,
         std::chrono::nanoseconds workDuration, std::chrono::nanoseconds readyDuration,
         impl::EventThread::InterceptVSyncsCallback interceptCallback) {
     auto vsyncSource = makePrimaryDispSyncSource(connectionName, workDuration, readyDuration);
-    auto throttleVsync = makeThrottleVsyncCallback();
     auto getVsyncPeriod = makeGetVsyncPeriodFunction();
+    auto throttleVsync = makeThrottleVsyncCallback();
     auto eventThread = std::make_unique<impl::EventThread>(std::move(vsyncSource), tokenManager,
                                                            std::move(interceptCallback),
                                                            std::move(throttleVsync),
@@ -367,6 +406,8 @@ void Scheduler::onFrameRateOverridesChanged(ConnectionHandle handle, PhysicalDis
         thread = mConnections[handle].thread.get();
     }
     thread->onFrameRateOverridesChanged(displayId, std::move(overrides));
+
+    updateVsyncFrameRateDividers(mRefreshRateConfigs.getCurrentRefreshRate().getFps());
 }
 
 void Scheduler::onPrimaryDisplayModeChanged(ConnectionHandle handle, PhysicalDisplayId displayId,
@@ -427,6 +468,11 @@ void Scheduler::onNonPrimaryDisplayModeChanged(ConnectionHandle handle, Physical
         thread = mConnections[handle].thread.get();
     }
     thread->onModeChanged(displayId, modeId, vsyncPeriod);
+
+    // A refresh rate change alters the dividers even when the override list itself
+    // did not change, e.g. a 30fps override is every 4th vsync at 120Hz but every
+    // 2nd at 60Hz.
+    updateVsyncFrameRateDividers(Fps::fromPeriodNsecs(vsyncPeriod));
 }
 
 size_t Scheduler::getEventThreadConnectionCount(ConnectionHandle handle) {
@@ -718,6 +764,22 @@ void Scheduler::notifyTouchEvent() {
     }
 }
 
+void Scheduler::onTouchHint() {
+    if (!mTouchTimer) {
+        return;
+    }
+
+    // Keep the timers armed so the boost decays as usual.
+    notifyTouchEvent();
+
+    // Apply the boost here rather than on the touch timer thread. The duplicate reset
+    // callback the timer thread delivers afterwards is a no-op, since the touch state
+    // is already Active by then. Switching the refresh rate also moves VsyncModulator
+    // to the early config, so the first post-touch frames are scheduled with the
+    // boosted offsets as well.
+    touchTimerCallback(TimerState::Reset);
+}
+
 void Scheduler::setDisplayPowerState(bool normal) {
     {
         std::lock_guard<std::mutex> lock(mFeatureStateLock);
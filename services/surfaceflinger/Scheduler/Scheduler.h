@@ -144,6 +144,12 @@ public:
     // Function that resets the touch timer.
     void notifyTouchEvent();
 
+    // Interaction hint from the input pipeline. Applies the touch boost on the calling
+    // thread instead of waiting for the touch timer thread to run the reset callback, so
+    // the switch to the high refresh rate is requested before the first post-touch frame
+    // is scheduled.
+    void onTouchHint();
+
     void setDisplayPowerState(bool normal);
 
     scheduler::VSyncDispatch& getVsyncDispatch() { return *mVsyncSchedule.dispatch; }
@@ -250,6 +256,13 @@ private:
     impl::EventThread::ThrottleVsyncCallback makeThrottleVsyncCallback() const;
     impl::EventThread::GetVsyncPeriodFunction makeGetVsyncPeriodFunction() const;
 
+    // Recomputes the vsync divider for each overridden uid against the given display
+    // refresh rate and pushes the result to every event thread. The map filters which
+    // connections query the throttle callback; the phase decision itself stays with
+    // isVsyncValid so delivery agrees with transaction and latch gating.
+    void updateVsyncFrameRateDividers(Fps displayRefreshRate)
+            EXCLUDES(mFrameRateOverridesMutex) EXCLUDES(mConnectionsLock);
+
     // Stores EventThread associated with a given VSyncSource, and an initial EventThreadConnection.
     struct Connection {
         sp<EventThreadConnection> connection;
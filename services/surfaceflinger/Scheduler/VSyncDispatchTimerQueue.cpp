@@ -17,6 +17,7 @@
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 #include <android-base/stringprintf.h>
 #include <utils/Trace.h>
+#include <algorithm>
 #include <vector>
 
 #include "TimeKeeper.h"
@@ -218,8 +219,21 @@ void VSyncDispatchTimerQueue::setTimer(nsecs_t targetTime, nsecs_t /*now*/) {
     mLastTimerSchedule = mTimeKeeper->now();
 }
 
-void VSyncDispatchTimerQueue::rearmTimer(nsecs_t now) {
-    rearmTimerSkippingUpdateFor(now, mCallbacks.end());
+void VSyncDispatchTimerQueue::rekeyArmedCallbackLocked(CallbackToken token,
+                                                       std::optional<nsecs_t> oldWakeup,
+                                                       std::optional<nsecs_t> newWakeup) {
+    if (oldWakeup) {
+        auto const [begin, end] = mArmedCallbacks.equal_range(*oldWakeup);
+        for (auto it = begin; it != end; it++) {
+            if (it->second == token) {
+                mArmedCallbacks.erase(it);
+                break;
+            }
+        }
+    }
+    if (newWakeup) {
+        mArmedCallbacks.emplace(*newWakeup, token);
+    }
 }
 
 void VSyncDispatchTimerQueue::TraceBuffer::note(std::string_view name, nsecs_t alarmIn,
@@ -232,33 +246,29 @@ void VSyncDispatchTimerQueue::TraceBuffer::note(std::string_view name, nsecs_t a
     ATRACE_NAME(str_buffer.data());
 }
 
-void VSyncDispatchTimerQueue::rearmTimerSkippingUpdateFor(
-        nsecs_t now, CallbackMap::iterator const& skipUpdateIt) {
-    std::optional<nsecs_t> min;
-    std::optional<nsecs_t> targetVsync;
-    std::optional<std::string_view> nextWakeupName;
-    for (auto it = mCallbacks.begin(); it != mCallbacks.end(); it++) {
-        auto& callback = it->second;
-        if (!callback->wakeupTime() && !callback->hasPendingWorkloadUpdate()) {
+void VSyncDispatchTimerQueue::rearmTimer(nsecs_t now) {
+    /* Entries keep the vsync estimate they were armed with; the estimate is refreshed when the
+     * entry is scheduled again, so rearming only has to apply deferred workload updates and read
+     * the front of the armed index. */
+    for (auto const token : mPendingWorkloadTokens) {
+        auto const it = mCallbacks.find(token);
+        if (it == mCallbacks.end()) {
             continue;
         }
-
-        if (it != skipUpdateIt) {
-            callback->update(mTracker, now);
-        }
-        auto const wakeupTime = *callback->wakeupTime();
-        if (!min || (min && *min > wakeupTime)) {
-            nextWakeupName = callback->name();
-            min = wakeupTime;
-            targetVsync = callback->targetVsync();
-        }
+        auto& callback = it->second;
+        auto const oldWakeup = callback->wakeupTime();
+        callback->update(mTracker, now);
+        rekeyArmedCallbackLocked(token, oldWakeup, callback->wakeupTime());
     }
+    mPendingWorkloadTokens.clear();
 
-    if (min && (min < mIntendedWakeupTime)) {
-        if (targetVsync && nextWakeupName) {
-            mTraceBuffer.note(*nextWakeupName, *min - now, *targetVsync - now);
+    if (!mArmedCallbacks.empty() && mArmedCallbacks.begin()->first < mIntendedWakeupTime) {
+        auto const& [wakeupTime, token] = *mArmedCallbacks.begin();
+        auto const& callback = mCallbacks.find(token)->second;
+        if (auto const targetVsync = callback->targetVsync()) {
+            mTraceBuffer.note(callback->name(), wakeupTime - now, *targetVsync - now);
         }
-        setTimer(*min, now);
+        setTimer(wakeupTime, now);
     } else {
         ATRACE_NAME("cancel timer");
         cancelTimer();
@@ -277,21 +287,18 @@ void VSyncDispatchTimerQueue::timerCallback() {
         std::lock_guard lock(mMutex);
         auto const now = mTimeKeeper->now();
         mLastTimerCallback = now;
-        for (auto it = mCallbacks.begin(); it != mCallbacks.end(); it++) {
-            auto& callback = it->second;
-            auto const wakeupTime = callback->wakeupTime();
-            if (!wakeupTime) {
-                continue;
-            }
-
-            auto const readyTime = callback->readyTime();
-
-            auto const lagAllowance = std::max(now - mIntendedWakeupTime, static_cast<nsecs_t>(0));
-            if (*wakeupTime < mIntendedWakeupTime + mTimerSlack + lagAllowance) {
-                callback->executing();
-                invocations.emplace_back(Invocation{callback, *callback->lastExecutedVsyncTarget(),
-                                                    *wakeupTime, *readyTime});
-            }
+        auto const lagAllowance = std::max(now - mIntendedWakeupTime, static_cast<nsecs_t>(0));
+        auto const dispatchCutoff = mIntendedWakeupTime + mTimerSlack + lagAllowance;
+        for (auto it = mArmedCallbacks.begin();
+             it != mArmedCallbacks.end() && it->first < dispatchCutoff;
+             it = mArmedCallbacks.erase(it)) {
+            auto& callback = mCallbacks.find(it->second)->second;
+            auto const wakeupTime = *callback->wakeupTime();
+            auto const readyTime = *callback->readyTime();
+            callback->executing();
+            invocations.emplace_back(
+                    Invocation{callback, *callback->lastExecutedVsyncTarget(), wakeupTime,
+                               readyTime});
         }
 
         mIntendedWakeupTime = kInvalidTime;
@@ -323,6 +330,10 @@ void VSyncDispatchTimerQueue::unregisterCallback(CallbackToken token) {
         auto it = mCallbacks.find(token);
         if (it != mCallbacks.end()) {
             entry = it->second;
+            rekeyArmedCallbackLocked(token, entry->wakeupTime(), std::nullopt);
+            mPendingWorkloadTokens.erase(std::remove(mPendingWorkloadTokens.begin(),
+                                                     mPendingWorkloadTokens.end(), token),
+                                         mPendingWorkloadTokens.end());
             mCallbacks.erase(it);
         }
     }
@@ -350,16 +361,22 @@ ScheduleResult VSyncDispatchTimerQueue::schedule(CallbackToken token,
         auto const rearmImminent = now > mIntendedWakeupTime;
         if (CC_UNLIKELY(rearmImminent)) {
             callback->addPendingWorkloadUpdate(scheduleTiming);
+            if (std::find(mPendingWorkloadTokens.begin(), mPendingWorkloadTokens.end(), token) ==
+                mPendingWorkloadTokens.end()) {
+                mPendingWorkloadTokens.push_back(token);
+            }
             return getExpectedCallbackTime(mTracker, now, scheduleTiming);
         }
 
+        auto const oldWakeup = callback->wakeupTime();
         result = callback->schedule(scheduleTiming, mTracker, now);
         if (!result.has_value()) {
             return result;
         }
+        rekeyArmedCallbackLocked(token, oldWakeup, callback->wakeupTime());
 
         if (callback->wakeupTime() < mIntendedWakeupTime - mTimerSlack) {
-            rearmTimerSkippingUpdateFor(now, it);
+            rearmTimer(now);
         }
     }
 
@@ -378,6 +395,7 @@ CancelResult VSyncDispatchTimerQueue::cancel(CallbackToken token) {
     auto const wakeupTime = callback->wakeupTime();
     if (wakeupTime) {
         callback->disarm();
+        rekeyArmedCallbackLocked(token, wakeupTime, std::nullopt);
 
         if (*wakeupTime == mIntendedWakeupTime) {
             mIntendedWakeupTime = kInvalidTime;
@@ -19,11 +19,13 @@
 #include <android-base/thread_annotations.h>
 #include <array>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "SchedulerUtils.h"
 #include "VSyncDispatch.h"
@@ -137,8 +139,8 @@ private:
     void timerCallback();
     void setTimer(nsecs_t, nsecs_t) REQUIRES(mMutex);
     void rearmTimer(nsecs_t now) REQUIRES(mMutex);
-    void rearmTimerSkippingUpdateFor(nsecs_t now, CallbackMap::iterator const& skipUpdate)
-            REQUIRES(mMutex);
+    void rekeyArmedCallbackLocked(CallbackToken, std::optional<nsecs_t> oldWakeup,
+                                  std::optional<nsecs_t> newWakeup) REQUIRES(mMutex);
     void cancelTimer() REQUIRES(mMutex);
 
     static constexpr nsecs_t kInvalidTime = std::numeric_limits<int64_t>::max();
@@ -151,6 +153,12 @@ private:
     size_t mCallbackToken GUARDED_BY(mMutex) = 0;
 
     CallbackMap mCallbacks GUARDED_BY(mMutex);
+    // Armed entries keyed by wakeup time, so rearming reads only the earliest entry and the
+    // dispatch walk touches only the entries that are due.
+    std::multimap<nsecs_t, CallbackToken> mArmedCallbacks GUARDED_BY(mMutex);
+    // Entries whose workload update was deferred by schedule() because the timer was about to
+    // fire; the update is applied on the next rearm.
+    std::vector<CallbackToken> mPendingWorkloadTokens GUARDED_BY(mMutex);
     nsecs_t mIntendedWakeupTime GUARDED_BY(mMutex) = kInvalidTime;
 
     struct TraceBuffer {
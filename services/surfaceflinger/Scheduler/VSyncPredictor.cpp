@@ -29,6 +29,7 @@
 #include <utils/Trace.h>
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <sstream>
 #include "RefreshRateConfigs.h"
 
@@ -43,11 +44,13 @@ static auto constexpr kMaxPercent = 100u;
 VSyncPredictor::~VSyncPredictor() = default;
 
 VSyncPredictor::VSyncPredictor(nsecs_t idealPeriod, size_t historySize,
-                               size_t minimumSamplesForPrediction, uint32_t outlierTolerancePercent)
+                               size_t minimumSamplesForPrediction, uint32_t outlierTolerancePercent,
+                               bool enableKalmanEstimator)
       : mTraceOn(property_get_bool("debug.sf.vsp_trace", true)),
         kHistorySize(historySize),
         kMinimumSamplesForPrediction(minimumSamplesForPrediction),
         kOutlierTolerancePercent(std::min(outlierTolerancePercent, kMaxPercent)),
+        kEnableKalmanEstimator(enableKalmanEstimator),
         mIdealPeriod(idealPeriod) {
     resetModel();
 }
@@ -121,6 +124,10 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
         mTimestamps[mLastTimestampIndex] = timestamp;
     }
 
+    if (kEnableKalmanEstimator) {
+        return updateKalmanModelLocked(timestamp);
+    }
+
     if (mTimestamps.size() < kMinimumSamplesForPrediction) {
         mRateMap[mIdealPeriod] = {mIdealPeriod, 0};
         return true;
@@ -201,6 +208,94 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     return true;
 }
 
+bool VSyncPredictor::updateKalmanModelLocked(nsecs_t timestamp) {
+    // Noise tuning, relative to the ideal period: the measurement noise absorbs hardware
+    // vsync timestamp jitter, while the process noise lets the estimate track slow period
+    // drift. With these values the filter is confident after five clean samples.
+    const double measurementVariance = std::pow(mIdealPeriod * 0.0025, 2);
+    const double vsyncProcessVariance = std::pow(mIdealPeriod * 0.0005, 2);
+    const double periodProcessVariance = std::pow(mIdealPeriod * 0.00005, 2);
+
+    auto& state = mKalmanState;
+    auto it = mRateMap.find(mIdealPeriod);
+
+    if (state.samples == 0) {
+        state.referenceTime = timestamp;
+        state.vsyncTime = 0;
+        state.period = mIdealPeriod;
+        state.vsyncVariance = measurementVariance;
+        state.covariance = 0;
+        // The period is initially known no better than the outlier tolerance allows.
+        state.periodVariance =
+                std::pow(mIdealPeriod * kOutlierTolerancePercent / kMaxPercent, 2);
+        state.samples = 1;
+        it->second = {mIdealPeriod, 0};
+        return true;
+    }
+
+    const double measurement = timestamp - state.referenceTime;
+
+    // Predict: skip over missed hardware vsyncs by advancing a whole number of periods.
+    const double cycles = std::max(1.0, std::round((measurement - state.vsyncTime) / state.period));
+    state.vsyncTime += cycles * state.period;
+    state.vsyncVariance +=
+            cycles * (2 * state.covariance + cycles * state.periodVariance) + vsyncProcessVariance;
+    state.covariance += cycles * state.periodVariance;
+    state.periodVariance += periodProcessVariance;
+
+    // Correct with the measured timestamp; only the vsync time is observed.
+    const double innovation = measurement - state.vsyncTime;
+    const double innovationVariance = state.vsyncVariance + measurementVariance;
+    const double vsyncGain = state.vsyncVariance / innovationVariance;
+    const double periodGain = state.covariance / innovationVariance;
+
+    state.vsyncTime += vsyncGain * innovation;
+    state.period += periodGain * innovation;
+    state.periodVariance -= periodGain * state.covariance;
+    state.covariance *= 1 - vsyncGain;
+    state.vsyncVariance *= 1 - vsyncGain;
+    state.samples++;
+
+    nsecs_t const anticipatedPeriod = static_cast<nsecs_t>(std::round(state.period));
+    auto const percent = std::abs(anticipatedPeriod - mIdealPeriod) * kMaxPercent / mIdealPeriod;
+    if (percent >= kOutlierTolerancePercent) {
+        it->second = {mIdealPeriod, 0};
+        clearTimestamps();
+        return false;
+    }
+
+    if (mTimestamps.size() < kMinimumSamplesForPrediction && !isKalmanConfidentLocked()) {
+        it->second = {mIdealPeriod, 0};
+        return true;
+    }
+
+    // nextAnticipatedVSyncTimeFromLocked() anchors the model at the oldest timestamp in the
+    // ring buffer, so express the estimated vsync time as an intercept relative to it.
+    auto const oldest = *std::min_element(mTimestamps.begin(), mTimestamps.end());
+    auto const estimatedVsync =
+            state.referenceTime + static_cast<nsecs_t>(std::round(state.vsyncTime));
+    auto intercept = (estimatedVsync - oldest) % anticipatedPeriod;
+    if (intercept < 0) {
+        intercept += anticipatedPeriod;
+    }
+
+    traceInt64If("VSP-period", anticipatedPeriod);
+    traceInt64If("VSP-intercept", intercept);
+
+    it->second = {anticipatedPeriod, intercept};
+
+    ALOGV("kalman model update ts: %" PRId64 " slope: %" PRId64 " intercept: %" PRId64, timestamp,
+          anticipatedPeriod, intercept);
+    return true;
+}
+
+bool VSyncPredictor::isKalmanConfidentLocked() const {
+    // The estimate has converged once the period's standard deviation is within 0.1% of the
+    // ideal period.
+    return mKalmanState.samples > 1 &&
+            std::sqrt(mKalmanState.periodVariance) * 1000 < mIdealPeriod;
+}
+
 nsecs_t VSyncPredictor::nextAnticipatedVSyncTimeFromLocked(nsecs_t timePoint) const {
     auto const [slope, intercept] = getVSyncPredictionModelLocked();
 
@@ -337,10 +432,16 @@ void VSyncPredictor::clearTimestamps() {
         mTimestamps.clear();
         mLastTimestampIndex = 0;
     }
+    mKalmanState = {};
 }
 
 bool VSyncPredictor::needsMoreSamples() const {
     std::lock_guard lock(mMutex);
+    if (kEnableKalmanEstimator) {
+        // The filter reports its own confidence, which lets hardware vsync turn off as soon
+        // as the estimate has converged rather than after a fixed number of samples.
+        return !isKalmanConfidentLocked();
+    }
     return mTimestamps.size() < kMinimumSamplesForPrediction;
 }
 
@@ -353,6 +454,11 @@ void VSyncPredictor::resetModel() {
 void VSyncPredictor::dump(std::string& result) const {
     std::lock_guard lock(mMutex);
     StringAppendF(&result, "\tmIdealPeriod=%.2f\n", mIdealPeriod / 1e6f);
+    if (kEnableKalmanEstimator) {
+        StringAppendF(&result, "\tKalman: period=%.3fms stddev=%.3fms samples=%zu confident=%d\n",
+                      mKalmanState.period / 1e6, std::sqrt(mKalmanState.periodVariance) / 1e6,
+                      mKalmanState.samples, isKalmanConfidentLocked());
+    }
     StringAppendF(&result, "\tRefresh Rate Map:\n");
     for (const auto& [idealPeriod, periodInterceptTuple] : mRateMap) {
         StringAppendF(&result,
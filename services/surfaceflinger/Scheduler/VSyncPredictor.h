@@ -33,9 +33,12 @@ public:
      * \param [in] minimumSamplesForPrediction The minimum number of samples to collect before
      * predicting. \param [in] outlierTolerancePercent a number 0 to 100 that will be used to filter
      * samples that fall outlierTolerancePercent from an anticipated vsync event.
+     * \param [in] enableKalmanEstimator Update the model incrementally with a Kalman filter
+     * instead of refitting a linear regression on every sample, and report needsMoreSamples()
+     * from the filter's confidence instead of a fixed sample count.
      */
     VSyncPredictor(nsecs_t idealPeriod, size_t historySize, size_t minimumSamplesForPrediction,
-                   uint32_t outlierTolerancePercent);
+                   uint32_t outlierTolerancePercent, bool enableKalmanEstimator = false);
     ~VSyncPredictor();
 
     bool addVsyncTimestamp(nsecs_t timestamp) final EXCLUDES(mMutex);
@@ -79,6 +82,7 @@ private:
     size_t const kHistorySize;
     size_t const kMinimumSamplesForPrediction;
     size_t const kOutlierTolerancePercent;
+    bool const kEnableKalmanEstimator;
 
     std::mutex mutable mMutex;
     size_t next(size_t i) const REQUIRES(mMutex);
@@ -88,6 +92,24 @@ private:
 
     nsecs_t nextAnticipatedVSyncTimeFromLocked(nsecs_t timePoint) const REQUIRES(mMutex);
 
+    // Incremental Kalman estimate of the vsync model, updated in constant time per sample.
+    // The state is the time of the last observed vsync (kept relative to referenceTime so the
+    // doubles stay precise) and the vsync period; only the vsync time is measured, and missed
+    // hardware vsyncs are skipped over by predicting ahead a whole number of periods.
+    struct KalmanState {
+        nsecs_t referenceTime = 0;
+        double vsyncTime = 0;
+        double period = 0;
+        // Error covariance of [vsyncTime, period].
+        double vsyncVariance = 0;
+        double covariance = 0;
+        double periodVariance = 0;
+        size_t samples = 0;
+    };
+
+    bool updateKalmanModelLocked(nsecs_t timestamp) REQUIRES(mMutex);
+    bool isKalmanConfidentLocked() const REQUIRES(mMutex);
+
     nsecs_t mIdealPeriod GUARDED_BY(mMutex);
     std::optional<nsecs_t> mKnownTimestamp GUARDED_BY(mMutex);
 
@@ -99,6 +121,8 @@ private:
 
     size_t mLastTimestampIndex GUARDED_BY(mMutex) = 0;
     std::vector<nsecs_t> mTimestamps GUARDED_BY(mMutex);
+
+    KalmanState mKalmanState GUARDED_BY(mMutex);
 };
 
 } // namespace android::scheduler
@@ -1063,11 +1063,13 @@ void SurfaceFlinger::init() {
     InitComposerExtn();
     // Get a RenderEngine for the given display / config (can't fail)
     // TODO(b/77156734): We need to stop casting and use HAL types when possible.
-    // Sending maxFrameBufferAcquiredBuffers as the cache size is tightly tuned to single-display.
+    // The output buffers rotate through one more buffer than the consumer
+    // acquires, so size the framebuffer image cache to cover the full
+    // rotation. This is still tightly tuned to single-display.
     mCompositionEngine->setRenderEngine(renderengine::RenderEngine::create(
             renderengine::RenderEngineCreationArgs::Builder()
                     .setPixelFormat(static_cast<int32_t>(defaultCompositionPixelFormat))
-                    .setImageCacheSize(maxFrameBufferAcquiredBuffers)
+                    .setImageCacheSize(maxFrameBufferAcquiredBuffers + 1)
                     .setUseColorManagerment(useColorManagement)
                     .setEnableProtectedContext(enable_protected_contents(false))
                     .setPrecacheToneMapperShaderOnly(false)
@@ -2190,7 +2192,7 @@ status_t SurfaceFlinger::notifyPowerBoost(int32_t boostId) {
     Boost powerBoost = static_cast<Boost>(boostId);
 
     if (powerBoost == Boost::INTERACTION) {
-        mScheduler->notifyTouchEvent();
+        mScheduler->onTouchHint();
     }
 
     return NO_ERROR;
@@ -2220,6 +2222,11 @@ void SurfaceFlinger::signalLayerUpdate() {
     mEventQueue->invalidate();
 }
 
+void SurfaceFlinger::signalLayerUpdate(Layer* layer) {
+    layer->markPendingUpdate();
+    signalLayerUpdate();
+}
+
 void SurfaceFlinger::signalImmedLayerUpdate() {
     notifyDisplayUpdateImminent();
     mEventQueue->invalidateImmed();
@@ -4262,6 +4269,8 @@ void SurfaceFlinger::commitTransactionLocked() {
     commitOffscreenLayers();
     if (mNumClones > 0) {
         mDrawingState.traverse([&](Layer* layer) { layer->updateMirrorInfo(); });
+        // updateMirrorInfo re-attaches the cloned hierarchies as drawing children.
+        mDrawingState.markLayerHierarchyDirty();
     }
 }
 
@@ -4310,6 +4319,15 @@ bool SurfaceFlinger::handlePageFlip() {
     // Display is now waiting on Layer 1's frame, which is behind layer 0's
     // second frame. But layer 0's second frame could be waiting on display.
     mDrawingState.traverse([&](Layer* layer) {
+         // Only layers marked since they last went idle can have a pending
+         // transaction or a frame to latch; skip the rest without the virtual
+         // hasReadyFrame/useEmptyDamage calls. The mark is consumed before the
+         // readiness checks so a producer-side update racing with this pass
+         // leaves the layer marked for the next one.
+         if (!layer->consumePendingUpdate() && !mForceTransactionDisplayChange) {
+             return;
+         }
+
          uint32_t trFlags = layer->getTransactionFlags(eTransactionNeeded);
          if (trFlags || mForceTransactionDisplayChange) {
              const uint32_t flags = layer->doTransaction(0);
@@ -4318,6 +4336,10 @@ bool SurfaceFlinger::handlePageFlip() {
          }
 
          if (layer->hasReadyFrame()) {
+            // Keep the mark while a frame is ready so the layer is visited
+            // again, either to latch the remaining frames or to clear its
+            // damage once it goes idle.
+            layer->markPendingUpdate();
             frameQueued = true;
             if (layer->shouldPresentNow(expectedPresentTime)) {
                 mLayersWithQueuedFrames.emplace(layer);
@@ -4495,6 +4517,7 @@ void SurfaceFlinger::flushTransactionQueues() {
                     transaction.traverseStatesWithBuffers([&](const layer_state_t& state) {
                         bufferLayersReadyToPresent.insert(state.surface);
                     });
+                    decrementQueuedTransactionCount(applyToken);
                     transactions.emplace_back(std::move(transaction));
                     transactionQueue.pop();
                 }
@@ -4526,11 +4549,17 @@ void SurfaceFlinger::flushTransactionQueues() {
                     transaction.traverseStatesWithBuffers([&](const layer_state_t& state) {
                         bufferLayersReadyToPresent.insert(state.surface);
                     });
+                    decrementQueuedTransactionCount(transaction.applyToken);
                     transactions.emplace_back(std::move(transaction));
                 }
                 mTransactionQueue.pop();
                 ATRACE_INT("TransactionQueue", mTransactionQueue.size());
             }
+
+            if (!transactions.empty()) {
+                // Wake any clients blocked on their per-token queue budget.
+                mTransactionQueueCV.broadcast();
+            }
         }
 
         // Now apply all transactions.
@@ -4541,7 +4570,8 @@ void SurfaceFlinger::flushTransactionQueues() {
                                   transaction.isAutoTimestamp, transaction.buffer,
                                   transaction.postTime, transaction.permissions,
                                   transaction.hasListenerCallbacks, transaction.listenerCallbacks,
-                                  transaction.originPid, transaction.originUid, transaction.id);
+                                  transaction.originPid, transaction.originUid, transaction.id,
+                                  transaction.resolvedBuffers);
             if (transaction.transactionCommittedSignal) {
                 mTransactionCommittedSignals.emplace_back(
                         std::move(transaction.transactionCommittedSignal));
@@ -4646,6 +4676,53 @@ bool SurfaceFlinger::transactionIsReadyToBeApplied(
     return true;
 }
 
+void SurfaceFlinger::resolveBufferStates(TransactionState& state) {
+    ATRACE_CALL();
+    state.resolvedBuffers.resize(state.states.size());
+    for (size_t i = 0; i < state.states.size(); i++) {
+        const layer_state_t& s = state.states[i].state;
+        if (!s.surface) {
+            continue;
+        }
+        const bool bufferChanged = s.what & layer_state_t::eBufferChanged;
+        const bool cacheIdChanged = s.what & layer_state_t::eCachedBufferChanged;
+        std::shared_ptr<renderengine::ExternalTexture> buffer;
+        if (bufferChanged && cacheIdChanged && s.buffer != nullptr) {
+            ClientCache::getInstance().add(s.cachedBuffer, s.buffer);
+            buffer = ClientCache::getInstance().get(s.cachedBuffer);
+        } else if (cacheIdChanged) {
+            buffer = ClientCache::getInstance().get(s.cachedBuffer);
+        } else if (bufferChanged && s.buffer != nullptr) {
+            // This also kicks off the import into RenderEngine ahead of the frame the buffer
+            // will first be drawn in.
+            buffer = std::make_shared<
+                    renderengine::ExternalTexture>(s.buffer, getRenderEngine(),
+                                                   renderengine::ExternalTexture::Usage::READABLE);
+        }
+        state.resolvedBuffers[i] = std::move(buffer);
+    }
+
+    // Apply the uncache here as well, so cache operations stay in the order the client issued
+    // them even when earlier transactions from the same client are still waiting in the pending
+    // queues. Transactions queued before this point resolved their textures above, so they are
+    // unaffected by the entry going away.
+    if (state.buffer.isValid()) {
+        ClientCache::getInstance().erase(state.buffer);
+        state.buffer = client_cache_t{};
+    }
+}
+
+void SurfaceFlinger::decrementQueuedTransactionCount(const sp<IBinder>& applyToken) {
+    auto it = mQueuedTransactionCounts.find(applyToken);
+    if (it == mQueuedTransactionCounts.end()) {
+        ALOGW("Transaction applied with no queued count for its apply token");
+        return;
+    }
+    if (--it->second == 0) {
+        mQueuedTransactionCounts.erase(it);
+    }
+}
+
 void SurfaceFlinger::queueTransaction(TransactionState& state) {
     Mutex::Autolock _l(mQueueLock);
 
@@ -4666,6 +4743,24 @@ void SurfaceFlinger::queueTransaction(TransactionState& state) {
         }
     }
 
+    // Apply backpressure per apply token. A client that has queued this much
+    // has stopped being serviced and is only growing the backlog that the main
+    // thread serializes on draining, so block it here until flush catches up
+    // rather than letting it degrade everyone else's composition latency.
+    constexpr uint32_t kMaxQueuedTransactionsPerToken = 500;
+    auto numQueued = mQueuedTransactionCounts.find(state.applyToken);
+    while (numQueued != mQueuedTransactionCounts.end() &&
+           numQueued->second >= kMaxQueuedTransactionsPerToken) {
+        status_t err = mTransactionQueueCV.waitRelative(mQueueLock, s2ns(5));
+        if (CC_UNLIKELY(err != NO_ERROR)) {
+            ALOGW_IF(err == TIMED_OUT,
+                     "setTransactionState timed out "
+                     "waiting for transaction backlog to drain");
+            break;
+        }
+        numQueued = mQueuedTransactionCounts.find(state.applyToken);
+    }
+
     // Generate a CountDownLatch pending state if this is a synchronous transaction.
     if ((state.flags & eSynchronous) || state.inputWindowCommands.syncInputWindows) {
         state.transactionCommittedSignal = std::make_shared<CountDownLatch>(
@@ -4675,6 +4770,7 @@ void SurfaceFlinger::queueTransaction(TransactionState& state) {
     }
 
     mTransactionQueue.emplace(state);
+    mQueuedTransactionCounts[state.applyToken]++;
     ATRACE_INT("TransactionQueue", mTransactionQueue.size());
 
     const auto schedule = [](uint32_t flags) {
@@ -4760,6 +4856,7 @@ status_t SurfaceFlinger::setTransactionState(
         }
         mBufferCountTracker.increment(state.surface->localBinder());
     });
+    resolveBufferStates(state);
     queueTransaction(state);
 
     // Check the pending state to make sure the transaction is synchronous.
@@ -4800,7 +4897,8 @@ void SurfaceFlinger::applyTransactionState(const FrameTimelineInfo& frameTimelin
                                            const int64_t postTime, uint32_t permissions,
                                            bool hasListenerCallbacks,
                                            const std::vector<ListenerCallbacks>& listenerCallbacks,
-                                           int originPid, int originUid, uint64_t transactionId) {
+                                           int originPid, int originUid, uint64_t transactionId,
+                                           const ResolvedBuffers& resolvedBuffers) {
     uint32_t transactionFlags = 0;
     for (const DisplayState& display : displays) {
         transactionFlags |= setDisplayStateLocked(display);
@@ -4816,10 +4914,13 @@ void SurfaceFlinger::applyTransactionState(const FrameTimelineInfo& frameTimelin
 
     std::unordered_set<ListenerCallbacks, ListenerCallbacksHash> listenerCallbacksWithSurfaces;
     uint32_t clientStateFlags = 0;
-    for (const ComposerState& state : states) {
+    for (size_t i = 0; i < states.size(); i++) {
+        const ComposerState& state = states[i];
         clientStateFlags |=
                 setClientStateLocked(frameTimelineInfo, state, desiredPresentTime, isAutoTimestamp,
-                                     postTime, permissions, listenerCallbacksWithSurfaces);
+                                     postTime, permissions,
+                                     i < resolvedBuffers.size() ? resolvedBuffers[i] : nullptr,
+                                     listenerCallbacksWithSurfaces);
         if ((flags & eAnimation) && state.state.surface) {
             if (const auto layer = fromHandle(state.state.surface).promote(); layer) {
                 mScheduler->recordLayerHistory(layer.get(),
@@ -4986,6 +5087,7 @@ bool SurfaceFlinger::callingThreadHasUnscopedSurfaceFlingerAccess(bool usePermis
 uint32_t SurfaceFlinger::setClientStateLocked(
         const FrameTimelineInfo& frameTimelineInfo, const ComposerState& composerState,
         int64_t desiredPresentTime, bool isAutoTimestamp, int64_t postTime, uint32_t permissions,
+        const std::shared_ptr<renderengine::ExternalTexture>& resolvedBuffer,
         std::unordered_set<ListenerCallbacks, ListenerCallbacksHash>& outListenerCallbacks) {
     const layer_state_t& s = composerState.state;
     const bool privileged = permissions & Permission::ACCESS_SURFACE_FLINGER;
@@ -5303,7 +5405,10 @@ uint32_t SurfaceFlinger::setClientStateLocked(
     bool bufferChanged = what & layer_state_t::eBufferChanged;
     bool cacheIdChanged = what & layer_state_t::eCachedBufferChanged;
     std::shared_ptr<renderengine::ExternalTexture> buffer;
-    if (bufferChanged && cacheIdChanged && s.buffer != nullptr) {
+    if (resolvedBuffer) {
+        // Resolved at queue time on the binder thread; see resolveBufferStates.
+        buffer = resolvedBuffer;
+    } else if (bufferChanged && cacheIdChanged && s.buffer != nullptr) {
         ClientCache::getInstance().add(s.cachedBuffer, s.buffer);
         buffer = ClientCache::getInstance().get(s.cachedBuffer);
     } else if (cacheIdChanged) {
@@ -5477,28 +5582,19 @@ status_t SurfaceFlinger::createLayer(const String8& name, const sp<Client>& clie
 }
 
 std::string SurfaceFlinger::getUniqueLayerName(const char* name) {
-    unsigned dupeCounter = 0;
-
-    // Tack on our counter whether there is a hit or not, so everyone gets a tag
-    std::string uniqueName = base::StringPrintf("%s#%u", name, dupeCounter);
-
-    // Grab the state lock since we're accessing mCurrentState
-    Mutex::Autolock lock(mStateLock);
-
-    // Loop over layers until we're sure there is no matching name
-    bool matchFound = true;
-    while (matchFound) {
-        matchFound = false;
-        mCurrentState.traverse([&](Layer* layer) {
-            if (layer->getName() == uniqueName) {
-                matchFound = true;
-                uniqueName = base::StringPrintf("%s#%u", name, ++dupeCounter);
-            }
-        });
+    // Tack on a counter whether there is a duplicate or not, so everyone gets a tag. The counter
+    // only grows, so a name freed by layer destruction is not reused, but that keeps creation off
+    // mStateLock: the previous scheme re-traversed mCurrentState per creation, which serialized
+    // bursts of createSurface calls during app launch behind the main thread.
+    unsigned dupeCounter;
+    {
+        std::lock_guard lock(mLayerNameMutex);
+        dupeCounter = mLayerNameCounts[name]++;
     }
 
-    ALOGV_IF(dupeCounter > 0, "duplicate layer name: changing %s to %s", name, uniqueName.c_str());
-    return uniqueName;
+    ALOGV_IF(dupeCounter > 0, "duplicate layer name: changing %s to %s#%u", name, name,
+             dupeCounter);
+    return base::StringPrintf("%s#%u", name, dupeCounter);
 }
 
 status_t SurfaceFlinger::createBufferQueueLayer(const sp<Client>& client, std::string name,
@@ -5621,7 +5717,7 @@ void SurfaceFlinger::onInitializeDisplays() {
     // It should be on the main thread, apply it directly.
     applyTransactionState(FrameTimelineInfo{}, state, displays, 0, mInputWindowCommands,
                           /* desiredPresentTime */ now, true, {}, /* postTime */ now, true, false,
-                          {}, getpid(), getuid(), 0 /* Undefined transactionId */);
+                          {}, getpid(), getuid(), 0 /* Undefined transactionId */, {});
 
     setPowerModeInternal(display, hal::PowerMode::ON);
     const nsecs_t vsyncPeriod = mRefreshRateConfigs->getCurrentRefreshRate().getVsyncPeriod();
@@ -5858,9 +5954,16 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
         StringAppendF(&result, "Permission Denial: can't dump SurfaceFlinger from pid=%d, uid=%d\n",
                       pid, uid);
     } else {
+        // These dumpers only read state that has its own synchronization, so they run without
+        // touching mStateLock and cannot stall (or be stalled by) composition.
+        static const std::unordered_map<std::string, Dumper> lockFreeDumpers = {
+                {"--dispsync"s, dumper([this](std::string& s) { mScheduler->dumpVsync(s); })},
+                {"--frametimeline"s, argsDumper(&SurfaceFlinger::dumpFrameTimeline)},
+                {"--timestats"s, protoDumper(&SurfaceFlinger::dumpTimeStats)},
+        };
+
         static const std::unordered_map<std::string, Dumper> dumpers = {
                 {"--display-id"s, dumper(&SurfaceFlinger::dumpDisplayIdentificationData)},
-                {"--dispsync"s, dumper([this](std::string& s) { mScheduler->dumpVsync(s); })},
                 {"--edid"s, argsDumper(&SurfaceFlinger::dumpRawDisplayIdentificationData)},
                 {"--frame-events"s, dumper(&SurfaceFlinger::dumpFrameEventsLocked)},
                 {"--latency"s, argsDumper(&SurfaceFlinger::dumpStatsLocked)},
@@ -5868,16 +5971,17 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
                 {"--list"s, dumper(&SurfaceFlinger::listLayersLocked)},
                 {"--planner"s, argsDumper(&SurfaceFlinger::dumpPlannerInfo)},
                 {"--static-screen"s, dumper(&SurfaceFlinger::dumpStaticScreenStats)},
-                {"--timestats"s, protoDumper(&SurfaceFlinger::dumpTimeStats)},
                 {"--vsync"s, dumper(&SurfaceFlinger::dumpVSync)},
                 {"--wide-color"s, dumper(&SurfaceFlinger::dumpWideColorInfo)},
-                {"--frametimeline"s, argsDumper(&SurfaceFlinger::dumpFrameTimeline)},
         };
 
         const auto flag = args.empty() ? ""s : std::string(String8(args[0]));
 
         bool dumpLayers = true;
-        {
+        if (const auto it = lockFreeDumpers.find(flag); it != lockFreeDumpers.end()) {
+            (it->second)(args, asProto, result);
+            dumpLayers = false;
+        } else {
             TimedLock lock(mStateLock, s2ns(1), __FUNCTION__);
             if (!lock.locked()) {
                 StringAppendF(&result, "Dumping without lock after timeout: %s (%d)\n",
@@ -7989,7 +8093,19 @@ void SurfaceFlinger::setInputWindowsFinished() {
 // ---------------------------------------------------------------------------
 
 void SurfaceFlinger::State::traverse(const LayerVector::Visitor& visitor) const {
-    layersSortedByZ.traverse(visitor);
+    if (stateSet != LayerVector::StateSet::Drawing) {
+        layersSortedByZ.traverse(visitor);
+        return;
+    }
+
+    if (mFlattenedLayersDirty) {
+        mFlattenedLayers.clear();
+        layersSortedByZ.traverse([this](Layer* layer) { mFlattenedLayers.push_back(layer); });
+        mFlattenedLayersDirty = false;
+    }
+    for (Layer* layer : mFlattenedLayers) {
+        visitor(layer);
+    }
 }
 
 void SurfaceFlinger::State::traverseInZOrder(const LayerVector::Visitor& visitor) const {
@@ -413,10 +413,16 @@ protected:
     // We're reference counted, never destroy SurfaceFlinger directly
     virtual ~SurfaceFlinger();
 
+    // Buffers resolved on the binder thread at queue time, one entry per composer state in the
+    // transaction (null when the state carries no buffer), so applying a transaction on the main
+    // thread only picks up prepared textures instead of importing buffers inside the frame window.
+    using ResolvedBuffers = std::vector<std::shared_ptr<renderengine::ExternalTexture>>;
+
     virtual uint32_t setClientStateLocked(
             const FrameTimelineInfo& info, const ComposerState& composerState,
             int64_t desiredPresentTime, bool isAutoTimestamp, int64_t postTime,
             uint32_t permissions,
+            const std::shared_ptr<renderengine::ExternalTexture>& resolvedBuffer,
             std::unordered_set<ListenerCallbacks, ListenerCallbacksHash>& listenerCallbacks)
             REQUIRES(mStateLock);
     virtual void commitTransactionLocked();
@@ -472,6 +478,9 @@ private:
             }
             globalShadowSettings = other.globalShadowSettings;
 
+            // The copy may have changed the hierarchy, so any flattening of it is stale.
+            mFlattenedLayersDirty = true;
+
             return *this;
         }
 
@@ -487,6 +496,20 @@ private:
         void traverse(const LayerVector::Visitor& visitor) const;
         void traverseInZOrder(const LayerVector::Visitor& visitor) const;
         void traverseInReverseZOrder(const LayerVector::Visitor& visitor) const;
+
+        // Must be called whenever the layer hierarchy of this state is mutated outside of
+        // operator=, e.g. when cloned hierarchies are re-attached or layersSortedByZ is
+        // edited in place.
+        void markLayerHierarchyDirty() { mFlattenedLayersDirty = true; }
+
+    private:
+        // Flattened snapshot of the hierarchy in traverse() order. traverse() runs several
+        // times per frame on the main thread, and iterating a contiguous array is much
+        // cheaper than re-walking the tree with a callback per node. The cache is only
+        // maintained for the drawing state, whose hierarchy is stable between commits; the
+        // current state mutates outside commits and always takes the recursive path.
+        mutable std::vector<Layer*> mFlattenedLayers;
+        mutable bool mFlattenedLayersDirty = true;
     };
 
     // Keeps track of pending buffers per layer handle in the transaction queue or current/drawing
@@ -647,6 +670,7 @@ private:
         int originUid;
         uint64_t id;
         std::shared_ptr<CountDownLatch> transactionCommittedSignal;
+        ResolvedBuffers resolvedBuffers;
     };
 
     template <typename F, std::enable_if_t<!std::is_member_function_pointer_v<F>>* = nullptr>
@@ -856,6 +880,9 @@ private:
     void signalTransaction();
     // Can only be called from the main thread or with mStateLock held
     void signalLayerUpdate();
+    // Additionally marks the layer as having a pending update so the next
+    // latch pass visits it. Safe to call from any thread.
+    void signalLayerUpdate(Layer* layer);
     void signalRefresh();
     void signalImmedLayerUpdate();
 
@@ -932,8 +959,8 @@ private:
                                const client_cache_t& uncacheBuffer, const int64_t postTime,
                                uint32_t permissions, bool hasListenerCallbacks,
                                const std::vector<ListenerCallbacks>& listenerCallbacks,
-                               int originPid, int originUid, uint64_t transactionId)
-            REQUIRES(mStateLock);
+                               int originPid, int originUid, uint64_t transactionId,
+                               const ResolvedBuffers& resolvedBuffers) REQUIRES(mStateLock);
     // flush pending transaction that was presented after desiredPresentTime.
     void flushTransactionQueues();
     // Returns true if there is at least one transaction that needs to be flushed
@@ -1325,7 +1352,13 @@ private:
     status_t CheckTransactCodeCredentials(uint32_t code);
 
     // Add transaction to the Transaction Queue
+    // Resolves the buffers carried by a transaction into render engine textures and applies its
+    // buffer uncache, in queue order on the calling binder thread, so the main thread does not
+    // spend frame time importing buffers or touching the client cache.
+    void resolveBufferStates(TransactionState& state);
     void queueTransaction(TransactionState& state) EXCLUDES(mQueueLock);
+    // Drops one queued transaction from the given apply token's budget.
+    void decrementQueuedTransactionCount(const sp<IBinder>& applyToken) REQUIRES(mQueueLock);
     void waitForSynchronousTransaction(const CountDownLatch& transactionCommittedSignal);
     void signalSynchronousTransactions(const uint32_t flag);
 
@@ -1511,6 +1544,11 @@ private:
     std::unordered_map<sp<IBinder>, std::queue<TransactionState>, IListenerHash>
             mPendingTransactionQueues GUARDED_BY(mQueueLock);
     std::queue<TransactionState> mTransactionQueue GUARDED_BY(mQueueLock);
+    // Number of queued transactions (in mTransactionQueue or a pending queue)
+    // per apply token, so queueTransaction can apply backpressure in O(1)
+    // without walking the queues.
+    std::unordered_map<sp<IBinder>, uint32_t, IListenerHash> mQueuedTransactionCounts
+            GUARDED_BY(mQueueLock);
     /*
      * Feature prototyping
      */
@@ -1660,6 +1698,11 @@ private:
     auto getLayerCreatedState(const sp<IBinder>& handle);
     sp<Layer> handleLayerCreatedLocked(const sp<IBinder>& handle) REQUIRES(mStateLock);
 
+    // Count of layers created so far per base name, used by getUniqueLayerName to pick the
+    // suffix for the next layer without traversing mCurrentState under mStateLock.
+    std::mutex mLayerNameMutex;
+    std::unordered_map<std::string, unsigned> mLayerNameCounts GUARDED_BY(mLayerNameMutex);
+
     std::atomic<ui::Transform::RotationFlags> mDefaultDisplayTransformHint;
 
     void scheduleRegionSamplingThread();
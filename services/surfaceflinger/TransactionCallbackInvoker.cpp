@@ -248,6 +248,12 @@ void TransactionCallbackInvoker::addPresentFence(const sp<Fence>& presentFence)
     mPresentFence = presentFence;
 }
 
+void TransactionCallbackInvoker::queueReleaseBufferCallback(
+        const sp<ITransactionCompletedListener>& listener, ReleaseBufferStats stats) {
+    std::lock_guard lock(mMutex);
+    mPendingReleaseStats[IInterface::asBinder(listener)].emplace_back(std::move(stats));
+}
+
 void TransactionCallbackInvoker::sendCallbacks() {
     std::lock_guard lock(mMutex);
 
@@ -319,6 +325,13 @@ void TransactionCallbackInvoker::sendCallbacks() {
         }
     }
 
+    // Flush every release queued since the last commit as a single callback per listener.
+    for (auto& [listener, releaseStats] : mPendingReleaseStats) {
+        interface_cast<ITransactionCompletedListener>(listener)
+                ->onReleaseBuffers(std::move(releaseStats));
+    }
+    mPendingReleaseStats.clear();
+
     if (mPresentFence) {
         mPresentFence.clear();
     }
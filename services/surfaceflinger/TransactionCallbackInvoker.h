@@ -84,6 +84,12 @@ public:
 
     void addPresentFence(const sp<Fence>& presentFence);
 
+    // Queues a buffer that was released outside of a completed transaction (a dropped frame or
+    // layer teardown). The queued releases are coalesced into a single onReleaseBuffers call per
+    // listener the next time sendCallbacks() runs instead of one binder call per buffer.
+    void queueReleaseBufferCallback(const sp<ITransactionCompletedListener>& listener,
+                                    ReleaseBufferStats stats);
+
     void sendCallbacks();
 
 private:
@@ -128,6 +134,9 @@ private:
     std::unordered_map<sp<IBinder>, std::deque<TransactionStats>, IListenerHash>
             mCompletedTransactions GUARDED_BY(mMutex);
 
+    std::unordered_map<sp<IBinder>, std::vector<ReleaseBufferStats>, IListenerHash>
+            mPendingReleaseStats GUARDED_BY(mMutex);
+
     sp<Fence> mPresentFence GUARDED_BY(mMutex);
 };
 
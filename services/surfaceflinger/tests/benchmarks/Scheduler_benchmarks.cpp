@@ -0,0 +1,265 @@
+/*
+ * Copyright 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#undef LOG_TAG
+#define LOG_TAG "SchedulerBenchmarks"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <private/gui/BitTube.h>
+
+#include "Scheduler/EventThread.h"
+#include "Scheduler/InjectVSyncSource.h"
+#include "Scheduler/TimeKeeper.h"
+#include "Scheduler/VSyncDispatchTimerQueue.h"
+#include "Scheduler/VSyncPredictor.h"
+
+using namespace std::chrono_literals;
+
+namespace android {
+namespace {
+
+// 60Hz, matching the scheduler's initial period.
+constexpr nsecs_t kPeriod = 16'666'667;
+
+// Mirror the production tuning in Scheduler.cpp so the measured costs track
+// what ships; see createVSyncTracker/createVSyncDispatch.
+constexpr size_t kHistorySize = 20;
+constexpr size_t kMinimumSamplesForPrediction = 6;
+constexpr uint32_t kOutlierTolerancePercent = 20;
+constexpr nsecs_t kTimerSlack = std::chrono::nanoseconds(500us).count();
+constexpr nsecs_t kVsyncMoveThreshold = std::chrono::nanoseconds(3ms).count();
+
+// A TimeKeeper over a synthetic clock: alarms are stored and fired manually,
+// jumping the clock to the wakeup time like a perfectly punctual timer thread.
+// This removes real timerfd waits from the measurement so what's left is the
+// dispatch machinery itself.
+class SyntheticTimeKeeper : public scheduler::TimeKeeper {
+public:
+    nsecs_t now() const override { return mNow; }
+
+    void alarmAt(std::function<void()> const& callback, nsecs_t time) override {
+        mCallback = callback;
+        mAlarmTime = time;
+    }
+
+    void alarmCancel() override { mCallback = nullptr; }
+    void dump(std::string&) const override {}
+
+    bool alarmPending() const { return mCallback != nullptr; }
+
+    void fireAlarm() {
+        if (!mCallback) {
+            return;
+        }
+        mNow = std::max(mNow, mAlarmTime);
+        // The callback will usually re-arm us, so hand off before invoking.
+        auto const callback = mCallback;
+        mCallback = nullptr;
+        callback();
+    }
+
+private:
+    std::function<void()> mCallback;
+    nsecs_t mAlarmTime = 0;
+    nsecs_t mNow = 0;
+};
+
+// One display worth of frame pacing state: a predictor seeded with a steady
+// period and a timer queue dispatching over the synthetic clock.
+struct SimulatedDisplay {
+    explicit SimulatedDisplay(nsecs_t period)
+          : tracker(period, kHistorySize, kMinimumSamplesForPrediction, kOutlierTolerancePercent) {
+        auto keeper = std::make_unique<SyntheticTimeKeeper>();
+        timeKeeper = keeper.get();
+        dispatch = std::make_unique<scheduler::VSyncDispatchTimerQueue>(std::move(keeper), tracker,
+                                                                        kTimerSlack,
+                                                                        kVsyncMoveThreshold);
+        for (size_t i = 1; i <= kMinimumSamplesForPrediction; i++) {
+            tracker.addVsyncTimestamp(static_cast<nsecs_t>(i) * period);
+        }
+    }
+
+    scheduler::VSyncPredictor tracker;
+    SyntheticTimeKeeper* timeKeeper = nullptr;
+    std::unique_ptr<scheduler::VSyncDispatchTimerQueue> dispatch;
+    nsecs_t lastVsync = 0;
+};
+
+// A registered listener that remembers the last vsync it was dispatched for,
+// standing in for an EventThread or the SF main thread callback.
+struct Listener {
+    Listener(SimulatedDisplay& display, std::string name, nsecs_t workDuration)
+          : display(display),
+            workDuration(workDuration),
+            token(display.dispatch->registerCallback(
+                    [this](nsecs_t vsyncTime, nsecs_t, nsecs_t) {
+                        this->display.lastVsync = std::max(this->display.lastVsync, vsyncTime);
+                        dispatched++;
+                    },
+                    std::move(name))) {}
+    ~Listener() { display.dispatch->unregisterCallback(token); }
+
+    void scheduleNext() {
+        display.dispatch->schedule(token,
+                                   {.workDuration = workDuration,
+                                    .readyDuration = 0,
+                                    .earliestVsync = display.lastVsync});
+    }
+
+    SimulatedDisplay& display;
+    nsecs_t const workDuration;
+    scheduler::VSyncDispatch::CallbackToken token;
+    size_t dispatched = 0;
+};
+
+void reportLatencyPercentiles(benchmark::State& state, std::vector<nsecs_t>& samples) {
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto const percentile = [&](double p) {
+        size_t const index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+        return static_cast<double>(samples[index]);
+    };
+    state.counters["lat_p50_ns"] = percentile(0.50);
+    state.counters["lat_p90_ns"] = percentile(0.90);
+    state.counters["lat_p99_ns"] = percentile(0.99);
+}
+
+// Cost of feeding the vsync model one hardware timestamp and re-querying the
+// next anticipated vsync, as VSyncReactor does while resyncing.
+void BM_VSyncPredictorModelUpdate(benchmark::State& state) {
+    scheduler::VSyncPredictor predictor(kPeriod, kHistorySize, kMinimumSamplesForPrediction,
+                                        kOutlierTolerancePercent);
+    nsecs_t vsync = 0;
+    int64_t sample = 0;
+    for (auto _ : state) {
+        // ±150us of deterministic jitter keeps the regression from degenerating.
+        nsecs_t const jitter = (sample % 3 - 1) * 150'000;
+        vsync += kPeriod;
+        sample++;
+        predictor.addVsyncTimestamp(vsync + jitter);
+        benchmark::DoNotOptimize(predictor.nextAnticipatedVSyncTimeFrom(vsync));
+    }
+}
+BENCHMARK(BM_VSyncPredictorModelUpdate);
+
+// One simulated frame per iteration: every listener on every display schedules
+// against the next predicted vsync, then the synthetic timer fires until all
+// wakeups for the frame have dispatched. Listener work durations are spread
+// over ~1ms so a frame exercises grouped and split wakeups, like a mix of SF
+// and app offsets does. Reports wall-clock per-frame latency percentiles on
+// top of the usual per-iteration CPU time.
+void BM_VSyncDispatchFrame(benchmark::State& state) {
+    size_t const numDisplays = static_cast<size_t>(state.range(0));
+    size_t const numListeners = static_cast<size_t>(state.range(1));
+
+    std::vector<std::unique_ptr<SimulatedDisplay>> displays;
+    std::vector<std::unique_ptr<Listener>> listeners;
+    for (size_t i = 0; i < numDisplays; i++) {
+        // Slightly detuned periods so displays don't beat in lockstep.
+        displays.push_back(std::make_unique<SimulatedDisplay>(
+                kPeriod + static_cast<nsecs_t>(i) * 200'000));
+        for (size_t j = 0; j < numListeners; j++) {
+            listeners.push_back(
+                    std::make_unique<Listener>(*displays[i], "listener" + std::to_string(j),
+                                               4'000'000 + static_cast<nsecs_t>(j) * 50'000));
+        }
+    }
+
+    std::vector<nsecs_t> frameLatencies;
+    for (auto _ : state) {
+        auto const start = std::chrono::steady_clock::now();
+        for (auto& listener : listeners) {
+            listener->scheduleNext();
+        }
+        for (auto& display : displays) {
+            while (display->timeKeeper->alarmPending()) {
+                display->timeKeeper->fireAlarm();
+            }
+        }
+        auto const end = std::chrono::steady_clock::now();
+        frameLatencies.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    size_t dispatched = 0;
+    for (auto& listener : listeners) {
+        dispatched += listener->dispatched;
+    }
+    state.counters["callbacks_per_frame"] = benchmark::Counter(
+            static_cast<double>(dispatched) / static_cast<double>(state.iterations()));
+    reportLatencyPercentiles(state, frameLatencies);
+}
+BENCHMARK(BM_VSyncDispatchFrame)
+        ->ArgsProduct({{1, 2, 3}, {1, 4, 16, 64}})
+        ->ArgNames({"displays", "listeners"});
+
+// End-to-end EventThread fanout: M app connections request the next vsync, a
+// vsync is injected, and the iteration ends when every connection's BitTube
+// has the event. This covers the real thread handoff and per-connection
+// socket writes that the synthetic-clock benchmarks above leave out.
+void BM_EventThreadFanout(benchmark::State& state) {
+    size_t const numConnections = static_cast<size_t>(state.range(0));
+
+    auto source = std::make_unique<InjectVSyncSource>();
+    auto* const injector = source.get();
+    impl::EventThread thread(std::move(source), /*tokenManager=*/nullptr,
+                             /*interceptVSyncsCallback=*/nullptr, /*throttleVsyncCallback=*/nullptr,
+                             [](uid_t) { return kPeriod; });
+
+    std::vector<sp<EventThreadConnection>> connections;
+    std::vector<gui::BitTube> tubes(numConnections);
+    for (size_t i = 0; i < numConnections; i++) {
+        connections.push_back(thread.createEventConnection([] {}));
+        connections.back()->stealReceiveChannel(&tubes[i]);
+    }
+
+    std::vector<nsecs_t> deliveryLatencies;
+    DisplayEventReceiver::Event events[8];
+    nsecs_t now = systemTime();
+    for (auto _ : state) {
+        for (auto& connection : connections) {
+            thread.requestNextVsync(connection);
+        }
+        auto const start = std::chrono::steady_clock::now();
+        now += kPeriod;
+        injector->onInjectSyncEvent(now, now + kPeriod, now + kPeriod / 2);
+        for (auto& tube : tubes) {
+            // Spin until this connection's event lands; delivery order matches
+            // registration order so later tubes are usually already readable.
+            while (DisplayEventReceiver::getEvents(&tube, events, std::size(events)) <= 0) {
+            }
+        }
+        auto const end = std::chrono::steady_clock::now();
+        deliveryLatencies.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    reportLatencyPercentiles(state, deliveryLatencies);
+}
+BENCHMARK(BM_EventThreadFanout)->RangeMultiplier(4)->Range(1, 64)->ArgName("connections");
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -89,6 +89,7 @@ protected:
                                             std::chrono::nanoseconds expectedReadyDuration);
     VSyncSource::Callback* expectVSyncSetCallbackCallReceived();
     void expectInterceptCallReceived(nsecs_t expectedTimestamp);
+    void expectThrottleVsyncReceived(nsecs_t expectedTimestamp, uid_t);
     void expectVsyncEventReceivedByConnection(const char* name,
                                               ConnectionEventRecorder& connectionEventRecorder,
                                               nsecs_t expectedTimestamp, unsigned expectedCount);
@@ -98,7 +99,6 @@ protected:
     void expectConfigChangedEventReceivedByConnection(PhysicalDisplayId expectedDisplayId,
                                                       int32_t expectedConfigId,
                                                       nsecs_t expectedVsyncPeriod);
-    void expectThrottleVsyncReceived(nsecs_t expectedTimestamp, uid_t);
     void expectUidFrameRateMappingEventReceivedByConnection(PhysicalDisplayId expectedDisplayId,
                                                             std::vector<FrameRateOverride>);
 
@@ -175,6 +175,10 @@ void EventThreadTest::createThread(std::unique_ptr<VSyncSource> source) {
                                                   mInterceptVSyncCallRecorder.getInvocable(),
                                                   throttleVsync, getVsyncPeriod);
 
+    // Mark the throttled connection's uid as overridden, so the event thread consults the
+    // throttle callback for it.
+    mThread->setVsyncFrameRateDividers({{mThrottledConnectionUid, 2}});
+
     // EventThread should register itself as VSyncSource callback.
     mCallback = expectVSyncSetCallbackCallReceived();
     ASSERT_TRUE(mCallback);
@@ -325,7 +329,6 @@ TEST_F(EventThreadTest, requestNextVsyncPostsASingleVSyncEventToTheConnection) {
     // The interceptor should receive the event, as well as the connection.
     mCallback->onVSyncEvent(123, 456, 789);
     expectInterceptCallReceived(123);
-    expectThrottleVsyncReceived(456, mConnectionUid);
     expectVsyncEventReceivedByConnection(123, 1u);
 
     // Use the received callback to signal a second vsync event.
@@ -333,7 +336,6 @@ TEST_F(EventThreadTest, requestNextVsyncPostsASingleVSyncEventToTheConnection) {
     // not as it was only interested in the first.
     mCallback->onVSyncEvent(456, 123, 0);
     expectInterceptCallReceived(456);
-    EXPECT_FALSE(mThrottleVsyncCallRecorder.waitForUnexpectedCall().has_value());
     EXPECT_FALSE(mConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
 
     // EventThread should also detect that at this point that it does not need
@@ -380,19 +382,16 @@ TEST_F(EventThreadTest, setVsyncRateOnePostsAllEventsToThatConnection) {
     // interceptor, and the connection.
     mCallback->onVSyncEvent(123, 456, 789);
     expectInterceptCallReceived(123);
-    expectThrottleVsyncReceived(456, mConnectionUid);
     expectVsyncEventReceivedByConnection(123, 1u);
 
     // A second event should go to the same places.
     mCallback->onVSyncEvent(456, 123, 0);
     expectInterceptCallReceived(456);
-    expectThrottleVsyncReceived(123, mConnectionUid);
     expectVsyncEventReceivedByConnection(456, 2u);
 
     // A third event should go to the same places.
     mCallback->onVSyncEvent(789, 777, 111);
     expectInterceptCallReceived(789);
-    expectThrottleVsyncReceived(777, mConnectionUid);
     expectVsyncEventReceivedByConnection(789, 3u);
 }
 
@@ -406,19 +405,16 @@ TEST_F(EventThreadTest, setVsyncRateTwoPostsEveryOtherEventToThatConnection) {
     mCallback->onVSyncEvent(123, 456, 789);
     expectInterceptCallReceived(123);
     EXPECT_FALSE(mConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
-    EXPECT_FALSE(mThrottleVsyncCallRecorder.waitForUnexpectedCall().has_value());
 
     // The second event will be seen by the interceptor and the connection.
     mCallback->onVSyncEvent(456, 123, 0);
     expectInterceptCallReceived(456);
     expectVsyncEventReceivedByConnection(456, 2u);
-    EXPECT_FALSE(mThrottleVsyncCallRecorder.waitForUnexpectedCall().has_value());
 
     // The third event will be seen by the interceptor, and not the connection.
     mCallback->onVSyncEvent(789, 777, 744);
     expectInterceptCallReceived(789);
     EXPECT_FALSE(mConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
-    EXPECT_FALSE(mThrottleVsyncCallRecorder.waitForUnexpectedCall().has_value());
 
     // The fourth event will be seen by the interceptor and the connection.
     mCallback->onVSyncEvent(101112, 7847, 86);
@@ -598,34 +594,72 @@ TEST_F(EventThreadTest, suppressUidFrameRateMapping) {
     ASSERT_FALSE(args.has_value());
 }
 
-TEST_F(EventThreadTest, requestNextVsyncWithThrottleVsyncDoesntPostVSync) {
-    // Signal that we want the next vsync event to be posted to the throttled connection
-    mThread->requestNextVsync(mThrottledConnection);
+TEST_F(EventThreadTest, setVsyncRateOnePostsNoVSyncToOutOfPhaseThrottledConnection) {
+    mThread->setVsyncRate(1, mThrottledConnection);
 
-    // EventThread should immediately request a resync.
-    EXPECT_TRUE(mResyncCallRecorder.waitForCall().has_value());
+    // EventThread should enable vsync callbacks.
+    expectVSyncSetEnabledCallReceived(true);
+
+    // The throttled uid has a divider, so the phase predicate decides; it
+    // judges the vsync out of phase and the event is not posted.
+    mCallback->onVSyncEvent(123, 456, 789);
+    expectInterceptCallReceived(123);
+    expectThrottleVsyncReceived(456, mThrottledConnectionUid);
+    EXPECT_FALSE(mThrottledConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
+}
+
+TEST_F(EventThreadTest, setVsyncRateOneSkipsPhaseQueryForUnthrottledUid) {
+    mThread->setVsyncRate(1, mConnection);
 
     // EventThread should enable vsync callbacks.
     expectVSyncSetEnabledCallReceived(true);
 
-    // Use the received callback to signal a first vsync event.
-    // The interceptor should receive the event, but not the connection.
+    // A uid without a divider is delivered every vsync without asking the
+    // scheduler about phase.
+    mCallback->onVSyncEvent(123, 456, 789);
+    expectInterceptCallReceived(123);
+    expectVsyncEventReceivedByConnection(123, 1u);
+    EXPECT_FALSE(mThrottleVsyncCallRecorder.waitForUnexpectedCall().has_value());
+}
+
+TEST_F(EventThreadTest, requestNextVsyncGatedByPhaseStaysPending) {
+    mThread->requestNextVsync(mThrottledConnection);
+    EXPECT_TRUE(mResyncCallRecorder.waitForCall().has_value());
+    expectVSyncSetEnabledCallReceived(true);
+
+    // Out-of-phase vsyncs are skipped and the request stays pending rather
+    // than being consumed.
     mCallback->onVSyncEvent(123, 456, 789);
     expectInterceptCallReceived(123);
     expectThrottleVsyncReceived(456, mThrottledConnectionUid);
-    mThrottledConnectionEventCallRecorder.waitForUnexpectedCall();
+    EXPECT_FALSE(mThrottledConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
 
-    // Use the received callback to signal a second vsync event.
-    // The interceptor should receive the event, but the connection should
-    // not as it was only interested in the first.
     mCallback->onVSyncEvent(456, 123, 0);
     expectInterceptCallReceived(456);
     expectThrottleVsyncReceived(123, mThrottledConnectionUid);
-    EXPECT_FALSE(mConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
+    EXPECT_FALSE(mThrottledConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
+}
 
-    // EventThread should not change the vsync state as it didn't send the event
-    // yet
-    EXPECT_FALSE(mVSyncSetEnabledCallRecorder.waitForUnexpectedCall().has_value());
+TEST_F(EventThreadTest, clearingFrameRateDividersStopsThrottling) {
+    mThread->setVsyncRate(1, mThrottledConnection);
+
+    // EventThread should enable vsync callbacks.
+    expectVSyncSetEnabledCallReceived(true);
+
+    // Throttled while the divider is present.
+    mCallback->onVSyncEvent(123, 456, 789);
+    expectInterceptCallReceived(123);
+    expectThrottleVsyncReceived(456, mThrottledConnectionUid);
+    EXPECT_FALSE(mThrottledConnectionEventCallRecorder.waitForUnexpectedCall().has_value());
+
+    // With the override gone the phase predicate is no longer consulted and
+    // every vsync is delivered again.
+    mThread->setVsyncFrameRateDividers({});
+    mCallback->onVSyncEvent(456, 123, 0);
+    expectInterceptCallReceived(456);
+    expectVsyncEventReceivedByConnection("mThrottledConnectionEventCallRecorder",
+                                         mThrottledConnectionEventCallRecorder, 456, 2u);
+    EXPECT_FALSE(mThrottleVsyncCallRecorder.waitForUnexpectedCall().has_value());
 }
 
 } // namespace
@@ -134,8 +134,14 @@ public:
                 a.presentTime == b.presentTime;
     }
 
-    const std::map<int64_t, TimelineItem>& getPredictions() const {
-        return mTokenManager->mPredictions;
+    std::map<int64_t, TimelineItem> getPredictions() const {
+        std::map<int64_t, TimelineItem> predictions;
+        for (const auto& slot : mTokenManager->mPredictionSlots) {
+            if (slot.token != FrameTimelineInfo::INVALID_VSYNC_ID) {
+                predictions.emplace(slot.token, slot.predictions);
+            }
+        }
+        return predictions;
     }
 
     uint32_t getNumberOfDisplayFrames() const {
@@ -179,5 +179,33 @@ TEST_F(HWComposerLayerGenericMetadataTest, forwardsSupportedMetadata) {
     EXPECT_EQ(hal::Error::UNSUPPORTED, result);
 }
 
+struct HWComposerLayerStateCachingTest : public HWComposerLayerTest {
+    HWComposerLayerStateCachingTest() : HWComposerLayerTest({}) {}
+};
+
+TEST_F(HWComposerLayerStateCachingTest, skipsRedundantLayerStateCommands) {
+    EXPECT_CALL(*mHal, setLayerBlendMode(kDisplayId, kLayerId, hal::BlendMode::PREMULTIPLIED))
+            .WillOnce(Return(V2_1::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setBlendMode(hal::BlendMode::PREMULTIPLIED));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setBlendMode(hal::BlendMode::PREMULTIPLIED));
+
+    EXPECT_CALL(*mHal, setLayerBlendMode(kDisplayId, kLayerId, hal::BlendMode::NONE))
+            .WillOnce(Return(V2_1::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setBlendMode(hal::BlendMode::NONE));
+
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 2u))
+            .WillOnce(Return(V2_1::Error::NONE));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(2u));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(2u));
+}
+
+TEST_F(HWComposerLayerStateCachingTest, doesNotCacheFailedLayerStateCommands) {
+    EXPECT_CALL(*mHal, setLayerZOrder(kDisplayId, kLayerId, 1u))
+            .WillOnce(Return(V2_1::Error::BAD_LAYER))
+            .WillOnce(Return(V2_1::Error::NONE));
+    EXPECT_EQ(hal::Error::BAD_LAYER, mLayer.setZOrder(1u));
+    EXPECT_EQ(hal::Error::NONE, mLayer.setZOrder(1u));
+}
+
 } // namespace
 } // namespace android
@@ -29,8 +29,17 @@ class LayerInfoTest : public testing::Test {
 protected:
     using FrameTimeData = LayerInfo::FrameTimeData;
 
+    static constexpr size_t kHistorySize = LayerInfo::HISTORY_SIZE;
+
     void setFrameTimes(const std::deque<FrameTimeData>& frameTimes) {
-        layerInfo.mFrameTimes = frameTimes;
+        layerInfo.mFrameTimes.clear();
+        layerInfo.mFrameTimeStats = {};
+        for (const auto& frameTime : frameTimes) {
+            layerInfo.recordFrameTime(frameTime);
+            if (layerInfo.mFrameTimes.size() > kHistorySize) {
+                layerInfo.evictOldestFrameTime();
+            }
+        }
     }
 
     void setLastRefreshRate(Fps fps) {
@@ -177,5 +186,40 @@ TEST_F(LayerInfoTest, ignoresLargePeriods) {
             << "Expected " << averageFps << " to be equal to " << kExpectedFps;
 }
 
+// Old frames are evicted from the history once it is full. Make sure the
+// incrementally maintained average stays in sync with the remaining window.
+TEST_F(LayerInfoTest, staysAccurateAfterEviction) {
+    std::deque<FrameTimeData> frameTimes;
+    constexpr auto kOldFps = Fps(25.0f);
+    constexpr auto kOldPeriod = kOldFps.getPeriodNsecs();
+    constexpr auto kExpectedFps = Fps(50.0f);
+    constexpr auto kExpectedPeriod = kExpectedFps.getPeriodNsecs();
+    constexpr auto kSmallPeriod = Fps(250.0f).getPeriodNsecs();
+
+    // Start with frames at a lower rate, including duplicates, which all get evicted once
+    // enough frames at the expected rate are recorded on top of them.
+    nsecs_t time = 0;
+    for (size_t i = 0; i < kHistorySize; i++) {
+        time += kOldPeriod;
+        frameTimes.push_back(
+                FrameTimeData{.presentTime = time, .queueTime = 0, .pendingModeChange = false});
+        frameTimes.push_back(FrameTimeData{.presentTime = time + kSmallPeriod,
+                                           .queueTime = 0,
+                                           .pendingModeChange = false});
+    }
+    for (size_t i = 0; i <= kHistorySize; i++) {
+        time += kExpectedPeriod;
+        frameTimes.push_back(
+                FrameTimeData{.presentTime = time, .queueTime = 0, .pendingModeChange = false});
+    }
+
+    setFrameTimes(frameTimes);
+    const auto averageFrameTime = calculateAverageFrameTime();
+    ASSERT_TRUE(averageFrameTime.has_value());
+    const auto averageFps = Fps::fromPeriodNsecs(*averageFrameTime);
+    ASSERT_TRUE(kExpectedFps.equalsWithMargin(averageFps))
+            << "Expected " << averageFps << " to be equal to " << kExpectedFps;
+}
+
 } // namespace
 } // namespace android::scheduler
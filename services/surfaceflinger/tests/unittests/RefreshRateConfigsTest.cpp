@@ -91,6 +91,20 @@ protected:
         return refreshRateConfigs.lastBestRefreshRateInvocation;
     }
 
+    float calculateLayerScore(const RefreshRateConfigs& refreshRateConfigs,
+                              const LayerRequirement& layer, const RefreshRate& refreshRate,
+                              bool isSeamlessSwitch) {
+        std::lock_guard lock(refreshRateConfigs.mLock);
+        return refreshRateConfigs.calculateLayerScoreLocked(layer, refreshRate, isSeamlessSwitch);
+    }
+
+    float computeLayerScore(const RefreshRateConfigs& refreshRateConfigs,
+                            const LayerRequirement& layer, const RefreshRate& refreshRate,
+                            bool isSeamlessSwitch) {
+        std::lock_guard lock(refreshRateConfigs.mLock);
+        return refreshRateConfigs.computeLayerScoreLocked(layer, refreshRate, isSeamlessSwitch);
+    }
+
     // Test config IDs
     static inline const DisplayModeId HWC_CONFIG_ID_60 = DisplayModeId(0);
     static inline const DisplayModeId HWC_CONFIG_ID_90 = DisplayModeId(1);
@@ -2296,6 +2310,35 @@ TEST_F(RefreshRateConfigsTest, updateDisplayModes) {
             getMinSupportedRefreshRate(*refreshRateConfigs).getFps().equalsWithMargin(Fps(60.0)));
 }
 
+TEST_F(RefreshRateConfigsTest, precomputedLayerScoresMatchComputedScores) {
+    auto refreshRateConfigs =
+            std::make_unique<RefreshRateConfigs>(m30_60_72_90_120Device,
+                                                 /*currentConfigId=*/HWC_CONFIG_ID_60);
+
+    constexpr LayerVoteType kVotes[] = {LayerVoteType::Heuristic, LayerVoteType::ExplicitDefault,
+                                        LayerVoteType::ExplicitExactOrMultiple,
+                                        LayerVoteType::ExplicitExact};
+
+    LayerRequirement layer = {.weight = 1.0f};
+    for (const auto vote : kVotes) {
+        layer.vote = vote;
+        for (const auto frameRate : getKnownFrameRate(*refreshRateConfigs)) {
+            layer.desiredRefreshRate = frameRate;
+            for (const auto& mode : m30_60_72_90_120Device) {
+                const RefreshRate refreshRate = createRefreshRate(mode);
+                for (const bool isSeamlessSwitch : {false, true}) {
+                    EXPECT_EQ(computeLayerScore(*refreshRateConfigs, layer, refreshRate,
+                                                isSeamlessSwitch),
+                              calculateLayerScore(*refreshRateConfigs, layer, refreshRate,
+                                                  isSeamlessSwitch))
+                            << "vote " << RefreshRateConfigs::layerVoteTypeString(vote) << " at "
+                            << to_string(frameRate) << " for mode " << mode->getId().value();
+                }
+            }
+        }
+    }
+}
+
 } // namespace
 } // namespace scheduler
 } // namespace android
@@ -46,5 +46,16 @@ TEST_F(DisplayTransactionTest, notifyPowerBoostNotifiesTouchEvent) {
     EXPECT_TRUE(mFlinger.scheduler()->isTouchActive());
 }
 
+TEST_F(DisplayTransactionTest, notifyPowerBoostAppliesTouchBoostSynchronously) {
+    mFlinger.scheduler()->replaceTouchTimer(100);
+    std::this_thread::sleep_for(110ms); // wait for the initial reset to expire
+    EXPECT_FALSE(mFlinger.scheduler()->isTouchActive());
+
+    // The interaction boost takes effect on the calling thread, with no wait for
+    // the touch timer thread.
+    EXPECT_EQ(NO_ERROR, mFlinger.notifyPowerBoost(static_cast<int32_t>(Boost::INTERACTION)));
+    EXPECT_TRUE(mFlinger.scheduler()->isTouchActive());
+}
+
 } // namespace
 } // namespace android
\ No newline at end of file
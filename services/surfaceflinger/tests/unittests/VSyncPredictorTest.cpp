@@ -532,6 +532,45 @@ TEST_F(VSyncPredictorTest, robustToDuplicateTimestamps_60hzRealTraceData) {
     EXPECT_THAT(intercept, IsCloseTo(expectedIntercept, mMaxRoundingError));
 }
 
+TEST_F(VSyncPredictorTest, kalmanEstimatorTracksPeriod) {
+    VSyncPredictor kalmanTracker{mPeriod, kHistorySize, kMinimumSamplesForPrediction,
+                                 kOutlierTolerancePercent, /*enableKalmanEstimator=*/true};
+    auto const slightlyMorePeriod = mPeriod + 5;
+    for (auto i = 0u; i < kHistorySize; i++) {
+        EXPECT_TRUE(kalmanTracker.addVsyncTimestamp(mNow += slightlyMorePeriod));
+    }
+
+    EXPECT_FALSE(kalmanTracker.needsMoreSamples());
+    auto const model = kalmanTracker.getVSyncPredictionModel();
+    EXPECT_THAT(model.slope, IsCloseTo(slightlyMorePeriod, mMaxRoundingError));
+    EXPECT_THAT(kalmanTracker.nextAnticipatedVSyncTimeFrom(mNow),
+                IsCloseTo(mNow + slightlyMorePeriod, mMaxRoundingError));
+}
+
+TEST_F(VSyncPredictorTest, kalmanEstimatorConvergesBeforeMinimumSamples) {
+    VSyncPredictor kalmanTracker{mPeriod, kHistorySize, kMinimumSamplesForPrediction,
+                                 kOutlierTolerancePercent, /*enableKalmanEstimator=*/true};
+    EXPECT_TRUE(kalmanTracker.needsMoreSamples());
+    for (auto i = 0u; i < kMinimumSamplesForPrediction - 1; i++) {
+        kalmanTracker.addVsyncTimestamp(mNow += mPeriod);
+    }
+
+    // With clean samples the filter is confident before the fixed sample count the
+    // regression would require.
+    EXPECT_FALSE(kalmanTracker.needsMoreSamples());
+
+    auto const changedPeriod = mPeriod * 2;
+    kalmanTracker.setPeriod(changedPeriod);
+    EXPECT_TRUE(kalmanTracker.needsMoreSamples());
+
+    for (auto i = 0u; i < kMinimumSamplesForPrediction - 1; i++) {
+        kalmanTracker.addVsyncTimestamp(mNow += changedPeriod);
+    }
+    EXPECT_FALSE(kalmanTracker.needsMoreSamples());
+    EXPECT_THAT(kalmanTracker.getVSyncPredictionModel().slope,
+                IsCloseTo(changedPeriod, mMaxRoundingError));
+}
+
 } // namespace android::scheduler
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
@@ -30,6 +30,7 @@
 #include <mutex>
 #include <new>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 
@@ -1193,10 +1194,15 @@ bool EnsureInitialized() {
         return initialized;
 
     init_attempted_for_pid = getpid();
-    if (driver::OpenHAL()) {
-        DiscoverLayers();
+
+    // Layer discovery is filesystem work (scanning the layer directories and
+    // dlopening every candidate to enumerate it) with no dependency on the
+    // driver, so let it run concurrently with the HAL probe instead of after
+    // it. Nothing reads the discovered layers until we return.
+    std::thread discovery(DiscoverLayers);
+    if (driver::OpenHAL())
         initialized = true;
-    }
+    discovery.join();
 
     return initialized;
 }